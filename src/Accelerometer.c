@@ -0,0 +1,309 @@
+//============================================================================
+// Name        : Accelerometer.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Reads the accelerometer of the TomTom and estimates bank angle, turn rate and slip
+//============================================================================
+
+//The event loop polls the device 50 times per second: the samples waiting in the FIFO of the driver are
+//moved in a ring and then filtered one by one. The TomTom has a two axes accelerometer and no gyros: in a
+//coordinated turn the lateral axis reads nothing, so it gives only the slip (the ball of a turn coordinator),
+//while the vertical axis gives the load factor n=1/cos(bank). A complementary filter keeps the fast changes of
+//the bank of the load factor and follows slowly the bank of a coordinated turn at the speed and turn rate of
+//the GPS, which also tells the side of the turn. The first seconds of samples, with the device at rest, are
+//taken as the zero of the lateral axis and as 1 g of the vertical one.
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include "Accelerometer.h"
+#include "Configuration.h"
+#include "GPSreceiver.h"
+#include "EventLoop.h"
+#include "AirCalc.h"
+#include "Logger.h"
+
+#define ACCEL_POLL_PERIOD     20   //ms between two reads of the device: 50 Hz
+#define ACCEL_RING_SIZE      256   //samples, power of 2 bigger than the FIFO of the driver
+#define ACCEL_CALIBRATION    2.0   //s of samples at rest to calibrate the axes
+#define ACCEL_VIBRATION_TAU  0.2   //s, time constant of the low pass filter of the samples against the vibrations
+#define ACCEL_GPS_TAU        2.0   //s, time constant with which the bank follows the one of the GPS
+#define ACCEL_MIN_SPEED     10.0   //m/s, below this the turn rate is not calculated from the bank
+#define ACCEL_MIN_TURN     0.005   //rad/s of the GPS below which the side of the turn is unknown and the load factor is not used
+#define ACCEL_MAX_GAP        0.5   //s between two samples after which the filter starts again from the last one
+#define GRAVITY          9.80665   //m/s^2
+
+struct AccelerometerStruct {
+	const struct AccelDevice *device;
+	int timer;                             //ID of the polling timer of the event loop, -1 if not started
+	FILE *captureFile;                     //where the samples are recorded, NULL if not recording
+	ACCMETER_DATA ring[ACCEL_RING_SIZE];   //samples read waiting to be filtered
+	unsigned int head,tail;                //samples written and filtered, they wrap
+	bool calibrated;
+	double calibrationStart;               //s, timestamp of the first sample of the calibration
+	double sumLateral,sumVertical;         //sums of the raw samples during the calibration
+	long calibrationSamples;
+	double zeroLateral,countsPerG;         //calibration of the axes
+	double lastSample;                     //s, timestamp of the last sample filtered
+	double lateral,vertical;               //g, after the low pass filter
+	double accelBank;                      //rad, bank of the load factor of the last sample
+	double bank;                           //rad, estimate
+	double gpsSpeed,gpsTurnRate;           //m/s and rad/s of the last GPS data
+	unsigned int gpsVersion;               //version of the last GPS data taken
+	unsigned long samples;                 //samples filtered
+	struct AccelAttitude published[2];     //readers use the one of version, the filter writes the other
+	volatile unsigned int version;         //incremented after each publication
+};
+
+struct accelDeviceFile { //state of the devices: only one is used at a time
+	int fd;                                //the driver, -1 if closed
+	FILE *file;                            //the recording, NULL if closed
+	unsigned long start;                   //EventLoopNow() of the opening of the recording
+	double firstSample;                    //s, timestamp of the first recorded sample
+	ACCMETER_DATA next;                    //recorded sample not due yet
+	bool hasNext;
+};
+
+void pollAccelerometer(void *arg);
+void accelFilterSample(const ACCMETER_DATA *sample);
+void accelPublish(void);
+double accelTimestamp(const ACCMETER_DATA *sample);
+bool accelOpenTomTom(const char *devName, int rate);
+int accelReadTomTom(ACCMETER_DATA *samples, int max);
+void accelCloseTomTom(void);
+bool accelOpenRecorded(const char *devName, int rate);
+int accelReadRecorded(ACCMETER_DATA *samples, int max);
+void accelCloseRecorded(void);
+
+static struct AccelerometerStruct Accelerometer = {
+	.device=NULL,
+	.timer=-1,
+	.captureFile=NULL,
+	.published={{.valid=false},{.valid=false}},
+	.version=0
+};
+
+static struct accelDeviceFile AccelFile = {
+	.fd=-1,
+	.file=NULL
+};
+
+const struct AccelDevice AccelDeviceTomTom = {
+	.name="accelerometer",
+	.open=accelOpenTomTom,
+	.read=accelReadTomTom,
+	.close=accelCloseTomTom
+};
+
+const struct AccelDevice AccelDeviceRecorded = {
+	.name="recording of the accelerometer",
+	.open=accelOpenRecorded,
+	.read=accelReadRecorded,
+	.close=accelCloseRecorded
+};
+
+double accelTimestamp(const ACCMETER_DATA *sample) {
+	return sample->u32sTimeStamp+sample->u32usTimeStamp*1e-6;
+}
+
+bool accelOpenTomTom(const char *devName, int rate) {
+	AccelFile.fd=open(devName,O_RDONLY|O_NOCTTY|O_NONBLOCK);
+	if(AccelFile.fd<0) return false;
+	if(ioctl(AccelFile.fd,IOW_ACC_SAMPLINGRATE,rate)!=0) LogWrite(LOG_WARNING,LOG_ACCEL,"unable to set the sampling rate to %d Hz.\n",rate);
+	return true;
+}
+
+int accelReadTomTom(ACCMETER_DATA *samples, int max) {
+	int redBytes=read(AccelFile.fd,samples,max*sizeof(ACCMETER_DATA));
+	if(redBytes<0) return errno==EAGAIN||errno==EINTR?0:-1;
+	return redBytes/sizeof(ACCMETER_DATA); //the driver gives whole samples
+}
+
+void accelCloseTomTom(void) {
+	if(AccelFile.fd>=0) close(AccelFile.fd);
+	AccelFile.fd=-1;
+}
+
+bool accelOpenRecorded(const char *devName, int rate) { //the rate is the one of the recording
+	AccelFile.file=fopen(devName,"rb");
+	if(AccelFile.file==NULL) return false;
+	AccelFile.hasNext=fread(&AccelFile.next,sizeof(ACCMETER_DATA),1,AccelFile.file)==1;
+	AccelFile.firstSample=AccelFile.hasNext?accelTimestamp(&AccelFile.next):0;
+	AccelFile.start=EventLoopNow();
+	return true;
+}
+
+int accelReadRecorded(ACCMETER_DATA *samples, int max) { //the samples whose time has come since the opening
+	double elapsed=(EventLoopNow()-AccelFile.start)*0.001;
+	int num=0;
+	while(num<max && AccelFile.hasNext && accelTimestamp(&AccelFile.next)-AccelFile.firstSample<=elapsed) {
+		samples[num++]=AccelFile.next;
+		AccelFile.hasNext=fread(&AccelFile.next,sizeof(ACCMETER_DATA),1,AccelFile.file)==1;
+	}
+	return num==0 && !AccelFile.hasNext?-1:num;
+}
+
+void accelCloseRecorded(void) {
+	if(AccelFile.file!=NULL) fclose(AccelFile.file);
+	AccelFile.file=NULL;
+}
+
+bool AccelerometerStart(const struct AccelDevice *device) {
+	if(Accelerometer.timer>=0) return true;
+	if(config.accelDevName==NULL) config.accelDevName=strdup("/dev/"ACC_DEVNAME); //Default value
+	if(!device->open(config.accelDevName,config.accelRate)) {
+		LogWrite(LOG_ERROR,LOG_ACCEL,"unable to open the %s %s.\n",device->name,config.accelDevName);
+		return false;
+	}
+	Accelerometer.device=device;
+	Accelerometer.head=0;
+	Accelerometer.tail=0;
+	Accelerometer.calibrated=false;
+	Accelerometer.calibrationSamples=0;
+	Accelerometer.samples=0;
+	Accelerometer.gpsVersion=0;
+	Accelerometer.gpsSpeed=0;
+	Accelerometer.gpsTurnRate=0;
+	if(config.accelCaptureFile!=NULL) {
+		Accelerometer.captureFile=fopen(config.accelCaptureFile,"wb");
+		if(Accelerometer.captureFile==NULL) LogWrite(LOG_WARNING,LOG_ACCEL,"unable to record the samples in %s.\n",config.accelCaptureFile);
+	}
+	Accelerometer.timer=EventLoopAddTimer(ACCEL_POLL_PERIOD,pollAccelerometer,NULL);
+	if(Accelerometer.timer<0) {
+		AccelerometerClose();
+		return false;
+	}
+	LogWrite(LOG_INFO,LOG_ACCEL,"reading the %s %s, calibrating it in the first %.0f s.\n",device->name,config.accelDevName,ACCEL_CALIBRATION);
+	return true;
+}
+
+void AccelerometerClose(void) { //to be called by the thread of the event loop
+	if(Accelerometer.device==NULL) return;
+	EventLoopRemoveTimer(Accelerometer.timer);
+	Accelerometer.timer=-1;
+	Accelerometer.device->close();
+	Accelerometer.device=NULL;
+	if(Accelerometer.captureFile!=NULL) fclose(Accelerometer.captureFile);
+	Accelerometer.captureFile=NULL;
+	Accelerometer.published[(Accelerometer.version+1)&1].valid=false; //no more estimates
+	MEMORY_BARRIER();
+	Accelerometer.version++;
+	LogWrite(LOG_INFO,LOG_ACCEL,"%lu samples filtered.\n",Accelerometer.samples);
+}
+
+void pollAccelerometer(void *arg) { //called by the event loop: moves the samples from the device to the ring and filters them
+	int num=0;
+	struct GPSdata data;
+	unsigned int version=GPSgetData(&data);
+	if(version!=Accelerometer.gpsVersion) { //the GPS tells the side of the turn and the slow part of the bank
+		Accelerometer.gpsVersion=version;
+		Accelerometer.gpsSpeed=data.speedKmh>0?Kmh2ms(data.speedKmh):0;
+		Accelerometer.gpsTurnRate=Deg2Rad(data.turnRateDegSec);
+	}
+	do {
+		unsigned int used=Accelerometer.head-Accelerometer.tail, start=Accelerometer.head&(ACCEL_RING_SIZE-1);
+		unsigned int space=ACCEL_RING_SIZE-used;
+		if(space>ACCEL_RING_SIZE-start) space=ACCEL_RING_SIZE-start; //till the end of the ring, the rest at the next round
+		if(space==0) break;
+		num=Accelerometer.device->read(&Accelerometer.ring[start],space);
+		if(num>0) {
+			if(Accelerometer.captureFile!=NULL) fwrite(&Accelerometer.ring[start],sizeof(ACCMETER_DATA),num,Accelerometer.captureFile);
+			Accelerometer.head+=num;
+		}
+	} while(num>0);
+	if(Accelerometer.head==Accelerometer.tail) {
+		if(num<0) { //the device is gone or the recording is over
+			LogWrite(LOG_WARNING,LOG_ACCEL,"no more samples from the %s.\n",Accelerometer.device->name);
+			AccelerometerClose();
+		}
+		return;
+	}
+	while(Accelerometer.tail!=Accelerometer.head) accelFilterSample(&Accelerometer.ring[(Accelerometer.tail++)&(ACCEL_RING_SIZE-1)]);
+	if(Accelerometer.calibrated) accelPublish();
+}
+
+void accelFilterSample(const ACCMETER_DATA *sample) {
+	double t=accelTimestamp(sample);
+	double rawLateral=config.accelLateralAxis==0?sample->u32xData:sample->u32yData;
+	double rawVertical=config.accelLateralAxis==0?sample->u32yData:sample->u32xData;
+	if(!Accelerometer.calibrated) { //the device is at rest: the lateral axis reads 0 and the vertical one 1 g
+		if(Accelerometer.calibrationSamples==0) {
+			Accelerometer.calibrationStart=t;
+			Accelerometer.sumLateral=0;
+			Accelerometer.sumVertical=0;
+		}
+		Accelerometer.sumLateral+=rawLateral;
+		Accelerometer.sumVertical+=rawVertical;
+		Accelerometer.calibrationSamples++;
+		if(t-Accelerometer.calibrationStart<ACCEL_CALIBRATION) return;
+		Accelerometer.zeroLateral=Accelerometer.sumLateral/Accelerometer.calibrationSamples;
+		Accelerometer.countsPerG=Accelerometer.sumVertical/Accelerometer.calibrationSamples-config.accelZero; //negative if the axis points down
+		Accelerometer.calibrationSamples=0;
+		if(fabs(Accelerometer.countsPerG)<1) {
+			LogWrite(LOG_WARNING,LOG_ACCEL,"the vertical axis does not feel the gravity, check lateralAxis and zero: calibrating again.\n");
+			return;
+		}
+		LogWrite(LOG_INFO,LOG_ACCEL,"calibrated: lateral zero %.1f, %.1f counts per g.\n",Accelerometer.zeroLateral,fabs(Accelerometer.countsPerG));
+		Accelerometer.calibrated=true;
+		Accelerometer.lastSample=t;
+		Accelerometer.lateral=0;
+		Accelerometer.vertical=1;
+		Accelerometer.accelBank=0;
+		Accelerometer.bank=0;
+		return;
+	}
+	double dt=t-Accelerometer.lastSample;
+	Accelerometer.lastSample=t;
+	double lateral=(rawLateral-Accelerometer.zeroLateral)/fabs(Accelerometer.countsPerG);
+	double vertical=(rawVertical-config.accelZero)/Accelerometer.countsPerG;
+	if(config.accelLateralInverted) lateral=-lateral;
+	if(dt<=0 || dt>ACCEL_MAX_GAP) { //start again from this sample
+		Accelerometer.lateral=lateral;
+		Accelerometer.vertical=vertical;
+		return;
+	}
+	double k=dt/(ACCEL_VIBRATION_TAU+dt);
+	Accelerometer.lateral+=k*(lateral-Accelerometer.lateral);
+	Accelerometer.vertical+=k*(vertical-Accelerometer.vertical);
+	double n=hypot(Accelerometer.lateral,Accelerometer.vertical); //load factor
+	double accelBank=n>1&&fabs(Accelerometer.gpsTurnRate)>ACCEL_MIN_TURN?acos(1/n):0;
+	if(Accelerometer.gpsTurnRate<0) accelBank=-accelBank; //turning to the left
+	double gpsBank=atan(Accelerometer.gpsSpeed*Accelerometer.gpsTurnRate/GRAVITY); //bank of a coordinated turn
+	double a=ACCEL_GPS_TAU/(ACCEL_GPS_TAU+dt);
+	Accelerometer.bank=a*(Accelerometer.bank+accelBank-Accelerometer.accelBank)+(1-a)*gpsBank;
+	Accelerometer.accelBank=accelBank;
+	Accelerometer.samples++;
+}
+
+void accelPublish(void) {
+	unsigned int next=Accelerometer.version+1;
+	struct AccelAttitude *attitude=&Accelerometer.published[next&1]; //the copy not visible to the readers
+	attitude->valid=true;
+	attitude->bankDeg=Rad2Deg(Accelerometer.bank);
+	if(Accelerometer.gpsSpeed>ACCEL_MIN_SPEED) attitude->turnRateDegSec=Rad2Deg(GRAVITY*tan(Accelerometer.bank)/Accelerometer.gpsSpeed);
+	else attitude->turnRateDegSec=Rad2Deg(Accelerometer.gpsTurnRate);
+	attitude->slipG=-Accelerometer.lateral; //the ball goes on the other side of the lateral acceleration
+	attitude->loadFactor=Accelerometer.vertical;
+	MEMORY_BARRIER(); //the copy must be complete before the readers can see it
+	Accelerometer.version=next;
+}
+
+unsigned int AccelerometerGetAttitude(struct AccelAttitude *attitude) { //consistent copy of the last estimate
+	unsigned int version;
+	do { //retry only if the filter published twice during the copy
+		version=Accelerometer.version;
+		MEMORY_BARRIER();
+		*attitude=Accelerometer.published[version&1];
+		MEMORY_BARRIER();
+	} while(version!=Accelerometer.version);
+	return version;
+}
@@ -0,0 +1,41 @@
+//============================================================================
+// Name        : Accelerometer.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Reads the accelerometer of the TomTom and estimates bank angle, turn rate and slip
+//============================================================================
+
+#ifndef ACCELEROMETER_H_
+#define ACCELEROMETER_H_
+
+#include <barcelona/Barc_acc.h>
+#include "Common.h"
+
+struct AccelDevice { //where the samples come from: the accelerometer of the TomTom or a recording of it
+	const char *name;
+	bool (*open)(const char *devName, int rate);
+	int (*read)(ACCMETER_DATA *samples, int max); //the samples available now without waiting, -1 when there will be no more
+	void (*close)(void);
+};
+
+struct AccelAttitude {
+	bool valid;                //false until calibrated
+	double bankDeg;            //positive to the right
+	double turnRateDegSec;     //positive to the right
+	double slipG;              //lateral acceleration in g: the ball of the turn coordinator, positive to the right
+	double loadFactor;         //g along the vertical axis
+};
+
+extern const struct AccelDevice AccelDeviceTomTom;   //the driver of /dev/acc
+extern const struct AccelDevice AccelDeviceRecorded; //a file of samples as given by the driver, played at their pace
+
+bool AccelerometerStart(const struct AccelDevice *device); //to be called by the thread of the event loop
+void AccelerometerClose(void);
+unsigned int AccelerometerGetAttitude(struct AccelAttitude *attitude); //any thread, returns the version of the estimate
+
+#endif /* ACCELEROMETER_H_ */
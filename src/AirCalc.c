@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 28/2/2016
+// Last change : 18/10/2026
 // Description : Collection of functions for air navigation calculation
 //============================================================================
 
@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "AirCalc.h"
+#include "FastTrig.h"
 
 //Internal AirCalc calculation defines
 #define EARTH_RADIUS_KM 6371
@@ -30,6 +31,7 @@
 #define YARD_M          0.9144   //1 yard = 0.9144 m (3 Ft)
 #define SEC_HOUR        0.00027777777777777778  // 1/3600
 #define DEG2RAD         (M_PI/180)
+#define GEO2RAD         (M_PI/(180.0*GEO_UNITS_DEG)) //units of GeoPosition to rad
 #define RAD2DEG         (180/M_PI)
 #define RAD2NM          ((180*60)/M_PI)
 
@@ -37,6 +39,32 @@
 //this is used in calcRhumbLineRoute to avoid 0/0 indeterminacies on E-W courses.
 #define SQRT_TOL 1e-8 //sqrt(TOL)=sqrt(1e-16)=1e-8 (6.4 cm)
 
+//Numeric backend of the navigation math (see AirCalc.h)
+#if AIRCALC_BACKEND==AIRCALC_FIXED //integers only, with the trigonometry from the tables of FastTrig
+#define Q30_ONE          1073741824.0
+#define compMul(a,b)     ((nVectorComp)(((long long)(a)*(b))>>30))
+#define comp2Dbl(c)      ((c)/Q30_ONE)
+#define dbl2Comp(d)      ((nVectorComp)floor((d)*Q30_ONE+0.5))
+#else
+#if AIRCALC_BACKEND==AIRCALC_DOUBLE
+typedef double navReal;
+#define navSin(x)      sin(x)
+#define navCos(x)      cos(x)
+#define navAsin(x)     asin(x)
+#define navAtan2(y,x)  atan2(y,x)
+#define navSqrt(x)     sqrt(x)
+#else //no FPU: single precision
+typedef float navReal;
+#define navSin(x)      sinf(x)
+#define navCos(x)      cosf(x)
+#define navAsin(x)     asinf(x)
+#define navAtan2(y,x)  atan2f(y,x)
+#define navSqrt(x)     sqrtf(x)
+#endif
+#define compMul(a,b)     ((a)*(b))
+#define comp2Dbl(c)      ((double)(c))
+#define dbl2Comp(d)      ((nVectorComp)(d))
+#endif
 
 double Km2Nm(const double valueKmh) {
 	return valueKmh/NM_KM;
@@ -86,14 +114,16 @@ double calcTotalSpeed(const double hSpeed, const double vSpeed) {
 	return sqrt(pow(hSpeed,2)+pow(vSpeed,2));
 }
 
-double latDegMin2rad(const int degrees, const float minutes, const bool N) {
-	if(N) return (degrees+minutes*SIXTYTH)*DEG2RAD; //North latitudes positive
-	else return -(degrees+minutes*SIXTYTH)*DEG2RAD; //South latitudes negative
+double geoLat2rad(const int lat) {
+	return lat*GEO2RAD; //North latitudes positive
 }
 
-double lonDegMin2rad(const int degrees, const float minutes, const bool E) {
-	if(E) return -(degrees+minutes*SIXTYTH)*DEG2RAD; //Here we consider East longitudes as negative
-	else return (degrees+minutes*SIXTYTH)*DEG2RAD; //... and West longitudes as positive
+double geoLon2rad(const int lon) {
+	return -(lon*GEO2RAD); //GeoPosition is East positive but here we consider East longitudes as negative
+}
+
+double geo2Deg(const int coord) {
+	return (double)coord/GEO_UNITS_DEG;
 }
 
 double latDegMinSec2rad(const int deg, const int min, const float sec, const bool N) {
@@ -139,9 +169,16 @@ double calcGreatCircleRoute(const double lat1, const double lon1, const double l
 		if(lat1>lat2) return M_PI;
 		else return TWO_PI;
 	}
-	double tc=acos((sin(lat2)-sin(lat1)*cos(*d))/(sin(*d)*cos(lat1)));
+#if AIRCALC_BACKEND==AIRCALC_DOUBLE
+	double cosTc=(sin(lat2)-sin(lat1)*cos(*d))/(sin(*d)*cos(lat1));
+	if(cosTc>1) cosTc=1; //only by rounding, close to N or S courses
+	else if(cosTc<-1) cosTc=-1;
+	double tc=acos(cosTc);
 	if(sin(lon2-lon1)>0) tc=TWO_PI-tc;
 	return tc;
+#else
+	return calcGreatCircleCourse(lat1,lon1,lat2,lon2); //in single precision acos loses too much on short legs
+#endif
 }
 
 double calcGreatCircleCourse(const double lat1, const double lon1, const double lat2, const double lon2) { //not require pre-computation of distance
@@ -151,7 +188,16 @@ double calcGreatCircleCourse(const double lat1, const double lon1, const double
 			if(lat1>lat2) return M_PI;
 			else return TWO_PI;
 	}
-	return absAngle(atan2(sin(lon1-lon2)*cos(lat2),cos(lat1)*sin(lat2)-sin(lat1)*cos(lat2)*cos(lon1-lon2)));
+#if AIRCALC_BACKEND==AIRCALC_FIXED
+	unsigned int lat1Angle=FastTrigRad2Angle(lat1), lat2Angle=FastTrigRad2Angle(lat2), dLonAngle=FastTrigRad2Angle(lon1-lon2);
+	int cosLat2=FastTrigCos(lat2Angle);
+	int y=compMul(FastTrigSin(dLonAngle),cosLat2);
+	int x=compMul(FastTrigCos(lat1Angle),FastTrigSin(lat2Angle))-compMul(compMul(FastTrigSin(lat1Angle),cosLat2),FastTrigCos(dLonAngle));
+	return FastTrigAngle2Rad(FastTrigAtan2(y,x));
+#else
+	navReal dLon=lon1-lon2, cosLat2=navCos((navReal)lat2);
+	return absAngle(navAtan2(navSin(dLon)*cosLat2,navCos((navReal)lat1)*navSin((navReal)lat2)-navSin((navReal)lat1)*cosLat2*navCos(dLon)));
+#endif
 }
 
 double calcGreatCircleFinalCourse(const double lat1, const double lon1, const double lat2, const double lon2) {
@@ -159,7 +205,19 @@ double calcGreatCircleFinalCourse(const double lat1, const double lon1, const do
 }
 
 double calcAngularDist(const double lat1, const double lon1, const double lat2, const double lon2) {
+#if AIRCALC_BACKEND==AIRCALC_DOUBLE
 	return acos(sin(lat1)*sin(lat2)+cos(lat1)*cos(lat2)*cos(lon1-lon2));
+#elif AIRCALC_BACKEND==AIRCALC_FIXED //the haversine summed in Q60, to keep the cm also on short distances
+	long long sinDLat=FastTrigSin(FastTrigRad2Angle((lat1-lat2)/2)), sinDLon=FastTrigSin(FastTrigRad2Angle((lon1-lon2)/2));
+	long long cosLats=compMul(FastTrigCos(FastTrigRad2Angle(lat1)),FastTrigCos(FastTrigRad2Angle(lat2)));
+	unsigned long long h=sinDLat*sinDLat+((cosLats*sinDLon)>>30)*sinDLon;
+	if(h>1ULL<<60) h=1ULL<<60; //only by rounding
+	return 2*FastTrigAngle2SignedRad(FastTrigAsin(FastTrigSqrt(h)));
+#else //the haversine: in single precision acos of a value close to 1 would be Km wrong
+	navReal sinDLat=navSin((navReal)(lat1-lat2)/2), sinDLon=navSin((navReal)(lon1-lon2)/2);
+	navReal h=sinDLat*sinDLat+navCos((navReal)lat1)*navCos((navReal)lat2)*sinDLon*sinDLon;
+	return 2*navAsin(h<1?navSqrt(h):1);
+#endif
 }
 
 double calcSmallAngularDist(const double lat1, const double lon1, const double lat2, const double lon2) { //less subject to rounding error for short distances
@@ -249,6 +307,14 @@ void convertDecimal2DegMinSec(const double dec, int *deg, int *min, float *sec)
 	*sec=(decimalMin-*min)/SIXTYTH;
 }
 
+void convertGeo2DegMinSec(const int coord, int *deg, int *min, int *milliSec) { //of the absolute value, only with integers
+	int units=coord<0?-coord:coord;
+	*deg=units/GEO_UNITS_DEG;
+	units=(units%GEO_UNITS_DEG)*60; //1e-7 minutes
+	*min=units/GEO_UNITS_DEG;
+	*milliSec=(units%GEO_UNITS_DEG)*6/1000; //from 1e-7 minutes to ms of second
+}
+
 void convertRad2DegMinSec(const double rad, int *deg, int *min, float *sec) {
 	convertDecimal2DegMinSec(Rad2Deg(rad),deg,min,sec);
 }
@@ -315,3 +381,119 @@ bool bisectorOverpassed(const double currCourse, const double actualCurrCourse,
 	else //currCourse is between bisector2 and bisector1
 		return isAngleBetween(bisector1,actualCurrCourse,bisector2);
 }
+
+//Great circle legs as n-vectors: the trigonometry is done once for each leg by calcGCleg(), then for each
+//position only its n-vector needs sin and cos, while along and cross track errors, courses and the passage
+//of the bisectors are made of dot and cross products, with one atan2 and one asin at most.
+//The legs are calculated in double from latitude and longitude with any backend, then stored as nVectorComp.
+
+nVectorComp dot(const struct nVector *a, const struct nVector *b);
+void cross(const struct nVector *a, const struct nVector *b, struct nVector *c);
+double courseTowards(const struct nVector *p, const struct nVector *dir);
+void comp2Double(const struct nVector *n, double v[3]);
+void double2Comp(const double v[3], struct nVector *n);
+
+nVectorComp dot(const struct nVector *a, const struct nVector *b) {
+	return compMul(a->x,b->x)+compMul(a->y,b->y)+compMul(a->z,b->z);
+}
+
+void cross(const struct nVector *a, const struct nVector *b, struct nVector *c) {
+	c->x=compMul(a->y,b->z)-compMul(a->z,b->y);
+	c->y=compMul(a->z,b->x)-compMul(a->x,b->z);
+	c->z=compMul(a->x,b->y)-compMul(a->y,b->x);
+}
+
+void comp2Double(const struct nVector *n, double v[3]) {
+	v[0]=comp2Dbl(n->x);
+	v[1]=comp2Dbl(n->y);
+	v[2]=comp2Dbl(n->z);
+}
+
+void double2Comp(const double v[3], struct nVector *n) {
+	n->x=dbl2Comp(v[0]);
+	n->y=dbl2Comp(v[1]);
+	n->z=dbl2Comp(v[2]);
+}
+
+void latLon2nVector(const double lat, const double lon, struct nVector *n) { //longitude positive to West, as everywhere here
+#if AIRCALC_BACKEND==AIRCALC_FIXED
+	unsigned int latAngle=FastTrigRad2Angle(lat), lonAngle=FastTrigRad2Angle(lon);
+	nVectorComp cosLat=FastTrigCos(latAngle);
+	n->x=compMul(cosLat,FastTrigCos(lonAngle));
+	n->y=-compMul(cosLat,FastTrigSin(lonAngle));
+	n->z=FastTrigSin(latAngle);
+#else
+	navReal cosLat=navCos((navReal)lat);
+	n->x=cosLat*navCos((navReal)lon);
+	n->y=-cosLat*navSin((navReal)lon);
+	n->z=navSin((navReal)lat);
+#endif
+}
+
+void calcGCleg(const double lat1, const double lon1, const double lat2, const double lon2, struct GCleg *leg) {
+	double f[3]={cos(lat1)*cos(lon1),-cos(lat1)*sin(lon1),sin(lat1)};
+	double t[3]={cos(lat2)*cos(lon2),-cos(lat2)*sin(lon2),sin(lat2)};
+	double normal[3]={f[1]*t[2]-f[2]*t[1],f[2]*t[0]-f[0]*t[2],f[0]*t[1]-f[1]*t[0]};
+	double sinDist=sqrt(normal[0]*normal[0]+normal[1]*normal[1]+normal[2]*normal[2]);
+	if(sinDist>0) {
+		normal[0]/=sinDist;
+		normal[1]/=sinDist;
+		normal[2]/=sinDist;
+	} //else the points are the same or antipodal: no great circle, any position is abeam the start
+	double along[3]={normal[1]*f[2]-normal[2]*f[1],normal[2]*f[0]-normal[0]*f[2],normal[0]*f[1]-normal[1]*f[0]};
+	double2Comp(f,&leg->from);
+	double2Comp(normal,&leg->normal);
+	double2Comp(along,&leg->along);
+	struct nVector to;
+	latLon2nVector(lat2,lon2,&to);
+	calcLegCrossTrackError(leg,&to,&leg->dist); //as the ATD of the n-vector of the end of the leg, so it is exactly reached there
+}
+
+double calcLegCrossTrackError(const struct GCleg *leg, const struct nVector *p, double *atd) { //XTD positive at right, ATD negative before the start
+#if AIRCALC_BACKEND==AIRCALC_FIXED
+	*atd=FastTrigAngle2SignedRad(FastTrigAtan2(dot(p,&leg->along),dot(p,&leg->from)));
+	return FastTrigAngle2SignedRad(FastTrigAsin(-dot(p,&leg->normal)));
+#else
+	*atd=navAtan2(dot(p,&leg->along),dot(p,&leg->from));
+	navReal sinXtd=-dot(p,&leg->normal);
+	if(sinXtd>1) sinXtd=1; //only by rounding
+	else if(sinXtd<-1) sinXtd=-1;
+	return navAsin(sinXtd);
+#endif
+}
+
+double courseTowards(const struct nVector *p, const struct nVector *dir) { //true course at p of a direction, not normalized
+	nVectorComp east=compMul(p->x,dir->y)-compMul(p->y,dir->x); //components along the local East and North, both multiplied by cos(lat)
+	nVectorComp north=compMul(compMul(p->x,p->x)+compMul(p->y,p->y),dir->z)-compMul(p->z,compMul(p->x,dir->x)+compMul(p->y,dir->y));
+#if AIRCALC_BACKEND==AIRCALC_FIXED
+	return FastTrigAngle2Rad(FastTrigAtan2(east,north));
+#else
+	return absAngle(navAtan2(east,north));
+#endif
+}
+
+double calcNvectorCourse(const struct nVector *p, const struct nVector *to) { //initial great circle course from p to to
+	return courseTowards(p,to);
+}
+
+double calcLegCourseAbeam(const struct GCleg *leg, const struct nVector *p) { //course of the leg at the point of the leg nearest to p
+	struct nVector dir;
+	cross(&leg->normal,p,&dir); //the direction of the leg abeam p: the component of p along the normal does not matter
+	return courseTowards(p,&dir);
+}
+
+void calcBisectorNormal(const struct nVector *wp, const struct GCleg *in, const struct GCleg *out, struct nVector *passNormal) {
+	double w[3],n[3],a[3];
+	comp2Double(wp,w);
+	comp2Double(&in->normal,n);
+	comp2Double(&out->along,a);
+	double sum[3]={ //perpendicular to the bisector, pointing forward: the direction of the incoming leg at the WP plus the outgoing one
+		(n[1]*w[2]-n[2]*w[1]+a[0])/2, //halved to stay in the range of the fixed point, only its sign is used
+		(n[2]*w[0]-n[0]*w[2]+a[1])/2,
+		(n[0]*w[1]-n[1]*w[0]+a[2])/2};
+	double2Comp(sum,passNormal);
+}
+
+bool bisectorPassed(const struct nVector *passNormal, const struct nVector *p) {
+	return dot(p,passNormal)>0;
+}
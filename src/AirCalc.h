@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 28/2/2016
+// Last change : 18/10/2026
 // Description : Header of AirCalc.c
 //============================================================================
 
@@ -21,6 +21,44 @@
 #define SIXTYTH 0.01666666666666666667 // 1/60
 #define MILE_FT 5280 //1 Mile = 5280 Ft (1760 Yards)
 
+//Numeric backend of the navigation math done for each fix, chosen at build time with NAVMATH in the Makefile:
+//AIRCALC_DOUBLE: as always, reference for the others
+//AIRCALC_FLOAT:  single precision, less soft-float work on targets without FPU
+//AIRCALC_FIXED:  n-vectors in Q30 fixed point and trigonometry from the tables of FastTrig: integers only
+//It affects the great circle distance and courses and the n-vectors followed for each fix, while the legs are always
+//calculated in double and the interfaces stay in double. The largest errors respect long double measured by
+//utility/airCalcAccuracy on legs from 100 m to 1000 Km all over the Earth, up to 5 Km off track (courses towards
+//points at least 1 Km away):
+//                distance   course     XTD      ATD
+//AIRCALC_DOUBLE  0.1 mm     0.006 deg  0.1 mm   0.1 mm
+//AIRCALC_FLOAT   1.5 m      0.09 deg   1.0 m    1.1 m
+//AIRCALC_FIXED   0.1 m      0.005 deg  0.08 m   0.09 m   (FastTrig tables of 12 bits)
+#define AIRCALC_DOUBLE 1
+#define AIRCALC_FLOAT  2
+#define AIRCALC_FIXED  3
+
+#ifndef AIRCALC_BACKEND
+#define AIRCALC_BACKEND AIRCALC_DOUBLE
+#endif
+
+#if AIRCALC_BACKEND==AIRCALC_FIXED
+typedef int nVectorComp; //Q30: 1 is 2^30
+#elif AIRCALC_BACKEND==AIRCALC_FLOAT
+typedef float nVectorComp;
+#else
+typedef double nVectorComp;
+#endif
+
+struct nVector { //unit vector from the center of the Earth: x to lat 0 lon 0, y to lat 0 lon 90 E, z to the N pole
+	nVectorComp x,y,z;
+};
+
+struct GCleg { //great circle leg precomputed as n-vectors, to be followed with products instead of trigonometry
+	struct nVector from;   //start of the leg
+	struct nVector normal; //unit normal of the great circle, on the left of the leg
+	struct nVector along;  //unit vector 90 deg from the start along the leg: from, along and normal are orthonormal
+	double dist;           //rad
+};
 
 double Km2Nm(const double valueKm);
 double Nm2Km(const double valueNm);
@@ -34,8 +72,9 @@ double ms2Kmh(const double valueMs);
 double FtMin2ms(const double valueFtMin);
 double ms2FtMin(const double valueMs);
 double calcTotalSpeed(const double hSpeed, const double vSpeed);
-double latDegMin2rad(const int degrees, const float minutes, const bool N);
-double lonDegMin2rad(const int degrees, const float minutes, const bool E);
+double geoLat2rad(const int lat); //from GeoPosition, only where trigonometry is needed
+double geoLon2rad(const int lon);
+double geo2Deg(const int coord);
 double latDegMinSec2rad(const int deg, const int min, const float sec, const bool N);
 double lonDegMinSec2rad(const int deg, const int min, const float sec, const bool E);
 double calcAngularDist(const double lat1, const double lon1, const double lat2, const double lon2);
@@ -58,6 +97,7 @@ bool isAngleBetween(double low, double angle, double hi);
 double calcGCCrossTrackError(const double lat1, const double lon1, const double lon2, const double latX, const double lonX, const double course12, double *atd);
 void convertDecimal2DegMin(const double dec, int *deg, double *min);
 void convertDecimal2DegMinSec(const double dec, int *deg, int *min, float *sec);
+void convertGeo2DegMinSec(const int coord, int *deg, int *min, int *milliSec);
 void convertRad2DegMinSec(const double rad, int *deg, int *min, float *sec);
 void convertTimestamp2HourMinSec(const float timestamp, int *hour, int *min, float *sec);
 double calcWindDirSpeed(const double crs, const double hd, const double tas, const double gs, double *ws);
@@ -66,5 +106,12 @@ double calcCourseGroundSpeed(const double hd, const double wd, const double tas,
 void calcHeadCrossWindComp(const double ws, const double wd, const double rd, double *hw, double *xw);
 void calcBisector(double currCourse, const double nextCourse, double *bisector, double *bisectorOpposite);
 bool bisectorOverpassed(const double currCourse, const double actualCurrCourse, const double bisector1, const double bisector2);
+void latLon2nVector(const double lat, const double lon, struct nVector *n);
+void calcGCleg(const double lat1, const double lon1, const double lat2, const double lon2, struct GCleg *leg);
+double calcLegCrossTrackError(const struct GCleg *leg, const struct nVector *p, double *atd);
+double calcNvectorCourse(const struct nVector *p, const struct nVector *to);
+double calcLegCourseAbeam(const struct GCleg *leg, const struct nVector *p);
+void calcBisectorNormal(const struct nVector *wp, const struct GCleg *in, const struct GCleg *out, struct nVector *passNormal);
+bool bisectorPassed(const struct nVector *passNormal, const struct nVector *p);
 
 #endif
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 28/2/2016
+// Last change : 18/10/2026
 // Description : Produces tracelogFiles as XML GPX files
 //============================================================================
 
@@ -15,11 +15,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 #include <math.h>
 #include "BlackBox.h"
 #include "Configuration.h"
 #include "AirCalc.h"
+#include "TimeBase.h"
 
 #define MIN_DIST 0.00000109872 // 7 m in Rad
 
@@ -32,8 +32,8 @@ enum blackBoxStatus {
 };
 
 struct BlackBoxStruct {
-	double lastlat, lastlon, minlat, minlon, maxlat, maxlon;
-	float currTimestamp,lastTimestamp;
+	struct GeoPosition last, min, max; //last point recorded and bounds of the track
+	long long lastUtc; //us from 1/1/1970 of the last point recorded
 	double updateDist; //here in rad
 	int cyear,cmonth,cday,chour,cmin,csec; //creation time of the track file
 	char *filename;
@@ -43,7 +43,7 @@ struct BlackBoxStruct {
 };
 
 bool openRecordingFile(void);
-void recordPos(double lat, double lon, float timestamp, int year, int month, int day, int hour, int min, float sec);
+void recordPos(const struct GeoPosition *pos, long long utc);
 
 static struct BlackBoxStruct BlackBox = {
 	.filename=NULL,
@@ -53,17 +53,15 @@ static struct BlackBoxStruct BlackBox = {
 
 void BlackBoxStart(void) {
 	if(BlackBox.status!=BBS_NOT_SET) return;
-	BlackBox.lastTimestamp=-config.recordTimeInterval;
 	BlackBox.trackPointCounter=0;
-	BlackBox.minlat=90;
-	BlackBox.minlon=180;
-	BlackBox.maxlat=-90;
-	BlackBox.maxlon=-180;
+	BlackBox.min.lat=90*GEO_UNITS_DEG;
+	BlackBox.min.lon=180*GEO_UNITS_DEG;
+	BlackBox.max.lat=-90*GEO_UNITS_DEG;
+	BlackBox.max.lon=-180*GEO_UNITS_DEG;
 	BlackBox.updateDist=m2Rad(config.recordMinDist);
 	if(BlackBox.updateDist<MIN_DIST) BlackBox.updateDist=MIN_DIST;
 	struct tm time_str;
-	long currTime=time(NULL); //get current time from internal clock
-	time_str=*localtime(&currTime); //to obtain day, month, year, hour and minute
+	TimeBaseSplit(TimeBaseNow(),&time_str); //UTC of the GPS, or of the RTC if the GPS has not given it yet
 	BlackBox.cyear=time_str.tm_year+1900; //year time of creation of the track file
 	BlackBox.cmonth=time_str.tm_mon+1; //month
 	BlackBox.cday=time_str.tm_mday; //creation day
@@ -114,48 +112,44 @@ bool BlackBoxIsPaused(void) {
 	return(BlackBox.status==BBS_PAUSED);
 }
 
-void recordPos(double lat, double lon, float timestamp, int year, int month, int day, int hour, int min, float sec) {
+void recordPos(const struct GeoPosition *pos, long long utc) { //East longitudes are positive as in GPX
+	struct tm time_str;
+	TimeBaseSplit(utc,&time_str);
 	BlackBox.trackPointCounter++;
-	BlackBox.lastlat=lat;
-	BlackBox.lastlon=lon;
-	BlackBox.lastTimestamp=timestamp;
-	lat=Rad2Deg(lat);
-	lon=-Rad2Deg(lon); //For the GPX standard East longitudes are positive
-	if(lat<BlackBox.minlat) BlackBox.minlat=lat;
-	if(lon<BlackBox.minlon) BlackBox.minlon=lon;
-	if(lat>BlackBox.maxlat) BlackBox.maxlat=lat;
-	if(lon>BlackBox.maxlon) BlackBox.maxlon=lon;
-	fprintf(BlackBox.tracklogFile,"<trkpt lat=\"%f\" lon=\"%f\">\n"
-			"<time>%d-%02d-%02dT%02d:%02d:%06.3fZ</time>\n",lat,lon,year,month,day,hour,min,sec);
+	BlackBox.last=*pos;
+	BlackBox.lastUtc=utc;
+	if(pos->lat<BlackBox.min.lat) BlackBox.min.lat=pos->lat;
+	if(pos->lon<BlackBox.min.lon) BlackBox.min.lon=pos->lon;
+	if(pos->lat>BlackBox.max.lat) BlackBox.max.lat=pos->lat;
+	if(pos->lon>BlackBox.max.lon) BlackBox.max.lon=pos->lon;
+	fprintf(BlackBox.tracklogFile,"<trkpt lat=\"" GEO_FORMAT "\" lon=\"" GEO_FORMAT "\">\n"
+			"<time>%d-%02d-%02dT%02d:%02d:%06.3fZ</time>\n",GEO_PRINT(pos->lat),GEO_PRINT(pos->lon),time_str.tm_year+1900,time_str.tm_mon+1,time_str.tm_mday,time_str.tm_hour,time_str.tm_min,time_str.tm_sec+(utc%1000000)*1e-6);
 	BlackBox.status=BBS_WAIT_OPT;
 }
 
-bool BlackBoxRecordPos(double lat, double lon, float timestamp, int hour, int min, float sec, int day, int month, int year, bool dateChanged) {
+bool BlackBoxRecordPos(const struct GeoPosition *pos, long long utc) {
 	bool retval=false;
 	switch(BlackBox.status) {
 		case BBS_WAIT_FIX:
-			if(openRecordingFile()) recordPos(lat,lon,timestamp,year,month,day,hour,min,sec);
+			if(openRecordingFile()) recordPos(pos,utc);
 			break;
 		case BBS_WAIT_POS: {
-			double deltaT;
-			if(dateChanged) BlackBox.lastTimestamp-=86400;
-			if(timestamp>BlackBox.lastTimestamp) deltaT=timestamp-BlackBox.lastTimestamp;
-			else {
+			double deltaT=(utc-BlackBox.lastUtc)*1e-6; //s, it does not wrap at midnight
+			if(deltaT<=0) {
 				retval=false;
 				break;
 			}
 			if(deltaT>=config.recordTimeInterval) {
-				double deltaS;
-				deltaS=calcAngularDist(lat,lon,BlackBox.lastlat,BlackBox.lastlon);
+				double deltaS=calcAngularDist(geoLat2rad(pos->lat),geoLon2rad(pos->lon),geoLat2rad(BlackBox.last.lat),geoLon2rad(BlackBox.last.lon));
 				if(deltaS>=BlackBox.updateDist) {
-					recordPos(lat,lon,timestamp,year,month,day,hour,min,sec);
+					recordPos(pos,utc);
 					retval=true;
 				}
 			}
 		} break;
 		case BBS_WAIT_OPT:
 			BlackBoxCommit();
-			retval=BlackBoxRecordPos(lat,lon,timestamp,hour,min,sec,day,month,year,dateChanged);
+			retval=BlackBoxRecordPos(pos,utc);
 			break;
 		case BBS_NOT_SET: //do nothing
 		case BBS_PAUSED: //do nothing
@@ -182,6 +176,24 @@ bool BlackBoxRecordCourse(double course) {
 	return true;
 }
 
+bool BlackBoxRecordClimb(double climbMs) { //vertical speed in m/s
+	if(BlackBox.status!=BBS_WAIT_OPT) return false;
+	fprintf(BlackBox.tracklogFile,"<climb>%.2f</climb>\n",climbMs);
+	return true;
+}
+
+bool BlackBoxRecordTurnRate(double turnRateDegSec) { //positive to the right
+	if(BlackBox.status!=BBS_WAIT_OPT) return false;
+	fprintf(BlackBox.tracklogFile,"<turnrate>%.2f</turnrate>\n",turnRateDegSec);
+	return true;
+}
+
+bool BlackBoxRecordSource(const char *source) { //the GPS source of the point, when there are more than one
+	if(BlackBox.status!=BBS_WAIT_OPT) return false;
+	fprintf(BlackBox.tracklogFile,"<src>%s</src>\n",source);
+	return true;
+}
+
 bool BlackBoxCommit(void) {
 	if(BlackBox.status!=BBS_WAIT_OPT) return false;
 	fprintf(BlackBox.tracklogFile,"</trkpt>\n");
@@ -207,9 +219,10 @@ void BlackBoxClose(void) {
 				"<text>AirNavigator website</text>\n"
 				"</link>\n"
 				"<time>%d-%02d-%02dT%02d:%02d:%02dZ</time>\n"
-				"<bounds minlat=\"%f\" minlon=\"%f\" maxlat=\"%f\" maxlon=\"%f\"/>\n"
+				"<bounds minlat=\"" GEO_FORMAT "\" minlon=\"" GEO_FORMAT "\" maxlat=\"" GEO_FORMAT "\" maxlon=\"" GEO_FORMAT "\"/>\n"
 				"</metadata>\n"
-				"</gpx>",BlackBox.trackPointCounter,BlackBox.filename,BlackBox.cyear,BlackBox.cmonth,BlackBox.cday,BlackBox.chour,BlackBox.cmin,BlackBox.csec,BlackBox.minlat,BlackBox.minlon,BlackBox.maxlat,BlackBox.maxlon);
+				"</gpx>",BlackBox.trackPointCounter,BlackBox.filename,BlackBox.cyear,BlackBox.cmonth,BlackBox.cday,BlackBox.chour,BlackBox.cmin,BlackBox.csec,
+				GEO_PRINT(BlackBox.min.lat),GEO_PRINT(BlackBox.min.lon),GEO_PRINT(BlackBox.max.lat),GEO_PRINT(BlackBox.max.lon));
 		fclose(BlackBox.tracklogFile);
 	}
 	free(BlackBox.filename);
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 8/12/2013
+// Last change : 18/10/2026
 // Description : Produces tracelogFiles as XML GPX files
 //============================================================================
 
@@ -17,10 +17,13 @@
 
 void BlackBoxStart(void);
 bool BlackBoxIsStarted(void);
-bool BlackBoxRecordPos(double lat, double lon, float timestamp, int hour, int min, float sec, int day, int month, int year, bool dateChanged);
+bool BlackBoxRecordPos(const struct GeoPosition *pos, long long utc);
 bool BlackBoxRecordAlt(double altMt);
 bool BlackBoxRecordSpeed(double speedMTSec);
 bool BlackBoxRecordCourse(double course);
+bool BlackBoxRecordClimb(double climbMs);
+bool BlackBoxRecordTurnRate(double turnRateDegSec);
+bool BlackBoxRecordSource(const char *source);
 bool BlackBoxCommit(void);
 void BlackBoxPause(void);
 bool BlackBoxIsPaused(void);
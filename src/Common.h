@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 8/12/2013
+// Last change : 18/10/2026
 // Description : Common definitions of AirNavigator
 //============================================================================
 
@@ -15,10 +15,27 @@
 
 #define BASE_PATH "/mnt/sdcard/AirNavigator/"
 
+//Memory barrier for data shared between threads without mutex
+#if defined(__GNUC__) && (__GNUC__>4 || (__GNUC__==4 && __GNUC_MINOR__>=1))
+#define MEMORY_BARRIER() __sync_synchronize()
+#else
+#define MEMORY_BARRIER() __asm__ __volatile__("":::"memory") //ARM920T is single core: a compiler barrier is enough
+#endif
+
 typedef char bool;
 
 enum boolean { false, true };
 
+//Position as given by the GPS, from the parsers to the navigator: 1e-7 degrees in 32 bits (about 1 cm)
+#define GEO_UNITS_DEG 10000000
+#define GEO_NO_POS    2000000000 //latitude of a position not known yet
+#define GEO_FORMAT    "%s%d.%07d" //in decimal degrees without floating point, with GEO_PRINT()
+#define GEO_PRINT(c)  (c)<0?"-":"",((c)<0?-(c):(c))/GEO_UNITS_DEG,((c)<0?-(c):(c))%GEO_UNITS_DEG
+
+struct GeoPosition {
+	int lat,lon; //North and East positive
+};
+
 enum mainStatus {
 	MAIN_NOT_INIT,
 	MAIN_DISPLAY_MENU,
@@ -27,10 +44,9 @@ enum mainStatus {
 	MAIN_DISPLAY_SUNRISE_SUNSET
 };
 
-bool openLog(void);
-int printLog(const char *texts, ...);
+bool openLog(void);                     //the log functions are in Logger.c
+int printLog(const char *texts, ...);   //texts must be a literal
 void closeLog(void);
-float getCurrentTime(void);
 enum mainStatus getMainStatus(void);
 
 #endif
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 21/3/2016
+// Last change : 18/10/2026
 // Description : Implementation of Config with the shared config data struct
 //============================================================================
 
@@ -19,6 +19,18 @@
 #include "AirCalc.h"
 #include "FBrender.h"
 
+#define GPS_SOURCE_DEFAULTS { \
+	.devName=NULL, \
+	.protocol=GPS_PROTOCOL_NMEA, \
+	.rate=0, \
+	.baudRate=115200, \
+	.dataBits=8, \
+	.stopBits=1, \
+	.parity=0, \
+	.minRead=1, \
+	.endOfBurst="" \
+}
+
 struct configuration config = { //Default configuration values
 	.distUnit=KM,
 	.trackErrUnit=MT,
@@ -34,11 +46,25 @@ struct configuration config = { //Default configuration values
 	.timeZone=1, //+1 hour for most of Europe
 	.recordTimeInterval=5, //sec
 	.recordMinDist=10, //meters
-	.GPSdevName=NULL,
-	.GPSbaudRate=115200,
-	.GPSdataBits=8,
-	.GPSstopBits=1,
-	.GPSparity=0,
+	.GPSsources={GPS_SOURCE_DEFAULTS},
+	.numOfGPSsources=1,
+	.GPSbufferSize=65536,
+	.GPScaptureFile=NULL,
+	.GPSfilterEnabled=true,
+	.GPSfilterRate=5,
+	.accelEnabled=false,
+	.accelDevName=NULL,
+	.accelRate=100,
+	.accelLateralAxis=1,
+	.accelLateralInverted=false,
+	.accelZero=2048,
+	.accelCaptureFile=NULL,
+	.logLevels={LOG_INFO,LOG_INFO,LOG_INFO,LOG_INFO,LOG_INFO,LOG_INFO,LOG_INFO,LOG_INFO,LOG_INFO},
+	.logRingSize=16384,
+	.logMaxFileSize=1048576,
+	.logMaxFiles=3,
+	.traceEnabled=false,
+	.GPSreplayFile=NULL,
 	.tomtomModel=NULL,
 	.serialNumber=NULL,
 	.colorSchema = {       //Default colors
@@ -321,34 +347,167 @@ void loadConfig(void) { //Load configuration
 					}
 				} else printLog("WARNING: in the color schema the colors are missing, using default colors.\n");
 			} else printLog("WARNING: no color schema found, using default colors.\n");
-			part=roxml_get_chld(root,"GPSreceiver",0);
-			if(part!=NULL) {
+			int sources;
+			for(sources=0;sources<GPS_MAX_SOURCES && (part=roxml_get_chld(root,"GPSreceiver",sources))!=NULL;sources++) { //one for each GPS receiver
+				struct GPSsourceConfig *source=&config.GPSsources[sources];
+				*source=(struct GPSsourceConfig)GPS_SOURCE_DEFAULTS;
 				attr=roxml_get_attr(part,"devName",0);
 				if(attr!=NULL) {
 					text=roxml_get_content(attr,NULL,0,NULL);
-					config.GPSdevName=strdup(text);
+					source->devName=strdup(text);
+				}
+				attr=roxml_get_attr(part,"protocol",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					if(strcmp(text,"SiRF")==0 || strcmp(text,"sirf")==0 || strcmp(text,"SIRF")==0) source->protocol=GPS_PROTOCOL_SIRF;
+					else if(strcmp(text,"UBX")==0 || strcmp(text,"ubx")==0) source->protocol=GPS_PROTOCOL_UBX;
+					else source->protocol=GPS_PROTOCOL_NMEA;
+				}
+				attr=roxml_get_attr(part,"rate",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					source->rate=atoi(text);
+					if(source->rate<0 || source->rate>50) source->rate=0;
 				}
 				attr=roxml_get_attr(part,"baudRate",0);
 				if(attr!=NULL) {
 					text=roxml_get_content(attr,NULL,0,NULL);
-					config.GPSbaudRate=atol(text);
+					source->baudRate=atol(text); //"auto" gives 0: the baud rate is detected
 				}
 				attr=roxml_get_attr(part,"dataBits",0);
 				if(attr!=NULL) {
 					text=roxml_get_content(attr,NULL,0,NULL);
-					config.GPSdataBits=atoi(text);
+					source->dataBits=atoi(text);
 				}
 				attr=roxml_get_attr(part,"stopBits",0);
 				if(attr!=NULL) {
 					text=roxml_get_content(attr,NULL,0,NULL);
-					config.GPSstopBits=atoi(text);
+					source->stopBits=atoi(text);
 				}
 				attr=roxml_get_attr(part,"parity",0);
 				if(attr!=NULL) {
 					text=roxml_get_content(attr,NULL,0,NULL);
-					config.GPSparity=atoi(text);
+					source->parity=atoi(text);
+				}
+				attr=roxml_get_attr(part,"minRead",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					source->minRead=atoi(text);
+					if(source->minRead<1 || source->minRead>255) source->minRead=1;
+				}
+				attr=roxml_get_attr(part,"bufferSize",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.GPSbufferSize=atol(text);
+				}
+				attr=roxml_get_attr(part,"endOfBurst",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					if(strlen(text)==3) strcpy(source->endOfBurst,text);
+					else source->endOfBurst[0]='\0'; //auto: learned from the sentences
+				}
+				attr=roxml_get_attr(part,"captureFile",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					if(text[0]!='\0' && config.GPScaptureFile==NULL) config.GPScaptureFile=strdup(text);
+				}
+			}
+			if(sources>0) config.numOfGPSsources=sources;
+			else printLog("WARNING: no GPS receiver configuration found, using default values.\n");
+			part=roxml_get_chld(root,"GPSfilter",0);
+			if(part!=NULL) {
+				attr=roxml_get_attr(part,"enabled",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.GPSfilterEnabled=strcmp(text,"on")==0;
+				}
+				attr=roxml_get_attr(part,"rate",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.GPSfilterRate=atoi(text);
+					if(config.GPSfilterRate<0 || config.GPSfilterRate>20) config.GPSfilterRate=5;
+				}
+			}
+			part=roxml_get_chld(root,"accelerometer",0);
+			if(part!=NULL) {
+				attr=roxml_get_attr(part,"enabled",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.accelEnabled=strcmp(text,"on")==0;
+				}
+				attr=roxml_get_attr(part,"devName",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					if(text[0]!='\0') config.accelDevName=strdup(text);
+				}
+				attr=roxml_get_attr(part,"rate",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.accelRate=atoi(text);
+					if(config.accelRate<1 || config.accelRate>100) config.accelRate=100; //the driver samples from 1 to 100 Hz
+				}
+				attr=roxml_get_attr(part,"lateralAxis",0);
+				if(attr!=NULL) { //x, y, -x or -y
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.accelLateralInverted=text[0]=='-';
+					config.accelLateralAxis=text[config.accelLateralInverted?1:0]=='x'?0:1;
+				}
+				attr=roxml_get_attr(part,"zero",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.accelZero=atoi(text);
+				}
+				attr=roxml_get_attr(part,"captureFile",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					if(text[0]!='\0') config.accelCaptureFile=strdup(text);
+				}
+			}
+			part=roxml_get_chld(root,"clock",0);
+			if(part!=NULL) {
+				attr=roxml_get_attr(part,"replay",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					if(text[0]!='\0') config.GPSreplayFile=strdup(text);
+				}
+			}
+			part=roxml_get_chld(root,"log",0);
+			if(part!=NULL) {
+				attr=roxml_get_attr(part,"level",0);
+				if(attr!=NULL) { //level of all the subsystems
+					text=roxml_get_content(attr,NULL,0,NULL);
+					enum logLevel level=LogParseLevel(text,LOG_INFO);
+					for(int i=0;i<LOG_NUM_SUBSYSTEMS;i++) config.logLevels[i]=level;
+				}
+				for(int i=0;i<LOG_NUM_SUBSYSTEMS;i++) { //level of each subsystem
+					attr=roxml_get_attr(part,LogSubsystemName(i),0);
+					if(attr!=NULL) {
+						text=roxml_get_content(attr,NULL,0,NULL);
+						config.logLevels[i]=LogParseLevel(text,config.logLevels[i]);
+					}
+				}
+				attr=roxml_get_attr(part,"ringSize",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.logRingSize=atol(text);
+				}
+				attr=roxml_get_attr(part,"maxFileSize",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.logMaxFileSize=atol(text);
+				}
+				attr=roxml_get_attr(part,"files",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.logMaxFiles=atoi(text);
+					if(config.logMaxFiles<1) config.logMaxFiles=1;
+				}
+				attr=roxml_get_attr(part,"trace",0);
+				if(attr!=NULL) {
+					text=roxml_get_content(attr,NULL,0,NULL);
+					config.traceEnabled=strcmp(text,"on")==0;
 				}
-			} else printLog("WARNING: no GPS receiver configuration found, using default values.\n");
+			} else printLog("WARNING: no log configuration found, using default values.\n");
 		} else printLog("ERROR: configuration file config.xml with root element wrong.\n");
 		roxml_release(RELEASE_ALL);
 		roxml_close(root);
@@ -6,13 +6,15 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 2/8/2014
+// Last change : 18/10/2026
 // Description : Header of Config with the shared config data struct
 //============================================================================
 
 #ifndef CONFIGURATION_H_
 #define CONFIGURATION_H_
 
+#include "Logger.h"
+
 enum lengthMeasureUnit {
 	KM,  //Distance in Kilometers
 	NM,  //Distance in Nautical Miles
@@ -29,6 +31,24 @@ enum speedMesureUnit {
 	MS     //Vertical speed in Meters each Second
 };
 
+enum GPSprotocol {
+	GPS_PROTOCOL_NMEA, //NMEA 0183 sentences
+	GPS_PROTOCOL_SIRF, //SiRF binary messages
+	GPS_PROTOCOL_UBX   //u-blox UBX binary messages
+};
+
+#define GPS_MAX_SOURCES 3 //GPS receivers read at the same time
+
+struct GPSsourceConfig {
+	char *devName;
+	enum GPSprotocol protocol; //protocol spoken by the GPS receiver
+	int rate; //navigation rate in Hz to set in the receiver (only UBX), 0 to keep its own
+	long baudRate; //0 to detect it, used only if the device is a serial port
+	short dataBits, stopBits, parity;
+	int minRead; //bytes the serial port waits for before to wake up the reader (VMIN)
+	char endOfBurst[4]; //NMEA sentence type sent last in each receiver cycle, empty to learn it
+};
+
 struct colorConfig {
 	unsigned short background;
 	unsigned short compassRose;
@@ -65,9 +85,25 @@ struct configuration {
 	int timeZone; //local time offset from UTC time in hours
 	double recordTimeInterval; //sec
 	double recordMinDist; //meters
-	char *GPSdevName;
-	long GPSbaudRate;
-	short GPSdataBits, GPSstopBits, GPSparity;
+	struct GPSsourceConfig GPSsources[GPS_MAX_SOURCES]; //in order of preference
+	int numOfGPSsources;
+	unsigned int GPSbufferSize; //size in bytes of the ring between the reader and the parser of each GPS source
+	char *GPScaptureFile; //where to capture the raw stream of the first GPS source, NULL not to capture it
+	bool GPSfilterEnabled; //smooth the GPS solutions with the Kalman filter
+	int GPSfilterRate; //Hz of the outputs of the filter between the solutions, 0 only at the solutions
+	bool accelEnabled; //read the accelerometer to show the turn coordinator
+	char *accelDevName; //the accelerometer device or a file of samples recorded from it
+	int accelRate; //Hz of the samples of the accelerometer
+	short accelLateralAxis; //0 if the lateral axis of the aircraft is x of the accelerometer, 1 if it is y
+	bool accelLateralInverted; //the axis is positive to the left
+	int accelZero; //raw value of the accelerometer with no acceleration
+	char *accelCaptureFile; //where to record the samples of the accelerometer, NULL not to record them
+	enum logLevel logLevels[LOG_NUM_SUBSYSTEMS]; //max level of the messages logged for each subsystem
+	unsigned int logRingSize; //size in bytes of the log ring of each thread
+	unsigned long logMaxFileSize; //size in bytes after which a new log file is started
+	short logMaxFiles; //number of log files kept
+	bool traceEnabled; //record the latency of the GPS fixes in trace.bin
+	char *GPSreplayFile; //capture of the first GPS source replayed on the virtual clock, NULL to read the devices
 	char *tomtomModel; //model of the TomtTom device
 	char *serialNumber; //TomTom device serial number ID
 	struct colorConfig colorSchema;
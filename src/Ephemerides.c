@@ -6,18 +6,16 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 2/8/2013
+// Last change : 18/10/2026
 // Description : Functions to manage sunrise and sunset times
 //============================================================================
 
 #include <math.h>
 #include <stdlib.h>
-#include <time.h>
-#include <pthread.h>
 #include "Ephemerides.h"
 #include "AirCalc.h"
 #include "Configuration.h"
-#include "GPSreceiver.h"
+#include "TimeBase.h"
 
 
 //struct EphemeridesStruct Ephemerides = {
@@ -67,25 +65,15 @@ int calcSunriseSunset(double lat, double lon, int day, int month, int year, doub
 	return retVal;
 }
 
-int calcSunriseSunsetWithInternalClockTime(double lat, double lon, double *riseTime, double *setTime) {
+int calcSunriseSunsetToday(double lat, double lon, double *riseTime, double *setTime) { //the date of the GPS, or of the RTC before the GPS gives it
 	struct tm time_str;
-	long timestamp=time(NULL); //get current time
-	time_str=*localtime(&timestamp); //to obtain day, month, year, hour and minute
-	int year=time_str.tm_year+1900; //year
-	int month=time_str.tm_mon+1; //month
-	int day=time_str.tm_mday; //day
-	return calcSunriseSunset(lat,lon,day,month,year,config.sunZenith,config.timeZone,riseTime,setTime);
+	TimeBaseSplit(TimeBaseNow(),&time_str);
+	return calcSunriseSunset(lat,lon,time_str.tm_mday,time_str.tm_mon+1,time_str.tm_year+1900,config.sunZenith,0,riseTime,setTime);
 }
 
 void calcFlightPlanEphemerides(double lat, double lon, bool isDeparture) {
 	double riseTime, setTime;
-	if(gps.fixMode>MODE_NO_FIX) {
-		//TODO: can we avoid to lock the mutex here?
-		pthread_mutex_lock(&gps.mutex);
-		calcSunriseSunset(lat,lon,gps.day,gps.month,gps.year,config.sunZenith,0,&riseTime,&setTime);
-		pthread_mutex_unlock(&gps.mutex);
-	}
-	else calcSunriseSunsetWithInternalClockTime(lat,lon,&riseTime,&setTime);
+	calcSunriseSunsetToday(lat,lon,&riseTime,&setTime);
 	if(isDeparture) {
 		//Ephemerides.departurePresent=true;
 		convertDecimal2DegMinSec(riseTime,&Ephemerides.deparure.sunriseHour,&Ephemerides.deparure.sunriseMin,&Ephemerides.deparure.sunriseSec);
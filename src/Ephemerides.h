@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 2/8/2013
+// Last change : 18/10/2026
 // Description : Functions to manage sunrise and sunset times
 //============================================================================
 
@@ -41,7 +41,7 @@ struct EphemeridesStruct {
 struct EphemeridesStruct Ephemerides;
 
 int calcSunriseSunset(double lat, double lon, int day, int month, int year, double zenith, int localOffset, double *riseTime, double *setTime);
-int calcSunriseSunsetWithInternalClockTime(double lat, double lon, double *riseTime, double *setTime);
+int calcSunriseSunsetToday(double lat, double lon, double *riseTime, double *setTime); //UTC times of the day of the time base
 void calcFlightPlanEphemerides(double lat, double lon, bool isDeparture);
 
 #endif /* EPHEMERIDES_H_ */
@@ -0,0 +1,234 @@
+//============================================================================
+// Name        : EventLoop.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Event loop of the main thread for the devices, the timers and the wake ups from other threads
+//============================================================================
+
+//One epoll set waits for the devices and for the read end of a self-pipe. The glibc of the TomTom has
+//neither timerfd nor eventfd: the timers are kept here and the timeout of epoll_wait() is the time to the
+//next one, while the other threads wake up the loop writing a byte in the pipe after setting their bit.
+//The timers follow the monotonic clock of the time base. With the virtual clock of a replay the loop never
+//sleeps: when no device is ready it calls the idle handler, that moves the clock at most to the next timer.
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include "EventLoop.h"
+#include "Logger.h"
+#include "TimeBase.h"
+
+struct eventLoopFd {
+	int fd;                                //-1 if the entry is free
+	void (*handler)(int fd, void *arg);
+	void *arg;
+};
+
+struct eventLoopTimer {
+	long period;                           //ms, 0 if the entry is free
+	unsigned long due;                     //EventLoopNow() of the next expiry
+	void (*handler)(void *arg);
+	void *arg;
+};
+
+struct eventLoopWakeup {
+	void (*handler)(void *arg);
+	void *arg;
+};
+
+struct EventLoopStruct {
+	int epfd;
+	int wakeupPipe[2];                     //read and write ends of the self-pipe
+	volatile bool running;
+	struct eventLoopFd fds[EVENT_LOOP_MAX_FDS];
+	struct eventLoopTimer timers[EVENT_LOOP_MAX_TIMERS];
+	struct eventLoopWakeup wakeups[EVENT_LOOP_MAX_WAKEUPS];
+	int numOfWakeups;
+	void (*idle)(long timeoutMs, void *arg); //called when there is nothing to do, only with the virtual clock
+	void *idleArg;
+	pthread_mutex_t pendingMutex;
+	unsigned int pending;                  //bits of the wake ups requested by the other threads
+};
+
+int eventLoopRunTimers(void);
+void eventLoopRunWakeups(void);
+
+static struct EventLoopStruct EventLoop = {
+	.epfd=-1,
+	.wakeupPipe={-1,-1},
+	.running=false,
+	.numOfWakeups=0,
+	.idle=NULL,
+	.pending=0
+};
+
+unsigned long EventLoopNow(void) { //ms of the monotonic clock of the time base, it wraps: compare the differences
+	return (unsigned long)(TimeBaseMonotonic()/1000);
+}
+
+bool EventLoopInit(void) {
+	for(int i=0;i<EVENT_LOOP_MAX_FDS;i++) EventLoop.fds[i].fd=-1;
+	for(int i=0;i<EVENT_LOOP_MAX_TIMERS;i++) EventLoop.timers[i].period=0;
+	EventLoop.epfd=epoll_create(EVENT_LOOP_MAX_FDS+1);
+	if(EventLoop.epfd<0) {
+		LogWrite(LOG_ERROR,LOG_MAIN,"unable to create the epoll set of the event loop.\n");
+		return false;
+	}
+	if(pipe(EventLoop.wakeupPipe)!=0) {
+		LogWrite(LOG_ERROR,LOG_MAIN,"unable to create the wake up pipe of the event loop.\n");
+		EventLoopClose();
+		return false;
+	}
+	fcntl(EventLoop.wakeupPipe[0],F_SETFL,O_NONBLOCK);
+	fcntl(EventLoop.wakeupPipe[1],F_SETFL,O_NONBLOCK); //if the pipe is full the loop is already going to wake up
+	struct epoll_event event;
+	memset(&event,0,sizeof(event));
+	event.events=EPOLLIN;
+	event.data.fd=EventLoop.wakeupPipe[0];
+	epoll_ctl(EventLoop.epfd,EPOLL_CTL_ADD,EventLoop.wakeupPipe[0],&event);
+	pthread_mutex_init(&EventLoop.pendingMutex,NULL);
+	return true;
+}
+
+void EventLoopClose(void) {
+	if(EventLoop.epfd>=0) close(EventLoop.epfd);
+	EventLoop.epfd=-1;
+	if(EventLoop.wakeupPipe[0]>=0) {
+		close(EventLoop.wakeupPipe[0]);
+		close(EventLoop.wakeupPipe[1]);
+		pthread_mutex_destroy(&EventLoop.pendingMutex);
+	}
+	EventLoop.wakeupPipe[0]=-1;
+	EventLoop.wakeupPipe[1]=-1;
+}
+
+bool EventLoopAddFd(int fd, void (*handler)(int fd, void *arg), void *arg) {
+	for(int i=0;i<EVENT_LOOP_MAX_FDS;i++) if(EventLoop.fds[i].fd==-1) {
+		struct epoll_event event;
+		memset(&event,0,sizeof(event));
+		event.events=EPOLLIN;
+		event.data.fd=fd;
+		if(epoll_ctl(EventLoop.epfd,EPOLL_CTL_ADD,fd,&event)!=0) break;
+		EventLoop.fds[i].fd=fd;
+		EventLoop.fds[i].handler=handler;
+		EventLoop.fds[i].arg=arg;
+		return true;
+	}
+	LogWrite(LOG_ERROR,LOG_MAIN,"unable to add a device to the event loop.\n");
+	return false;
+}
+
+void EventLoopRemoveFd(int fd) { //to be called before to close the fd
+	for(int i=0;i<EVENT_LOOP_MAX_FDS;i++) if(EventLoop.fds[i].fd==fd) {
+		struct epoll_event event; //not used but needed by the old kernels
+		epoll_ctl(EventLoop.epfd,EPOLL_CTL_DEL,fd,&event);
+		EventLoop.fds[i].fd=-1;
+	}
+}
+
+int EventLoopAddTimer(long periodMs, void (*handler)(void *arg), void *arg) { //periodic timer, returns its ID or -1
+	if(periodMs>0) for(int i=0;i<EVENT_LOOP_MAX_TIMERS;i++) if(EventLoop.timers[i].period==0) {
+		EventLoop.timers[i].period=periodMs;
+		EventLoop.timers[i].due=EventLoopNow()+periodMs;
+		EventLoop.timers[i].handler=handler;
+		EventLoop.timers[i].arg=arg;
+		return i;
+	}
+	LogWrite(LOG_ERROR,LOG_MAIN,"unable to add a timer to the event loop.\n");
+	return -1;
+}
+
+void EventLoopRemoveTimer(int id) {
+	if(id>=0 && id<EVENT_LOOP_MAX_TIMERS) EventLoop.timers[id].period=0;
+}
+
+int EventLoopAddWakeup(void (*handler)(void *arg), void *arg) { //returns the ID to be passed to EventLoopWakeup() or -1
+	if(EventLoop.numOfWakeups==EVENT_LOOP_MAX_WAKEUPS) {
+		LogWrite(LOG_ERROR,LOG_MAIN,"unable to add a wake up to the event loop.\n");
+		return -1;
+	}
+	EventLoop.wakeups[EventLoop.numOfWakeups].handler=handler;
+	EventLoop.wakeups[EventLoop.numOfWakeups].arg=arg;
+	return EventLoop.numOfWakeups++;
+}
+
+void EventLoopWakeup(int id) { //any thread: the handler will be called once by the loop also if woken up many times
+	if(id<0 || id>=EventLoop.numOfWakeups) return;
+	pthread_mutex_lock(&EventLoop.pendingMutex);
+	EventLoop.pending|=1<<id;
+	pthread_mutex_unlock(&EventLoop.pendingMutex);
+	if(write(EventLoop.wakeupPipe[1],"",1)<0) return; //full: a wake up is already pending
+}
+
+void EventLoopSetIdle(void (*handler)(long timeoutMs, void *arg), void *arg) { //the handler gets the ms to the next timer, -1 if none
+	EventLoop.idle=handler;
+	EventLoop.idleArg=arg;
+}
+
+void EventLoopStop(void) { //any thread: the loop returns after the current handler
+	EventLoop.running=false;
+	if(write(EventLoop.wakeupPipe[1],"",1)<0) return;
+}
+
+int eventLoopRunTimers(void) { //runs the expired timers, returns the ms to the next one or -1 if there are none
+	int timeout=-1;
+	for(int i=0;i<EVENT_LOOP_MAX_TIMERS && EventLoop.running;i++) if(EventLoop.timers[i].period>0) {
+		struct eventLoopTimer *timer=&EventLoop.timers[i];
+		long left=(long)(timer->due-EventLoopNow());
+		if(left<=0) {
+			timer->due+=timer->period;
+			if((long)(timer->due-EventLoopNow())<=0) timer->due=EventLoopNow()+timer->period; //too late: skip the lost ticks
+			timer->handler(timer->arg);
+			if(timer->period==0) continue; //removed by its handler
+			left=(long)(timer->due-EventLoopNow());
+			if(left<0) left=0;
+		}
+		if(timeout==-1 || left<timeout) timeout=left;
+	}
+	return timeout;
+}
+
+void eventLoopRunWakeups(void) {
+	char discard[16];
+	while(read(EventLoop.wakeupPipe[0],discard,sizeof(discard))>0);
+	pthread_mutex_lock(&EventLoop.pendingMutex);
+	unsigned int pending=EventLoop.pending;
+	EventLoop.pending=0;
+	pthread_mutex_unlock(&EventLoop.pendingMutex);
+	for(int i=0;i<EventLoop.numOfWakeups && EventLoop.running;i++)
+		if(pending&(1<<i)) EventLoop.wakeups[i].handler(EventLoop.wakeups[i].arg);
+}
+
+void EventLoopRun(void) { //dispatches the events until EventLoopStop()
+	struct epoll_event events[EVENT_LOOP_MAX_FDS+1];
+	EventLoop.running=true;
+	while(EventLoop.running) {
+		int timeout=eventLoopRunTimers();
+		if(!EventLoop.running) break;
+		bool driven=EventLoop.idle!=NULL && TimeBaseIsVirtual();
+		int num=epoll_wait(EventLoop.epfd,events,EVENT_LOOP_MAX_FDS+1,driven?0:timeout); //the virtual clock does not move by itself
+		if(num<0) {
+			if(errno==EINTR) continue;
+			LogWrite(LOG_ERROR,LOG_MAIN,"unable to wait for the events, leaving the event loop.\n");
+			break;
+		}
+		for(int i=0;i<num && EventLoop.running;i++) {
+			int fd=events[i].data.fd;
+			if(fd==EventLoop.wakeupPipe[0]) eventLoopRunWakeups();
+			else for(int j=0;j<EVENT_LOOP_MAX_FDS;j++) if(EventLoop.fds[j].fd==fd) { //not found if removed by a previous handler
+				EventLoop.fds[j].handler(fd,EventLoop.fds[j].arg);
+				break;
+			}
+		}
+		if(driven && num==0 && EventLoop.running) EventLoop.idle(timeout,EventLoop.idleArg);
+	}
+	EventLoop.running=false;
+}
@@ -0,0 +1,37 @@
+//============================================================================
+// Name        : EventLoop.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Event loop of the main thread for the devices, the timers and the wake ups from other threads
+//============================================================================
+
+#ifndef EVENTLOOP_H_
+#define EVENTLOOP_H_
+
+#include "Common.h"
+
+#define EVENT_LOOP_MAX_FDS     8
+#define EVENT_LOOP_MAX_TIMERS  8
+#define EVENT_LOOP_MAX_WAKEUPS 8 //the pending wake ups are the bits of an int
+
+//All the handlers are called by the thread running EventLoopRun(), only EventLoopWakeup() and EventLoopStop()
+//can be called by the other threads.
+bool EventLoopInit(void);
+void EventLoopRun(void);
+void EventLoopStop(void);
+void EventLoopClose(void);
+bool EventLoopAddFd(int fd, void (*handler)(int fd, void *arg), void *arg);
+void EventLoopRemoveFd(int fd);
+int EventLoopAddTimer(long periodMs, void (*handler)(void *arg), void *arg);
+void EventLoopRemoveTimer(int id);
+int EventLoopAddWakeup(void (*handler)(void *arg), void *arg);
+void EventLoopWakeup(int id);
+void EventLoopSetIdle(void (*handler)(long timeoutMs, void *arg), void *arg); //driver of the virtual clock, NULL to remove it
+unsigned long EventLoopNow(void);
+
+#endif /* EVENTLOOP_H_ */
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 22/1/2014
+// Last change : 18/10/2026
 // Description : FrameBuffer renderer
 //============================================================================
 
@@ -27,6 +27,7 @@
 #include "AirCalc.h"
 #include "GPSreceiver.h"
 #include "Configuration.h"
+#include "Trace.h"
 
 #define CHAR_WIDTH    8
 
@@ -319,7 +320,9 @@ int FBrenderBlitText(int x, int y, unsigned short aColor, unsigned short aBackCo
 }
 
 void FBrenderFlush(void) {
+	TRACE_BEGIN(TRACE_FB_FLUSH);
 	memcpy(FBrender.fbp,FBrender.fbbackp,FBrender.screensize);
+	TRACE_END(TRACE_FB_FLUSH);
 }
 
 void FBrenderScroll(int target_y, int source_y, int height) {
@@ -505,10 +508,13 @@ void FillTriangle(const int ax, const int ay, const int bx, const int by, const
 	}
 }*/
 
-void PrintPosition(int latD, int latM, double latS, short N, int lonD, int lonM, double lonS, short E) {
+void PrintPosition(const struct GeoPosition *pos) {
 	if(screen.height!=240) {
-		FBrenderBlitText(screen.height+28,2,config.colorSchema.text,config.colorSchema.background,false,"%3d %2d' %6.3f\" %c ",latD,latM,latS,N?'N':'S');
-		FBrenderBlitText(screen.height+28,12,config.colorSchema.text,config.colorSchema.background,false,"%3d %2d' %6.3f\" %c ",lonD,lonM,lonS,E?'E':'W');
+		int deg,min,milliSec;
+		convertGeo2DegMinSec(pos->lat,&deg,&min,&milliSec);
+		FBrenderBlitText(screen.height+28,2,config.colorSchema.text,config.colorSchema.background,false,"%3d %2d' %2d.%03d\" %c ",deg,min,milliSec/1000,milliSec%1000,pos->lat>=0?'N':'S');
+		convertGeo2DegMinSec(pos->lon,&deg,&min,&milliSec);
+		FBrenderBlitText(screen.height+28,12,config.colorSchema.text,config.colorSchema.background,false,"%3d %2d' %2d.%03d\" %c ",deg,min,milliSec/1000,milliSec%1000,pos->lon>=0?'E':'W');
 	}
 }
 
@@ -647,13 +653,13 @@ void PrintAltitude(double altMt, double altFt) {
 	FBrenderBlitText(screen.height+28,133,config.colorSchema.text,config.colorSchema.background,false,"%.0f Ft   %.0f m    ",altFt,altMt);
 }
 
-/*void PrintVerticalSpeed(double FtMin) {
-	FBrenderBlitText(2,42,config.colorSchema.text,config.colorSchema.background,str,false,"VS: %.0f Ft/min   ",FtMin);
+void PrintVerticalSpeed(double FtMin) {
+	if(screen.height!=240) FBrenderBlitText(screen.height+28,143,config.colorSchema.text,config.colorSchema.background,false,"VS: %+5.0f Ft/min   ",FtMin);
 }
 
 void PrintTurnRate(double DegMin) {
-	FBrenderBlitText(2,52,config.colorSchema.text,config.colorSchema.background,str,false,"TR: %.2f Deg/min  ",DegMin);
-}*/
+	if(screen.height!=240) FBrenderBlitText(screen.height+28,153,config.colorSchema.text,config.colorSchema.background,false,"TR: %+6.1f Deg/min  ",DegMin);
+}
 
 void PrintNavRemainingDistDST(double distKm, double averageSpeedKmh, double timeHours) {
 	if(screen.height!=240) {
@@ -729,6 +735,10 @@ void PrintFixMode(int fixMode) {
 	}
 }
 
+void PrintGPSlost(void) { //in place of the fix mode while the GPS device is being opened again
+	FBrenderBlitText(screen.height+28,260,config.colorSchema.caution,config.colorSchema.background,false,"GPS: LOST   ");
+}
+
 /*void PrintDiluitions(float pDiluition, float hDiluition, float vDiluition) {
 	FBrenderBlitText(2,260,config.colorSchema.text,config.colorSchema.background,0,"DOP P:%4.1f H:%4.1f V:%4.1f",pDiluition,hDiluition,vDiluition);
 }*/
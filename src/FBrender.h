@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 22/1/2014
+// Last change : 18/10/2026
 // Description : Header of FBrender.c the FrameBuffer renderer
 //============================================================================
 
@@ -37,14 +37,15 @@ void FillRect(int ulx, int uly, int drx, int dry, unsigned short color);
 void DrawButton(int x, int y, bool active, const char *label, ...);
 //void FillTriangle(int ax, int ay, int bx, int by, int cx, int cy, unsigned short color);
 //void FillQuadrangle(int ax, int ay, int bx, int by, int cx, int cy, int dx, int dy, unsigned short color);
-void PrintPosition(int latD, int latM, double latS, short N, int lonD, int lonM, double lonS, short E);
+void PrintPosition(const struct GeoPosition *pos);
 void PrintSpeed(double speedKmh, double speedKnots);
 void PrintAltitude(double altMt, double altFt);
-//void PrintVerticalSpeed(double FtMin);
-//void PrintTurnRate(double DegMin);
+void PrintVerticalSpeed(double FtMin);
+void PrintTurnRate(double DegMin);
 //void PrintDate(int day, int month, int year);
 void PrintTime(int hour, int minute, float second, short waring);
 void PrintFixMode(int fixMode);
+void PrintGPSlost(void);
 void PrintNumOfSats(int activeSats, int satsInView);
 //void PrintDiluitions(float pDiluition, float hDiluition, float vDiluition);
 void PrintNavStatus(int navStatus, char *WPname);
@@ -0,0 +1,124 @@
+//============================================================================
+// Name        : FastTrig.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Trigonometry with interpolated tables and integers, for the drawing and the fixed point math
+//============================================================================
+
+//The TomTom has no FPU, so each sin, cos or atan2 of libm costs hundreds of emulated floating point operations.
+//Here sin is taken from a table of a quarter of turn and atan from a table between 0 and 1 (the other octants
+//by symmetry), both with 2^TRIG_TABLE_BITS intervals and linear interpolation between them: only integer
+//multiplications and, for atan2, one division. With the default 12 bits (32 KB of tables) the errors are
+//below 2e-8 for sin and cos and below 1e-8 rad for atan2; with 8 bits they are still below 1 pixel for the HSI.
+
+#include <math.h>
+#include "FastTrig.h"
+
+#ifndef TRIG_TABLE_BITS
+#define TRIG_TABLE_BITS 12 //can be chosen with TRIGBITS in the Makefile
+#endif
+
+#if TRIG_TABLE_BITS<4 || TRIG_TABLE_BITS>20
+#error "TRIG_TABLE_BITS must be between 4 and 20"
+#endif
+
+#define TRIG_TABLE_SIZE  (1<<TRIG_TABLE_BITS)
+#define TRIG_SIN_SHIFT   (30-TRIG_TABLE_BITS) //bits of the angle in a quarter of turn under the index
+#define TRIG_ATAN_SHIFT  (32-TRIG_TABLE_BITS) //bits of the ratio in Q32 under the index
+#define TRIG_RAD_ANGLE   (4294967296.0/(2*M_PI))
+
+int quarterSin(unsigned int angle);
+unsigned int octantAtan(unsigned int num, unsigned int den);
+
+static struct FastTrigStruct {
+	int sinTable[TRIG_TABLE_SIZE+2];           //Q30 sin of a quarter of turn, one more to interpolate the last
+	unsigned int atanTable[TRIG_TABLE_SIZE+2]; //binary angle of atan between 0 and 1, same
+} FastTrig;
+
+void FastTrigInit(void) {
+	for(int i=0;i<=TRIG_TABLE_SIZE;i++) {
+		FastTrig.sinTable[i]=(int)floor(sin(M_PI_2*i/TRIG_TABLE_SIZE)*TRIG_ONE+0.5);
+		FastTrig.atanTable[i]=(unsigned int)floor(atan((double)i/TRIG_TABLE_SIZE)*TRIG_RAD_ANGLE+0.5);
+	}
+	FastTrig.sinTable[TRIG_TABLE_SIZE+1]=FastTrig.sinTable[TRIG_TABLE_SIZE];
+	FastTrig.atanTable[TRIG_TABLE_SIZE+1]=FastTrig.atanTable[TRIG_TABLE_SIZE];
+}
+
+int quarterSin(unsigned int angle) { //from 0 to TRIG_QUARTER_TURN included
+	unsigned int i=angle>>TRIG_SIN_SHIFT;
+	long long frac=angle&((1<<TRIG_SIN_SHIFT)-1);
+	int delta=FastTrig.sinTable[i+1]-FastTrig.sinTable[i];
+	return FastTrig.sinTable[i]+(int)((delta*frac+(1<<(TRIG_SIN_SHIFT-1)))>>TRIG_SIN_SHIFT);
+}
+
+int FastTrigSin(unsigned int angle) {
+	unsigned int inQuarter=angle&(TRIG_QUARTER_TURN-1);
+	switch(angle>>30) {
+		case 0:  return quarterSin(inQuarter);
+		case 1:  return quarterSin(TRIG_QUARTER_TURN-inQuarter);
+		case 2:  return -quarterSin(inQuarter);
+		default: return -quarterSin(TRIG_QUARTER_TURN-inQuarter);
+	}
+}
+
+int FastTrigCos(unsigned int angle) {
+	return FastTrigSin(angle+TRIG_QUARTER_TURN);
+}
+
+unsigned int octantAtan(unsigned int num, unsigned int den) { //num<=den, den>0: up to 1/8 of turn
+	unsigned long long ratio=((unsigned long long)num<<32)/den; //Q32, up to 1
+	unsigned int i=(unsigned int)(ratio>>TRIG_ATAN_SHIFT);
+	unsigned long long frac=ratio&((1ULL<<TRIG_ATAN_SHIFT)-1);
+	unsigned int delta=FastTrig.atanTable[i+1]-FastTrig.atanTable[i];
+	return FastTrig.atanTable[i]+(unsigned int)((delta*frac+(1ULL<<(TRIG_ATAN_SHIFT-1)))>>TRIG_ATAN_SHIFT);
+}
+
+unsigned int FastTrigAtan2(int y, int x) { //as atan2(y,x): 0 along x, a quarter of turn along y
+	unsigned int ax=x<0?-(unsigned int)x:(unsigned int)x;
+	unsigned int ay=y<0?-(unsigned int)y:(unsigned int)y;
+	if(ax==0 && ay==0) return 0;
+	unsigned int angle=ay<=ax?octantAtan(ay,ax):TRIG_QUARTER_TURN-octantAtan(ax,ay); //first quadrant
+	if(x<0) angle=TRIG_HALF_TURN-angle;
+	return y<0?-angle:angle;
+}
+
+int FastTrigSqrt(unsigned long long valueQ60) { //bit by bit, exact to the last bit
+	unsigned long long root=0, bit=1ULL<<62;
+	while(bit>valueQ60) bit>>=2;
+	while(bit!=0) {
+		if(valueQ60>=root+bit) {
+			valueQ60-=root+bit;
+			root=(root>>1)+bit;
+		} else root>>=1;
+		bit>>=2;
+	}
+	return (int)root;
+}
+
+unsigned int FastTrigAsin(int sinQ30) {
+	if(sinQ30>TRIG_ONE) sinQ30=TRIG_ONE;
+	else if(sinQ30<-TRIG_ONE) sinQ30=-TRIG_ONE;
+	int cosQ30=FastTrigSqrt((1ULL<<60)-(unsigned long long)((long long)sinQ30*sinQ30));
+	return FastTrigAtan2(sinQ30,cosQ30);
+}
+
+unsigned int FastTrigRad2Angle(const double rad) {
+	return (unsigned int)(long long)(rad*TRIG_RAD_ANGLE);
+}
+
+unsigned int FastTrigDeg2Angle(const int deg) {
+	return (unsigned int)((long long)deg*4294967296LL/360);
+}
+
+double FastTrigAngle2Rad(const unsigned int angle) {
+	return angle/TRIG_RAD_ANGLE;
+}
+
+double FastTrigAngle2SignedRad(const unsigned int angle) {
+	return (int)angle/TRIG_RAD_ANGLE;
+}
@@ -0,0 +1,35 @@
+//============================================================================
+// Name        : FastTrig.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Trigonometry with interpolated tables and integers, for the drawing and the fixed point math
+//============================================================================
+
+#ifndef FASTTRIG_H_
+#define FASTTRIG_H_
+
+#include "Common.h"
+
+//Angles are binary: 2^32 is a full turn, so they wrap by themselves, 1 is 1.5e-9 rad (1 cm on the Earth).
+//The signed ones are the same bits taken as int. Sin and cos are in Q30 fixed point: 1 is 2^30.
+#define TRIG_QUARTER_TURN 0x40000000U
+#define TRIG_HALF_TURN    0x80000000U
+#define TRIG_ONE          0x40000000    //1 in Q30
+
+void FastTrigInit(void); //builds the tables: before anything else
+int FastTrigSin(unsigned int angle);
+int FastTrigCos(unsigned int angle);
+unsigned int FastTrigAtan2(int y, int x); //any scale, as long as the same for both
+unsigned int FastTrigAsin(int sinQ30);    //between -1/4 and 1/4 of turn
+int FastTrigSqrt(unsigned long long valueQ60); //square root in Q30 of a Q60 value
+unsigned int FastTrigRad2Angle(const double rad);
+unsigned int FastTrigDeg2Angle(const int deg);
+double FastTrigAngle2Rad(const unsigned int angle); //between 0 and 2PI
+double FastTrigAngle2SignedRad(const unsigned int angle); //between -PI and PI
+
+#endif /* FASTTRIG_H_ */
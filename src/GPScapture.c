@@ -0,0 +1,123 @@
+//============================================================================
+// Name        : GPScapture.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Capture of the raw GPS stream with its arrival times
+//============================================================================
+
+//The reader thread only copies each chunk it reads, with its CLOCK_MONOTONIC time, in a lock-free ring;
+//a low priority thread writes the ring to the capture file. If the ring is full the chunk is lost and counted.
+//The files can be played back with utility/gpsReplay.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "GPScapture.h"
+#include "RingBuffer.h"
+#include "Logger.h"
+
+#define GPS_CAPTURE_RING_SIZE     65536
+#define GPS_CAPTURE_WRITER_PERIOD 200000 //us between two drains of the ring
+#define GPS_CAPTURE_WRITER_NICE   10     //priority of the writer thread, lower than the others
+
+
+struct GPScaptureStruct {
+	FILE *file;
+	struct RingBuffer ring;       //records waiting to be written
+	volatile bool running;        //true while the writer thread is running
+	pthread_t writer;
+	unsigned long droppedChunks;  //chunks lost because the ring was full
+	unsigned long capturedBytes;
+};
+
+void captureDrainRing(void);
+void* captureRunWriter(void *ptr);
+
+static struct GPScaptureStruct GPScapture = {
+	.file=NULL,
+	.running=false,
+	.droppedChunks=0,
+	.capturedBytes=0
+};
+
+bool GPScaptureOpen(const char *path) {
+	GPScapture.file=fopen(path,"wb");
+	if(GPScapture.file==NULL) {
+		LogWrite(LOG_ERROR,LOG_GPS,"unable to create the capture file %s\n",path);
+		return false;
+	}
+	unsigned int header[2]={GPS_CAPTURE_VERSION,GPS_CAPTURE_ENDIAN_MARK};
+	fwrite(GPS_CAPTURE_MAGIC,1,4,GPScapture.file);
+	fwrite(header,sizeof(header),1,GPScapture.file);
+	if(!RingBufferInit(&GPScapture.ring,GPS_CAPTURE_RING_SIZE)) {
+		fclose(GPScapture.file);
+		GPScapture.file=NULL;
+		return false;
+	}
+	GPScapture.running=true;
+	if(pthread_create(&GPScapture.writer,NULL,captureRunWriter,NULL)) {
+		GPScapture.running=false;
+		RingBufferRelease(&GPScapture.ring);
+		fclose(GPScapture.file);
+		GPScapture.file=NULL;
+		return false;
+	}
+	LogWrite(LOG_INFO,LOG_GPS,"capturing the GPS stream in %s\n",path);
+	return true;
+}
+
+void GPScaptureRecord(const unsigned char *data, unsigned int length) { //to be called only by the reader thread
+	if(!GPScapture.running) return;
+	struct GPScaptureRecord record;
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	record.sec=now.tv_sec;
+	record.nsec=now.tv_nsec;
+	record.length=length;
+	unsigned int space=GPScapture.ring.size-RingBufferUsed(&GPScapture.ring);
+	if(space<sizeof(record)+length) { //the writer is late: header and data go together or not at all
+		GPScapture.droppedChunks++;
+		return;
+	}
+	RingBufferWrite(&GPScapture.ring,&record,sizeof(record));
+	RingBufferWrite(&GPScapture.ring,data,length);
+}
+
+void captureDrainRing(void) {
+	unsigned char *buf;
+	unsigned int len;
+	while((len=RingBufferGetReadSpace(&GPScapture.ring,&buf))>0) { //at most in two chunks because of the wrap
+		fwrite(buf,1,len,GPScapture.file);
+		GPScapture.capturedBytes+=len;
+		RingBufferCommitRead(&GPScapture.ring,len);
+	}
+	fflush(GPScapture.file);
+}
+
+void* captureRunWriter(void *ptr) {
+	setpriority(PRIO_PROCESS,0,GPS_CAPTURE_WRITER_NICE); //on Linux it works on the calling thread
+	while(GPScapture.running) {
+		usleep(GPS_CAPTURE_WRITER_PERIOD);
+		captureDrainRing();
+	}
+	captureDrainRing(); //the last chunks
+	return NULL;
+}
+
+void GPScaptureClose(void) { //the reader thread must be already terminated
+	if(GPScapture.file==NULL) return;
+	GPScapture.running=false;
+	pthread_join(GPScapture.writer,NULL);
+	fclose(GPScapture.file);
+	GPScapture.file=NULL;
+	RingBufferRelease(&GPScapture.ring);
+	LogWrite(LOG_INFO,LOG_GPS,"captured %lu bytes, %lu chunks lost.\n",GPScapture.capturedBytes,GPScapture.droppedChunks);
+}
@@ -0,0 +1,31 @@
+//============================================================================
+// Name        : GPScapture.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Header of GPScapture.c capture of the raw GPS stream
+//============================================================================
+
+#ifndef GPSCAPTURE_H_
+#define GPSCAPTURE_H_
+
+#include "Common.h"
+
+#define GPS_CAPTURE_MAGIC       "ANGC"     //first 4 bytes of each capture file
+#define GPS_CAPTURE_VERSION     1
+#define GPS_CAPTURE_ENDIAN_MARK 0x01020304 //to find out the byte order of integers
+
+struct GPScaptureRecord { //header of each chunk of bytes, 12 bytes
+	unsigned int sec, nsec; //CLOCK_MONOTONIC time of arrival of the chunk
+	unsigned int length;    //bytes of the chunk following the header
+};
+
+bool GPScaptureOpen(const char *path);
+void GPScaptureRecord(const unsigned char *data, unsigned int length);
+void GPScaptureClose(void);
+
+#endif /* GPSCAPTURE_H_ */
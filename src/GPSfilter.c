@@ -0,0 +1,366 @@
+//============================================================================
+// Name        : GPSfilter.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Kalman filter of the GPS solutions with a constant turn rate and speed model
+//============================================================================
+
+//Extended Kalman filter on a plane tangent to the Earth in a reference point near the aircraft. The state is
+//east, north, ground speed, true track and turn rate: between two solutions the aircraft keeps its speed and
+//turn rate, so the state can be predicted at any time. The altitude and the vertical speed are a separate
+//linear filter. Each measurement is accepted only if its innovation is within the chi-square gate, so a wrong
+//solution alone cannot move the position; after some rejections in a row the filter starts again from the
+//last solution, as the receiver is more likely to be right than the model.
+
+#include <string.h>
+#include <math.h>
+#include "GPSfilter.h"
+#include "AirCalc.h"
+#include "Logger.h"
+
+#define FILTER_STATES            5
+#define FILTER_EAST              0      //m from the reference point
+#define FILTER_NORTH             1      //m from the reference point
+#define FILTER_SPEED             2      //ground speed in m/s
+#define FILTER_TRACK             3      //true track in rad, clockwise from North
+#define FILTER_TURN              4      //turn rate in rad/s, positive to the right
+
+#define FILTER_UERE            5.0      //m, user equivalent range error: horizontal error=HDOP*UERE
+#define FILTER_DEFAULT_POS_ERR 15.0     //m, horizontal error when the receiver tells neither the errors nor the HDOP
+#define FILTER_SPEED_ERR       0.5      //m/s, standard deviation of the measured ground speed
+#define FILTER_MIN_TRACK_SPEED 1.0      //m/s, below this the measured track is noise
+#define FILTER_MAX_TRACK_ERR   10.0     //deg, standard deviation of the track above which it is not shown
+#define FILTER_STILL_TURN_ERR  0.01     //rad/s, pseudo measurement of no turn when too slow to measure the track
+#define FILTER_ACCEL_NOISE     2.0      //m/s^2, changes of ground speed allowed by the model
+#define FILTER_TURN_ACCEL_NOISE 0.05    //rad/s^2, changes of turn rate allowed: a rate one turn in about 1 s
+#define FILTER_VERT_ACCEL_NOISE 1.0     //m/s^2, changes of vertical speed allowed
+#define FILTER_GATE_2D        13.8      //chi-square with 2 degrees of freedom at 99.9%
+#define FILTER_GATE_1D        10.8      //chi-square with 1 degree of freedom at 99.9%
+#define FILTER_MAX_REJECTS       5      //positions rejected in a row after which the filter starts again
+#define FILTER_MAX_GAP       10000      //ms without solutions after which the filter starts again
+#define FILTER_RECENTER     5000.0      //m from the reference point after which the plane is moved
+
+struct GPSfilterStruct {
+	bool initialized;
+	struct GeoPosition ref;                //reference point of the plane
+	double cosRefLat;
+	double x[FILTER_STATES];               //state
+	double P[FILTER_STATES][FILTER_STATES]; //covariance of the state
+	bool hasAltitude;
+	double h[2];                           //altitude in m and vertical speed in m/s
+	double Ph[2][2];                       //covariance of h
+	long timestamp;                        //ms from the beginning of the UTC day of the state
+	int rejects;                           //positions rejected in a row
+	unsigned long updates,rejectedPositions,rejectedVelocities,rejectedAltitudes,restarts;
+};
+
+double filterWrapAngle(double angle);
+long filterElapsed(long timestamp, long since);
+double filterPositionErr(const struct GPSsolution *solution, double *eastErr, double *northErr);
+void filterStart(const struct GPSsolution *solution);
+void filterStartAltitude(const struct GPSsolution *solution, double errH);
+void filterPredict(double x[FILTER_STATES], double P[FILTER_STATES][FILTER_STATES], double h[2], double Ph[2][2], double dt);
+bool filterCorrect(const int *idx, const double *z, const double *r, int m, double gate);
+bool filterCorrectAltitude(double altMt, double errMt);
+void filterRecenter(void);
+void filterPlane2Geo(const double x[FILTER_STATES], struct GeoPosition *pos);
+
+static struct GPSfilterStruct GPSfilter = {
+	.initialized=false,
+	.hasAltitude=false,
+	.rejects=0,
+	.updates=0,
+	.rejectedPositions=0,
+	.rejectedVelocities=0,
+	.rejectedAltitudes=0,
+	.restarts=0
+};
+
+double filterWrapAngle(double angle) { //in [-PI,PI)
+	angle=fmod(angle+M_PI,TWO_PI);
+	if(angle<0) angle+=TWO_PI;
+	return angle-M_PI;
+}
+
+long filterElapsed(long timestamp, long since) { //ms from since to timestamp also across midnight, negative if timestamp is older
+	long elapsed=(timestamp-since+MS_DAY)%MS_DAY;
+	return elapsed>MS_DAY/2?elapsed-MS_DAY:elapsed;
+}
+
+double filterPositionErr(const struct GPSsolution *solution, double *eastErr, double *northErr) { //standard deviations in m, returns the vertical one
+	double err;
+	if(solution->content&SOLUTION_ERRORS) {
+		*eastErr=solution->lonErr*0.001;
+		*northErr=solution->latErr*0.001;
+		err=solution->altErr*0.001;
+	} else {
+		if(solution->content&(SOLUTION_HDOP|SOLUTION_DOP)) err=solution->hdop*0.01*FILTER_UERE*M_SQRT1_2; //split on the two axes
+		else err=FILTER_DEFAULT_POS_ERR*M_SQRT1_2;
+		*eastErr=err;
+		*northErr=err;
+		err=solution->content&SOLUTION_DOP?solution->vdop*0.01*FILTER_UERE:1.5*err*M_SQRT2; //the vertical error is usually 1.5 times the horizontal one
+	}
+	if(*eastErr<1) *eastErr=1; //no receiver is so good, the gate would reject everything
+	if(*northErr<1) *northErr=1;
+	return err<1?1:err;
+}
+
+void filterStart(const struct GPSsolution *solution) { //the state is the solution itself
+	double eastErr,northErr,errH=filterPositionErr(solution,&eastErr,&northErr);
+	memset(GPSfilter.x,0,sizeof(GPSfilter.x));
+	memset(GPSfilter.P,0,sizeof(GPSfilter.P));
+	GPSfilter.ref=solution->pos;
+	GPSfilter.cosRefLat=cos(geoLat2rad(solution->pos.lat));
+	GPSfilter.P[FILTER_EAST][FILTER_EAST]=eastErr*eastErr;
+	GPSfilter.P[FILTER_NORTH][FILTER_NORTH]=northErr*northErr;
+	GPSfilter.P[FILTER_TRACK][FILTER_TRACK]=M_PI*M_PI;
+	GPSfilter.P[FILTER_TURN][FILTER_TURN]=0.2*0.2; //more than a rate one turn
+	GPSfilter.P[FILTER_SPEED][FILTER_SPEED]=100; //any speed
+	if(solution->content&SOLUTION_VELOCITY) {
+		double speed=Kmh2ms(Nm2Km(solution->groundSpeedKnots*0.001));
+		GPSfilter.x[FILTER_SPEED]=speed;
+		GPSfilter.P[FILTER_SPEED][FILTER_SPEED]=FILTER_SPEED_ERR*FILTER_SPEED_ERR;
+		if(speed>FILTER_MIN_TRACK_SPEED) {
+			GPSfilter.x[FILTER_TRACK]=filterWrapAngle(Deg2Rad(solution->trueTrack*0.01));
+			GPSfilter.P[FILTER_TRACK][FILTER_TRACK]=(FILTER_SPEED_ERR/speed)*(FILTER_SPEED_ERR/speed);
+		}
+	}
+	filterStartAltitude(solution,errH);
+	GPSfilter.timestamp=solution->timestamp;
+	GPSfilter.rejects=0;
+	GPSfilter.initialized=true;
+}
+
+void filterStartAltitude(const struct GPSsolution *solution, double errH) {
+	GPSfilter.hasAltitude=(solution->content&SOLUTION_ALTITUDE) && solution->fixMode!=MODE_2D_FIX;
+	if(!GPSfilter.hasAltitude) return;
+	GPSfilter.h[0]=solution->altUnit=='F'||solution->altUnit=='f'?Ft2m(solution->alt*0.001):solution->alt*0.001;
+	GPSfilter.h[1]=0;
+	GPSfilter.Ph[0][0]=errH*errH;
+	GPSfilter.Ph[0][1]=GPSfilter.Ph[1][0]=0;
+	GPSfilter.Ph[1][1]=25; //any vertical speed up to 1000 ft/min
+}
+
+void filterPredict(double x[FILTER_STATES], double P[FILTER_STATES][FILTER_STATES], double h[2], double Ph[2][2], double dt) { //moves the state dt seconds ahead
+	double F[FILTER_STATES][FILTER_STATES], FP[FILTER_STATES][FILTER_STATES], G[FILTER_STATES][2];
+	double v=x[FILTER_SPEED], psi=x[FILTER_TRACK], omega=x[FILTER_TURN], psi1=psi+omega*dt;
+	double sinPsi=sin(psi), cosPsi=cos(psi), sinPsi1=sin(psi1), cosPsi1=cos(psi1);
+	memset(F,0,sizeof(F));
+	for(int i=0;i<FILTER_STATES;i++) F[i][i]=1;
+	if(fabs(omega)>1e-4) { //along an arc
+		double r=v/omega;
+		x[FILTER_EAST]+=r*(cosPsi-cosPsi1);
+		x[FILTER_NORTH]+=r*(sinPsi1-sinPsi);
+		F[FILTER_EAST][FILTER_SPEED]=(cosPsi-cosPsi1)/omega;
+		F[FILTER_EAST][FILTER_TRACK]=r*(sinPsi1-sinPsi);
+		F[FILTER_EAST][FILTER_TURN]=-r/omega*(cosPsi-cosPsi1)+r*sinPsi1*dt;
+		F[FILTER_NORTH][FILTER_SPEED]=(sinPsi1-sinPsi)/omega;
+		F[FILTER_NORTH][FILTER_TRACK]=r*(cosPsi1-cosPsi);
+		F[FILTER_NORTH][FILTER_TURN]=-r/omega*(sinPsi1-sinPsi)+r*cosPsi1*dt;
+	} else { //straight
+		x[FILTER_EAST]+=v*sinPsi*dt;
+		x[FILTER_NORTH]+=v*cosPsi*dt;
+		F[FILTER_EAST][FILTER_SPEED]=sinPsi*dt;
+		F[FILTER_EAST][FILTER_TRACK]=v*cosPsi*dt;
+		F[FILTER_EAST][FILTER_TURN]=v*cosPsi*dt*dt/2;
+		F[FILTER_NORTH][FILTER_SPEED]=cosPsi*dt;
+		F[FILTER_NORTH][FILTER_TRACK]=-v*sinPsi*dt;
+		F[FILTER_NORTH][FILTER_TURN]=-v*sinPsi*dt*dt/2;
+	}
+	x[FILTER_TRACK]=filterWrapAngle(psi1);
+	F[FILTER_TRACK][FILTER_TURN]=dt;
+	for(int i=0;i<FILTER_STATES;i++) for(int j=0;j<FILTER_STATES;j++) { //F*P
+		FP[i][j]=0;
+		for(int k=0;k<FILTER_STATES;k++) FP[i][j]+=F[i][k]*P[k][j];
+	}
+	memset(G,0,sizeof(G)); //how the accelerations of speed and of turn rate move the state
+	G[FILTER_EAST][0]=sinPsi*dt*dt/2;
+	G[FILTER_NORTH][0]=cosPsi*dt*dt/2;
+	G[FILTER_SPEED][0]=dt;
+	G[FILTER_TRACK][1]=dt*dt/2;
+	G[FILTER_TURN][1]=dt;
+	for(int i=0;i<FILTER_STATES;i++) for(int j=0;j<FILTER_STATES;j++) { //F*P*F'+G*Q*G'
+		P[i][j]=G[i][0]*G[j][0]*FILTER_ACCEL_NOISE*FILTER_ACCEL_NOISE+G[i][1]*G[j][1]*FILTER_TURN_ACCEL_NOISE*FILTER_TURN_ACCEL_NOISE;
+		for(int k=0;k<FILTER_STATES;k++) P[i][j]+=FP[i][k]*F[j][k];
+	}
+	if(h!=NULL) { //constant vertical speed
+		double q=FILTER_VERT_ACCEL_NOISE*FILTER_VERT_ACCEL_NOISE;
+		h[0]+=h[1]*dt;
+		Ph[0][0]+=dt*(Ph[1][0]+Ph[0][1])+dt*dt*Ph[1][1]+q*dt*dt*dt*dt/4;
+		Ph[0][1]+=dt*Ph[1][1]+q*dt*dt*dt/2;
+		Ph[1][0]=Ph[0][1];
+		Ph[1][1]+=q*dt*dt;
+	}
+}
+
+bool filterCorrect(const int *idx, const double *z, const double *r, int m, double gate) { //m (1 or 2) measurements of the states idx, false if out of the gate
+	double y[2], S[2][2], Si[2][2], K[FILTER_STATES][2], HP[2][FILTER_STATES];
+	double (*P)[FILTER_STATES]=GPSfilter.P;
+	for(int i=0;i<m;i++) {
+		y[i]=z[i]-GPSfilter.x[idx[i]];
+		if(idx[i]==FILTER_TRACK) y[i]=filterWrapAngle(y[i]);
+		for(int j=0;j<m;j++) S[i][j]=P[idx[i]][idx[j]]+(i==j?r[i]:0);
+	}
+	if(m==1) Si[0][0]=1/S[0][0];
+	else {
+		double det=S[0][0]*S[1][1]-S[0][1]*S[1][0];
+		if(det<=0) return false;
+		Si[0][0]=S[1][1]/det;
+		Si[1][1]=S[0][0]/det;
+		Si[0][1]=-S[0][1]/det;
+		Si[1][0]=-S[1][0]/det;
+	}
+	double distance=0; //squared Mahalanobis distance of the innovation
+	for(int i=0;i<m;i++) for(int j=0;j<m;j++) distance+=y[i]*Si[i][j]*y[j];
+	if(gate>0 && distance>gate) return false;
+	for(int k=0;k<FILTER_STATES;k++) for(int j=0;j<m;j++) {
+		K[k][j]=0;
+		for(int i=0;i<m;i++) K[k][j]+=P[k][idx[i]]*Si[i][j];
+	}
+	for(int i=0;i<m;i++) memcpy(HP[i],P[idx[i]],sizeof(HP[i]));
+	for(int k=0;k<FILTER_STATES;k++) {
+		for(int j=0;j<m;j++) GPSfilter.x[k]+=K[k][j]*y[j];
+		for(int l=0;l<FILTER_STATES;l++) for(int j=0;j<m;j++) P[k][l]-=K[k][j]*HP[j][l];
+	}
+	for(int k=0;k<FILTER_STATES;k++) for(int l=k+1;l<FILTER_STATES;l++) P[k][l]=P[l][k]=(P[k][l]+P[l][k])/2; //keep it symmetric
+	GPSfilter.x[FILTER_TRACK]=filterWrapAngle(GPSfilter.x[FILTER_TRACK]);
+	if(GPSfilter.x[FILTER_SPEED]<0) GPSfilter.x[FILTER_SPEED]=0;
+	return true;
+}
+
+bool filterCorrectAltitude(double altMt, double errMt) {
+	double (*Ph)[2]=GPSfilter.Ph;
+	double y=altMt-GPSfilter.h[0], S=Ph[0][0]+errMt*errMt;
+	if(y*y/S>FILTER_GATE_1D) return false;
+	double K0=Ph[0][0]/S, K1=Ph[1][0]/S;
+	GPSfilter.h[0]+=K0*y;
+	GPSfilter.h[1]+=K1*y;
+	Ph[1][1]-=K1*Ph[0][1];
+	Ph[0][1]-=K0*Ph[0][1];
+	Ph[0][0]-=K0*Ph[0][0];
+	Ph[1][0]=Ph[0][1];
+	return true;
+}
+
+void filterPlane2Geo(const double x[FILTER_STATES], struct GeoPosition *pos) { //pos is the reference point, moved by the state on the plane
+	double lon=pos->lon+Rad2Deg(m2Rad(x[FILTER_EAST]/GPSfilter.cosRefLat))*GEO_UNITS_DEG; //in double: it could go beyond 180 degrees
+	pos->lat+=(int)(Rad2Deg(m2Rad(x[FILTER_NORTH]))*GEO_UNITS_DEG);
+	if(lon>180.0*GEO_UNITS_DEG) lon-=360.0*GEO_UNITS_DEG;
+	else if(lon<-180.0*GEO_UNITS_DEG) lon+=360.0*GEO_UNITS_DEG;
+	pos->lon=(int)lon;
+}
+
+void filterRecenter(void) { //moves the reference point under the aircraft so the plane stays a good approximation
+	filterPlane2Geo(GPSfilter.x,&GPSfilter.ref);
+	GPSfilter.cosRefLat=cos(geoLat2rad(GPSfilter.ref.lat));
+	GPSfilter.x[FILTER_EAST]=0;
+	GPSfilter.x[FILTER_NORTH]=0;
+}
+
+void GPSfilterReset(void) {
+	GPSfilter.initialized=false;
+}
+
+bool GPSfilterUpdate(const struct GPSsolution *solution) { //returns false if the solution had no position or it has been rejected
+	if(!(solution->content&SOLUTION_TIME)) return false;
+	bool hasPosition=(solution->content&SOLUTION_POSITION) && solution->fixMode!=MODE_NO_FIX;
+	if(!GPSfilter.initialized) {
+		if(!hasPosition) return false;
+		filterStart(solution);
+		GPSfilter.updates++;
+		return true;
+	}
+	long elapsed=filterElapsed(solution->timestamp,GPSfilter.timestamp);
+	if(elapsed<=0) return false; //the same or an older epoch
+	if(elapsed>FILTER_MAX_GAP) { //too much to predict
+		if(!hasPosition) return false;
+		LogWrite(LOG_INFO,LOG_GPS,"GPS filter: no solutions for %ld s, starting again.\n",elapsed/1000);
+		GPSfilter.restarts++;
+		filterStart(solution);
+		GPSfilter.updates++;
+		return true;
+	}
+	filterPredict(GPSfilter.x,GPSfilter.P,GPSfilter.hasAltitude?GPSfilter.h:NULL,GPSfilter.Ph,elapsed*0.001);
+	GPSfilter.timestamp=solution->timestamp;
+	if(!hasPosition) return false; //dead reckoning
+	GPSfilter.updates++;
+	double eastErr,northErr,errH=filterPositionErr(solution,&eastErr,&northErr);
+	int idx[2]={FILTER_EAST,FILTER_NORTH};
+	double z[2], r[2]={eastErr*eastErr,northErr*northErr};
+	double deltaLon=(double)solution->pos.lon-GPSfilter.ref.lon; //in double: across the antimeridian it does not fit in 32 bits
+	if(deltaLon>180.0*GEO_UNITS_DEG) deltaLon-=360.0*GEO_UNITS_DEG;
+	else if(deltaLon<-180.0*GEO_UNITS_DEG) deltaLon+=360.0*GEO_UNITS_DEG;
+	z[0]=Rad2m(Deg2Rad(deltaLon/GEO_UNITS_DEG))*GPSfilter.cosRefLat;
+	z[1]=Rad2m(Deg2Rad(((double)solution->pos.lat-GPSfilter.ref.lat)/GEO_UNITS_DEG));
+	if(!filterCorrect(idx,z,r,2,FILTER_GATE_2D)) {
+		GPSfilter.rejectedPositions++;
+		if(++GPSfilter.rejects<FILTER_MAX_REJECTS) {
+			LogWrite(LOG_DEBUG,LOG_GPS,"GPS filter: position rejected, %.0f m from the expected one.\n",hypot(z[0]-GPSfilter.x[FILTER_EAST],z[1]-GPSfilter.x[FILTER_NORTH]));
+			return false; //the velocity of the same solution is not trusted either
+		}
+		LogWrite(LOG_INFO,LOG_GPS,"GPS filter: %d positions rejected in a row, starting again.\n",GPSfilter.rejects);
+		GPSfilter.restarts++;
+		filterStart(solution);
+		return true;
+	}
+	GPSfilter.rejects=0;
+	if(solution->content&SOLUTION_VELOCITY) {
+		double speed=Kmh2ms(Nm2Km(solution->groundSpeedKnots*0.001));
+		if(speed>FILTER_MIN_TRACK_SPEED) {
+			idx[0]=FILTER_SPEED;
+			idx[1]=FILTER_TRACK;
+			z[0]=speed;
+			z[1]=Deg2Rad(solution->trueTrack*0.01);
+			r[0]=FILTER_SPEED_ERR*FILTER_SPEED_ERR;
+			r[1]=r[0]/(speed*speed); //the track is as good as the speed is big respect its error
+			if(!filterCorrect(idx,z,r,2,FILTER_GATE_2D)) GPSfilter.rejectedVelocities++;
+		} else {
+			idx[0]=FILTER_SPEED;
+			z[0]=speed;
+			r[0]=FILTER_SPEED_ERR*FILTER_SPEED_ERR;
+			if(!filterCorrect(idx,z,r,1,FILTER_GATE_1D)) GPSfilter.rejectedVelocities++;
+			idx[0]=FILTER_TURN; //too slow to tell the track: hold it instead of letting it spin
+			z[0]=0;
+			r[0]=FILTER_STILL_TURN_ERR*FILTER_STILL_TURN_ERR;
+			filterCorrect(idx,z,r,1,0);
+		}
+	}
+	if((solution->content&SOLUTION_ALTITUDE) && solution->fixMode!=MODE_2D_FIX) {
+		if(!GPSfilter.hasAltitude) filterStartAltitude(solution,errH);
+		else if(!filterCorrectAltitude(solution->altUnit=='F'||solution->altUnit=='f'?Ft2m(solution->alt*0.001):solution->alt*0.001,errH))
+			GPSfilter.rejectedAltitudes++;
+	}
+	if(fabs(GPSfilter.x[FILTER_EAST])>FILTER_RECENTER || fabs(GPSfilter.x[FILTER_NORTH])>FILTER_RECENTER) filterRecenter();
+	return true;
+}
+
+bool GPSfilterGetState(long afterMs, struct GPSfilterState *state) { //state predicted afterMs ms after the last solution
+	if(!GPSfilter.initialized) return false;
+	double x[FILTER_STATES], P[FILTER_STATES][FILTER_STATES], h[2], Ph[2][2];
+	memcpy(x,GPSfilter.x,sizeof(x));
+	memcpy(P,GPSfilter.P,sizeof(P));
+	memcpy(h,GPSfilter.h,sizeof(h));
+	memcpy(Ph,GPSfilter.Ph,sizeof(Ph));
+	if(afterMs>0) filterPredict(x,P,GPSfilter.hasAltitude?h:NULL,Ph,afterMs*0.001);
+	state->pos=GPSfilter.ref;
+	filterPlane2Geo(x,&state->pos);
+	state->speedMs=x[FILTER_SPEED];
+	state->trueTrack=Rad2Deg(x[FILTER_TRACK]<0?x[FILTER_TRACK]+TWO_PI:x[FILTER_TRACK]);
+	state->turnRate=Rad2Deg(x[FILTER_TURN]);
+	state->posErr=sqrt(P[FILTER_EAST][FILTER_EAST]+P[FILTER_NORTH][FILTER_NORTH]);
+	state->isTrackValid=sqrt(P[FILTER_TRACK][FILTER_TRACK])<Deg2Rad(FILTER_MAX_TRACK_ERR);
+	state->hasAltitude=GPSfilter.hasAltitude;
+	state->altMt=h[0];
+	state->climbMs=h[1];
+	return true;
+}
+
+void GPSfilterLogStats(void) {
+	LogWrite(LOG_INFO,LOG_GPS,"GPS filter: %lu solutions, rejected %lu positions, %lu velocities and %lu altitudes, %lu restarts.\n",
+		GPSfilter.updates,GPSfilter.rejectedPositions,GPSfilter.rejectedVelocities,GPSfilter.rejectedAltitudes,GPSfilter.restarts);
+}
@@ -0,0 +1,37 @@
+//============================================================================
+// Name        : GPSfilter.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Kalman filter of the GPS solutions with a constant turn rate and speed model
+//============================================================================
+
+#ifndef GPSFILTER_H_
+#define GPSFILTER_H_
+
+#include "Common.h"
+#include "GPSreceiver.h"
+
+struct GPSfilterState {
+	struct GeoPosition pos;    //1e-7 degrees, North and East positive
+	double altMt;              //m respect WGS84, valid only if hasAltitude
+	double speedMs;            //ground speed in m/s
+	double trueTrack;          //deg
+	double turnRate;           //deg/s, positive to the right
+	double climbMs;            //vertical speed in m/s, valid only if hasAltitude
+	double posErr;             //standard deviation of the position in m
+	bool isTrackValid;         //the track is known well enough to be shown, also when slow
+	bool hasAltitude;
+};
+
+//To be used by one thread only: the one of the GPS parser.
+void GPSfilterReset(void);
+bool GPSfilterUpdate(const struct GPSsolution *solution);
+bool GPSfilterGetState(long afterMs, struct GPSfilterState *state);
+void GPSfilterLogStats(void);
+
+#endif /* GPSFILTER_H_ */
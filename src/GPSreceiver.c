@@ -6,12 +6,11 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 21/03/2016
+// Last change : 18/10/2026
 // Description : Reads from a NMEA serial device NMEA sentences and parse them
 //============================================================================
 
 
-//#define SERIAL_DEVICE //to be enabled if reading from a real serial device
 //#define PRINT_RECEIVED_DATA
 
 #include <stdio.h>////
@@ -20,237 +19,1009 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <fcntl.h>
-#ifdef SERIAL_DEVICE
-#include <termios.h>
+#include <errno.h>
+#include <sys/time.h>
+#if defined(__GLIBC__) && (__GLIBC__>2 || (__GLIBC__==2 && __GLIBC_MINOR__>=4))
+#define GPS_INOTIFY //inotify is in glibc since 2.4: with the older ones the device is only polled
+#include <sys/inotify.h>
 #endif
 #include "GPSreceiver.h"
 #include "Configuration.h"
 #include "AirCalc.h"
 #include "Geoidal.h"
 #include "NMEAparser.h"
+#include "SiRFparser.h"
+#include "UBXparser.h"
 #include "FBrender.h"
 #include "HSI.h"
 #include "BlackBox.h"
+#include "RingBuffer.h"
+#include "Logger.h"
+#include "GPScapture.h"
+#include "GPSreplay.h"
+#include "Navigator.h"
+#include "Trace.h"
+#include "SerialPort.h"
+#include "EventLoop.h"
+#include "GPSfilter.h"
+#include "Accelerometer.h"
+#include "Regression.h"
+#include "TimeBase.h"
 
+#define GPS_DISCARD_SIZE 1024
+#define GPS_WATCHDOG_PERIOD 1000 //ms between two checks of the silence of the GPS
+#define GPS_SILENCE_TIMEOUT 5000 //ms without bytes after which the device is closed and opened again
+#define GPS_RETRY_MIN        500 //ms before the first attempt to open again the device, doubled at each failure
+#define GPS_RETRY_MAX      16000 //ms, max time between two attempts
+#define GPS_SOURCE_STALE    1500 //ms without solutions after which a source is replaced by any other one, if its rate is unknown
+#define GPS_SWITCH_MARGIN     20 //score by which a less preferred source has to beat the selected one to replace it
+#define GPS_MAX_PREDICTION  2000 //ms after the last solution for which the filter keeps predicting the position
+#define GPS_CLIMB_WINDOW   10000 //ms of altitudes from which the vertical speed is calculated, without the filter
+#define GPS_TURN_WINDOW     5000 //ms of tracks from which the turn rate is calculated, without the filter
+#define GPS_TURN_MIN_SPEED    10 //Km/h below which the turn rate is not calculated
+
+#define GPS_DATA_INITIALIZER { \
+	.timestamp=-1, \
+	.speedKmh=-100, \
+	.speedKnots=-100, \
+	.altMt=-100, \
+	.altFt=-100, \
+	.realAltMt=-100, \
+	.realAltFt=-100, \
+	.trueTrack=0, \
+	.day=-65, \
+	.second=-65, \
+	.pos={.lat=GEO_NO_POS}, \
+	.pdop=50, \
+	.hdop=50, \
+	.vdop=50, \
+	.latErrMt=-1, \
+	.lonErrMt=-1, \
+	.altErrMt=-1, \
+	.fixMode=MODE_UNKNOWN, \
+	.source=-1 \
+}
+
+
+struct GPSsource { //one GPS receiver: its device is read by the event loop and its bytes are parsed by the parser thread
+	int index;
+	struct GPSsourceConfig *settings;
+	int fd;                 //the device read by the event loop, -1 if closed
+	bool isSerial;          //the device is a serial port: its settings have to be restored
+	struct termios oldtio;  //old settings of the serial port
+	unsigned long lastArrival; //EventLoopNow() of the last bytes received
+	volatile bool lost;     //the device has been closed and it is going to be opened again
+	int retryTimer;         //ID of the timer of the next attempt to open the device, or of the next rate of the autobaud
+	long retryDelay;        //ms from a failed attempt to the next one
+	long baudRate;          //baud rate of the serial port, 0 until found by the autobaud, then the last one found
+	bool autobaudPending;   //the rate is looked for at the next opening: at start and each time the device appears again
+	struct SerialAutobaud autobaud; //search of the baud rate, done while the device is open and still lost
+	int watchWd;            //inotify watch of the directory of the device, -1 if not watched
+	struct RingBuffer ring; //bytes read from the device waiting to be parsed
+	void (*processBuffer)(int source, unsigned char *buf, int redBytes); //parser of the configured protocol
+	void (*logStats)(int source);
+	int score;              //quality of the last solution, see scoreGPSsolution()
+	unsigned long lastSolution;  //EventLoopNow() of the last solution
+	long interval;          //average ms between two solutions, 0 until known
+	unsigned long selectedSince; //EventLoopNow() of the last time the source has been selected
+	struct GPSsourceStats stats;
+};
 
 struct GPSreceiverStruct {
-	pthread_t thread;
+	pthread_t parserThread; //thread parsing the bytes and updating navigation and display
 	volatile short reading; //-1 means still not initialized
-#ifdef SERIAL_DEVICE
-	long BAUD;
-	int DATABITS,STOPBITS,PARITYON,PARITY;
-#endif
+	bool parserStarted;     //true when the parser thread has to be joined
+	struct GPSsource sources[GPS_MAX_SOURCES]; //in order of preference
+	int numOfSources;
+	int selected;           //index of the source whose solutions are published, -1 until the first one
+	int watchdog;           //ID of the timer checking that the bytes keep arriving
+	int drainTimer;         //ID of the timer reading the tail of the bursts of the serial ports with minRead>1, -1 if none
+	int watchFd;            //inotify descriptor watching the directories of the devices, -1 if not used
+	pthread_mutex_t dataMutex;
+	pthread_cond_t dataSignal;
+	pthread_cond_t idleSignal; //the parser is going to wait, for GPSreceiverSync()
+	bool parserIdle;        //the parser waits with nothing to do, protected by dataMutex
+	struct GPSdata published[2];   //published copies of gps: readers use the one of version, the parser writes the other
+	volatile unsigned int version; //incremented after each publication
+	struct Regression climb; //altitudes in Ft of the last solutions, without the filter
+	struct Regression turn;  //true tracks in deg of the last solutions, without the filter
+	bool filtering;         //the position, altitude and velocity published are the ones of GPSfilter
+	long tickPeriod;        //ms between two outputs of the filter between the solutions, 0 for none
+	unsigned long lastEpoch; //EventLoopNow() of the last solution given to the filter
+	unsigned long lastFix;  //EventLoopNow() of the last solution with a position given to the filter
+	unsigned long nextTick; //EventLoopNow() of the next output of the filter
+	long long epochUtc;     //us from 1/1/1970 UTC of the last solution given to the filter
 };
 
 void configureGPSreceiver(void);
-void* run(void *ptr);
+bool configureGPSsource(struct GPSsource *source, int index);
+bool validGPSstream(const unsigned char *buf, int len, void *arg);
+bool setupSerialPort(struct GPSsource *source);
+bool openGPSdevice(struct GPSsource *source);
+bool startGPSdevice(struct GPSsource *source);
+bool startGPSautobaud(struct GPSsource *source);
+void readGPSautobaud(int fd, void *arg);
+void nextGPSautobaud(void *arg);
+void stopGPSautobaud(struct GPSsource *source);
+void closeGPSdevice(struct GPSsource *source);
+void readGPSdevice(int fd, void *arg);
+int readGPSbytes(struct GPSsource *source);
+void checkGPSsilence(void *arg);
+void drainGPSdevices(void *arg);
+void loseGPSdevice(struct GPSsource *source);
+void retryGPSdevice(void *arg);
+void scheduleGPSretry(struct GPSsource *source);
+void backoffGPSretry(struct GPSsource *source);
+void showGPSstatus(void);
+void watchGPSdevices(void);
+void readGPSwatch(int fd, void *arg);
+void* runParser(void *ptr);
+bool pendingGPSdata(void);
+void signalParser(void);
+int scoreGPSsolution(const struct GPSsolution *solution);
+bool betterGPSsource(const struct GPSsource *candidate, const struct GPSsource *current);
+bool aliveGPSsource(const struct GPSsource *source, unsigned long now);
+bool arbitrateGPSsources(struct GPSsource *source, unsigned long now);
+void selectGPSsource(struct GPSsource *source, unsigned long now);
+bool updatePosition(const struct GeoPosition *newPos);
+bool updateAltitude(float newAltitude, char altUnit);
+void updateDirection(float newTrueTrack, float magneticVar, bool isVarToEast, bool isTrackValid);
+void updateVerticalSpeed(double climbFtMin);
+void updateTurnRate(double turnRateDegSec);
+void updateRegressions(const struct GPSsolution *solution);
+bool publishFilterState(const struct GPSfilterState *state, bool *altChanged);
+void publishGPSprediction(void);
+long nextGPSprediction(void);
+void waitParser(long ms);
+void updateTurnCoordinator(void);
 
 static struct GPSreceiverStruct GPSreceiver = {
 	.reading=-1, //-1 means still not initialized
+	.parserStarted=false,
+	.numOfSources=0,
+	.selected=-1,
+	.watchdog=-1,
+	.drainTimer=-1,
+	.watchFd=-1,
+	.published={GPS_DATA_INITIALIZER,GPS_DATA_INITIALIZER},
+	.version=0,
+	.filtering=false,
+	.tickPeriod=0
 };
 
-struct GPSdata gps = {
-	.timestamp=-1,
-	.speedKmh=-100,
-	.speedKnots=-100,
-	.altMt=-100,
-	.altFt=-100,
-	.realAltMt=-100,
-	.realAltFt=-100,
-	.trueTrack=0,
-	.day=-65,
-	.second=-65,
-	.latMinDecimal=-70,
-	.lonMinDecimal=-70,
-	.lat=100,
-	.pdop=50,
-	.hdop=50,
-	.vdop=50,
-	.fixMode=MODE_UNKNOWN
-};
+struct GPSdata gps = GPS_DATA_INITIALIZER;
 
 void configureGPSreceiver(void) {
-	if(config.GPSdevName==NULL) config.GPSdevName=strdup("/var/run/gpsfeed"); //Default value
-#ifdef SERIAL_DEVICE
-	switch(config.GPSbaudRate) { //configuration of the serial port
-		case 230400:
-			BAUD=B230400;
-			break;
-		case 115200:
-		default:
-			BAUD=B115200;
-			break;
-		case 57600:
-			BAUD=B57600;
-			break;
-		case 38400:
-			BAUD=B38400;
-			break;
-		case 19200:
-			BAUD=B19200;
-			break;
-		case 9600:
-			BAUD=B9600;
-			break;
-		case 4800:
-			BAUD=B4800;
-			break;
-		case 2400:
-			BAUD=B2400;
-			break;
-		case 1800:
-			BAUD=B1800;
-			break;
-		case 1200:
-			BAUD=B1200;
-			break;
-		case 600:
-			BAUD=B600;
-			break;
-		case 300:
-			BAUD=B300;
-			break;
-		case 200:
-			BAUD=B200;
-			break;
-		case 150:
-			BAUD=B150;
-			break;
-		case 134:
-			BAUD=B134;
-			break;
-		case 110:
-			BAUD=B110;
-			break;
-		case 75:
-			BAUD=B75;
+	GeoidalOpen();
+	for(int i=0;i<config.numOfGPSsources;i++) if(!configureGPSsource(&GPSreceiver.sources[i],i)) {
+		while(--i>=0) RingBufferRelease(&GPSreceiver.sources[i].ring);
+		return;
+	}
+	GPSreceiver.numOfSources=config.numOfGPSsources;
+	GPSreceiver.filtering=config.GPSfilterEnabled;
+	GPSreceiver.tickPeriod=config.GPSfilterEnabled && config.GPSfilterRate>0?1000/config.GPSfilterRate:0;
+	GPSfilterReset();
+	RegressionInit(&GPSreceiver.climb,GPS_CLIMB_WINDOW,MS_DAY,0);
+	RegressionInit(&GPSreceiver.turn,GPS_TURN_WINDOW,MS_DAY,360);
+	if(config.GPScaptureFile!=NULL) GPScaptureOpen(config.GPScaptureFile); //the capture is optional: go on also if it fails
+	pthread_mutex_init(&GPSreceiver.dataMutex,NULL);
+	pthread_cond_init(&GPSreceiver.dataSignal,NULL);
+	pthread_cond_init(&GPSreceiver.idleSignal,NULL);
+	GPSreceiver.reading=0;
+	updateNumOfTotalSatsInView(0); //Display: at the moment we have no info from GPS
+	updateNumOfActiveSats(0);
+	GPSpublishData();
+	FBrenderFlush();
+}
+
+bool configureGPSsource(struct GPSsource *source, int index) {
+	struct GPSsourceConfig *settings=&config.GPSsources[index];
+	if(settings->devName==NULL) settings->devName=strdup("/var/run/gpsfeed"); //Default value
+	memset(source,0,sizeof(*source));
+	source->index=index;
+	source->settings=settings;
+	source->fd=-1;
+	source->retryTimer=-1;
+	source->watchWd=-1;
+	source->baudRate=settings->baudRate;
+	source->autobaudPending=settings->baudRate==0;
+	if(source->baudRate!=0 && SerialPortBaudConstant(source->baudRate)==B0) {
+		LogWrite(LOG_WARNING,LOG_GPS,"unsupported baud rate %ld for %s, using 115200.\n",source->baudRate,settings->devName);
+		source->baudRate=115200;
+	}
+	switch(settings->protocol) {
+		case GPS_PROTOCOL_SIRF:
+			SiRFparserInit(index);
+			source->processBuffer=SiRFparserProcessBuffer;
+			source->logStats=SiRFparserLogStats;
 			break;
-		case 50:
-			BAUD=B50;
+		case GPS_PROTOCOL_UBX:
+			UBXparserInit(index);
+			source->processBuffer=UBXparserProcessBuffer;
+			source->logStats=UBXparserLogStats;
 			break;
-	} //end of switch baud_rate
-	switch(config.GPSdataBits){
-		case 8:
+		case GPS_PROTOCOL_NMEA:
 		default:
-			DATABITS=CS8;
-			break;
-		case 7:
-			DATABITS=CS7;
+			NMEAparserInit(index,settings->endOfBurst);
+			source->processBuffer=NMEAparserProcessBuffer;
+			source->logStats=NMEAparserLogStats;
 			break;
-		case 6:
-			DATABITS=CS6;
+	}
+	source->stats.devName=settings->devName;
+	if(!RingBufferInit(&source->ring,config.GPSbufferSize)) {
+		LogWrite(LOG_ERROR,LOG_GPS,"unable to allocate the receiving ring buffer.\n");
+		return false;
+	}
+	return true;
+}
+
+bool pendingGPSdata(void) { //true if there are bytes to be parsed from any source
+	for(int i=0;i<GPSreceiver.numOfSources;i++) if(RingBufferUsed(&GPSreceiver.sources[i].ring)>0) return true;
+	return false;
+}
+
+void signalParser(void) { //wake up the parser, the mutex is held by the parser just to check if the rings are empty
+	pthread_mutex_lock(&GPSreceiver.dataMutex);
+	pthread_cond_signal(&GPSreceiver.dataSignal);
+	pthread_mutex_unlock(&GPSreceiver.dataMutex);
+}
+
+bool validGPSstream(const unsigned char *buf, int len, void *arg) { //true if there is a whole valid sentence or message of the protocol of the source
+	const struct GPSsource *source=(const struct GPSsource*)arg;
+	for(int i=0;i<len;i++) switch(source->settings->protocol) {
+		case GPS_PROTOCOL_SIRF: //start sequence, length, payload, 15 bits checksum and end sequence
+			if(buf[i]==0xA0 && i+3<len && buf[i+1]==0xA2) {
+				int payloadLen=((buf[i+2]&0x7F)<<8)|buf[i+3];
+				if(payloadLen>SIRF_MAX_PAYLOAD_LENGTH || i+8+payloadLen>len) break;
+				unsigned int checksum=0;
+				for(int j=0;j<payloadLen;j++) checksum+=buf[i+4+j];
+				const unsigned char *tail=buf+i+4+payloadLen;
+				if((((tail[0]<<8)|tail[1])==(checksum&0x7FFF)) && tail[2]==0xB0 && tail[3]==0xB3) return true;
+			}
 			break;
-		case 5:
-			DATABITS=CS5;
+		case GPS_PROTOCOL_UBX: //sync chars, class, ID, length, payload and Fletcher checksum
+			if(buf[i]==0xB5 && i+5<len && buf[i+1]==0x62) {
+				int payloadLen=buf[i+4]|(buf[i+5]<<8);
+				if(payloadLen>UBX_MAX_PAYLOAD_LENGTH || i+8+payloadLen>len) break;
+				unsigned char ckA=0, ckB=0;
+				for(int j=2;j<6+payloadLen;j++) {
+					ckA+=buf[i+j];
+					ckB+=ckA;
+				}
+				if(buf[i+6+payloadLen]==ckA && buf[i+7+payloadLen]==ckB) return true;
+			}
 			break;
-	} //end of switch data_bits
-	switch(config.GPSstopBits){
-		case 1:
+		case GPS_PROTOCOL_NMEA: //printable sentence with the right checksum
 		default:
-			STOPBITS=0;
-			break;
-		case 2:
-			STOPBITS=CSTOPB;
-			break;
-	} //end of switch stop bits
-	switch(config.GPSparity){
-		case 0:
-		default: //none
-			PARITYON=0;
-			PARITY=0;
-			break;
-		case 1: //odd
-			PARITYON=PARENB;
-			PARITY=PARODD;
-			break;
-		case 2: //even
-			PARITYON=PARENB;
-			PARITY=0;
+			if(buf[i]=='$') {
+				unsigned char checksum=0;
+				int j;
+				for(j=i+1;j<len && j-i<MAX_SENTENCE_LENGTH && buf[j]!='*';j++) {
+					if(buf[j]<' ' || buf[j]>'~') break;
+					checksum^=buf[j];
+				}
+				if(j+2<len && buf[j]=='*') {
+					char hex[3]={buf[j+1],buf[j+2],'\0'};
+					char *end;
+					if(strtol(hex,&end,16)==checksum && *end=='\0') return true;
+				}
+			}
 			break;
-	} //end of switch parity
-#endif
-	GeoidalOpen();
-	pthread_mutex_init(&gps.mutex, NULL);
-	GPSreceiver.reading=0;
-	updateNumOfTotalSatsInView(0); //Display: at the moment we have no info from GPS
-	updateNumOfActiveSats(0);
+	}
+	return false;
+}
+
+bool setupSerialPort(struct GPSsource *source) { //set up the port at the configured baud rate or at the one found by the autobaud
+	struct GPSsourceConfig *settings=source->settings;
+	if(!SerialPortSetup(source->fd,source->baudRate,settings->dataBits,settings->stopBits,settings->parity,settings->minRead)) return false;
+	if(settings->protocol==GPS_PROTOCOL_UBX) UBXparserConfigureReceiver(source->fd,settings->rate); //go on also if it fails: it may be already configured
+	return true;
+}
+
+bool openGPSdevice(struct GPSsource *source) {
+	const char *devName=source->settings->devName;
+	source->fd=open(devName,O_RDWR|O_NOCTTY|O_NONBLOCK); //non blocking, writing is needed only to configure the receiver
+	if(source->fd<0) source->fd=open(devName,O_RDONLY|O_NOCTTY|O_NONBLOCK);
+	if(source->fd<0) {
+		LogWrite(LOG_ERROR,LOG_GPS,"Can't open the GPS serial port or pipe %s.\n",devName);
+		return false;
+	}
+	source->isSerial=isatty(source->fd); //otherwise it is a pipe: nothing to set up
+	if(source->isSerial) {
+		tcgetattr(source->fd,&source->oldtio);
+		if(source->baudRate==0 || source->autobaudPending) return true; //the autobaud sets it up
+		if(!setupSerialPort(source)) {
+			closeGPSdevice(source);
+			return false;
+		}
+	} else {
+		unsigned char discard[GPS_DISCARD_SIZE];
+		while(read(source->fd,discard,GPS_DISCARD_SIZE)>0); // flush the stream, the serial port is flushed by its setup
+	}
+	return true;
+}
+
+bool startGPSdevice(struct GPSsource *source) { //the device is open and set up: from now on it is read by the event loop
+	if(!EventLoopAddFd(source->fd,readGPSdevice,source)) {
+		closeGPSdevice(source);
+		return false;
+	}
+	source->lost=false;
+	source->lastArrival=EventLoopNow();
+	LogWrite(LOG_INFO,LOG_GPS,"GPS device %s opened.\n",source->settings->devName);
+	showGPSstatus();
+	return true;
+}
+
+bool startGPSautobaud(struct GPSsource *source) { //the event loop tries one rate at a time: the other sources, the touch screen and the display go on
+	struct GPSsourceConfig *settings=source->settings;
+	LogWrite(LOG_INFO,LOG_GPS,"looking for the baud rate of the GPS receiver on %s.\n",settings->devName);
+	if(!SerialPortAutobaudStart(&source->autobaud,source->fd,settings->dataBits,settings->stopBits,settings->parity,validGPSstream,source)) return false;
+	if(!EventLoopAddFd(source->fd,readGPSautobaud,source)) return false;
+	source->retryTimer=EventLoopAddTimer(SERIAL_AUTOBAUD_LISTEN,nextGPSautobaud,source);
+	if(source->retryTimer<0) {
+		EventLoopRemoveFd(source->fd);
+		return false;
+	}
+	return true;
+}
+
+void readGPSautobaud(int fd, void *arg) { //called by the event loop when there are bytes during the autobaud
+	struct GPSsource *source=(struct GPSsource*)arg;
+	long rate=SerialPortAutobaudRead(&source->autobaud);
+	if(rate==0) return; //no valid data yet at this rate
+	stopGPSautobaud(source);
+	if(rate>0) {
+		source->baudRate=rate;
+		LogWrite(LOG_INFO,LOG_GPS,"GPS receiver on %s found at %ld baud.\n",source->settings->devName,rate); //kept for the next openings
+		if(setupSerialPort(source) && startGPSdevice(source)) return;
+	} else LogWrite(LOG_ERROR,LOG_GPS,"Unable to read from GPS serial port %s while looking for its baud rate.\n",source->settings->devName);
+	closeGPSdevice(source);
+	backoffGPSretry(source);
+}
+
+void nextGPSautobaud(void *arg) { //called by the event loop every SERIAL_AUTOBAUD_LISTEN ms during the autobaud
+	struct GPSsource *source=(struct GPSsource*)arg;
+	if(SerialPortAutobaudNext(&source->autobaud)) return;
+	if(source->baudRate!=0) LogWrite(LOG_ERROR,LOG_GPS,"no valid data from the GPS receiver on %s at any baud rate, retrying at %ld baud.\n",source->settings->devName,source->baudRate);
+	else LogWrite(LOG_ERROR,LOG_GPS,"no valid data from the GPS receiver on %s at any baud rate, looking again when the device appears.\n",source->settings->devName);
+	stopGPSautobaud(source);
+	closeGPSdevice(source);
+	backoffGPSretry(source);
+}
+
+void stopGPSautobaud(struct GPSsource *source) {
+	EventLoopRemoveTimer(source->retryTimer);
+	source->retryTimer=-1;
+	EventLoopRemoveFd(source->fd);
+}
+
+void closeGPSdevice(struct GPSsource *source) {
+	if(source->fd<0) return;
+	if(source->isSerial) tcsetattr(source->fd,TCSANOW,&source->oldtio); //restore old port settings
+	close(source->fd);
+	source->fd=-1;
+}
+
+void readGPSdevice(int fd, void *arg) { //called by the event loop when there are bytes
+	readGPSbytes((struct GPSsource*)arg);
+}
+
+int readGPSbytes(struct GPSsource *source) { //it only moves the bytes from the device to the ring, returns how many or <=0 if none
+	int fd=source->fd;
+	unsigned char discard[GPS_DISCARD_SIZE]; //where to put the bytes when the ring is full
+	unsigned char *buf;
+	unsigned int space=RingBufferGetWriteSpace(&source->ring,&buf);
+	int redBytes;
+	if(space>0) {
+		redBytes=read(fd,buf,space);
+		if(redBytes>0) {
+			if(source->index==0) GPScaptureRecord(buf,redBytes); //the capture and the trace follow only the first source
+			RingBufferCommitWrite(&source->ring,redBytes);
+			if(source->index==0) TRACE_MARK(TRACE_BYTES_ARRIVED,source->ring.head,redBytes);
+			signalParser();
+		}
+	} else { //the parser is late: never wait for it, throw away the bytes and take note of it
+		redBytes=read(fd,discard,GPS_DISCARD_SIZE);
+		if(redBytes>0) {
+			if(source->index==0) GPScaptureRecord(discard,redBytes);
+			RingBufferRecordOverflow(&source->ring,redBytes);
+		}
+		signalParser();
+	}
+	if(redBytes>0) source->lastArrival=EventLoopNow();
+	else if(redBytes==0 || (errno!=EAGAIN && errno!=EINTR)) { //the device has gone
+		LogWrite(LOG_ERROR,LOG_GPS,"Unable to read from GPS serial port or pipe %s, reopening device.\n",source->settings->devName);
+		loseGPSdevice(source);
+		return 0;
+	}
+	return redBytes;
+}
+
+void checkGPSsilence(void *arg) { //called by the event loop once per second
+	unsigned long now=EventLoopNow();
+	for(int i=0;i<GPSreceiver.numOfSources;i++) {
+		struct GPSsource *source=&GPSreceiver.sources[i];
+		if(source->lost || now-source->lastArrival<GPS_SILENCE_TIMEOUT) continue;
+		LogWrite(LOG_WARNING,LOG_GPS,"Nothing received from %s within %d seconds, reopening device.\n",source->settings->devName,GPS_SILENCE_TIMEOUT/1000);
+		loseGPSdevice(source);
+	}
+}
+
+void drainGPSdevices(void *arg) { //called by the event loop every SERIAL_DRAIN_PERIOD ms: the bytes less than minRead do not wake it up
+	for(int i=0;i<GPSreceiver.numOfSources;i++) {
+		struct GPSsource *source=&GPSreceiver.sources[i];
+		if(!source->lost && source->isSerial && source->settings->minRead>1) while(readGPSbytes(source)>0); //until the port is empty, then EAGAIN
+	}
+}
+
+void loseGPSdevice(struct GPSsource *source) { //closes the device and keeps trying to open it again: the other sources, the route and the track go on
+	EventLoopRemoveFd(source->fd);
+	closeGPSdevice(source);
+	source->lost=true;
+	source->retryDelay=GPS_RETRY_MIN;
+	scheduleGPSretry(source);
+	showGPSstatus();
+}
+
+void scheduleGPSretry(struct GPSsource *source) {
+	EventLoopRemoveTimer(source->retryTimer);
+	source->retryTimer=EventLoopAddTimer(source->retryDelay,retryGPSdevice,source);
+}
+
+void retryGPSdevice(void *arg) { //called by the retry timer and when the device appears
+	struct GPSsource *source=(struct GPSsource*)arg;
+	EventLoopRemoveTimer(source->retryTimer); //the timers are periodic: this one is used just once
+	source->retryTimer=-1;
+	if(!source->lost || source->fd>=0) return; //already open, or looking for its baud rate
+	if(openGPSdevice(source)) {
+		if(!source->isSerial || (source->baudRate!=0 && !source->autobaudPending)) { //at the configured or at the last found rate
+			if(startGPSdevice(source)) return;
+		} else if(source->autobaudPending) {
+			source->autobaudPending=false; //once for each appearance of the device, not at each retry
+			if(startGPSautobaud(source)) return; //it goes on in the event loop
+			closeGPSdevice(source);
+		} else { //no rate found since it appeared: just keep checking that it is still there
+			LogWrite(LOG_DEBUG,LOG_GPS,"no baud rate for %s, waiting for the device to appear again.\n",source->settings->devName);
+			closeGPSdevice(source);
+		}
+	} else if(source->settings->baudRate==0) source->autobaudPending=true; //missing: the next opening is a new appearance
+	backoffGPSretry(source);
+}
+
+void backoffGPSretry(struct GPSsource *source) { //the next attempt after a failed one
+	source->retryDelay*=2; //exponential backoff
+	if(source->retryDelay>GPS_RETRY_MAX) source->retryDelay=GPS_RETRY_MAX;
+	scheduleGPSretry(source);
+}
+
+void showGPSstatus(void) { //on the HSI the fix mode is replaced by GPS lost while all the devices are closed
+	if(getMainStatus()!=MAIN_DISPLAY_HSI) return;
+	if(GPSisLost()) PrintGPSlost();
+	else {
+		struct GPSdata data;
+		GPSgetData(&data);
+		PrintFixMode(data.fixMode);
+	}
 	FBrenderFlush();
 }
 
-void* run(void *ptr) { //listening function, it will be ran in a separate thread
-	static int fd=-1;
-	fd=open(config.GPSdevName,O_RDONLY|O_NOCTTY|O_NONBLOCK); //read only, non blocking
-	if(fd>=0) {
-		#ifdef SERIAL_DEVICE
-		struct termios oldtio,newtio; //place for old and new port settings for serial port
-		tcgetattr(fd,&oldtio); // save current port settings
-		newtio.c_cflag=BAUD|CRTSCTS|DATABITS|STOPBITS|PARITYON|PARITY|CLOCAL|CREAD; // set new port settings for canonical input processing
-		newtio.c_iflag=IGNPAR;
-		newtio.c_oflag=0;
-		newtio.c_lflag=0; //ICANON;
-		newtio.c_cc[VMIN]=1;
-		newtio.c_cc[VTIME]=0;
-		tcsetattr(fd,TCSANOW,&newtio); // Set the new options for the port...
-		tcflush(fd,TCIFLUSH);
-		#endif
-		static unsigned char *buf=NULL; //read buffer
-		buf=(unsigned char *) malloc(NMEA_BUFFER_SIZE*sizeof(unsigned char));
-		if (buf!=NULL) {
-			int maxfd=fd+1;
-			fd_set readfs;
-			FD_SET(fd,&readfs);
-			int toRead_redBytes=0; // return flag of select() or number of bytes red
-			struct timeval timeout;
-			timeout.tv_sec = 5;
-			timeout.tv_usec = 0;
-			while(read(fd,buf,NMEA_BUFFER_SIZE)>0); // flush the stream
-			while(GPSreceiver.reading) { // loop while waiting for input
-				toRead_redBytes=select(maxfd,&readfs,NULL,NULL,&timeout); //wait to read because the read is now non-blocking
-				if(GPSreceiver.reading) { // further check if we want still to read after waiting
-					if(toRead_redBytes==1) {
-						toRead_redBytes=read(fd,buf,NMEA_BUFFER_SIZE);
-						NMEAparserProcessBuffer(buf,toRead_redBytes);
-						timeout.tv_sec = 5; // reset the timeout
-					} else {
-						GPSreceiver.reading=0;
-						if(toRead_redBytes==0) printLog("GPSreceiver: WARNING Nothing received on GPS serial port or pipe within 5 seconds, closing device.\n");
-						else printLog("GPSreceiver: ERROR Unable to wait for input on GPS serial port or pipe on the chosen device.\n");
-					}
-				}
+bool GPSisLost(void) {
+	if(GPSreceiver.numOfSources==0) return false;
+	for(int i=0;i<GPSreceiver.numOfSources;i++) if(!GPSreceiver.sources[i].lost) return false;
+	return true;
+}
+
+void watchGPSdevices(void) { //to know at once when a device is created again, for example when an USB GPS is plugged in
+#ifdef GPS_INOTIFY
+	GPSreceiver.watchFd=inotify_init();
+	if(GPSreceiver.watchFd>=0) {
+		fcntl(GPSreceiver.watchFd,F_SETFL,O_NONBLOCK);
+		if(!EventLoopAddFd(GPSreceiver.watchFd,readGPSwatch,NULL)) {
+			close(GPSreceiver.watchFd);
+			GPSreceiver.watchFd=-1;
+		}
+	}
+	for(int i=0;i<GPSreceiver.numOfSources;i++) {
+		struct GPSsource *source=&GPSreceiver.sources[i];
+		char *dir=strdup(source->settings->devName);
+		char *slash=strrchr(dir,'/');
+		if(slash==NULL) strcpy(dir,".");
+		else if(slash==dir) slash[1]='\0';
+		else *slash='\0';
+		if(GPSreceiver.watchFd>=0) source->watchWd=inotify_add_watch(GPSreceiver.watchFd,dir,IN_CREATE|IN_ATTRIB|IN_MOVED_TO); //the same for the devices in the same directory
+		if(source->watchWd<0) LogWrite(LOG_WARNING,LOG_GPS,"unable to watch %s, the GPS device will be only polled.\n",dir);
+		free(dir);
+	}
+#endif
+}
+
+void readGPSwatch(int fd, void *arg) { //called by the event loop when something changed in the directory of a device
+#ifdef GPS_INOTIFY
+	char buf[1024];
+	bool appeared[GPS_MAX_SOURCES]={false};
+	int len;
+	while((len=read(fd,buf,sizeof(buf)))>0) {
+		for(int i=0;i+(int)sizeof(struct inotify_event)<=len;) {
+			struct inotify_event *event=(struct inotify_event*)(buf+i);
+			if(event->len>0) for(int j=0;j<GPSreceiver.numOfSources;j++) {
+				const char *devName=GPSreceiver.sources[j].settings->devName;
+				const char *name=strrchr(devName,'/');
+				name=name==NULL?devName:name+1;
+				if(event->wd==GPSreceiver.sources[j].watchWd && strcmp(event->name,name)==0) appeared[j]=true;
 			}
-			#ifdef SERIAL_DEVICE
-			tcsetattr(fd,TCSANOW,&oldtio); //restore old port settings
-			#endif
-			free(buf);
-			buf=NULL;
-		} else printLog("GPSreceiver: ERROR unable to allocate read buffer.\n");
-		close(fd); //close the serial port
-	} else {
-		fd=-1;
-		printLog("ERROR: Can't open the GPS serial port or pipe on the chosen device.\n");
+			i+=sizeof(struct inotify_event)+event->len;
+		}
+	}
+	for(int j=0;j<GPSreceiver.numOfSources;j++) {
+		struct GPSsource *source=&GPSreceiver.sources[j];
+		if(!appeared[j] || !source->lost || source->fd>=0) continue; //open or looking for its baud rate
+		if(source->settings->baudRate==0) source->autobaudPending=true; //it may be another receiver
+		source->retryDelay=GPS_RETRY_MIN;
+		retryGPSdevice(source);
+	}
+#endif
+}
+
+void* runParser(void *ptr) { //parsing function, it will be ran in a separate thread so the event loop never waits for parsing and drawing
+	unsigned char *buf;
+	unsigned int len;
+	while(GPSreceiver.reading) {
+		pthread_mutex_lock(&GPSreceiver.dataMutex);
+		while(GPSreceiver.reading && !pendingGPSdata()) { //between two solutions wake up also for the outputs of the filter
+			long wait=nextGPSprediction();
+			if(wait==0) break;
+			GPSreceiver.parserIdle=true;
+			pthread_cond_signal(&GPSreceiver.idleSignal);
+			if(wait<0 || TimeBaseIsVirtual()) pthread_cond_wait(&GPSreceiver.dataSignal,&GPSreceiver.dataMutex); //the virtual clock moves only with GPSreceiverSync()
+			else waitParser(wait);
+		}
+		pthread_mutex_unlock(&GPSreceiver.dataMutex);
+		for(int i=0;i<GPSreceiver.numOfSources;i++) { //one source at a time: the parsers keep a context for each one
+			struct GPSsource *source=&GPSreceiver.sources[i];
+			while((len=RingBufferGetReadSpace(&source->ring,&buf))>0) { //process all what is in the ring, at most in two chunks because of the wrap
+				source->processBuffer(i,buf,len);
+				RingBufferCommitRead(&source->ring,len);
+			}
+		}
+		if(nextGPSprediction()==0) publishGPSprediction();
 	}
-	GPSreceiver.reading=0;
 	pthread_exit(NULL);
 	return NULL;
 }
 
-char GPSreceiverStart(void) { //function to start the listening thread
+void GPSreceiverFeed(int index, const unsigned char *data, int length) { //bytes of a replay as if read from the device, only the thread of the event loop
+	struct GPSsource *source=&GPSreceiver.sources[index];
+	while(length>0 && GPSreceiver.reading) {
+		unsigned char *buf;
+		unsigned int space=RingBufferGetWriteSpace(&source->ring,&buf);
+		if(space==0) { //the ring is full: a replay waits for the parser, nothing is lost
+			GPSreceiverSync();
+			continue;
+		}
+		if(space>(unsigned int)length) space=length;
+		memcpy(buf,data,space);
+		RingBufferCommitWrite(&source->ring,space);
+		data+=space;
+		length-=space;
+	}
+	source->lastArrival=EventLoopNow();
+}
+
+void GPSreceiverSync(void) { //with the virtual clock: returns when the parser has processed all the bytes and the outputs of the filter due by now
+	pthread_mutex_lock(&GPSreceiver.dataMutex);
+	GPSreceiver.parserIdle=false;
+	pthread_cond_signal(&GPSreceiver.dataSignal);
+	while(GPSreceiver.reading && !GPSreceiver.parserIdle) pthread_cond_wait(&GPSreceiver.idleSignal,&GPSreceiver.dataMutex);
+	pthread_mutex_unlock(&GPSreceiver.dataMutex);
+}
+
+void waitParser(long ms) { //waits for new bytes at most ms of the time base, the mutex must be held
+	struct timeval now;
+	struct timespec until; //absolute time of the real time clock as wanted by pthread_cond_timedwait()
+	gettimeofday(&now,NULL);
+	until.tv_sec=now.tv_sec+ms/1000;
+	until.tv_nsec=now.tv_usec*1000+(ms%1000)*1000000;
+	if(until.tv_nsec>=1000000000) {
+		until.tv_sec++;
+		until.tv_nsec-=1000000000;
+	}
+	pthread_cond_timedwait(&GPSreceiver.dataSignal,&GPSreceiver.dataMutex,&until);
+}
+
+long nextGPSprediction(void) { //ms to the next output of the filter, 0 if due, -1 if there is none to be done
+	if(GPSreceiver.tickPeriod==0 || GPSreceiver.selected==-1) return -1;
+	unsigned long now=EventLoopNow();
+	if(now-GPSreceiver.lastFix>GPS_MAX_PREDICTION) return -1; //the fixes stopped: do not make up the position
+	long wait=(long)(GPSreceiver.nextTick-now);
+	return wait>0?wait:0;
+}
+
+void publishGPSprediction(void) { //output of the filter between two solutions of a receiver slower than the filter
+	unsigned long now=EventLoopNow();
+	struct GPSfilterState state;
+	GPSreceiver.nextTick+=GPSreceiver.tickPeriod;
+	if((long)(GPSreceiver.nextTick-now)<=0) GPSreceiver.nextTick=now+GPSreceiver.tickPeriod; //too late: skip the lost ones
+	long elapsed=now-GPSreceiver.lastEpoch;
+	if(!GPSfilterGetState(elapsed,&state)) return;
+	gps.utc=GPSreceiver.epochUtc+elapsed*1000LL;
+	long timestamp=TimeBaseDayMs(gps.utc);
+	updateTime(timestamp/1000.0f,timestamp/3600000,(timestamp/60000)%60,(timestamp%60000)/1000.0f,false);
+	bool altChanged, posChanged=publishFilterState(&state,&altChanged);
+	GPSpublishData();
+	if(posChanged||altChanged) NavUpdatePosition(&gps.pos,gps.realAltMt,gps.speedKmh,gps.utc);
+	updateTurnCoordinator();
+	if(getMainStatus()==MAIN_DISPLAY_HSI) FBrenderFlush();
+	BlackBoxCommit();
+}
+
+char GPSreceiverStart(void) { //opens the devices, they will be read by the event loop and opened again when lost
 	if(GPSreceiver.reading==-1) configureGPSreceiver();
+	if(GPSreceiver.reading==-1) return 0; //configuration failed
 	if(!GPSreceiver.reading) {
 		GPSreceiver.reading=1;
-		if(pthread_create(&GPSreceiver.thread,NULL,run,(void*)NULL)) {
+		if(pthread_create(&GPSreceiver.parserThread,NULL,runParser,(void*)NULL)) {
 			GPSreceiver.reading=0;
-			printLog("GPSreceiver: ERROR unable to create the reading thread.\n");
+			LogWrite(LOG_ERROR,LOG_GPS,"unable to create the parsing thread.\n");
+			return 0;
+		}
+		GPSreceiver.parserStarted=true;
+		if(config.GPSreplayFile!=NULL) { //the first source is fed by the replay, no device is opened
+			if(!GPSreplayOpen(config.GPSreplayFile)) {
+				GPSreceiverStop();
+				return 0;
+			}
+			for(int i=0;i<GPSreceiver.numOfSources;i++) GPSreceiver.sources[i].lost=i>0;
+			return GPSreceiver.reading;
+		}
+		GPSreceiver.watchdog=EventLoopAddTimer(GPS_WATCHDOG_PERIOD,checkGPSsilence,NULL);
+		for(int i=0;i<GPSreceiver.numOfSources;i++) if(GPSreceiver.sources[i].settings->minRead>1) { //one timer for all the ports
+			GPSreceiver.drainTimer=EventLoopAddTimer(SERIAL_DRAIN_PERIOD,drainGPSdevices,NULL);
+			break;
+		}
+		watchGPSdevices();
+		for(int i=0;i<GPSreceiver.numOfSources;i++) {
+			struct GPSsource *source=&GPSreceiver.sources[i];
+			source->lost=true; //not opened yet
+			source->retryDelay=GPS_RETRY_MIN;
+			retryGPSdevice(source);
+			if(source->lost && source->fd<0) LogWrite(LOG_WARNING,LOG_GPS,"GPS device %s not available yet, it will be opened when it appears.\n",source->settings->devName);
 		}
 	}
 	return GPSreceiver.reading;
 }
 
-void GPSreceiverClose(void) {
+void GPSreceiverStop(void) { //to be called by the thread of the event loop
+	if(GPSreceiver.reading!=1) return;
+	GPSreplayClose();
+	EventLoopRemoveTimer(GPSreceiver.watchdog);
+	GPSreceiver.watchdog=-1;
+	EventLoopRemoveTimer(GPSreceiver.drainTimer);
+	GPSreceiver.drainTimer=-1;
+	if(GPSreceiver.watchFd>=0) {
+		EventLoopRemoveFd(GPSreceiver.watchFd);
+		close(GPSreceiver.watchFd);
+		GPSreceiver.watchFd=-1;
+	}
+	for(int i=0;i<GPSreceiver.numOfSources;i++) {
+		struct GPSsource *source=&GPSreceiver.sources[i];
+		EventLoopRemoveTimer(source->retryTimer);
+		source->retryTimer=-1;
+		source->watchWd=-1;
+		if(source->fd>=0) EventLoopRemoveFd(source->fd); //read or looking for its baud rate
+		closeGPSdevice(source);
+		source->lost=false;
+	}
 	GPSreceiver.reading=0;
-	pthread_mutex_destroy(&gps.mutex);
+	signalParser(); //let also the parser terminate
+	if(GPSreceiver.parserStarted) {
+		pthread_join(GPSreceiver.parserThread,NULL);
+		GPSreceiver.parserStarted=false;
+	}
+}
+
+void GPSreceiverClose(void) {
+	if(GPSreceiver.reading!=-1) {
+		GPSreceiverStop();
+		struct GPSsourceStats stats[GPS_MAX_SOURCES];
+		int num=GPSgetSourceStats(stats);
+		for(int i=0;i<num;i++) {
+			struct GPSsource *source=&GPSreceiver.sources[i];
+			source->logStats(i);
+			LogWrite(LOG_INFO,LOG_GPS,"source %d %s: %lu solutions, %lu published, selected %lu times for %lu s.\n",i,stats[i].devName,stats[i].solutions,stats[i].published,stats[i].selections,stats[i].selectedMs/1000);
+			LogWrite(LOG_INFO,LOG_GPS,"source %d: ring of %u bytes, max used %u bytes, overflowed %lu times, dropped %lu bytes.\n",i,source->ring.size,source->ring.highWater,source->ring.overflows,source->ring.droppedBytes);
+			RingBufferRelease(&source->ring);
+		}
+		if(GPSreceiver.filtering) GPSfilterLogStats();
+		GPScaptureClose();
+		pthread_mutex_destroy(&GPSreceiver.dataMutex);
+		pthread_cond_destroy(&GPSreceiver.dataSignal);
+		pthread_cond_destroy(&GPSreceiver.idleSignal);
+		GPSreceiver.numOfSources=0;
+		GPSreceiver.selected=-1;
+		GPSreceiver.reading=-1;
+	}
 	GeoidalClose();
-	pthread_join(GPSreceiver.thread,NULL); //wait for thread death
+}
+
+int GPSgetSourceStats(struct GPSsourceStats *stats) { //the counters are updated by the parser thread: the copy may be a little behind
+	unsigned long now=EventLoopNow();
+	for(int i=0;i<GPSreceiver.numOfSources;i++) {
+		const struct GPSsource *source=&GPSreceiver.sources[i];
+		stats[i]=source->stats;
+		stats[i].lost=source->lost;
+		if(stats[i].selected) stats[i].selectedMs+=now-source->selectedSince; //the time since the last selection is not counted yet
+	}
+	return GPSreceiver.numOfSources;
+}
+
+void GPSpublishData(void) { //to be called only by the parser thread
+	unsigned int next=GPSreceiver.version+1;
+	GPSreceiver.published[next&1]=gps; //the copy not visible to the readers
+	MEMORY_BARRIER(); //the copy must be complete before the readers can see it
+	GPSreceiver.version=next;
+}
+
+unsigned int GPSgetData(struct GPSdata *data) { //consistent copy of the last published GPS data, returns its version
+	unsigned int version;
+	do { //retry only if the parser published twice during the copy and so it may have overwritten it
+		version=GPSreceiver.version;
+		MEMORY_BARRIER();
+		*data=GPSreceiver.published[version&1];
+		MEMORY_BARRIER();
+	} while(version!=GPSreceiver.version);
+	return version;
+}
+
+int scoreGPSsolution(const struct GPSsolution *solution) { //quality of a solution: 0 without a fix, the higher the better
+	int score;
+	if(!(solution->content&SOLUTION_POSITION)) return 0;
+	switch(solution->fixMode) {
+		case MODE_NO_FIX: return 0;
+		case MODE_2D_FIX: score=100; break;
+		case MODE_3D_FIX: score=300; break;
+		default: score=200; break; //fix of unknown dimension
+	}
+	if(solution->content&SOLUTION_SATS_IN_USE) score+=5*(solution->satsInUse<12?solution->satsInUse:12);
+	if(solution->content&(SOLUTION_HDOP|SOLUTION_DOP)) score-=solution->hdop<1000?solution->hdop/10:100; //10 points for each unit of HDOP
+	return score>1?score:1; //any fix is better than none
+}
+
+bool betterGPSsource(const struct GPSsource *candidate, const struct GPSsource *current) {
+	if(candidate->score==0) return false;
+	if(candidate->index<current->index) return candidate->score>=current->score; //back to the preferred source as soon as it is as good
+	return candidate->score>current->score+GPS_SWITCH_MARGIN; //the margin avoids to switch back and forth
+}
+
+bool aliveGPSsource(const struct GPSsource *source, unsigned long now) { //false if the source missed two of its solutions
+	return now-source->lastSolution<=(source->interval>0?2*source->interval:GPS_SOURCE_STALE);
+}
+
+bool arbitrateGPSsources(struct GPSsource *source, unsigned long now) { //true if the solution just scored of the source has to be published
+	if(GPSreceiver.selected==-1) {
+		selectGPSsource(source,now);
+		return true;
+	}
+	struct GPSsource *selected=&GPSreceiver.sources[GPSreceiver.selected];
+	if(source==selected) { //it may have degraded: leave it for a better source still alive
+		struct GPSsource *best=NULL;
+		for(int i=0;i<GPSreceiver.numOfSources;i++) {
+			struct GPSsource *other=&GPSreceiver.sources[i];
+			if(other==source || !aliveGPSsource(other,now) || !betterGPSsource(other,source)) continue;
+			if(best==NULL || other->score>best->score) best=other;
+		}
+		if(best==NULL) return true;
+		selectGPSsource(best,now);
+		return false; //the next solution of the new source, due within its epoch, will be published
+	}
+	if(!aliveGPSsource(selected,now) || betterGPSsource(source,selected)) { //the selected source is silent or worse
+		selectGPSsource(source,now);
+		return true;
+	}
+	return false;
+}
+
+void selectGPSsource(struct GPSsource *source, unsigned long now) {
+	if(GPSreceiver.selected>=0) {
+		struct GPSsource *previous=&GPSreceiver.sources[GPSreceiver.selected];
+		previous->stats.selectedMs+=now-previous->selectedSince;
+		previous->stats.selected=false;
+		LogWrite(LOG_INFO,LOG_GPS,"GPS source switched from %s (score %d) to %s (score %d).\n",previous->settings->devName,previous->score,source->settings->devName,source->score);
+	} else if(GPSreceiver.numOfSources>1) LogWrite(LOG_INFO,LOG_GPS,"GPS source %s selected (score %d).\n",source->settings->devName,source->score);
+	source->selectedSince=now;
+	source->stats.selections++;
+	source->stats.selected=true;
+	GPSreceiver.selected=source->index;
+	RegressionReset(&GPSreceiver.climb); //the altitudes and tracks of two receivers do not make a slope
+	RegressionReset(&GPSreceiver.turn);
+}
+
+void GPSpublishSolution(int index, const struct GPSsolution *solution) { //one update of GPS data, navigation and display for each receiver cycle of the selected source
+	struct GPSsource *source=&GPSreceiver.sources[index];
+	unsigned long now=EventLoopNow();
+	source->score=scoreGPSsolution(solution);
+	if(source->stats.solutions>0 && now-source->lastSolution<GPS_SOURCE_STALE) { //the gaps are not part of the rate
+		long interval=now-source->lastSolution;
+		source->interval=source->interval>0?(3*source->interval+interval)/4:interval;
+	}
+	source->lastSolution=now;
+	source->stats.score=source->score;
+	source->stats.solutions++;
+	if(!arbitrateGPSsources(source,now)) return;
+	source->stats.published++;
+	bool posChanged=false, altChanged=false;
+	unsigned int content=solution->content;
+	if(content&SOLUTION_DATE) {
+		updateDate(solution->day,solution->month,solution->year);
+		if(content&SOLUTION_TIME) TimeBaseDiscipline(solution->year,solution->month,solution->day,solution->timestamp,solution->received);
+	}
+	if(content&SOLUTION_TIME) {
+		gps.utc=TimeBaseFromDayMs(solution->timestamp); //the date of the time base, also when it is not in the solution
+		updateTime(solution->timestamp/1000.0f,solution->hour,solution->minute,solution->milliSec/1000.0f,!(content&SOLUTION_POSITION)); //updateTime must be done always before of updatePosition
+	}
+	if(solution->fixMode!=MODE_UNKNOWN) updateFixMode(solution->fixMode);
+	if(content&SOLUTION_MAGVAR) {
+		gps.magneticVariation=solution->magneticVariation*0.01f;
+		gps.isMagVarToEast=solution->isMagVarToEast;
+	}
+	if(GPSreceiver.filtering) { //a solution rejected by the filter moves neither the position nor the navigation
+		struct GPSfilterState state;
+		GPSfilterUpdate(solution);
+		if((content&SOLUTION_POSITION) && solution->fixMode!=MODE_NO_FIX) GPSreceiver.lastFix=now;
+		if((content&SOLUTION_TIME) && GPSfilterGetState(0,&state)) {
+			GPSreceiver.lastEpoch=now;
+			GPSreceiver.epochUtc=gps.utc;
+			GPSreceiver.nextTick=now+GPSreceiver.tickPeriod;
+			if(now-GPSreceiver.lastFix<=GPS_MAX_PREDICTION) posChanged=publishFilterState(&state,&altChanged);
+		}
+	} else {
+		if(content&SOLUTION_POSITION) posChanged=updatePosition(&solution->pos);
+		if(content&SOLUTION_ALTITUDE) altChanged=updateAltitude(solution->alt*0.001f,solution->altUnit);
+		if(content&SOLUTION_VELOCITY) {
+			updateSpeed(solution->groundSpeedKnots*0.001f);
+			updateDirection(solution->trueTrack*0.01f,gps.magneticVariation,gps.isMagVarToEast,gps.speedKmh>2);
+		}
+		if(content&SOLUTION_TIME) updateRegressions(solution);
+	}
+	if(content&SOLUTION_SATS_IN_VIEW) updateNumOfTotalSatsInView(solution->satsInView);
+	if(content&SOLUTION_SATS_IN_USE) updateNumOfActiveSats(solution->satsInUse);
+	if(content&SOLUTION_SATELLITES) memcpy(gps.satellites,solution->satellites,sizeof(gps.satellites));
+	if(content&SOLUTION_DOP) {
+		gps.pdop=solution->pdop*0.01f;
+		gps.hdop=solution->hdop*0.01f;
+		gps.vdop=solution->vdop*0.01f;
+		//updateDiluition(gps.pdop,gps.hdop,gps.vdop);
+	} else if(content&SOLUTION_HDOP) gps.hdop=solution->hdop*0.01f; //updateHdiluition(gps.hdop);
+	if(content&SOLUTION_ERRORS) {
+		gps.latErrMt=solution->latErr*0.001f;
+		gps.lonErrMt=solution->lonErr*0.001f;
+		gps.altErrMt=solution->altErr*0.001f;
+	}
+	gps.source=index;
+	GPSpublishData(); //from now on the other threads see the new solution
+	if(posChanged||altChanged) NavUpdatePosition(&gps.pos,gps.realAltMt,gps.speedKmh,gps.utc);
+	updateTurnCoordinator();
+	if(getMainStatus()==MAIN_DISPLAY_HSI) FBrenderFlush();
+	if(GPSreceiver.numOfSources>1) BlackBoxRecordSource(source->settings->devName);
+	BlackBoxCommit();
+}
+
+bool publishFilterState(const struct GPSfilterState *state, bool *altChanged) { //returns true if the position has changed
+	bool posChanged=updatePosition(&state->pos);
+	*altChanged=state->hasAltitude && updateAltitude(state->altMt,'M');
+	updateSpeed(Km2Nm(ms2Kmh(state->speedMs)));
+	updateDirection(state->trueTrack,gps.magneticVariation,gps.isMagVarToEast,state->isTrackValid);
+	updateTurnRate(state->turnRate);
+	if(state->hasAltitude) updateVerticalSpeed(ms2FtMin(state->climbMs));
+	return posChanged;
+}
+
+void updateRegressions(const struct GPSsolution *solution) { //vertical speed and turn rate from the slopes of the last solutions
+	double slope;
+	if((solution->content&SOLUTION_ALTITUDE) && solution->fixMode!=MODE_NO_FIX) {
+		RegressionAdd(&GPSreceiver.climb,solution->timestamp,gps.altFt);
+		if(RegressionSlope(&GPSreceiver.climb,&slope)) updateVerticalSpeed(slope*60);
+	}
+	if(solution->content&SOLUTION_VELOCITY) {
+		if(gps.speedKmh>GPS_TURN_MIN_SPEED) {
+			RegressionAdd(&GPSreceiver.turn,solution->timestamp,gps.trueTrack);
+			if(RegressionSlope(&GPSreceiver.turn,&slope)) updateTurnRate(slope);
+		} else { //the track is not reliable
+			RegressionReset(&GPSreceiver.turn);
+			updateTurnRate(0);
+		}
+	}
+}
+
+void updateVerticalSpeed(double climbFtMin) {
+	if(climbFtMin!=gps.climbFtMin) {
+		gps.climbFtMin=climbFtMin;
+		if(getMainStatus()==MAIN_DISPLAY_HSI) PrintVerticalSpeed(climbFtMin);
+	}
+	BlackBoxRecordClimb(Ft2m(climbFtMin)/60);
+}
+
+void updateTurnRate(double turnRateDegSec) {
+	if(turnRateDegSec!=gps.turnRateDegSec) {
+		gps.turnRateDegSec=turnRateDegSec;
+		gps.turnRateDegMin=turnRateDegSec*60;
+		if(getMainStatus()==MAIN_DISPLAY_HSI) PrintTurnRate(gps.turnRateDegMin);
+	}
+	BlackBoxRecordTurnRate(turnRateDegSec);
+}
+
+void updateTurnCoordinator(void) { //shown only when the accelerometer is read
+	struct AccelAttitude attitude;
+	AccelerometerGetAttitude(&attitude);
+	if(attitude.valid && getMainStatus()==MAIN_DISPLAY_HSI) HSIupdateTurnCoordinator(attitude.turnRateDegSec,attitude.bankDeg,attitude.slipG);
+}
+
+bool updatePosition(const struct GeoPosition *newPos) { //kept as it comes, in radians only where the trigonometry needs it
+	if(newPos->lat!=gps.pos.lat||newPos->lon!=gps.pos.lon) {
+		gps.pos=*newPos;
+		if(getMainStatus()==MAIN_DISPLAY_HSI) PrintPosition(&gps.pos);
+		else if(getMainStatus()==MAIN_DISPLAY_SUNRISE_SUNSET) {
+			//TODO: ....
+		}
+		BlackBoxRecordPos(&gps.pos,gps.utc);
+		return true;
+	}
+	return false;
+}
+
+bool updateAltitude(float newAltitude, char altUnit) {
+	float newAltitudeMt=0,newAltitudeFt=0;
+	bool updateAlt=false;
+	if(altUnit=='M' || altUnit=='m') {
+		if(newAltitude!=gps.altMt) {
+			updateAlt=true;
+			newAltitudeMt=newAltitude;
+			newAltitudeFt=m2Ft(newAltitude);
+		}
+	} else if(altUnit=='F' || altUnit=='f') {
+		if(newAltitude!=gps.altFt) {
+			updateAlt=true;
+			newAltitudeFt=newAltitude;
+			newAltitudeMt=Ft2m(newAltitude);
+		}
+	} else {
+		LogWrite(LOG_ERROR,LOG_GPS,"Unknown altitude unit: %c\n",altUnit);
+		return 0;
+	}
+	if(updateAlt) {
+		gps.altMt=newAltitudeMt;
+		gps.altFt=newAltitudeFt;
+		double deltaMt=GeoidalGetSeparation(geo2Deg(gps.pos.lat),geo2Deg(gps.pos.lon)); //East positive as EGM96
+		newAltitudeMt-=deltaMt;
+		newAltitudeFt-=m2Ft(deltaMt);
+		if(getMainStatus()==MAIN_DISPLAY_HSI) {
+			HSIdrawVSIscale(newAltitudeFt);
+			PrintAltitude(newAltitudeMt,newAltitudeFt);
+		}
+		gps.realAltMt=newAltitudeMt;
+		gps.realAltFt=newAltitudeFt;
+	}
+	BlackBoxRecordAlt(gps.realAltMt);
+	return updateAlt;
+}
+
+void updateDirection(float newTrueTrack, float magneticVar, bool isVarToEast, bool isTrackValid) { //the track is not shown if not valid, as when too slow
+	if(isTrackValid) {
+		if(newTrueTrack!=gps.trueTrack) {
+			gps.magneticVariation=magneticVar;
+			gps.isMagVarToEast=isVarToEast;
+			if(newTrueTrack<90 && newTrueTrack>270) { // I'm up
+				if(isVarToEast) gps.magneticTrack=newTrueTrack+magneticVar;
+				else gps.magneticTrack=newTrueTrack-magneticVar;
+			} else { // I'm down
+				if(isVarToEast) gps.magneticTrack=newTrueTrack-magneticVar;
+				else gps.magneticTrack=newTrueTrack+magneticVar;
+			}
+			if(getMainStatus()==MAIN_DISPLAY_HSI) HSIupdateDir(newTrueTrack);
+			gps.trueTrack=newTrueTrack;
+		}
+		if(gps.speedKmh>4) BlackBoxRecordCourse(newTrueTrack);
+	}
 }
 
 /*void updateHdiluition(float hDiluition) {
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 12/12/2013
+// Last change : 18/10/2026
 // Description : Reads from a NMEA serial device NMEA sentences and parse them
 //============================================================================
 
@@ -17,6 +17,7 @@
 #include "Common.h"
 
 #define MAX_NUM_SAT 24
+#define MS_DAY 86400000 //milliseconds in a day
 
 //FAA Mode Indicators
 #define FAA_ABSENT  0 //Previous version of NMEA 2.3 without FAA
@@ -53,8 +54,43 @@ enum indexSatData { //Indexes for satellite's data
 	SAT_SNR        //SNR in dB (00-99)
 };
 
+enum GPSsolutionContent { //bits telling which parts of a GPS solution are known
+	SOLUTION_TIME=1,
+	SOLUTION_DATE=2,
+	SOLUTION_POSITION=4,
+	SOLUTION_ALTITUDE=8,
+	SOLUTION_VELOCITY=16,      //ground speed and true track
+	SOLUTION_MAGVAR=32,        //magnetic variation
+	SOLUTION_HDOP=64,          //only the horizontal dilution
+	SOLUTION_DOP=128,          //all the dilutions
+	SOLUTION_SATS_IN_USE=256,
+	SOLUTION_SATS_IN_VIEW=512,
+	SOLUTION_SATELLITES=1024,  //the matrix of the satellites in view
+	SOLUTION_ERRORS=2048       //standard deviations of the position errors
+};
+
+struct GPSsolution { //one coherent solution of a receiver cycle, it is not modified once published
+	unsigned int content;                          //enum GPSsolutionContent bits of the known parts
+	long timestamp;                                //ms from the beginning of the UTC day
+	long long received;                            //TimeBaseMonotonic() of the arrival of its first sentence with UTC
+	int hour,minute,milliSec;                      //UTC time
+	int day,month,year;                            //date
+	enum GPSmode fixMode;                          //MODE_UNKNOWN if no sentence told it
+	struct GeoPosition pos;                        //1e-7 degrees, North and East positive
+	long alt;                                      //thousandths of altUnit respect WGS84
+	char altUnit;                                  //'M' or 'F'
+	long groundSpeedKnots;                         //thousandths of knot
+	long trueTrack,magneticVariation;              //hundredths of degree
+	bool isMagVarToEast;                           //true if magnetic variation is to east
+	long pdop,hdop,vdop;                           //hundredths
+	int satsInUse,satsInView;
+	int satellites[MAX_NUM_SAT][3];                //matrix of the satellites in view
+	long latErr,lonErr,altErr;                     //standard deviations of position errors in mm
+};
+
 struct GPSdata {
 	float timestamp;                               //timestamp of the data in sec from the beginning of the day
+	long long utc;                                 //us from 1/1/1970 UTC of the data, it never wraps, 0 if unknown
 	double speedKmh,speedKnots;                    //ground speeds in Km/h and knots
 	double altMt,altFt;                            //altitudes in m and feet respect WGS84 as received by the GPS
 	double realAltMt,realAltFt;                    //altitudes in m and feet respect m.s.l.
@@ -66,24 +102,43 @@ struct GPSdata {
 	int day,month,year;                            //date
 	int hour,minute;                               //UTC time
 	float second;                                  //seconds of UTC time
-	int latDeg,lonDeg;                             //deg part of latitude and longitude
-	float latMinDecimal,lonMinDecimal;             //decimal minutes and seconds part of lat and lon
-	bool isLatN,isLonE;                            //true if latitude is to North, true if longitude is to East
-	double lat,lon;                                //latitude and longitude expressed in rad
+	struct GeoPosition pos;                        //1e-7 degrees, North and East positive, lat GEO_NO_POS if unknown
 	float pdop,hdop,vdop;                          //P,H,V dilutions in m
+	float latErrMt,lonErrMt,altErrMt;              //standard deviations of position errors in m (-1 if unknown)
 	char activeSats,satsInView;                    //used and visible sats
 	enum GPSmode fixMode;                          //type of fix
 	int signalStrength,SNR,beaconDataRate,channel; //data about GPS signal (not used)
 	int beaconFrequency;                           //beacon frequency of GPS signal (not used)
 	int satellites[MAX_NUM_SAT][3];                //matrix of detected satellites
-	pthread_mutex_t mutex;                         //mutex for reading and writing GPS data in this struct
+	int source;                                    //index of the GPS source of the data, -1 if none yet
+};
+
+struct GPSsourceStats { //state and counters of a GPS source
+	const char *devName;
+	bool selected;                                 //its solutions are the published ones
+	bool lost;                                     //its device is closed and it is being opened again
+	int score;                                     //quality of its last solution, 0 without fix
+	unsigned long solutions;                       //solutions parsed
+	unsigned long published;                       //solutions published because it was the selected source
+	unsigned long selections;                      //times it has been selected
+	unsigned long selectedMs;                      //total time it has been selected
 };
 
-struct GPSdata gps;
+struct GPSdata gps; //working copy owned by the parser thread, the other threads must use GPSgetData()
 
 char GPSreceiverStart(void);
 void GPSreceiverStop(void);
 void GPSreceiverClose(void);
+void GPSreceiverFeed(int index, const unsigned char *data, int length); //bytes of a replay for a source, see GPSreplay.c
+void GPSreceiverSync(void);                                            //waits for the parser to be done, with the virtual clock
+bool GPSisLost(void); //true while all the devices are closed because silent or gone and they are being opened again
+int GPSgetSourceStats(struct GPSsourceStats *stats); //one element for each source, at most GPS_MAX_SOURCES, returns their number
+
+//Published GPS data: the parser updates gps and then publishes it with GPSpublishData() once per solution,
+//the other threads take a consistent copy with GPSgetData() without ever blocking the parser.
+void GPSpublishData(void);
+unsigned int GPSgetData(struct GPSdata *data);
+void GPSpublishSolution(int source, const struct GPSsolution *solution); //only the ones of the best source are published
 
 char updateDate(int newDay, int newMonth, int newYear);
 void updateTime(float timestamp, int newHour, int newMin, float newSec, bool timeWithNoFix);
@@ -0,0 +1,140 @@
+//============================================================================
+// Name        : GPSreplay.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Replay of a GPS capture on the virtual clock, as fast as possible and always the same
+//============================================================================
+
+//The replay is the idle handler of the event loop: each time the loop has nothing to do it moves the virtual
+//clock to the next record of the capture, or to the next timer if it comes first, and gives the bytes of the
+//record to the first GPS source as if they had been read from its device at that time. Then it waits for the
+//parser to have processed them, with the outputs of the filter due by then, before to go on: so each run of
+//the same capture sees the same times and gives the same ETAs, track points and log of the navigation.
+//The clock moves at most GPS_REPLAY_MAX_STEP at a time, so the outputs of the filter between two solutions
+//are done at most that late. At the end of the capture the event loop is stopped, so AirNavigator exits.
+
+#include <stdio.h>
+#include <string.h>
+#include "GPSreplay.h"
+#include "GPScapture.h"
+#include "GPSreceiver.h"
+#include "EventLoop.h"
+#include "TimeBase.h"
+#include "Logger.h"
+
+#define GPS_REPLAY_MAX_CHUNK 65536 //as gpsReplay
+#define GPS_REPLAY_MAX_STEP  50000 //us the virtual clock moves at most at a time
+
+
+struct GPSreplayStruct {
+	FILE *file;
+	bool swapBytes;       //the capture has been made on a CPU of the other byte order
+	long long first;      //capture time of the first record in us
+	long long start;      //virtual time of the first record
+	long long next;       //virtual time of the record in chunk
+	unsigned int length;  //bytes in chunk, 0 at the end of the capture
+	unsigned char chunk[GPS_REPLAY_MAX_CHUNK];
+	unsigned long records;
+	unsigned long long bytes;
+};
+
+unsigned int replayGetU32(const unsigned char *p);
+bool replayReadRecord(void);
+void replayStep(long timeoutMs, void *arg);
+
+static struct GPSreplayStruct GPSreplay = {
+	.file=NULL,
+	.swapBytes=false,
+	.length=0,
+	.records=0,
+	.bytes=0
+};
+
+unsigned int replayGetU32(const unsigned char *p) {
+	unsigned int value;
+	memcpy(&value,p,4);
+	if(GPSreplay.swapBytes) value=(value>>24)|((value>>8)&0xFF00)|((value<<8)&0xFF0000)|(value<<24);
+	return value;
+}
+
+bool replayReadRecord(void) { //the next record in chunk with its virtual time, false at the end
+	unsigned char header[sizeof(struct GPScaptureRecord)];
+	GPSreplay.length=0;
+	if(fread(header,sizeof(header),1,GPSreplay.file)!=1) return false;
+	long long time=replayGetU32(header)*1000000LL+replayGetU32(header+4)/1000;
+	unsigned int length=replayGetU32(header+8);
+	if(length>GPS_REPLAY_MAX_CHUNK || fread(GPSreplay.chunk,1,length,GPSreplay.file)!=length) {
+		LogWrite(LOG_WARNING,LOG_GPS,"replay: the capture is truncated or corrupted after %lu records.\n",GPSreplay.records);
+		return false;
+	}
+	if(GPSreplay.records==0) GPSreplay.first=time;
+	GPSreplay.next=GPSreplay.start+time-GPSreplay.first;
+	GPSreplay.length=length;
+	return true;
+}
+
+bool GPSreplayOpen(const char *path) {
+	unsigned char header[12];
+	if(!TimeBaseIsVirtual()) return false;
+	GPSreplay.file=fopen(path,"rb");
+	if(GPSreplay.file==NULL) {
+		LogWrite(LOG_ERROR,LOG_GPS,"unable to open the capture %s to replay it.\n",path);
+		return false;
+	}
+	if(fread(header,sizeof(header),1,GPSreplay.file)!=1 || memcmp(header,GPS_CAPTURE_MAGIC,4)!=0) {
+		LogWrite(LOG_ERROR,LOG_GPS,"%s is not a GPS capture.\n",path);
+		GPSreplayClose();
+		return false;
+	}
+	GPSreplay.swapBytes=false;
+	if(replayGetU32(header+8)!=GPS_CAPTURE_ENDIAN_MARK) GPSreplay.swapBytes=true;
+	if(replayGetU32(header+4)!=GPS_CAPTURE_VERSION || replayGetU32(header+8)!=GPS_CAPTURE_ENDIAN_MARK) {
+		LogWrite(LOG_ERROR,LOG_GPS,"unsupported version of the GPS capture %s.\n",path);
+		GPSreplayClose();
+		return false;
+	}
+	GPSreplay.start=TimeBaseMonotonic();
+	GPSreplay.records=0;
+	GPSreplay.bytes=0;
+	if(!replayReadRecord()) {
+		LogWrite(LOG_ERROR,LOG_GPS,"the GPS capture %s is empty.\n",path);
+		GPSreplayClose();
+		return false;
+	}
+	EventLoopSetIdle(replayStep,NULL);
+	LogWrite(LOG_INFO,LOG_GPS,"replaying the GPS capture %s on the virtual clock.\n",path);
+	return true;
+}
+
+void replayStep(long timeoutMs, void *arg) { //idle handler of the event loop: timeoutMs to its next timer, -1 if none
+	long long now=TimeBaseMonotonic();
+	long long target=GPSreplay.next;
+	if(timeoutMs>=0 && now+timeoutMs*1000LL<target) target=now+timeoutMs*1000LL;
+	if(target>now+GPS_REPLAY_MAX_STEP) target=now+GPS_REPLAY_MAX_STEP;
+	TimeBaseAdvance(target-now);
+	if(GPSreplay.next<=target) {
+		GPSreceiverFeed(0,GPSreplay.chunk,GPSreplay.length);
+		GPSreplay.records++;
+		GPSreplay.bytes+=GPSreplay.length;
+		if(!replayReadRecord()) {
+			GPSreceiverSync();
+			LogWrite(LOG_INFO,LOG_GPS,"replay: end of the capture after %lu records, %llu bytes, %lld s.\n",GPSreplay.records,GPSreplay.bytes,(target-GPSreplay.start)/1000000);
+			EventLoopSetIdle(NULL,NULL);
+			EventLoopStop();
+			return;
+		}
+	}
+	GPSreceiverSync(); //the parser takes the bytes and the outputs of the filter due by now
+}
+
+void GPSreplayClose(void) {
+	if(GPSreplay.file==NULL) return;
+	EventLoopSetIdle(NULL,NULL);
+	fclose(GPSreplay.file);
+	GPSreplay.file=NULL;
+}
@@ -0,0 +1,21 @@
+//============================================================================
+// Name        : GPSreplay.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Header of GPSreplay.c replay of a GPS capture on the virtual clock
+//============================================================================
+
+#ifndef GPSREPLAY_H_
+#define GPSREPLAY_H_
+
+#include "Common.h"
+
+bool GPSreplayOpen(const char *path);
+void GPSreplayClose(void);
+
+#endif /* GPSREPLAY_H_ */
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 20/1/2014
+// Last change : 18/10/2026
 // Description : Draws and updates the Horizontal Situation Indicator
 //============================================================================
 
@@ -18,7 +18,9 @@
 #include "HSI.h"
 #include "FBrender.h"
 #include "AirCalc.h"
+#include "FastTrig.h"
 #include "Configuration.h"
+#include "Trace.h"
 
 
 struct HSIstruct {
@@ -67,11 +69,13 @@ struct HSIstruct {
 	int symTailU;
 	int symTailC;
 	int symTailD;
+	int tcX,tcY;                   //center of the wings of the turn coordinator
+	int tcTurn,tcBall,tcBank;      //last drawn: wings angle in deg, ball position in pixel and bank in deg, tcTurn -1000 to draw it again
 };
 
 void HSIinitialize(void);
 int HSIround(double d);
-void rotatePoint(int mx, int my, int *px, int *py, double angle);
+void rotatePoint(int mx, int my, int *px, int *py, unsigned int angle);
 void HSIdraw(double directionDeg, double courseDeg, double courseDeviationMt, bool force, bool onlyDirection, bool validCrossTrackError, double bearing);
 void drawCompass(int dir, bool drawPlaneSymbol);
 void drawLabels(int dir);
@@ -80,6 +84,7 @@ void drawAirplaneSymbol(void);
 void displayTRKvalue(double track);
 void displayDTKandBRGvalues(double desiredTrack, double bearing);
 void diplayCDIvalue(double cdiMt);
+void drawTurnCoordinator(int turn, int ball);
 
 static struct HSIstruct HSI = {
 	.cx=-1, //this means that it is still not initialized
@@ -137,10 +142,14 @@ void HSIinitialize() { //TODO: depending on the screen size calculate all dimens
 	HSI.symTailD=HSI.cy+12;
 	if(screen.height==240) HSI.HalfAltScale=438;
 	HSI.PxAltScale=screen.height-12;
+	HSI.tcX=screen.height+60; //in the text column beside the altitude scale, between the navigation data and the time
+	HSI.tcY=216;
+	HSI.tcTurn=-1000;
 }
 
 void HSIfirstTimeDraw(double direction, double course, double cdiMt, bool onlyDirection, bool validXTD, double bearing) {
 	if(HSI.cx==-1) HSIinitialize();
+	HSI.tcTurn=-1000; //the screen has been cleared
 	DrawTwoPointsLine(HSI.cx-1,0,HSI.cx-1,HSI.mark_start-4,config.colorSchema.dirMarker);
 	DrawTwoPointsLine(HSI.cx,0,HSI.cx,HSI.mark_start,config.colorSchema.dirMarker);
 	DrawTwoPointsLine(HSI.cx+1,0,HSI.cx+1,HSI.mark_start-4,config.colorSchema.dirMarker);
@@ -153,11 +162,11 @@ int HSIround(double d) {
 	return (d-(double)n)>0.5 ? (int)(n+1) : (int)n;
 }
 
-void rotatePoint(int mx, int my, int *px, int *py, double angle) {
-	double cos_theta = cos(angle); //convert the angle to a useful form
-	double sin_theta = sin(angle);
-	int x2 = round((*px-mx)*(cos_theta)-(*py-my)*(sin_theta)); // calc the transformation
-	int y2 = round((*px-mx)*(sin_theta)+(*py-my)*(cos_theta));
+void rotatePoint(int mx, int my, int *px, int *py, unsigned int angle) { //binary angle of FastTrig: no floating point
+	long long cosTheta=FastTrigCos(angle), sinTheta=FastTrigSin(angle); //Q30
+	long long dx=*px-mx, dy=*py-my;
+	int x2=(int)((dx*cosTheta-dy*sinTheta+(1<<29))>>30); //calc the transformation, rounded to the nearest pixel
+	int y2=(int)((dx*sinTheta+dy*cosTheta+(1<<29))>>30);
 	*px=x2+mx;
 	*py=y2+my;
 }
@@ -169,7 +178,7 @@ void drawCompass(int dir, bool drawPlaneSymbol) { //works with direction as inte
 	short i;
 	for(i=0,indexCompass=dir;i<12;indexCompass+=30,i++) {
 		if(indexCompass>359) indexCompass-=360;
-		double angle=Deg2Rad(indexCompass);
+		unsigned int angle=FastTrigDeg2Angle(indexCompass);
 		pex=HSI.cx;
 		pey=HSI.mark_start;
 		pix=HSI.cx;
@@ -184,7 +193,7 @@ void drawCompass(int dir, bool drawPlaneSymbol) { //works with direction as inte
 		int index2=indexCompass+5;
 		short minor=1,j;
 		for(j=0;j<5;index2+=5,j++,minor=!minor) {
-			angle=Deg2Rad(index2);
+			angle=FastTrigDeg2Angle(index2);
 			pex=HSI.cx;
 			pey=HSI.mark_start;
 			pix=HSI.cx;
@@ -201,7 +210,7 @@ void drawCompass(int dir, bool drawPlaneSymbol) { //works with direction as inte
 void drawLabels(int dir) { //also here direction as integer
 	for(int i=0,indexLabel=dir;i<12;indexLabel+=30,i++) {
 		if(indexLabel>359) indexLabel-=360;
-		double angle=Deg2Rad(indexLabel);
+		unsigned int angle=FastTrigDeg2Angle(indexLabel);
 		int pix=HSI.cx; //locate the label
 		int piy=HSI.label_pos;
 		rotatePoint(HSI.cx,HSI.cy,&pix,&piy,angle);
@@ -212,9 +221,7 @@ void drawLabels(int dir) { //also here direction as integer
 void drawCDI(double direction, double course, double cdi, double bearing) {
 	if(course<0||course>360) return;
 	HSI.actualCourse=course;
-	double angle=course-direction;
-	if(angle<0) angle+=360;
-	angle=Deg2Rad(angle);
+	unsigned int angle=FastTrigRad2Angle(Deg2Rad(course-direction)); //wraps by itself
 	int pex=HSI.cx-1; //course indicator left
 	int pey=HSI.major_mark+2;
 	int pix=HSI.cx-1;
@@ -283,22 +290,22 @@ void drawCDI(double direction, double course, double cdi, double bearing) {
 	pey=HSI.major_mark;
 	pix=HSI.cx-1;
 	piy=HSI.cdi_border;
-	rotatePoint(HSI.cx,HSI.cy,&pex,&pey,angle+M_PI);
-	rotatePoint(HSI.cx,HSI.cy,&pix,&piy,angle+M_PI);
+	rotatePoint(HSI.cx,HSI.cy,&pex,&pey,angle+TRIG_HALF_TURN);
+	rotatePoint(HSI.cx,HSI.cy,&pix,&piy,angle+TRIG_HALF_TURN);
 	DrawTwoPointsLine(pex,pey,pix,piy,config.colorSchema.routeIndicator);
 	pex=HSI.cx; //other side of the course central
 	pey=HSI.major_mark;
 	pix=HSI.cx;
 	piy=HSI.cdi_border-1;
-	rotatePoint(HSI.cx,HSI.cy,&pex,&pey,angle+M_PI);
-	rotatePoint(HSI.cx,HSI.cy,&pix,&piy,angle+M_PI);
+	rotatePoint(HSI.cx,HSI.cy,&pex,&pey,angle+TRIG_HALF_TURN);
+	rotatePoint(HSI.cx,HSI.cy,&pix,&piy,angle+TRIG_HALF_TURN);
 	DrawTwoPointsLine(pex,pey,pix,piy,config.colorSchema.routeIndicator);
 	pex=HSI.cx+1; //other side of the course indicator right
 	pey=HSI.major_mark;
 	pix=HSI.cx+1;
 	piy=HSI.cdi_border;
-	rotatePoint(HSI.cx,HSI.cy,&pex,&pey,angle+M_PI);
-	rotatePoint(HSI.cx,HSI.cy,&pix,&piy,angle+M_PI);
+	rotatePoint(HSI.cx,HSI.cy,&pex,&pey,angle+TRIG_HALF_TURN);
+	rotatePoint(HSI.cx,HSI.cy,&pix,&piy,angle+TRIG_HALF_TURN);
 	DrawTwoPointsLine(pex,pey,pix,piy,config.colorSchema.routeIndicator);
 	int dev=0; //deviation in pixel
 	unsigned short cdiColor=config.colorSchema.routeIndicator; //same color of course direction arrow in case we don have to draw the CDI
@@ -333,9 +340,7 @@ void drawCDI(double direction, double course, double cdi, double bearing) {
 				cdiColor=config.colorSchema.caution;
 			} else dev=-(int)(round((HSI.cdi_pixel_scale*cdi)/HSI.bigCDIscale));
 		}
-		double alpha=bearing-direction; //calculate angle for bearing indicator
-		if(alpha<0) alpha+=360;
-		alpha=Deg2Rad(alpha);
+		unsigned int alpha=FastTrigRad2Angle(Deg2Rad(bearing-direction)); //calculate angle for bearing indicator
 		pex=HSI.cx; //first side of the arrow (bearing indicator)
 		pey=HSI.bea_arrow_top;
 		pix=HSI.cx-HSI.bea_arrow_side;
@@ -443,6 +448,7 @@ void HSIdraw(double direction, double course, double cdiMt, bool force, bool onl
 
 void HSIupdateDir(double direction) {
 	if(direction<0||direction>360) return;
+	TRACE_BEGIN(TRACE_HSI_DRAW);
 	int dir=360-(int)round(direction);
 	if(dir!=HSI.previousDir) { //need to update all the compass
 		drawCompass(dir,false);
@@ -452,10 +458,12 @@ void HSIupdateDir(double direction) {
 	displayTRKvalue(direction);
 	displayDTKandBRGvalues(HSI.actualCourse,HSI.actualBearing);
 	diplayCDIvalue(HSI.actualCDI);
+	TRACE_END(TRACE_HSI_DRAW);
 }
 
 void HSIupdateCDI(double course, double courseDeviation, bool validXTD, double bearing) {
 	if(course!=HSI.actualCourse||courseDeviation!=HSI.actualCDI) {
+		TRACE_BEGIN(TRACE_HSI_DRAW);
 		FillCircle(HSI.cx,HSI.cy,HSI.cir,config.colorSchema.background); //clear the internal part of the compass
 		drawLabels(HSI.previousDir);
 		HSI.drawCDI=validXTD;
@@ -463,6 +471,7 @@ void HSIupdateCDI(double course, double courseDeviation, bool validXTD, double b
 		displayTRKvalue(HSI.actualDir);
 		displayDTKandBRGvalues(course,bearing);
 		diplayCDIvalue(courseDeviation);
+		TRACE_END(TRACE_HSI_DRAW);
 	} //else no need to repaint the HSI
 }
 
@@ -470,6 +479,7 @@ void HSIdrawVSIscale(double altFt) {
 	long maxScaleFt=(long)altFt;
 	if(maxScaleFt==HSI.currentAltFt) return; //no need to update
 	HSI.currentAltFt=maxScaleFt;
+	TRACE_BEGIN(TRACE_HSI_DRAW);
 	FillRect(screen.height+1,1,screen.height+25,screen.height,config.colorSchema.background); //clean all
 	maxScaleFt+=HSI.HalfAltScale; //add 500 ft for the top of the scale
 	int markerFt=(maxScaleFt/50)*50; //assign the first line altitude
@@ -490,12 +500,14 @@ void HSIdrawVSIscale(double altFt) {
 		HSI.expectedAltFt=-4000; //to force it to be updated
 		HSIupdateVSI(newExpectedAltFt);
 	}
+	TRACE_END(TRACE_HSI_DRAW);
 }
 
 void HSIupdateVSI(double newExpectedAltFt) {
 	long expAlt=(long)newExpectedAltFt;
 	if(expAlt==HSI.expectedAltFt) return; //no need to update
 	HSI.expectedAltFt=expAlt;
+	TRACE_BEGIN(TRACE_HSI_DRAW);
 	FillRect(screen.height-7,1,screen.height,screen.height,config.colorSchema.background); //clean all
 	if(expAlt>HSI.currentAltFt+HSI.HalfAltScale) { //we're too low
 		FBrenderPutPixel(screen.height-7,2,config.colorSchema.caution);
@@ -523,4 +535,44 @@ void HSIupdateVSI(double newExpectedAltFt) {
 		DrawHorizontalLine(screen.height-7,ypos+2,3,config.colorSchema.vsi);
 		FBrenderPutPixel(screen.height-7,ypos+3,config.colorSchema.vsi);
 	}
+	TRACE_END(TRACE_HSI_DRAW);
+}
+
+void drawTurnCoordinator(int turn, int ball) {
+	int x=30,y=0;
+	FillRect(HSI.tcX-34,HSI.tcY-14,HSI.tcX+34,HSI.tcY+22,config.colorSchema.background); //clean all
+	rotatePoint(0,0,&x,&y,FastTrigDeg2Angle(20));
+	for(int side=-1;side<=1;side+=2) { //level marks and under them the ones of the standard rate turn (3 deg/s)
+		DrawTwoPointsLine(HSI.tcX+side*29,HSI.tcY,HSI.tcX+side*34,HSI.tcY,config.colorSchema.text);
+		DrawTwoPointsLine(HSI.tcX+side*x,HSI.tcY+y,HSI.tcX+side*(x+4),HSI.tcY+y+2,config.colorSchema.text);
+	}
+	x=27;
+	y=0;
+	rotatePoint(0,0,&x,&y,FastTrigDeg2Angle(turn)); //the wings, the right one down when turning right
+	DrawTwoPointsLine(HSI.tcX-x,HSI.tcY-y,HSI.tcX+x,HSI.tcY+y,config.colorSchema.airplaneSymbol);
+	FillCircle(HSI.tcX,HSI.tcY,2,config.colorSchema.airplaneSymbol);
+	DrawHorizontalLine(HSI.tcX-26,HSI.tcY+14,53,config.colorSchema.text); //the tube of the ball
+	DrawHorizontalLine(HSI.tcX-26,HSI.tcY+22,53,config.colorSchema.text);
+	DrawTwoPointsLine(HSI.tcX-4,HSI.tcY+14,HSI.tcX-4,HSI.tcY+22,config.colorSchema.text);
+	DrawTwoPointsLine(HSI.tcX+4,HSI.tcY+14,HSI.tcX+4,HSI.tcY+22,config.colorSchema.text);
+	FillCircle(HSI.tcX+ball,HSI.tcY+18,3,abs(ball)>4?config.colorSchema.warning:config.colorSchema.ok);
+}
+
+void HSIupdateTurnCoordinator(double turnRateDegSec, double bankDeg, double slipG) {
+	if(HSI.cx==-1) return;
+	int turn=(int)round(turnRateDegSec*20/3); //a standard rate turn is on the 20 deg marks
+	if(turn>30) turn=30; //one and a half the standard rate
+	else if(turn<-30) turn=-30;
+	int ball=(int)round(slipG*100); //1 pixel each 0.01 g
+	if(ball>22) ball=22;
+	else if(ball<-22) ball=-22;
+	int bank=(int)round(bankDeg);
+	if(turn==HSI.tcTurn && ball==HSI.tcBall && bank==HSI.tcBank) return; //no need to repaint it
+	TRACE_BEGIN(TRACE_HSI_DRAW);
+	if(turn!=HSI.tcTurn || ball!=HSI.tcBall) drawTurnCoordinator(turn,ball);
+	FBrenderBlitText(HSI.tcX+42,HSI.tcY-4,config.colorSchema.text,config.colorSchema.background,false,"BANK %2d%c",abs(bank),bank>0?'R':bank<0?'L':' ');
+	HSI.tcTurn=turn;
+	HSI.tcBall=ball;
+	HSI.tcBank=bank;
+	TRACE_END(TRACE_HSI_DRAW);
 }
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 20/1/2014
+// Last change : 18/10/2026
 // Description : Header of HSI.c to manage the Horizontal Situation Indicator
 //============================================================================
 
@@ -20,5 +20,6 @@ void HSIupdateDir(double trueDirectionDeg);
 void HSIupdateCDI(double courseDeg, double courseDeviationMt, bool validCrossTrackError, double bearing);
 void HSIdrawVSIscale(double altFt);
 void HSIupdateVSI(double expectedAltFt);
+void HSIupdateTurnCoordinator(double turnRateDegSec, double bankDeg, double slipG);
 
 #endif /* HSI_H_ */
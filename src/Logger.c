@@ -0,0 +1,402 @@
+//============================================================================
+// Name        : Logger.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Asynchronous binary logger
+//============================================================================
+
+//Each thread logs in its own lock-free ring only the address of the format string and the raw arguments,
+//a low priority writer thread drains the rings into a binary file on the SD card, the format strings are
+//written only once per file. The files can be read with utility/logDecoder.
+//The format strings must be literals because they are read later by the writer, in the file they are
+//identified by their index in the table of the formats of that file.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "Logger.h"
+#include "RingBuffer.h"
+#include "Configuration.h"
+
+#define LOG_MAX_THREADS   16
+#define LOG_MAX_RECORD    512    //max size of a message record including its header
+#define LOG_MAX_STRING    255    //max length of a string argument
+#define LOG_MAX_FORMATS   256    //size of the table of the formats already in the current file, power of 2
+#define LOG_WRITER_PERIOD 100000 //us between two drains of the rings
+#define LOG_WRITER_NICE   10     //priority of the writer thread, lower than the others
+
+
+struct LogRing {
+	struct RingBuffer ring;         //records of one thread
+	unsigned char id;               //ID of the ring written in the records
+	volatile bool closed;           //the thread is dead: the ring can be released once empty
+	volatile unsigned long dropped; //messages lost because the ring was full (written by the producer)
+	unsigned long reportedDropped;  //lost messages already reported in the file (used by the writer)
+};
+
+struct LoggerStruct {
+	FILE *file;                           //current binary log file
+	char *path;                           //path of the current log file
+	volatile bool running;                //true while the writer thread is running
+	pthread_t writer;                     //the thread writing the rings to the file
+	pthread_key_t key;                    //to get the ring of each thread
+	pthread_mutex_t ringsMutex;           //protects the list of rings, it is not taken to log
+	struct LogRing *rings[LOG_MAX_THREADS];
+	int numOfRings;
+	unsigned char nextId;
+	unsigned long fileSize;               //bytes written in the current file
+	const char *formats[LOG_MAX_FORMATS]; //format IDs already written in the current file
+};
+
+struct LogRing* logGetRing(void);
+void logReleaseRing(void *ptr);
+int logWriteArgs(enum logLevel level, enum logSubsystem subsystem, const char *format, va_list args);
+int logPutArg(unsigned char *buf, int len, char tag, const void *value, int size);
+int logEncodeArgs(const char *format, va_list args, unsigned char *buf, int size);
+bool logOpenFile(void);
+void logRotateFiles(void);
+unsigned int logWriteFormat(const char *format);
+void logWriteDropped(struct LogRing *logRing);
+void logDrainRings(void);
+void* logRunWriter(void *ptr);
+
+static struct LoggerStruct Logger = {
+	.file=NULL,
+	.path=NULL,
+	.running=false,
+	.numOfRings=0,
+	.nextId=0,
+	.fileSize=0
+};
+
+static struct LogRing noRing; //marks the threads that could not get a ring
+
+static const char *levelNames[LOG_NUM_LEVELS]={"error","warning","info","debug"};
+
+static char *subsystemNames[LOG_NUM_SUBSYSTEMS]={"main","GPS","NMEA","nav","display","touch","blackBox","config","accel"};
+
+bool LogOpen(void) {
+	asprintf(&Logger.path,"%slog.bin",BASE_PATH);
+	logRotateFiles(); //keep the log of the previous run
+	if(!logOpenFile()) {
+		free(Logger.path);
+		Logger.path=NULL;
+		return false;
+	}
+	pthread_key_create(&Logger.key,logReleaseRing);
+	pthread_mutex_init(&Logger.ringsMutex,NULL);
+	Logger.running=true;
+	if(pthread_create(&Logger.writer,NULL,logRunWriter,NULL)) {
+		Logger.running=false;
+		LogClose();
+		return false;
+	}
+	return true;
+}
+
+bool logOpenFile(void) {
+	Logger.file=fopen(Logger.path,"wb");
+	if(Logger.file==NULL) return false;
+	unsigned int header[2]={LOG_FILE_VERSION,LOG_ENDIAN_MARK};
+	double doubleMark=LOG_DOUBLE_MARK;
+	fwrite(LOG_FILE_MAGIC,1,4,Logger.file);
+	fwrite(header,sizeof(header),1,Logger.file);
+	fwrite(&doubleMark,sizeof(doubleMark),1,Logger.file);
+	Logger.fileSize=4+sizeof(header)+sizeof(doubleMark);
+	memset(Logger.formats,0,sizeof(Logger.formats)); //the new file has no format strings yet
+	return true;
+}
+
+void logRotateFiles(void) { //log.bin becomes log.1.bin, log.1.bin becomes log.2.bin ... the last one is lost
+	char *from, *to;
+	for(int i=config.logMaxFiles-1;i>0;i--) {
+		asprintf(&to,"%slog.%d.bin",BASE_PATH,i);
+		if(i>1) asprintf(&from,"%slog.%d.bin",BASE_PATH,i-1);
+		else from=strdup(Logger.path);
+		rename(from,to);
+		free(from);
+		free(to);
+	}
+}
+
+struct LogRing* logGetRing(void) {
+	struct LogRing *logRing=(struct LogRing*)pthread_getspecific(Logger.key);
+	if(logRing!=NULL) return logRing;
+	logRing=(struct LogRing*)malloc(sizeof(struct LogRing)); //first message of this thread
+	if(logRing!=NULL) {
+		if(RingBufferInit(&logRing->ring,config.logRingSize)) {
+			logRing->closed=false;
+			logRing->dropped=0;
+			logRing->reportedDropped=0;
+			pthread_mutex_lock(&Logger.ringsMutex);
+			if(Logger.numOfRings<LOG_MAX_THREADS) {
+				logRing->id=Logger.nextId++;
+				Logger.rings[Logger.numOfRings++]=logRing;
+			} else {
+				RingBufferRelease(&logRing->ring);
+				free(logRing);
+				logRing=NULL;
+			}
+			pthread_mutex_unlock(&Logger.ringsMutex);
+		} else {
+			free(logRing);
+			logRing=NULL;
+		}
+	}
+	if(logRing==NULL) logRing=&noRing; //do not try again at each message
+	pthread_setspecific(Logger.key,logRing);
+	return logRing;
+}
+
+void logReleaseRing(void *ptr) { //called at the death of a thread
+	struct LogRing *logRing=(struct LogRing*)ptr;
+	if(logRing!=&noRing) logRing->closed=true; //the writer will release it
+}
+
+bool LogIsEnabled(enum logLevel level, enum logSubsystem subsystem) {
+	return Logger.running && level<=config.logLevels[subsystem];
+}
+
+int LogWrite(enum logLevel level, enum logSubsystem subsystem, const char *format, ...) {
+	va_list args;
+	va_start(args,format);
+	int done=logWriteArgs(level,subsystem,format,args);
+	va_end(args);
+	return done;
+}
+
+int printLog(const char *texts, ...) { //old interface: the level is taken from the beginning of the message
+	enum logLevel level=LOG_INFO;
+	if(strncmp(texts,"ERROR",5)==0) level=LOG_ERROR;
+	else if(strncmp(texts,"WARNING",7)==0) level=LOG_WARNING;
+	va_list args;
+	va_start(args,texts);
+	int done=logWriteArgs(level,LOG_MAIN,texts,args);
+	va_end(args);
+	return done;
+}
+
+int logWriteArgs(enum logLevel level, enum logSubsystem subsystem, const char *format, va_list args) {
+	if(!LogIsEnabled(level,subsystem)) return -1;
+	struct LogRing *logRing=logGetRing();
+	if(logRing==&noRing) return -1;
+	unsigned char record[LOG_MAX_RECORD]; //header, address of the format and arguments
+	struct logRecordHeader header;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	int len=logEncodeArgs(format,args,record+sizeof(header)+sizeof(format),LOG_MAX_RECORD-sizeof(header)-sizeof(format));
+	header.kind=LOG_RECORD_MESSAGE;
+	header.level=level;
+	header.subsystem=subsystem;
+	header.thread=logRing->id;
+	header.length=len;
+	header.reserved=0;
+	header.formatId=0; //assigned by the writer
+	header.sec=now.tv_sec;
+	header.usec=now.tv_usec;
+	memcpy(record,&header,sizeof(header));
+	memcpy(record+sizeof(header),&format,sizeof(format));
+	if(!RingBufferWrite(&logRing->ring,record,sizeof(header)+sizeof(format)+len)) { //never wait for the writer
+		logRing->dropped++;
+		return -1;
+	}
+	return len;
+}
+
+int logPutArg(unsigned char *buf, int len, char tag, const void *value, int size) {
+	buf[len++]=tag;
+	memcpy(buf+len,value,size); //native byte order, the decoder fixes it
+	return len+size;
+}
+
+int logEncodeArgs(const char *format, va_list args, unsigned char *buf, int size) { //returns the number of bytes used
+	int len=0;
+	for(const char *c=format;*c!='\0';c++) {
+		if(*c!='%') continue;
+		if(*++c=='%') continue;
+		if(len+1+8>size) break; //no room for one more number: the remaining arguments are lost
+		while(*c=='-' || *c=='+' || *c==' ' || *c=='#' || *c=='0') c++; //flags
+		if(*c=='*') { //width as argument
+			int width=va_arg(args,int);
+			len=logPutArg(buf,len,LOG_ARG_INT32,&width,4);
+			c++;
+		} else while(*c>='0' && *c<='9') c++;
+		if(*c=='.') { //precision
+			if(*++c=='*') {
+				int precision=va_arg(args,int);
+				len=logPutArg(buf,len,LOG_ARG_INT32,&precision,4);
+				c++;
+			} else while(*c>='0' && *c<='9') c++;
+		}
+		int longs=0; //0 int, 1 long, 2 long long
+		for(;;c++) { //length modifiers
+			if(*c=='l') longs++;
+			else if(*c=='L' || *c=='q' || *c=='j') longs=2;
+			else if(*c=='z' || *c=='t') longs=sizeof(size_t)==sizeof(long)?1:0;
+			else if(*c!='h') break;
+		}
+		switch(*c) {
+			case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+				if(longs>=2 || (longs==1 && sizeof(long)==8)) {
+					long long value=longs>=2?va_arg(args,long long):va_arg(args,long);
+					len=logPutArg(buf,len,LOG_ARG_INT64,&value,8);
+				} else {
+					int value=longs==1?(int)va_arg(args,long):va_arg(args,int);
+					len=logPutArg(buf,len,LOG_ARG_INT32,&value,4);
+				}
+				break;
+			case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+				double value=longs==2?(double)va_arg(args,long double):va_arg(args,double);
+				len=logPutArg(buf,len,LOG_ARG_DOUBLE,&value,8);
+			}	break;
+			case 's': {
+				const char *text=va_arg(args,const char*);
+				if(text==NULL) text="(null)";
+				int textLen=strlen(text);
+				if(textLen>LOG_MAX_STRING) textLen=LOG_MAX_STRING;
+				if(textLen>size-len-3) textLen=size-len-3; //truncate it to fit the record
+				unsigned short shortLen=textLen;
+				len=logPutArg(buf,len,LOG_ARG_STRING,&shortLen,2);
+				memcpy(buf+len,text,textLen);
+				len+=textLen;
+			}	break;
+			case 'p': {
+				void *value=va_arg(args,void*);
+				len=logPutArg(buf,len,sizeof(value)==8?LOG_ARG_INT64:LOG_ARG_INT32,&value,sizeof(value));
+			}	break;
+			default: //end of the format or unsupported conversion (%n, %m ...): stop here
+				return len;
+		}
+	}
+	return len;
+}
+
+unsigned int logWriteFormat(const char *format) { //returns the ID of the format, writing it if it is not yet in the current file
+	unsigned int i=((unsigned long)format>>2)&(LOG_MAX_FORMATS-1);
+	int n;
+	for(n=0;n<LOG_MAX_FORMATS;n++,i=(i+1)&(LOG_MAX_FORMATS-1)) {
+		if(Logger.formats[i]==format) return i; //already there
+		if(Logger.formats[i]==NULL) {
+			Logger.formats[i]=format;
+			break;
+		}
+	}
+	if(n==LOG_MAX_FORMATS) i=LOG_MAX_FORMATS; //the table is full: this ID is redefined before each use
+	struct logRecordHeader header;
+	memset(&header,0,sizeof(header));
+	header.kind=LOG_RECORD_FORMAT;
+	header.length=strlen(format);
+	header.formatId=i;
+	fwrite(&header,sizeof(header),1,Logger.file);
+	fwrite(format,1,header.length,Logger.file);
+	Logger.fileSize+=sizeof(header)+header.length;
+	return i;
+}
+
+void logWriteDropped(struct LogRing *logRing) {
+	unsigned long dropped=logRing->dropped;
+	if(dropped==logRing->reportedDropped) return;
+	struct logRecordHeader header;
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	unsigned int count=dropped-logRing->reportedDropped;
+	memset(&header,0,sizeof(header));
+	header.kind=LOG_RECORD_DROPPED;
+	header.thread=logRing->id;
+	header.length=sizeof(count);
+	header.sec=now.tv_sec;
+	header.usec=now.tv_usec;
+	fwrite(&header,sizeof(header),1,Logger.file);
+	fwrite(&count,sizeof(count),1,Logger.file);
+	Logger.fileSize+=sizeof(header)+sizeof(count);
+	logRing->reportedDropped=dropped;
+}
+
+void logDrainRings(void) {
+	unsigned char record[LOG_MAX_RECORD];
+	struct logRecordHeader *header=(struct logRecordHeader*)record;
+	pthread_mutex_lock(&Logger.ringsMutex);
+	for(int i=0;i<Logger.numOfRings;i++) {
+		struct LogRing *logRing=Logger.rings[i];
+		bool closed=logRing->closed; //read it before draining: after that no more records can arrive
+		logWriteDropped(logRing);
+		while(RingBufferRead(&logRing->ring,record,sizeof(struct logRecordHeader))) {
+			const char *format;
+			RingBufferRead(&logRing->ring,&format,sizeof(format)); //the producer commits whole records
+			RingBufferRead(&logRing->ring,record+sizeof(struct logRecordHeader),header->length);
+			header->formatId=logWriteFormat(format);
+			fwrite(record,sizeof(struct logRecordHeader)+header->length,1,Logger.file);
+			Logger.fileSize+=sizeof(struct logRecordHeader)+header->length;
+		}
+		if(closed) { //the thread is dead and its ring is empty
+			RingBufferRelease(&logRing->ring);
+			free(logRing);
+			Logger.rings[i--]=Logger.rings[--Logger.numOfRings];
+		}
+	}
+	pthread_mutex_unlock(&Logger.ringsMutex);
+	fflush(Logger.file);
+	if(Logger.fileSize>config.logMaxFileSize) { //start a new file
+		fclose(Logger.file);
+		logRotateFiles();
+		if(!logOpenFile()) Logger.running=false; //nothing else can be done: stop logging
+	}
+}
+
+void* logRunWriter(void *ptr) {
+	setpriority(PRIO_PROCESS,0,LOG_WRITER_NICE); //on Linux it works on the calling thread
+	while(Logger.running) {
+		usleep(LOG_WRITER_PERIOD);
+		logDrainRings();
+	}
+	if(Logger.file!=NULL) logDrainRings(); //the last messages
+	return NULL;
+}
+
+enum logLevel LogParseLevel(const char *name, enum logLevel defaultLevel) {
+	for(int i=0;i<LOG_NUM_LEVELS;i++) if(strcmp(name,levelNames[i])==0) return i;
+	return defaultLevel;
+}
+
+char* LogSubsystemName(enum logSubsystem subsystem) {
+	return subsystemNames[subsystem];
+}
+
+void LogClose(void) {
+	if(Logger.path==NULL) return;
+	if(Logger.running) {
+		Logger.running=false;
+		pthread_join(Logger.writer,NULL);
+	}
+	pthread_key_delete(Logger.key); //no more destructors for the rings
+	for(int i=0;i<Logger.numOfRings;i++) {
+		RingBufferRelease(&Logger.rings[i]->ring);
+		free(Logger.rings[i]);
+	}
+	Logger.numOfRings=0;
+	pthread_mutex_destroy(&Logger.ringsMutex);
+	if(Logger.file!=NULL) fclose(Logger.file);
+	Logger.file=NULL;
+	free(Logger.path);
+	Logger.path=NULL;
+}
+
+bool openLog(void) {
+	return LogOpen();
+}
+
+void closeLog(void) {
+	LogClose();
+}
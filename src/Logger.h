@@ -0,0 +1,75 @@
+//============================================================================
+// Name        : Logger.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Header of Logger.c asynchronous binary logger
+//============================================================================
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include "Common.h"
+
+#define LOG_FILE_MAGIC   "ANLG"     //first 4 bytes of each binary log file
+#define LOG_FILE_VERSION 1
+#define LOG_ENDIAN_MARK  0x01020304 //to find out the byte order of integers
+#define LOG_DOUBLE_MARK  1.5        //to find out the words order of doubles (FPA on ARM has them swapped)
+
+enum logLevel {
+	LOG_ERROR,
+	LOG_WARNING,
+	LOG_INFO,
+	LOG_DEBUG,
+	LOG_NUM_LEVELS
+};
+
+enum logSubsystem {
+	LOG_MAIN,
+	LOG_GPS,
+	LOG_NMEA,
+	LOG_NAV,
+	LOG_DISPLAY,
+	LOG_TOUCH,
+	LOG_BLACKBOX,
+	LOG_CONFIG,
+	LOG_ACCEL,
+	LOG_NUM_SUBSYSTEMS
+};
+
+enum logRecordKind { //first byte of each record of the binary log file
+	LOG_RECORD_MESSAGE, //a message: header followed by the encoded arguments
+	LOG_RECORD_FORMAT,  //the format string of a format ID, written before its first use in each file
+	LOG_RECORD_DROPPED  //number of messages a thread lost because its ring was full
+};
+
+enum logArgType { //tag preceding each argument in a message record
+	LOG_ARG_INT32='i',  //4 bytes integer
+	LOG_ARG_INT64='q',  //8 bytes integer
+	LOG_ARG_DOUBLE='d', //8 bytes double as it is in memory
+	LOG_ARG_STRING='s'  //2 bytes length followed by the chars without terminator
+};
+
+struct logRecordHeader { //20 bytes, all the fields are naturally aligned
+	unsigned char kind;      //enum logRecordKind
+	unsigned char level;     //enum logLevel
+	unsigned char subsystem; //enum logSubsystem
+	unsigned char thread;    //ID of the ring of the thread that logged
+	unsigned short length;   //bytes following the header
+	unsigned short reserved;
+	unsigned int formatId;   //ID of the format string in the current file
+	unsigned int sec, usec;  //time of the message
+};
+
+bool LogOpen(void);
+int LogWrite(enum logLevel level, enum logSubsystem subsystem, const char *format, ...);
+bool LogIsEnabled(enum logLevel level, enum logSubsystem subsystem);
+enum logLevel LogParseLevel(const char *name, enum logLevel defaultLevel);
+char* LogSubsystemName(enum logSubsystem subsystem);
+void LogClose(void);
+
+#endif /* LOGGER_H_ */
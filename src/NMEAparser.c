@@ -6,349 +6,367 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 21/3/2016
+// Last change : 18/10/2026
 // Description : Parses NMEA sentences from a GPS device
 //============================================================================
 
-#define PRINT_SENTENCES
-
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "NMEAparser.h"
 #include "Common.h"
 #include "GPSreceiver.h"
-#include "Navigator.h"
-#include "AirCalc.h"
-#include "BlackBox.h"
-#include "FBrender.h"
-#include "HSI.h"
-#include "Geoidal.h"
+#include "Logger.h"
+#include "Configuration.h"
+#include "Trace.h"
+#include "TimeBase.h"
 
 
 #define MAX_FIELDS 30
-#define MAX_FIELD_LENGTH 25
+#define MAX_FIELD_LENGTH 25 //max length of a field including its terminator
+#define MAX_FIXED_DIGITS 9 //max number of significant digits of a fixed point value to stay in a 32 bit long
+#define NUM_OF_SENTENCE_TYPES 8 //number of entries of the dispatch table
+#define MAX_STALE_MS 2000  //sentences older than the current epoch up to this are stale, more means the time jumped back
+#define MAX_MISSED_END_OF_BURST 3 //epochs closed by a time change after which the learned end of burst is learned again
+
+#define NMEA_TYPE(a,b,c) (((a)<<16)|((b)<<8)|(c)) //the three letters of a sentence type packed in an int
 
 
 struct NMEAparserStruct {
-	float altTimestamp, dirTimestamp, newerTimestamp, rcvdTimestamp;
-	bool GGAfound, RMCfound, GSAfound;
+	int source;              //index of the GPS source parsed with this context
 	int numOfGSVmsg, GSVmsgSeqNo, GSVtotalSatInView;
-	int rcvdBytesOfSentence, rcvdBytesOfField, rcvdBytesOfCheksum;
-	char sentence[MAX_SENTENCE_LENGTH];
-	char fields[MAX_FIELDS][MAX_FIELD_LENGTH];
+	bool GSVseriesEnd;       //true if the last GSV sentence completed a series of the GPS satellites
+	int GSAofEpoch;          //GSA sentences in the current epoch, receivers of more constellations send one for each
+	int GSAsatsInUse;        //satellites in use summed over the GSA sentences of the current epoch
+	int satellites[MAX_NUM_SAT][3]; //matrix filled by the current series of GSV
+	int rcvdBytesOfSentence, rcvdBytesOfCheksum;
+	char sentence[MAX_SENTENCE_LENGTH];  //the only copy of the sentence, fields are slices of it
+	unsigned char fieldStart[MAX_FIELDS]; //offset of each field in the sentence
+	unsigned char fieldLength[MAX_FIELDS];
 	int fieldId;
-	float alt, latMin, lonMin, timeSec, groundSpeedKnots, trueTrack, magneticVariation, pdop, hdop, vdop;
-	char altUnit;
-	int latGra, lonGra, timeHour, timeMin, SatsInView, SatsInUse, timeDay, timeMonth, timeYear;
-	bool latNorth, lonEast, magneticVariationToEast;
+	unsigned char checksum; //XOR of the bytes between '$' and '*' updated as they arrive
+	unsigned int streamOffset;   //offset in the GPS stream of the first byte of the buffer being processed
+	unsigned int sentenceOffset; //offset in the GPS stream of the '$' of the current sentence
+	unsigned int epochOffset;    //offset in the GPS stream of the first sentence with UTC of the current epoch, or of its first one without UTC
+	bool epochStarted;           //true if epochOffset has been taken for the current epoch
+	struct GPSsolution epoch; //solution being assembled from the sentences with the same UTC tag
+	long publishedTimestamp;  //UTC tag of the last published epoch, -1 if none
+	int lastType;             //type of the last handled sentence
+	int endOfBurstType;       //type of the last sentence of each receiver cycle, 0 if unknown
+	bool learnEndOfBurst;     //true if endOfBurstType is learned from the received sentences
+	int missedEndOfBurst;     //consecutive epochs closed by a time change
+	unsigned long handledSentences[NUM_OF_SENTENCE_TYPES]; //counters of the sentences of each type in the dispatch table
+	unsigned long unsupportedSentences, failedSentences, staleSentences, publishedEpochs;
+};
+
+struct NMEAsentenceType {
+	int type;           //three letters of the sentence type packed with NMEA_TYPE, the talker is not considered
+	int (*parse)(void); //returns 1 if the sentence brings new data, 0 if not and negative values on errors
 };
 
+bool closeField(void);
+void terminateFields(void);
+long timeDifference(long timestamp, long reference);
+bool epochTime(long timestamp, int timeHour, int timeMin, int timeMilliSec);
+void closeEpoch(void);
 int parseNMEAsentence(void);
 int parseGGA(void);
 int parseRMC(void);
 int parseGSA(void);
 int parseGSV(void);
+int parseVTG(void);
+int parseGLL(void);
+int parseZDA(void);
+int parseGST(void);
+
+int hexDigitValue(char digit);
+bool parseDigits(const char* field, int numOfDigits, int* value);
+bool parseTime(const char* field, int* timeHour, int* timeMin, int* timeMilliSec);
+bool parseDate(const char* field, int* dd, int* mm, int* yy);
+bool parseDegMin(const char* firstField, int degDigits, int* coord);
+bool parseLatitude(const char* firstField, const char* secondField, int* latitude);
+bool parseLongitude(const char* firstField, const char* secondField, int* longitude);
+bool parseValid(const char* field, bool* isValid);
+bool parseEastWest(const char* field, bool* isEast);
+bool parseInteger(const char* field, int* value);
+bool parseFixed(const char* field, int decimals, long* value);
+
+static struct NMEAparserStruct NMEAparsers[GPS_MAX_SOURCES]; //one context for each GPS source
+static struct NMEAparserStruct *NMEAparser=NMEAparsers; //context of the source being parsed, there is only the parser thread
 
-unsigned int getCRCintValue(void);
-bool updateAltitude(float newAltitude, char altUnit, float timestamp);
-void updateDirection(float newTrueTrack, float magneticVar, bool isVarToEast, float timestamp);
-bool updatePosition(int newlatDeg, float newlatMin, bool newisLatN, int newlonDeg, float newlonMin, bool newisLonE, bool dateChaged);
-bool parseTime(char* field, int* timeHour, int* timeMin, float* timeSec);
-bool parseDate(char* field, int* dd, int* mm, int* yy);
-bool parseLatitude(char* firstField, char* secondField, int* latDeg, float* latMin, bool* latNorth);
-bool parseLongitude(char* firstField, char* secondField, int* lonDeg, float* lonMin, bool* lonEast);
-bool parseValid(char* field, bool* isValid);
-bool parseEastWest(char* field, bool* isEast);
-bool parseInteger(char* field, int* value);
-bool parseFloat(char* field, float* value);
-
-static struct NMEAparserStruct NMEAparser = {
-	.altTimestamp=0,
-	.dirTimestamp=0,
-	.newerTimestamp=0,
-	.rcvdTimestamp=0,
-	.GGAfound=false,
-	.RMCfound=false,
-	.GSAfound=false,
-	.numOfGSVmsg=0,
-	.GSVmsgSeqNo=0,
-	.GSVtotalSatInView=0,
-	.rcvdBytesOfSentence=0,
-	.rcvdBytesOfCheksum=-1,
-	.fieldId=0
+static const struct NMEAsentenceType NMEAsentenceTypes[NUM_OF_SENTENCE_TYPES] = { //dispatch table, the most frequent types first
+	{NMEA_TYPE('G','S','V'),parseGSV},
+	{NMEA_TYPE('G','S','A'),parseGSA},
+	{NMEA_TYPE('G','G','A'),parseGGA},
+	{NMEA_TYPE('R','M','C'),parseRMC},
+	{NMEA_TYPE('V','T','G'),parseVTG},
+	{NMEA_TYPE('G','L','L'),parseGLL},
+	{NMEA_TYPE('G','S','T'),parseGST},
+	{NMEA_TYPE('Z','D','A'),parseZDA}
 };
 
-void NMEAparserProcessBuffer(unsigned char *buf, int redBytes) {
-	for(int i=0;i<redBytes;i++) switch(buf[i]) {
-		case '$':
-			NMEAparser.rcvdBytesOfSentence=1;
-			NMEAparser.rcvdBytesOfField=0;
-			NMEAparser.rcvdBytesOfCheksum=-1;
-			NMEAparser.fieldId=0;
-			NMEAparser.sentence[0]='$';
-			break;
-		case ',':
-			NMEAparser.fields[NMEAparser.fieldId][NMEAparser.rcvdBytesOfField]='\0';
-			if(NMEAparser.rcvdBytesOfSentence > 5) {
-				if(NMEAparser.fieldId<MAX_FIELDS) {
-					if(NMEAparser.rcvdBytesOfSentence<MAX_SENTENCE_LENGTH) {
-						NMEAparser.fieldId++;
-						NMEAparser.rcvdBytesOfField=0;
-						NMEAparser.sentence[NMEAparser.rcvdBytesOfSentence++]=',';
+#define FIELD(n) (NMEAparser->sentence+NMEAparser->fieldStart[n]) //the n-th field as a NUL terminated string, valid only while parsing
+
+bool closeField(void) { //record the length of the current field, false if the field is too long
+	int length=NMEAparser->rcvdBytesOfSentence-NMEAparser->fieldStart[NMEAparser->fieldId];
+	if(length>=MAX_FIELD_LENGTH) return false;
+	NMEAparser->fieldLength[NMEAparser->fieldId]=length;
+	return true;
+}
+
+void terminateFields(void) { //replace each separator with a terminator so the fields can be decoded in place
+	for(int i=0;i<=NMEAparser->fieldId;i++) NMEAparser->sentence[NMEAparser->fieldStart[i]+NMEAparser->fieldLength[i]]='\0';
+}
+
+void NMEAparserInit(int source, const char *endOfBurst) {
+	NMEAparser=&NMEAparsers[source];
+	memset(NMEAparser,0,sizeof(*NMEAparser));
+	NMEAparser->source=source;
+	NMEAparser->rcvdBytesOfCheksum=-1;
+	NMEAparser->publishedTimestamp=-1;
+	NMEAparser->epoch.fixMode=MODE_UNKNOWN;
+	if(strlen(endOfBurst)==3) { //sentence type given by the configuration
+		NMEAparser->endOfBurstType=NMEA_TYPE(endOfBurst[0],endOfBurst[1],endOfBurst[2]);
+		NMEAparser->learnEndOfBurst=false;
+	} else {
+		NMEAparser->endOfBurstType=0;
+		NMEAparser->learnEndOfBurst=true;
+	}
+}
+
+void NMEAparserProcessBuffer(int source, unsigned char *buf, int redBytes) {
+	NMEAparser=&NMEAparsers[source];
+	for(int i=0;i<redBytes;i++) {
+		unsigned char c=buf[i];
+		if(c=='$') { //start of a new sentence
+			NMEAparser->rcvdBytesOfSentence=1;
+			NMEAparser->rcvdBytesOfCheksum=-1;
+			NMEAparser->fieldId=0;
+			NMEAparser->fieldStart[0]=1;
+			NMEAparser->checksum=0;
+			NMEAparser->sentence[0]='$';
+			NMEAparser->sentenceOffset=NMEAparser->streamOffset+i;
+			continue;
+		}
+		if(NMEAparser->rcvdBytesOfSentence==0 || c=='\r' || c=='\n') continue; //outside of a sentence or end of line
+		if(NMEAparser->rcvdBytesOfSentence>=MAX_SENTENCE_LENGTH-1) { //overflow
+			NMEAparser->rcvdBytesOfSentence=0;
+			continue;
+		}
+		NMEAparser->sentence[NMEAparser->rcvdBytesOfSentence]=c;
+		if(NMEAparser->rcvdBytesOfCheksum!=-1) { //checksum
+			NMEAparser->rcvdBytesOfSentence++;
+			if(++NMEAparser->rcvdBytesOfCheksum==2) { //do checksum check
+				int high=hexDigitValue(NMEAparser->sentence[NMEAparser->rcvdBytesOfSentence-2]);
+				int low=hexDigitValue(c);
+				if(high>=0 && low>=0 && ((high<<4)|low)==NMEAparser->checksum) { //right CRC
+					NMEAparser->sentence[NMEAparser->rcvdBytesOfSentence]='\0';
+					LogWrite(LOG_DEBUG,LOG_NMEA,"%s\n",NMEAparser->sentence); //all the sentences received, if required
+					terminateFields();
+					if(NMEAparser->source==0) TRACE_MARK(TRACE_SENTENCE_OK,NMEAparser->sentenceOffset,NMEAparser->rcvdBytesOfSentence);
+					if(!NMEAparser->epochStarted) {
+						NMEAparser->epochOffset=NMEAparser->sentenceOffset;
+						NMEAparser->epochStarted=true;
+						NMEAparser->epoch.received=TimeBaseMonotonic();
 					}
+					parseNMEAsentence();
 				}
+				NMEAparser->rcvdBytesOfSentence=0;
 			}
-			break;
-		case '*':
-			NMEAparser.fields[NMEAparser.fieldId][NMEAparser.rcvdBytesOfField]='\0';
-			NMEAparser.rcvdBytesOfCheksum=0;
-			if(NMEAparser.rcvdBytesOfSentence<MAX_SENTENCE_LENGTH) {
-				NMEAparser.sentence[NMEAparser.rcvdBytesOfSentence++]='*';
-			}
-			break;
-		case '\r':
-		case '\n':
-			break;
-		default:
-			if(NMEAparser.rcvdBytesOfSentence>0) {
-				if(NMEAparser.rcvdBytesOfSentence<MAX_SENTENCE_LENGTH) {
-					NMEAparser.sentence[NMEAparser.rcvdBytesOfSentence++]=buf[i]; //add chars to the sentence
-					if(NMEAparser.rcvdBytesOfCheksum!=-1) { // checksum
-						NMEAparser.rcvdBytesOfCheksum++;
-						if(NMEAparser.rcvdBytesOfCheksum==2) { // do checksum check
-							unsigned int checksum=0;
-							for(int j=1;j<NMEAparser.rcvdBytesOfSentence-3;j++) checksum^=NMEAparser.sentence[j];
-							if(getCRCintValue()==checksum) { //right CRC
-								NMEAparser.sentence[NMEAparser.rcvdBytesOfSentence]='\0';
-								#ifdef PRINT_SENTENCES //Print all the sentences received, if required
-								printLog("%s\n",NMEAparser.sentence);
-								#endif
-								NMEAparser.rcvdTimestamp=getCurrentTime();
-								parseNMEAsentence();
-								NMEAparser.rcvdBytesOfSentence=0;
-							}
-						}
-					} else { // not checksum
-						NMEAparser.fields[NMEAparser.fieldId][NMEAparser.rcvdBytesOfField++]=buf[i];
-					}
-				} else { // overflow
-					NMEAparser.rcvdBytesOfSentence=0; //to avoid buffer overflow
+			continue;
+		}
+		switch(c) {
+			case ',':
+				if(!closeField() || NMEAparser->fieldId>=MAX_FIELDS-1) { //field too long or too many fields: drop the sentence
+					NMEAparser->rcvdBytesOfSentence=0;
+					continue;
+				}
+				NMEAparser->fieldStart[++NMEAparser->fieldId]=NMEAparser->rcvdBytesOfSentence+1;
+				break;
+			case '*':
+				if(!closeField()) {
+					NMEAparser->rcvdBytesOfSentence=0;
+					continue;
 				}
+				NMEAparser->rcvdBytesOfCheksum=0;
+				NMEAparser->rcvdBytesOfSentence++;
+				continue; //'*' is not part of the checksum
+		}
+		NMEAparser->checksum^=c;
+		NMEAparser->rcvdBytesOfSentence++;
+	} //end of for(each byte) of just received sequence
+	NMEAparser->streamOffset+=redBytes;
+}
+
+void NMEAparserLogStats(int source) {
+	NMEAparser=&NMEAparsers[source];
+	LogWrite(LOG_INFO,LOG_NMEA,"source %d: GSV %lu, GSA %lu, GGA %lu, RMC %lu, VTG %lu, GLL %lu, GST %lu, ZDA %lu sentences, %lu unsupported, %lu failed, %lu stale.\n",source,
+			NMEAparser->handledSentences[0],NMEAparser->handledSentences[1],NMEAparser->handledSentences[2],NMEAparser->handledSentences[3],
+			NMEAparser->handledSentences[4],NMEAparser->handledSentences[5],NMEAparser->handledSentences[6],NMEAparser->handledSentences[7],
+			NMEAparser->unsupportedSentences,NMEAparser->failedSentences,NMEAparser->staleSentences);
+	LogWrite(LOG_INFO,LOG_NMEA,"source %d: %lu epochs parsed.\n",source,NMEAparser->publishedEpochs);
+}
+
+long timeDifference(long timestamp, long reference) { //timestamp-reference in ms, across midnight too
+	long diff=timestamp-reference;
+	if(diff>MS_DAY/2) diff-=MS_DAY;
+	else if(diff<-MS_DAY/2) diff+=MS_DAY;
+	return diff;
+}
+
+bool epochTime(long timestamp, int timeHour, int timeMin, int timeMilliSec) { //put a sentence with its UTC tag in the right epoch, false if it is stale
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	if(epoch->content&SOLUTION_TIME) {
+		long diff=timeDifference(timestamp,epoch->timestamp);
+		if(diff==0) return true; //same epoch
+		if(diff<0 && diff>=-MAX_STALE_MS) { //late sentence of an epoch already closed
+			NMEAparser->staleSentences++;
+			return false;
+		}
+		if(NMEAparser->learnEndOfBurst) { //the epoch is closed by a time change: its last sentence is the end of the burst
+			if(NMEAparser->endOfBurstType==0 || ++NMEAparser->missedEndOfBurst>=MAX_MISSED_END_OF_BURST) {
+				NMEAparser->endOfBurstType=NMEAparser->lastType;
+				NMEAparser->missedEndOfBurst=0;
+				LogWrite(LOG_INFO,LOG_NMEA,"end of burst sentence: %c%c%c\n",NMEAparser->lastType>>16,(NMEAparser->lastType>>8)&0xFF,NMEAparser->lastType&0xFF);
 			}
-			break;
-	} //end of switch(each byte) of just received sequence
-	bool dateChanged=false, posChanged=false, altChanged=false;
-	if(NMEAparser.GGAfound  || NMEAparser.RMCfound || NMEAparser.GSAfound) {
-		pthread_mutex_lock(&gps.mutex);
-		if(NMEAparser.RMCfound) dateChanged=updateDate(NMEAparser.timeDay,NMEAparser.timeMonth,NMEAparser.timeYear); //pre-check if date is changed
-		if(NMEAparser.GGAfound) {
-			updateTime(NMEAparser.newerTimestamp,NMEAparser.timeHour,NMEAparser.timeMin,NMEAparser.timeSec,false); //updateTime must be done always before of updatePosition
-			posChanged=updatePosition(NMEAparser.latGra,NMEAparser.latMin,NMEAparser.latNorth,NMEAparser.lonGra,NMEAparser.lonMin,NMEAparser.lonEast,dateChanged);
-			altChanged=updateAltitude(NMEAparser.alt,NMEAparser.altUnit,NMEAparser.newerTimestamp);
-			updateNumOfTotalSatsInView(NMEAparser.SatsInView);
-			if(NMEAparser.GSAfound) {
-				updateNumOfActiveSats(NMEAparser.SatsInUse);
-				//updateDiluition(NMEAparser.pdop,NMEAparser.hdop,NMEAparser.vdop);
-			} //else updateHdiluition(NMEAparser.hdop);
 		}
-		if(NMEAparser.RMCfound) {
-			if(!NMEAparser.GGAfound) {
-				updateTime(NMEAparser.newerTimestamp,NMEAparser.timeHour,NMEAparser.timeMin,NMEAparser.timeSec,false); //updateTime must be done always before of updatePosition
-				posChanged=updatePosition(NMEAparser.latGra,NMEAparser.latMin,NMEAparser.latNorth,NMEAparser.lonGra,NMEAparser.lonMin,NMEAparser.lonEast,dateChanged);
+		closeEpoch();
+	} else if(NMEAparser->publishedTimestamp>=0) { //the epoch has been opened by sentences without time
+		long diff=timeDifference(timestamp,NMEAparser->publishedTimestamp);
+		if(diff<=0 && diff>=-MAX_STALE_MS) {
+			NMEAparser->staleSentences++;
+			if(diff==0 && NMEAparser->learnEndOfBurst && NMEAparser->endOfBurstType!=0) { //the burst went on after its supposed end: learn it again
+				LogWrite(LOG_DEBUG,LOG_NMEA,"end of burst sentence received before the end of the burst\n");
+				NMEAparser->endOfBurstType=0;
 			}
-			updateSpeed(NMEAparser.groundSpeedKnots);
-			updateDirection(NMEAparser.trueTrack,NMEAparser.magneticVariation,NMEAparser.magneticVariationToEast,NMEAparser.newerTimestamp);
+			return false;
 		}
-		if(posChanged||altChanged) NavUpdatePosition(gps.lat,gps.lon,gps.realAltMt,gps.speedKmh,gps.timestamp);
-		pthread_mutex_unlock(&gps.mutex);
-		if(getMainStatus()==MAIN_DISPLAY_HSI) FBrenderFlush();
-		BlackBoxCommit();
-		NMEAparser.GGAfound=false;
-		NMEAparser.RMCfound=false;
-		NMEAparser.GSAfound=false;
 	}
+	NMEAparser->epochOffset=NMEAparser->sentenceOffset; //the epoch starts with its first sentence with UTC, not with the tail of the previous burst
+	NMEAparser->epochStarted=true;
+	epoch->received=TimeBaseMonotonic();
+	epoch->content|=SOLUTION_TIME;
+	epoch->timestamp=timestamp;
+	epoch->hour=timeHour;
+	epoch->minute=timeMin;
+	epoch->milliSec=timeMilliSec;
+	return true;
 }
 
-int parseNMEAsentence() {
-	if(strlen(NMEAparser.sentence)<6) return -1; //wrong sentence
-	int r=2;
-	switch(NMEAparser.sentence[3]){
-		case 'G': //GGA GSA GSV GLL GBS
-			switch(NMEAparser.sentence[4]){
-				case 'G': //GGA
-					if(NMEAparser.sentence[5]=='A') {
-						r=parseGGA();
-						#ifdef PRINT_SENTENCES
-						printLog("Time difference: %f\n",NMEAparser.newerTimestamp-NMEAparser.rcvdTimestamp);
-						#endif
-					}
-					break;
-				case 'S': //GSA GSV
-					if(NMEAparser.sentence[5]=='A') r=parseGSA(); //GSA
-					else if(NMEAparser.sentence[5]=='V') r=parseGSV(); //GSV
-					break;
-			}
-			break;
-		case 'R': //RMC
-			if(NMEAparser.sentence[4]=='M' && NMEAparser.sentence[5]=='C') r=parseRMC();
-			break;
+void closeEpoch(void) { //publish the current epoch and start a new empty one
+	if(NMEAparser->epoch.content!=0) {
+		if(NMEAparser->epoch.content&SOLUTION_TIME) NMEAparser->publishedTimestamp=NMEAparser->epoch.timestamp;
+		if(NMEAparser->source==0) TRACE_MARK(TRACE_EPOCH_CLOSED,NMEAparser->publishedEpochs,NMEAparser->epochOffset);
+		GPSpublishSolution(NMEAparser->source,&NMEAparser->epoch);
+		NMEAparser->publishedEpochs++;
 	}
-	#ifdef PRINT_SENTENCES
-	if(r<0) printLog("WARNING: parsing sentence %s returned: %d\n",NMEAparser.sentence,r);
-	else if(r==2) printLog("Received unexpected sentence: %s\n",NMEAparser.sentence);
-	#endif
-	return 1;
+	memset(&NMEAparser->epoch,0,sizeof(NMEAparser->epoch));
+	NMEAparser->epoch.fixMode=MODE_UNKNOWN;
+	NMEAparser->epochStarted=false;
+	NMEAparser->GSAofEpoch=0;
+	NMEAparser->GSAsatsInUse=0;
 }
 
-bool updatePosition(int newlatDeg, float newlatMin, bool newisLatN, int newlonDeg, float newlonMin, bool newisLonE, bool dateChaged) {
-	if(gps.latMinDecimal!=newlatMin||gps.lonMinDecimal!=newlonMin) {
-		gps.latDeg=newlatDeg;
-		gps.lonDeg=newlonDeg;
-		gps.latMinDecimal=newlatMin;
-		gps.lonMinDecimal=newlonMin;
-		gps.isLatN=newisLatN;
-		gps.isLonE=newisLonE;
-		gps.lat=latDegMin2rad(gps.latDeg,gps.latMinDecimal,gps.isLatN);
-		gps.lon=lonDegMin2rad(gps.lonDeg,gps.lonMinDecimal,gps.isLonE);
-		if(getMainStatus()==MAIN_DISPLAY_HSI) {
-			int latMin,lonMin;
-			double latSec,lonSec;
-			convertDecimal2DegMin(gps.latMinDecimal,&latMin,&latSec);
-			convertDecimal2DegMin(gps.lonMinDecimal,&lonMin,&lonSec);
-			PrintPosition(gps.latDeg,latMin,latSec,gps.isLatN,gps.lonDeg,lonMin,lonSec,gps.isLonE);
-		} else if(getMainStatus()==MAIN_DISPLAY_SUNRISE_SUNSET) {
-			//TODO: ....
+int parseNMEAsentence() {
+	if(NMEAparser->fieldLength[0]!=5) { //not a standard sentence with 2 letters of talker and 3 of type (proprietary ones too)
+		NMEAparser->unsupportedSentences++;
+		return 0;
+	}
+	const char *type=NMEAparser->sentence+3; //skip '$' and the talker
+	int key=NMEA_TYPE(type[0],type[1],type[2]);
+	for(int i=0;i<NUM_OF_SENTENCE_TYPES;i++) if(NMEAsentenceTypes[i].type==key) {
+		NMEAparser->handledSentences[i]++;
+		int r=NMEAsentenceTypes[i].parse();
+		if(r<0) {
+			NMEAparser->failedSentences++;
+			LogWrite(LOG_WARNING,LOG_NMEA,"parsing sentence %s returned: %d\n",NMEAparser->sentence,r); //here the sentence is just its address field
+		} else if(key==NMEAparser->endOfBurstType && (key!=NMEA_TYPE('G','S','V') || NMEAparser->GSVseriesEnd)) {
+			closeEpoch(); //last sentence of the receiver cycle (for GSV the last of its series)
+			NMEAparser->missedEndOfBurst=0;
 		}
-		BlackBoxRecordPos(gps.lat,gps.lon,gps.timestamp,gps.hour,gps.minute,gps.second,gps.day,gps.month,gps.year,dateChaged);
-		return true;
+		NMEAparser->lastType=key;
+		return r;
 	}
-	return false;
+	NMEAparser->unsupportedSentences++; //just count it: logging each one would be too expensive
+	return 0;
 }
 
-bool updateAltitude(float newAltitude, char altUnit, float timestamp) {
-	float newAltitudeMt=0,newAltitudeFt=0;
-	bool updateAlt=false;
-	if(altUnit=='M' || altUnit=='m') {
-		if(newAltitude!=gps.altMt) {
-			updateAlt=true;
-			newAltitudeMt=newAltitude;
-			newAltitudeFt=m2Ft(newAltitude);
-		}
-	} else if(altUnit=='F' || altUnit=='f') {
-		if(newAltitude!=gps.altFt) {
-			updateAlt=true;
-			newAltitudeFt=newAltitude;
-			newAltitudeMt=Ft2m(newAltitude);
-		}
-	} else {
-		#ifdef PRINT_SENTENCES
-		printLog("ERROR: Unknown altitude unit: %c\n",altUnit);
-		#endif
-		return 0;
-	}
-	NMEAparser.altTimestamp=timestamp;
-	if(updateAlt) {
-		gps.altMt=newAltitudeMt;
-		gps.altFt=newAltitudeFt;
-		double deltaMt=GeoidalGetSeparation(Rad2Deg(gps.lat),Rad2Deg(gps.lon));
-		newAltitudeMt-=deltaMt;
-		newAltitudeFt-=m2Ft(deltaMt);
-		if(getMainStatus()==MAIN_DISPLAY_HSI) {
-			HSIdrawVSIscale(newAltitudeFt);
-			PrintAltitude(newAltitudeMt,newAltitudeFt);
-		}
-//		if(NMEAparser.altTimestamp!=0) {
-//			float deltaT;
-//			if(timestamp>NMEAparser.altTimestamp) deltaT=timestamp-NMEAparser.altTimestamp;
-//			else if(timestamp!=NMEAparser.altTimestamp) {
-//				deltaT=timestamp+86400-NMEAparser.altTimestamp;
-//				float deltaH=newAltitudeFt-gps.altFt;
-//				gps.climbFtMin=deltaH/(deltaT/60);
-//				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintVerticalSpeed(gps.climbFtMin);
-//			}
-//		}
-		gps.realAltMt=newAltitudeMt;
-		gps.realAltFt=newAltitudeFt;
+int hexDigitValue(char digit) {
+	if(digit>='0' && digit<='9') return digit-'0';
+	if(digit>='A' && digit<='F') return digit-'A'+10;
+	if(digit>='a' && digit<='f') return digit-'a'+10;
+	return -1;
+}
+
+bool parseDigits(const char* field, int numOfDigits, int* value) { //exactly numOfDigits decimal digits
+	int result=0;
+	for(int i=0;i<numOfDigits;i++) {
+		if(field[i]<'0' || field[i]>'9') return false;
+		result=result*10+field[i]-'0';
 	}
-//else if(gps.climbFtMin!=0) { //altitude remained the same: put the variometer to 0
-//		gps.climbFtMin=0;
-//		if(getMainStatus()==MAIN_DISPLAY_HSI) PrintVerticalSpeed(0);
-//	}
-	BlackBoxRecordAlt(gps.realAltMt);
-	return updateAlt;
+	*value=result;
+	return true;
 }
 
-void updateDirection(float newTrueTrack, float magneticVar, bool isVarToEast, float timestamp) {
-	if(gps.speedKmh>2) {
-		if(newTrueTrack!=gps.trueTrack) {
-			gps.magneticVariation=magneticVar;
-			gps.isMagVarToEast=isVarToEast;
-			if(newTrueTrack<90 && newTrueTrack>270) { // I'm up
-				if(isVarToEast) gps.magneticTrack=newTrueTrack+magneticVar;
-				else gps.magneticTrack=newTrueTrack-magneticVar;
-			} else { // I'm down
-				if(isVarToEast) gps.magneticTrack=newTrueTrack-magneticVar;
-				else gps.magneticTrack=newTrueTrack+magneticVar;
-			}
-			if(getMainStatus()==MAIN_DISPLAY_HSI) HSIupdateDir(newTrueTrack);
-			if(NMEAparser.dirTimestamp!=0 && gps.speedKmh>10) {
-				float deltaT;
-				if(timestamp>NMEAparser.dirTimestamp) deltaT=timestamp-NMEAparser.dirTimestamp;
-				else if(timestamp!=NMEAparser.dirTimestamp) deltaT=timestamp+86400-NMEAparser.dirTimestamp;
-				else return;
-//				float deltaA=newTrueTrack-gps.trueTrack;
-//				gps.turnRateDegSec=deltaA/deltaT;
-//				gps.turnRateDegMin=gps.turnRateDegSec*60;
-//				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintTurnRate(gps.turnRateDegMin);
-			}
-			gps.trueTrack=newTrueTrack;
-		} else {
-			if(gps.turnRateDegSec!=0) {
-				gps.turnRateDegSec=0;
-				gps.turnRateDegMin=0;
-//				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintTurnRate(0);
-			}
+bool parseTime(const char* field, int* timeHour, int* timeMin, int* timeMilliSec) { //Hour, Minute, second hhmmss.sss
+	int hour, min, sec, milliSec=0;
+	if(!parseDigits(field,2,&hour) || !parseDigits(field+2,2,&min) || !parseDigits(field+4,2,&sec)) return false;
+	if(hour>23 || min>59 || sec>60) return false; //60 for the leap second
+	const char *c=field+6;
+	if(*c=='.') {
+		int weight=100;
+		for(c++;*c>='0' && *c<='9';c++) { //fraction of second truncated to the ms
+			milliSec+=(*c-'0')*weight;
+			weight/=10;
 		}
 	}
-	if(gps.speedKmh>4) BlackBoxRecordCourse(newTrueTrack);
-	NMEAparser.dirTimestamp=timestamp;
+	if(*c!='\0') return false;
+	*timeHour=hour;
+	*timeMin=min;
+	*timeMilliSec=sec*1000+milliSec;
+	return true;
 }
 
-bool parseTime(char* field, int* timeHour, int* timeMin, float* timeSec) {
-	if(field[0]=='\0') return false;
-	return (sscanf(field,"%2d%2d%f",timeHour,timeMin,timeSec)==3); //Hour, Minute, second hhmmss.sss
+bool parseDate(const char* field, int* dd, int* mm, int* yy) { //Date ddmmyy
+	if(!parseDigits(field,2,dd) || !parseDigits(field+2,2,mm)) return false;
+	if(!parseInteger(field+4,yy)) return false;
+	return (*dd>0 && *mm>0);
 }
 
-bool parseDate(char* field, int* dd, int* mm, int* yy)
-{
-	if(field[0]=='\0') return false;
-	if(sscanf(field,"%2d%2d%d",dd,mm,yy)!=3) return false; //Date ddmmyy
-	return (*dd>0 && *mm>0);
+bool parseDegMin(const char* firstField, int degDigits, int* coord) { //degrees with degDigits digits followed by decimal minutes mm.mmmmmm
+	int deg;
+	long minutes; //millionths of minute
+	if(!parseDigits(firstField,degDigits,&deg) || deg>180) return false;
+	if(!parseFixed(firstField+degDigits,6,&minutes) || minutes<0 || minutes>=60000000) return false;
+	*coord=deg*GEO_UNITS_DEG+(int)((minutes+3)/6); //rounded to 1e-7 degrees as GeoPosition
+	return true;
 }
 
-bool parseLatitude(char* firstField, char* secondField, int* latDeg, float* latMin, bool* latNorth) {
-	if(firstField[0]=='\0' || secondField[0]=='\0') return false;
-	if(sscanf(firstField,"%2d%f",latDeg,latMin)!=2) return false; //Latitude ddmm.mm
+bool parseLatitude(const char* firstField, const char* secondField, int* latitude) {
+	int coord;
+	if(!parseDegMin(firstField,2,&coord)) return false; //Latitude ddmm.mm
 	switch(secondField[0]) { //North or South
 		case 'N':
-			*latNorth=true;
+			*latitude=coord;
 			return true;
 		case 'S':
-			*latNorth=false;
+			*latitude=-coord;
 			return true;
 		default:
 			return false;
 	}
 }
 
-bool parseLongitude(char* firstField, char* secondField, int* lonDeg, float* lonMin, bool* lonEast) {
-	if(firstField[0]=='\0' || secondField[0]=='\0') return false;
-	if(sscanf(firstField,"%3d%f",lonDeg,lonMin)!=2) return false; //Longitude dddmm.mm
-	return parseEastWest(secondField,lonEast);
+bool parseLongitude(const char* firstField, const char* secondField, int* longitude) {
+	int coord;
+	bool east;
+	if(!parseDegMin(firstField,3,&coord)) return false; //Longitude dddmm.mm
+	if(!parseEastWest(secondField,&east)) return false;
+	*longitude=east?coord:-coord;
+	return true;
 }
 
-bool parseValid(char* field, bool* isValid) {
+bool parseValid(const char* field, bool* isValid) {
 	switch(field[0]) {
 		case 'A':
 			*isValid=true;
@@ -361,7 +379,7 @@ bool parseValid(char* field, bool* isValid) {
 	}
 }
 
-bool parseEastWest(char* field, bool* isEast) {
+bool parseEastWest(const char* field, bool* isEast) {
 	switch(field[0]) { //East or West
 		case 'E':
 			*isEast=true;
@@ -374,155 +392,146 @@ bool parseEastWest(char* field, bool* isEast) {
 	}
 }
 
-bool parseInteger(char* field, int* value)
-{
-	if(field[0]=='\0') return false;
-	return (sscanf(field,"%d",value)==1);
+bool parseInteger(const char* field, int* value) {
+	long result;
+	if(!parseFixed(field,0,&result)) return false;
+	*value=result;
+	return true;
 }
 
-bool parseFloat(char* field, float* value)
-{
-	if(field[0]=='\0') return false;
-	return (sscanf(field,"%f",value)==1);
+bool parseFixed(const char* field, int decimals, long* value) { //decimal number scaled by 10^decimals, further decimals are rounded
+	const char *c=field;
+	bool negative=false;
+	if(*c=='-') {
+		negative=true;
+		c++;
+	} else if(*c=='+') c++;
+	long result=0;
+	int digits=0, decimalDigits=0;
+	for(;*c>='0' && *c<='9';c++) {
+		if(++digits>MAX_FIXED_DIGITS) return false; //too big to stay in a long
+		result=result*10+*c-'0';
+	}
+	if(*c=='.') for(c++;*c>='0' && *c<='9';c++) {
+		if(decimalDigits<decimals) {
+			if(++digits>MAX_FIXED_DIGITS) return false;
+			result=result*10+*c-'0';
+			decimalDigits++;
+		} else if(decimalDigits==decimals) { //first digit out of the requested ones
+			if(*c>='5') result++;
+			decimalDigits++;
+		}
+	}
+	if(*c!='\0' || (digits==0 && decimalDigits==0)) return false; //garbage or no digits at all
+	for(;decimalDigits<decimals;decimalDigits++,digits++) result*=10;
+	if(digits>MAX_FIXED_DIGITS) return false; //too big to stay in a long
+	*value=negative?-result:result;
+	return true;
 }
 
 int parseGGA() {
-	if(NMEAparser.fieldId != 14) return 0;
-	int timeHour, timeMin;
-	float timeSec;
-	if(!parseTime(NMEAparser.fields[1],&timeHour,&timeMin,&timeSec)) return -1;
-	int latGra=-91, lonGra=-181;
-	float latMin, lonMin;
-	bool latNorth, lonEast;
-	parseLatitude(NMEAparser.fields[2], NMEAparser.fields[3], &latGra, &latMin, &latNorth);
-	parseLongitude(NMEAparser.fields[4], NMEAparser.fields[5], &lonGra,&lonMin, &lonEast);
-	int quality=NMEAparser.fields[6][0]-'0'; //Quality
+	if(NMEAparser->fieldId != 14) return 0;
+	int timeHour, timeMin, timeMilliSec;
+	if(!parseTime(FIELD(1),&timeHour,&timeMin,&timeMilliSec)) return -1;
+	struct GeoPosition pos={0,0};
+	bool posOk=parseLatitude(FIELD(2), FIELD(3), &pos.lat) && parseLongitude(FIELD(4), FIELD(5), &pos.lon);
+	int quality=FIELD(6)[0]-'0'; //Quality
 	int numOfSatellites=-1;
-	parseInteger(NMEAparser.fields[7],&numOfSatellites); //Number of satellites
-	float hDilutionPrecision=-1;
-	parseFloat(NMEAparser.fields[8],&hDilutionPrecision); //H dilution
-	float alt=-1;
-	parseFloat(NMEAparser.fields[9],&alt); //Altitude
-	char altUnit=NMEAparser.fields[10][0]; //Altitude unit
-	float geoidalSeparation=0;
-	parseFloat(NMEAparser.fields[11],&geoidalSeparation); //Geoidal separation
-	char geoidalUnit=NMEAparser.fields[12][0]; //Geoidal Separation unit
+	bool satsOk=parseInteger(FIELD(7),&numOfSatellites); //Number of satellites in use
+	long hDilutionPrecision=-100;
+	bool hdopOk=parseFixed(FIELD(8),2,&hDilutionPrecision); //H dilution
+	long alt=-1000;
+	bool altOk=parseFixed(FIELD(9),3,&alt); //Altitude
+	char altUnit=FIELD(10)[0]; //Altitude unit
+	long geoidalSeparation=0;
+	parseFixed(FIELD(11),3,&geoidalSeparation); //Geoidal separation
+	char geoidalUnit=FIELD(12)[0]; //Geoidal Separation unit
 	if(geoidalUnit != 'M') {
-		#ifdef PRINT_SENTENCES
-		printLog("WARNING: Geoidal separation unit not in meters!");
-		#endif
+		LogWrite(LOG_WARNING,LOG_NMEA,"Geoidal separation unit not in meters!\n");
 		return 0;
 	}
-	float diffAge=0;
-	parseFloat(NMEAparser.fields[13],&diffAge); //Age of differential GPS data
+	long diffAge=0;
+	parseFixed(FIELD(13),1,&diffAge); //Age of differential GPS data
 	int diffRef=-1;
-	parseInteger(NMEAparser.fields[14],&diffRef); //Differential reference station ID, the last one
-	float timestamp=timeHour*3600+timeMin*60+timeSec;
-	if(timestamp<NMEAparser.newerTimestamp) return 0; //the sentence is old
-	if(quality!=Q_NO_FIX) {
-		if(timestamp>NMEAparser.newerTimestamp) { //this is a new one sentence
-			NMEAparser.newerTimestamp=timestamp;
-			NMEAparser.GGAfound=true;
-			NMEAparser.RMCfound=false;
-			NMEAparser.GSAfound=false;
-		} else { //timestamp==newerTimestamp
-			if(NMEAparser.GGAfound) return 0;
-			else NMEAparser.GGAfound=true;
-		}
-		NMEAparser.alt=alt;
-		NMEAparser.altUnit=altUnit;
-		NMEAparser.latGra=latGra;
-		NMEAparser.latMin=latMin;
-		NMEAparser.latNorth=latNorth;
-		NMEAparser.lonGra=lonGra;
-		NMEAparser.lonMin=lonMin;
-		NMEAparser.lonEast=lonEast;
-		NMEAparser.timeHour=timeHour;
-		NMEAparser.timeMin=timeMin;
-		NMEAparser.timeSec=timeSec;
-		NMEAparser.hdop=hDilutionPrecision;
-		NMEAparser.SatsInView=numOfSatellites;
-		updateFixMode(MODE_GPS_FIX);
+	parseInteger(FIELD(14),&diffRef); //Differential reference station ID, the last one
+	long timestamp=(timeHour*3600L+timeMin*60)*1000+timeMilliSec;
+	if(!epochTime(timestamp,timeHour,timeMin,timeMilliSec)) return 0; //the sentence is old
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	LogWrite(LOG_DEBUG,LOG_NMEA,"Time difference: %ld ms\n",(long)((TimeBaseUTC(epoch->received)-TimeBaseFromDayMs(timestamp))/1000));
+	if(quality==Q_NO_FIX) { //there is no fix: the epoch will show just the time
+		if(epoch->fixMode==MODE_UNKNOWN) epoch->fixMode=MODE_NO_FIX;
 		return 1;
-	} else { //there is no fix...;
-		updateFixMode(MODE_NO_FIX); //show that there is no fix
-		if(timestamp>NMEAparser.newerTimestamp) {
-			NMEAparser.newerTimestamp=timestamp;
-			updateTime(timestamp,timeHour,timeMin,timeSec,true); //show the time
-		}
 	}
-	return 0;
+	if(epoch->fixMode==MODE_UNKNOWN) epoch->fixMode=MODE_GPS_FIX; //GSA tells if 2D or 3D
+	if(posOk) {
+		epoch->pos=pos;
+		epoch->content|=SOLUTION_POSITION;
+	}
+	if(altOk) {
+		epoch->alt=alt;
+		epoch->altUnit=altUnit;
+		epoch->content|=SOLUTION_ALTITUDE;
+	}
+	if(satsOk && !(epoch->content&SOLUTION_SATS_IN_USE)) {
+		epoch->satsInUse=numOfSatellites;
+		epoch->content|=SOLUTION_SATS_IN_USE;
+	}
+	if(hdopOk) {
+		epoch->hdop=hDilutionPrecision;
+		epoch->content|=SOLUTION_HDOP;
+	}
+	return 1;
 }
 
 int parseRMC() {
-	if(NMEAparser.fieldId!=12 && NMEAparser.fieldId!=11) return 0;
-	int timeHour=-1,timeMin=-1;
-	float timeSec=0;
-	if(!parseTime(NMEAparser.fields[1],&timeHour,&timeMin,&timeSec)) return -1;
+	if(NMEAparser->fieldId<11) return 0; //11 fields up to NMEA 2.2, 12 with the FAA mode, 13 with the navigational status of NMEA 4.10
+	int timeHour=-1,timeMin=-1,timeMilliSec=0;
+	if(!parseTime(FIELD(1),&timeHour,&timeMin,&timeMilliSec)) return -1;
 	bool isValid=false;
-	if(!parseValid(NMEAparser.fields[2], &isValid)) return -2; //Status
+	if(!parseValid(FIELD(2), &isValid)) return -2; //Status
+	char faa=FAA_ABSENT;
+	if(NMEAparser->fieldId>=12) faa=FIELD(12)[0]; //FAA Indicator (optional)
+	if(faa==FAA_NOTVAL) isValid=false;
+	if(NMEAparser->fieldId>=13 && FIELD(13)[0]=='V') isValid=false; //Navigational status (optional): not valid
 	int timeDay=-1,timeMonth=-1,timeYear=-1;
-	if(!parseDate(NMEAparser.fields[9],&timeDay,&timeMonth,&timeYear)) return -9; //Date
-	float timestamp=timeHour*3600+timeMin*60+timeSec;
-	if(timeDay!=gps.day) {
-		NMEAparser.newerTimestamp=timestamp; //change of date
-		NMEAparser.timeDay=timeDay;
-		NMEAparser.timeMonth=timeMonth;
-		NMEAparser.timeYear=timeYear;
-		NMEAparser.RMCfound=isValid;
-		NMEAparser.GGAfound=false;
-		NMEAparser.GSAfound=false;
-		updateTime(timestamp,timeHour,timeMin,timeSec,isValid); //show the time
-	} else if(timestamp<NMEAparser.newerTimestamp) return 0; //the sentence is old
-	else if(timestamp>NMEAparser.newerTimestamp) { //new sentence
-		NMEAparser.newerTimestamp=timestamp;
-		updateTime(timestamp,timeHour,timeMin,timeSec,isValid); //show the time
-		NMEAparser.RMCfound=isValid;
-		NMEAparser.GGAfound=false;
-		NMEAparser.GSAfound=false;
-	} else { // timestamp==NMEAparser.newerTimestamp
-		if(NMEAparser.RMCfound) return 0;
-		else NMEAparser.RMCfound=isValid;
-	}
-	if(isValid)
-	{
-		int latGra=-91, lonGra=-181;
-		float latMin=0, lonMin=0;
-		bool latNorth=true, lonEast=true;
-		parseLatitude(NMEAparser.fields[3], NMEAparser.fields[4], &latGra, &latMin, &latNorth);
-		parseLongitude(NMEAparser.fields[5], NMEAparser.fields[6], &lonGra,&lonMin, &lonEast);
-		float groundSpeedKnots=0;
-		parseFloat(NMEAparser.fields[7],&groundSpeedKnots); //Ground speed Knots
-		float trueTrack=0;
-		parseFloat(NMEAparser.fields[8],&trueTrack); //True track
-		float magneticVariation=0;
-		parseFloat(NMEAparser.fields[10],&magneticVariation); //Magnetic declination
-		bool magneticVariationToEast=true;
-		parseEastWest(NMEAparser.fields[11], &magneticVariationToEast); //Magnetic declination East or West, can be the last one
-		char faa=FAA_ABSENT;
-		if(NMEAparser.fieldId==12) faa=NMEAparser.fields[12][0]; //FAA Indicator (optional)
-		NMEAparser.latGra=latGra;
-		NMEAparser.latMin=latMin;
-		NMEAparser.latNorth=latNorth;
-		NMEAparser.lonGra=lonGra;
-		NMEAparser.lonMin=lonMin;
-		NMEAparser.lonEast=lonEast;
-		NMEAparser.timeHour=timeHour;
-		NMEAparser.timeMin=timeMin;
-		NMEAparser.timeSec=timeSec;
-		NMEAparser.groundSpeedKnots=groundSpeedKnots;
-		NMEAparser.trueTrack=trueTrack;
-		NMEAparser.magneticVariation=magneticVariation;
-		NMEAparser.magneticVariationToEast=magneticVariationToEast;
+	if(!parseDate(FIELD(9),&timeDay,&timeMonth,&timeYear)) return -9; //Date
+	long timestamp=(timeHour*3600L+timeMin*60)*1000+timeMilliSec;
+	if(!epochTime(timestamp,timeHour,timeMin,timeMilliSec)) return 0; //the sentence is old
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	if(!isValid) { //the epoch will show just the time
+		if(epoch->fixMode==MODE_UNKNOWN) epoch->fixMode=MODE_NO_FIX;
 		return 1;
 	}
-	return 0;
+	epoch->day=timeDay;
+	epoch->month=timeMonth;
+	epoch->year=timeYear;
+	epoch->content|=SOLUTION_DATE;
+	struct GeoPosition pos={0,0};
+	if(parseLatitude(FIELD(3), FIELD(4), &pos.lat) && parseLongitude(FIELD(5), FIELD(6), &pos.lon)) {
+		epoch->pos=pos;
+		epoch->content|=SOLUTION_POSITION;
+	}
+	long groundSpeedKnots=0;
+	long trueTrack=0;
+	if(parseFixed(FIELD(7),3,&groundSpeedKnots) && parseFixed(FIELD(8),2,&trueTrack)) { //Ground speed Knots and true track
+		epoch->groundSpeedKnots=groundSpeedKnots;
+		epoch->trueTrack=trueTrack;
+		epoch->content|=SOLUTION_VELOCITY;
+	}
+	long magneticVariation=0;
+	bool magneticVariationToEast=true;
+	if(parseFixed(FIELD(10),2,&magneticVariation) && parseEastWest(FIELD(11), &magneticVariationToEast)) { //Magnetic declination East or West, can be the last one
+		epoch->magneticVariation=magneticVariation;
+		epoch->isMagVarToEast=magneticVariationToEast;
+		epoch->content|=SOLUTION_MAGVAR;
+	}
+	return 1;
 }
 
 int parseGSA() {
-	if(NMEAparser.fieldId!=17) return 0;
+	if(NMEAparser->fieldId<17) return 0; //18 fields with the system ID of NMEA 4.10
 	bool autoSelectionMode;
-	switch(NMEAparser.fields[1][0]) {  //Mode
+	switch(FIELD(1)[0]) {  //Mode
 		case 'A':
 			autoSelectionMode=true;
 			break;
@@ -533,76 +542,157 @@ int parseGSA() {
 			return (-1);
 	}
 	int mode=MODE_NO_FIX;
-	if(!parseInteger(NMEAparser.fields[2],&mode)) return -2; //Signal Strength
+	if(!parseInteger(FIELD(2),&mode)) return -2; //Signal Strength
 	int satellites[12];
 	int numOfSatellites=0;
-	for(short i=0;i<12;i++) if(parseInteger(NMEAparser.fields[i+3],&satellites[i])) numOfSatellites++; //Satellites IDs
-	float pdop=0;
-	if(!parseFloat(NMEAparser.fields[15],&pdop)) return -15; //PDOP
-	float hdop=0;
-	if(!parseFloat(NMEAparser.fields[16],&hdop)) return -16; //HDOP
-	float vdop=0;
-	if(!parseFloat(NMEAparser.fields[17],&vdop)) return -17; //VDOP, the last one
-	updateFixMode(mode);
+	for(short i=0;i<12;i++) if(parseInteger(FIELD(i+3),&satellites[i])) numOfSatellites++; //Satellites IDs
+	long pdop=0;
+	if(!parseFixed(FIELD(15),2,&pdop)) return -15; //PDOP
+	long hdop=0;
+	if(!parseFixed(FIELD(16),2,&hdop)) return -16; //HDOP
+	long vdop=0;
+	if(!parseFixed(FIELD(17),2,&vdop)) return -17; //VDOP
+	int systemId=0;
+	if(NMEAparser->fieldId>=18 && FIELD(18)[0]!='\0' && !parseInteger(FIELD(18),&systemId)) return -18; //System ID (optional)
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	bool first=NMEAparser->GSAofEpoch++==0; //the next ones are of other constellations (or of more satellites) of the same solution
+	if(first || mode>epoch->fixMode) epoch->fixMode=mode;
 	if(mode!=MODE_NO_FIX) {
-		if(NMEAparser.GSAfound) return 0;
-		else if(NMEAparser.GGAfound && NMEAparser.RMCfound) {
-			NMEAparser.GSAfound=1;
-			NMEAparser.pdop=pdop;
-			NMEAparser.hdop=hdop;
-			NMEAparser.vdop=vdop;
-			NMEAparser.SatsInUse=numOfSatellites;
-			return 1;
-		}
-		return 0;
+		epoch->pdop=pdop;
+		epoch->hdop=hdop;
+		epoch->vdop=vdop;
+		NMEAparser->GSAsatsInUse+=numOfSatellites;
+		epoch->satsInUse=NMEAparser->GSAsatsInUse; //in place of the one of GGA
+		epoch->content|=SOLUTION_DOP|SOLUTION_SATS_IN_USE;
 	}
-	return 0;
+	return 1;
 }
 
 int parseGSV() {
-	int numOfGSVmsg=NMEAparser.numOfGSVmsg; //take a note of numOfGSV...
-	int GSVmsgSeqNo=NMEAparser.GSVmsgSeqNo; // ... and seq number
-	NMEAparser.numOfGSVmsg=0; // reset "a priori"
-	NMEAparser.GSVmsgSeqNo=0;
-	if(NMEAparser.fieldId < 7) return 0;
+	NMEAparser->GSVseriesEnd=false;
+	if(NMEAparser->sentence[1]!='G' || NMEAparser->sentence[2]!='P') return 0; //the satellites matrix is only for GPS PRNs: the GPS series goes on
+	int numOfGSVmsg=NMEAparser->numOfGSVmsg; //take a note of numOfGSV...
+	int GSVmsgSeqNo=NMEAparser->GSVmsgSeqNo; // ... and seq number
+	NMEAparser->numOfGSVmsg=0; // reset "a priori"
+	NMEAparser->GSVmsgSeqNo=0;
+	if(NMEAparser->fieldId < 7) return 0;
 	int sen,seq,sat; //Number of GSV messages, GSV message seq no, total number of satellites in view
-	if(parseInteger(NMEAparser.fields[1],&sen) && parseInteger(NMEAparser.fields[2],&seq) && parseInteger(NMEAparser.fields[3],&sat)) {
+	if(parseInteger(FIELD(1),&sen) && parseInteger(FIELD(2),&seq) && parseInteger(FIELD(3),&sat)) {
 		if(sen<=0 || seq<=0 || seq>sen || sat<0 || sat>MAX_NUM_SAT) return -2;
 	} else return -1;
 	if(seq==1) { //the first one resets GSVmsgSeqNo counter
 		numOfGSVmsg=sen;
 		GSVmsgSeqNo=1;
-		for(int i=0; i<MAX_NUM_SAT; i++) for(int j=SAT_ELEVATION; j<=SAT_SNR; j++) gps.satellites[i][j]=-1; //reset all sats
-		NMEAparser.GSVtotalSatInView=sat;
-		updateNumOfTotalSatsInView(NMEAparser.GSVtotalSatInView);
+		for(int i=0; i<MAX_NUM_SAT; i++) for(int j=SAT_ELEVATION; j<=SAT_SNR; j++) NMEAparser->satellites[i][j]=-1; //reset all sats
+		NMEAparser->GSVtotalSatInView=sat;
 	} else { //we are not expecting the first
 		if(sen!=numOfGSVmsg) return -3;
 		if(seq!=++GSVmsgSeqNo) return -4;
-		if(sat!=NMEAparser.GSVtotalSatInView) return -5;
+		if(sat!=NMEAparser->GSVtotalSatInView) return -5;
 	}
 	int pos=5;
 	bool ok=true;
-	while(pos<=NMEAparser.fieldId && ok) {
+	while(pos<=NMEAparser->fieldId && ok) {
 		int satId;
-		if(!(ok=parseInteger(NMEAparser.fields[pos++],&satId))) break;
-		if(!(ok=(satId<=0 || satId>MAX_NUM_SAT))) break;
+		if(!(ok=parseInteger(FIELD(pos++),&satId))) break;
+		if(satId<=0 || satId>MAX_NUM_SAT) { //not a GPS PRN (SBAS, ...): skip its data
+			pos+=3;
+			continue;
+		}
 		satId--;
-		for(int i=SAT_ELEVATION; i<=SAT_SNR && ok && pos<=NMEAparser.fieldId; i++) {
-			if(!(ok=parseInteger(NMEAparser.fields[pos++],&gps.satellites[satId][i]))) gps.satellites[satId][i]=-1;
+		for(int i=SAT_ELEVATION; i<=SAT_SNR && ok && pos<=NMEAparser->fieldId; i++) {
+			if(!(ok=parseInteger(FIELD(pos++),&NMEAparser->satellites[satId][i]))) NMEAparser->satellites[satId][i]=-1;
 		}
 	}
 	if(!ok) return(-1-pos);
-	NMEAparser.numOfGSVmsg=numOfGSVmsg; //put back the right values
-	NMEAparser.GSVmsgSeqNo=GSVmsgSeqNo;
+	NMEAparser->numOfGSVmsg=numOfGSVmsg; //put back the right values
+	NMEAparser->GSVmsgSeqNo=GSVmsgSeqNo;
+	if(GSVmsgSeqNo==numOfGSVmsg) { //last of the series: the matrix is complete
+		NMEAparser->GSVseriesEnd=true;
+		struct GPSsolution *epoch=&NMEAparser->epoch;
+		memcpy(epoch->satellites,NMEAparser->satellites,sizeof(epoch->satellites));
+		epoch->satsInView=NMEAparser->GSVtotalSatInView;
+		epoch->content|=SOLUTION_SATELLITES|SOLUTION_SATS_IN_VIEW;
+	}
+	return 1;
+}
+
+int parseVTG() {
+	if(NMEAparser->fieldId!=8 && NMEAparser->fieldId!=9) return 0;
+	if(NMEAparser->fieldId==9 && FIELD(9)[0]=='N') return 0; //FAA mode: data not valid
+	long trueTrack, magneticTrack=-1, groundSpeedKnots;
+	if(!parseFixed(FIELD(1),2,&trueTrack)) return -1; //True track
+	parseFixed(FIELD(3),2,&magneticTrack); //Magnetic track, often empty
+	if(!parseFixed(FIELD(5),3,&groundSpeedKnots)) return -5; //Ground speed knots
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	if(epoch->content&SOLUTION_VELOCITY) return 0; //RMC already gave all of that for this epoch
+	epoch->trueTrack=trueTrack;
+	epoch->groundSpeedKnots=groundSpeedKnots;
+	epoch->content|=SOLUTION_VELOCITY;
+	if(magneticTrack>=0 && !(epoch->content&SOLUTION_MAGVAR)) {
+		long variation=trueTrack-magneticTrack; //positive to East
+		if(variation>18000) variation-=36000;
+		else if(variation<-18000) variation+=36000;
+		epoch->isMagVarToEast=variation>=0;
+		epoch->magneticVariation=variation>=0?variation:-variation;
+		epoch->content|=SOLUTION_MAGVAR;
+	}
+	return 1;
+}
+
+int parseGLL() {
+	if(NMEAparser->fieldId!=6 && NMEAparser->fieldId!=7) return 0;
+	int timeHour, timeMin, timeMilliSec;
+	if(!parseTime(FIELD(5),&timeHour,&timeMin,&timeMilliSec)) return -5;
+	bool isValid=false;
+	if(!parseValid(FIELD(6),&isValid)) return -6; //Status
+	if(!isValid) return 0;
+	struct GeoPosition pos;
+	if(!parseLatitude(FIELD(1),FIELD(2),&pos.lat)) return -1;
+	if(!parseLongitude(FIELD(3),FIELD(4),&pos.lon)) return -3;
+	long timestamp=(timeHour*3600L+timeMin*60)*1000+timeMilliSec;
+	if(!epochTime(timestamp,timeHour,timeMin,timeMilliSec)) return 0; //the sentence is old
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	if(epoch->content&SOLUTION_POSITION) return 0; //GGA or RMC already gave it
+	epoch->pos=pos;
+	epoch->content|=SOLUTION_POSITION;
+	return 1;
+}
+
+int parseZDA() {
+	if(NMEAparser->fieldId!=6) return 0;
+	int timeHour, timeMin, timeMilliSec;
+	if(!parseTime(FIELD(1),&timeHour,&timeMin,&timeMilliSec)) return -1;
+	int timeDay, timeMonth, timeYear;
+	if(!parseInteger(FIELD(2),&timeDay) || timeDay<1 || timeDay>31) return -2;
+	if(!parseInteger(FIELD(3),&timeMonth) || timeMonth<1 || timeMonth>12) return -3;
+	if(!parseInteger(FIELD(4),&timeYear)) return -4; //4 digits year
+	long timestamp=(timeHour*3600L+timeMin*60)*1000+timeMilliSec;
+	if(!epochTime(timestamp,timeHour,timeMin,timeMilliSec)) return 0; //the sentence is old
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	if(epoch->content&SOLUTION_DATE) return 0; //the date is already known
+	epoch->day=timeDay;
+	epoch->month=timeMonth;
+	epoch->year=timeYear;
+	epoch->content|=SOLUTION_DATE;
 	return 1;
 }
 
-unsigned int getCRCintValue(void) {
-	if(NMEAparser.rcvdBytesOfSentence<9) return -1;
-	char asciiCheksum[2]; //two digits
-	asciiCheksum[0]=NMEAparser.sentence[NMEAparser.rcvdBytesOfSentence-2];
-	asciiCheksum[1]=NMEAparser.sentence[NMEAparser.rcvdBytesOfSentence-1];
-	unsigned int checksum;
-	sscanf(asciiCheksum,"%x",&checksum); //read as hex
-	return checksum;
+int parseGST() {
+	if(NMEAparser->fieldId!=8) return 0;
+	long latErr, lonErr, altErr;
+	if(!parseFixed(FIELD(6),3,&latErr)) return -6; //Standard deviation of latitude error in m
+	if(!parseFixed(FIELD(7),3,&lonErr)) return -7; //Standard deviation of longitude error in m
+	if(!parseFixed(FIELD(8),3,&altErr)) return -8; //Standard deviation of altitude error in m
+	int timeHour, timeMin, timeMilliSec;
+	if(parseTime(FIELD(1),&timeHour,&timeMin,&timeMilliSec)) { //the time can be empty
+		long timestamp=(timeHour*3600L+timeMin*60)*1000+timeMilliSec;
+		if(!epochTime(timestamp,timeHour,timeMin,timeMilliSec)) return 0; //the sentence is old
+	}
+	struct GPSsolution *epoch=&NMEAparser->epoch;
+	epoch->latErr=latErr;
+	epoch->lonErr=lonErr;
+	epoch->altErr=altErr;
+	epoch->content|=SOLUTION_ERRORS;
+	return 1;
 }
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 22/11/2013
+// Last change : 18/10/2026
 // Description : Parses NMEA sentences from a GPS device
 //============================================================================
 
@@ -16,7 +16,9 @@
 #define NMEA_BUFFER_SIZE         (4096*6)
 #define MAX_SENTENCE_LENGTH 255
 
-void NMEAparserProcessBuffer(unsigned char *buf, int redBytes);
+void NMEAparserInit(int source, const char *endOfBurst);
+void NMEAparserProcessBuffer(int source, unsigned char *buf, int redBytes);
+void NMEAparserLogStats(int source);
 
 
 
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 28/2/2016
+// Last change : 18/10/2026
 // Description : Navigation manager
 //============================================================================
 
@@ -26,53 +26,148 @@
 #include "FBrender.h"
 #include "HSI.h"
 #include "Ephemerides.h"
+#include "Trace.h"
+#include "TimeBase.h"
 
 
-typedef struct wp {
-	int seqNo;            //sequence number
-	char *name;           //name of the WP
-	double latitude;      //rad
-	double longitude;     //rad
-	double altitude;      //meters
-	double dist;          //distance to to this WP in rad
-	double initialCourse; //initial true course to to this WP in rad
-	double finalCourse;   //final true course to this WP in rad
-	double bisector1;     //bisector in rad between this leg and the next
-	double bisector2;     //opposite bisector to bisector1 in rad
-	double arrTimestamp;  //arrival to this WP timestamp in seconds (from h 0:00)
-	struct wp *prev;      //Pointer to the previous waypoint in the list
-	struct wp *next;      //Pointer to the next waypoint in the list
-} *wayPoint;
+#define ROUTE_MIN_SIZE  16 //waypoints of the first allocation of the route, then doubled
+#define ROUTE_NAMES_MIN 256 //bytes of the first allocation of the names
+#define ROUTE_DOUBLES   7  //arrays of doubles in the arena
+#define ROUTE_TEXT_SIZE 64 //max length of the texts read from the GPX file, names included
+
+
+struct route { //the waypoints in parallel arrays of one allocation: 0 is the departure, numWayPoints-1 the destination
+	int size;              //waypoints the arrays can hold
+	double *latitude;      //rad
+	double *longitude;     //rad
+	double *altitude;      //meters
+	double *dist;          //distance of the leg to this WP in rad, 0 for the departure
+	double *cumDist;       //distance in rad along the legs from the departure to this WP: prefix sums of dist
+	double *initialCourse; //initial true course of the leg to this WP in rad
+	double *finalCourse;   //final true course of the leg to this WP in rad
+	struct nVector *position;   //n-vector of this WP
+	struct GCleg *leg;          //the leg to this WP as n-vectors, to follow it with no trigonometry
+	struct nVector *passNormal; //normal of the bisector between the leg to this WP and the next, pointing to the next
+	long long *arrUtc;     //us from 1/1/1970 UTC of the arrival to this WP
+	int *nameOffset;       //where the name of this WP starts in names
+	char *arena;           //memory of all the arrays above
+	char *names;           //the names of the WPs one after the other
+	int namesSize, namesUsed; //bytes
+};
 
 struct NavigatorStruct {
 	enum navigatorStatus status;
 	int numWayPoints;
+	int curr;                //index of the current WP in the route
+	struct route route;
 	double trueCourse, remainDist, previousAltitude;
-	double totalDistKm, prevWPsTotDist; //Km
 	double prevWpAvgSpeed, prevTotAvgSpeed; //Km/h
-	wayPoint dept, currWP, dest;
 	char *routeLogPath;
 	FILE *routeLog;
 	double atd, trackErr, bearing;
 	double WPreaminDist,WPaverageSpeed,WPremaingTime;
 	double TotRemainDist,TotAverageSpeed,TotArrivalTime;
+	pthread_mutex_t mutex; //serializes the updates from the GPS parser with the commands from the user
 };
 
 void NavConfigure(void);
 short NavCalculateRoute(void);
 void NavFindNextWP(double lat, double lon);
-void updateDtgEteEtaAs(double atd, float timestamp, double remainDist);
+void updateDtgEteEtaAs(double atd, long long utc, double remainDist);
+void updateNavigation(double lat, double lon, double altMt, double speedKmh, long long utc);
+bool routeReserve(int size);
+int routeAddName(const char *name);
+void routeReverse(void);
+void routeFree(void);
+char* wpName(int wp);
 
 static struct NavigatorStruct Navigator = {
 	.status=NAV_STATUS_NOT_INIT,
 	.numWayPoints=0,
+	.curr=0,
+	.route={.size=0,.arena=NULL,.names=NULL,.namesSize=0,.namesUsed=0},
 	.previousAltitude=-1000,
 	.routeLog=NULL,
-	.currWP=NULL,
 	.trueCourse=0,
-	.trackErr=0
+	.trackErr=0,
+	.mutex=PTHREAD_MUTEX_INITIALIZER
 };
 
+bool routeReserve(int size) { //makes room for size waypoints keeping the ones already in the route
+	struct route *route=&Navigator.route;
+	if(size<=route->size) return true;
+	char *arena=(char*)malloc(size*(ROUTE_DOUBLES*sizeof(double)+2*sizeof(struct nVector)+sizeof(struct GCleg)+sizeof(long long)+sizeof(int)));
+	if(arena==NULL) return false;
+	double **columns[ROUTE_DOUBLES]={&route->latitude,&route->longitude,&route->altitude,&route->dist,&route->cumDist,
+			&route->initialCourse,&route->finalCourse};
+	double *column=(double*)arena;
+	for(int i=0;i<ROUTE_DOUBLES;i++,column+=size) {
+		if(Navigator.numWayPoints>0) memcpy(column,*columns[i],Navigator.numWayPoints*sizeof(double));
+		*columns[i]=column;
+	}
+	route->leg=(struct GCleg*)column; //the vectors are calculated by NavCalculateRoute(): nothing to keep
+	long long *arrUtc=(long long*)(route->leg+size);
+	if(Navigator.numWayPoints>0) memcpy(arrUtc,route->arrUtc,Navigator.numWayPoints*sizeof(long long));
+	route->arrUtc=arrUtc;
+	route->position=(struct nVector*)(arrUtc+size); //after the 8 bytes aligned columns, as they may be made of floats or ints
+	route->passNormal=route->position+size;
+	int *nameOffset=(int*)(route->passNormal+size);
+	if(Navigator.numWayPoints>0) memcpy(nameOffset,route->nameOffset,Navigator.numWayPoints*sizeof(int));
+	route->nameOffset=nameOffset;
+	free(route->arena);
+	route->arena=arena;
+	route->size=size;
+	return true;
+}
+
+int routeAddName(const char *name) { //returns the offset of the copy of the name, -1 without memory
+	struct route *route=&Navigator.route;
+	int len=strlen(name)+1;
+	if(route->namesUsed+len>route->namesSize) {
+		int size=route->namesSize>0?route->namesSize:ROUTE_NAMES_MIN;
+		while(route->namesUsed+len>size) size*=2;
+		char *names=(char*)realloc(route->names,size);
+		if(names==NULL) return -1;
+		route->names=names;
+		route->namesSize=size;
+	}
+	memcpy(route->names+route->namesUsed,name,len);
+	route->namesUsed+=len;
+	return route->namesUsed-len;
+}
+
+void routeReverse(void) { //only the waypoints: the legs are calculated again by NavCalculateRoute()
+	struct route *route=&Navigator.route;
+	for(int i=0,j=Navigator.numWayPoints-1;i<j;i++,j--) {
+		double swap=route->latitude[i];
+		route->latitude[i]=route->latitude[j];
+		route->latitude[j]=swap;
+		swap=route->longitude[i];
+		route->longitude[i]=route->longitude[j];
+		route->longitude[j]=swap;
+		swap=route->altitude[i];
+		route->altitude[i]=route->altitude[j];
+		route->altitude[j]=swap;
+		int offset=route->nameOffset[i];
+		route->nameOffset[i]=route->nameOffset[j];
+		route->nameOffset[j]=offset;
+	}
+}
+
+void routeFree(void) {
+	free(Navigator.route.arena);
+	Navigator.route.arena=NULL;
+	Navigator.route.size=0;
+	free(Navigator.route.names);
+	Navigator.route.names=NULL;
+	Navigator.route.namesSize=0;
+	Navigator.route.namesUsed=0;
+}
+
+char* wpName(int wp) {
+	return Navigator.route.names+Navigator.route.nameOffset[wp];
+}
+
 void NavConfigure(void) {
 	int oldStatus=Navigator.status;
 	Navigator.status=NAV_STATUS_NAV_BUSY;
@@ -85,29 +180,28 @@ void NavConfigure(void) {
 short NavCalculateRoute(void) {
 	if(Navigator.status==NAV_STATUS_NO_ROUTE_SET) Navigator.status=NAV_STATUS_NAV_BUSY;
 	else if(Navigator.status!=NAV_STATUS_NAV_BUSY) return -1;
-	if(Navigator.dept!=NULL) {
-		if(Navigator.numWayPoints>1) {
-				if(Navigator.dept->next==NULL) return -3;
-		} else if(Navigator.numWayPoints!=1) return -4;
-	} else return -5;
-	Navigator.totalDistKm=0;
-	Navigator.prevWPsTotDist=0;
-	Navigator.dest=Navigator.currWP;
-	calcFlightPlanEphemerides(Navigator.dest->latitude,Navigator.dest->longitude,false);
+	if(Navigator.numWayPoints<1) return -5;
+	struct route *route=&Navigator.route;
+	int dest=Navigator.numWayPoints-1;
+	route->dist[0]=0;
+	route->cumDist[0]=0;
+	for(int i=0;i<=dest;i++) latLon2nVector(route->latitude[i],route->longitude[i],&route->position[i]);
+	calcFlightPlanEphemerides(route->latitude[dest],route->longitude[dest],false);
 	if(Navigator.numWayPoints>1) {
-		Navigator.currWP=Navigator.dept->next;
-		do {
-			Navigator.currWP->initialCourse=calcGreatCircleRoute(Navigator.currWP->prev->latitude,Navigator.currWP->prev->longitude,Navigator.currWP->latitude,Navigator.currWP->longitude,&Navigator.currWP->dist);
-			Navigator.currWP->finalCourse=calcGreatCircleFinalCourse(Navigator.currWP->prev->latitude,Navigator.currWP->prev->longitude,Navigator.currWP->latitude,Navigator.currWP->longitude);
-			double remainDistance=Rad2Km(Navigator.currWP->dist);
-			Navigator.totalDistKm+=remainDistance;
-			fprintf(Navigator.routeLog,"* Travel from %s to %s\n",Navigator.currWP->prev->name,Navigator.currWP->name);
-			fprintf(Navigator.routeLog,"Initial course to WP: %07.3f°\n",Rad2Deg(Navigator.currWP->initialCourse));
-			fprintf(Navigator.routeLog,"Final   course to WP: %07.3f°\n",Rad2Deg(Navigator.currWP->finalCourse));
+		for(int i=1;i<=dest;i++) {
+			calcGCleg(route->latitude[i-1],route->longitude[i-1],route->latitude[i],route->longitude[i],&route->leg[i]);
+			route->dist[i]=route->leg[i].dist;
+			route->initialCourse[i]=calcNvectorCourse(&route->position[i-1],&route->position[i]);
+			route->finalCourse[i]=absAngle(calcNvectorCourse(&route->position[i],&route->position[i-1])+M_PI);
+			route->cumDist[i]=route->cumDist[i-1]+route->dist[i];
+			double remainDistance=Rad2Km(route->dist[i]);
+			fprintf(Navigator.routeLog,"* Travel from %s to %s\n",wpName(i-1),wpName(i));
+			fprintf(Navigator.routeLog,"Initial course to WP: %07.3f°\n",Rad2Deg(route->initialCourse[i]));
+			fprintf(Navigator.routeLog,"Final   course to WP: %07.3f°\n",Rad2Deg(route->finalCourse[i]));
 			fprintf(Navigator.routeLog,"Horizontal distance to WP is: %.3f Km\n",remainDistance);
-			if(Navigator.currWP->prev!=Navigator.dept) calcBisector(Navigator.currWP->prev->finalCourse,Navigator.currWP->initialCourse,&Navigator.currWP->prev->bisector1,&Navigator.currWP->prev->bisector2); //calc bisectors for prev WP
+			if(i>1) calcBisectorNormal(&route->position[i-1],&route->leg[i-1],&route->leg[i],&route->passNormal[i-1]); //calc bisector for prev WP
 			double timeHours=remainDistance/config.cruiseSpeed; //hours
-			if(Navigator.currWP==Navigator.dept->next) {
+			if(i==1) {
 				Navigator.WPreaminDist=remainDistance;
 				Navigator.WPaverageSpeed=config.cruiseSpeed;
 				Navigator.WPremaingTime=timeHours;
@@ -116,35 +210,36 @@ short NavCalculateRoute(void) {
 			float secs;
 			convertDecimal2DegMinSec(timeHours,&hours,&mins,&secs);
 			fprintf(Navigator.routeLog,"Flight time to WP: %2d:%02d:%02d\n",hours,mins,(int)secs);
-			fprintf(Navigator.routeLog,"Initial altitude: %.0f m  %.0f Ft\n",Navigator.currWP->prev->altitude,m2Ft(Navigator.currWP->prev->altitude));
-			fprintf(Navigator.routeLog,"Final altitude: %.0f m  %.0f Ft\n",Navigator.currWP->altitude,m2Ft(Navigator.currWP->altitude));
-			double altDiff=Navigator.currWP->altitude-Navigator.currWP->prev->altitude;
+			fprintf(Navigator.routeLog,"Initial altitude: %.0f m  %.0f Ft\n",route->altitude[i-1],m2Ft(route->altitude[i-1]));
+			fprintf(Navigator.routeLog,"Final altitude: %.0f m  %.0f Ft\n",route->altitude[i],m2Ft(route->altitude[i]));
+			double altDiff=route->altitude[i]-route->altitude[i-1];
 			double slope=altDiff/1000/remainDistance;
 			fprintf(Navigator.routeLog,"Slope: %.2f %%\n",slope*100);
 			double climb=altDiff/(timeHours*3600); // m/s
 			fprintf(Navigator.routeLog,"Estimated climb rate: %.2f m/s  %.0f Ft/min\n\n",climb,ms2FtMin(climb)); //just to have an idea
-			Navigator.currWP=Navigator.currWP->next;
-		} while(Navigator.currWP!=NULL);
-		fprintf(Navigator.routeLog,"TOTAL distance from departure along all WPs to Navigator.destination is: %.3f Km\n",Navigator.totalDistKm);
-		Navigator.trueCourse=Navigator.dept->next->initialCourse;
-		double totalTimeHours=Navigator.totalDistKm/config.cruiseSpeed;
+		}
+		double totalDistKm=Rad2Km(route->cumDist[dest]);
+		fprintf(Navigator.routeLog,"TOTAL distance from departure along all WPs to Navigator.destination is: %.3f Km\n",totalDistKm);
+		Navigator.trueCourse=route->initialCourse[1];
+		double totalTimeHours=totalDistKm/config.cruiseSpeed;
 		int hours,mins;
 		float secs;
 		convertDecimal2DegMinSec(totalTimeHours,&hours,&mins,&secs);
 		fprintf(Navigator.routeLog,"TOTAL flight time: %2d:%02d:%02d\n",hours,mins,(int)secs);
-		pthread_mutex_lock(&gps.mutex);
-		Navigator.TotArrivalTime=gps.timestamp;
-		pthread_mutex_unlock(&gps.mutex);
-		if(Navigator.TotArrivalTime<0) Navigator.TotArrivalTime=getCurrentTime(); //In this case we don't have the time from GPS so we take it from the internal clock
-		Navigator.TotArrivalTime=Navigator.TotArrivalTime/3600+totalTimeHours; //hours, in order to obtain the ETA
-		Navigator.TotRemainDist=Navigator.totalDistKm;
+		struct GPSdata gpsData;
+		GPSgetData(&gpsData);
+		long long utc=gpsData.utc!=0?gpsData.utc:TimeBaseNow(); //without the time from GPS take the one of the RTC
+		Navigator.TotArrivalTime=TimeBaseDayMs(utc)/3600000.0+totalTimeHours; //hours, in order to obtain the ETA
+		Navigator.TotRemainDist=totalDistKm;
 		Navigator.TotAverageSpeed=config.cruiseSpeed;
 		double fuelNeeded=config.fuelConsumption*totalTimeHours;
 		fprintf(Navigator.routeLog,"TOTAL fuel needed: %.2f liters\n\n",fuelNeeded);
-		calcFlightPlanEphemerides(Navigator.dept->latitude,Navigator.dept->longitude,true);
-		Navigator.currWP=Navigator.dept->next;
-	} else //Navigator.numWayPoints==1
-		fprintf(Navigator.routeLog,"* Route with only one waypoint: %s\n",Navigator.currWP->name);
+		calcFlightPlanEphemerides(route->latitude[0],route->longitude[0],true);
+		Navigator.curr=1;
+	} else { //Navigator.numWayPoints==1
+		fprintf(Navigator.routeLog,"* Route with only one waypoint: %s\n",wpName(0));
+		Navigator.curr=0;
+	}
 	if(Navigator.routeLog!=NULL) fclose(Navigator.routeLog); //Close the route log file when not needed
 	Navigator.status=NAV_STATUS_TO_START_NAV;
 	return 1;
@@ -171,7 +266,6 @@ int NavLoadFlightPlan(char* GPXfile) {
 		printLog("ERROR no such file '%s'\n",GPXfile);
 		return -4;
 	}
-	char* text=NULL;
 	//TODO: here we load just the first route may be there are others routes in the GPX file...
 	node_t* route=roxml_get_chld(root,"rte",0);
 	if(route==NULL) {
@@ -188,36 +282,31 @@ int NavLoadFlightPlan(char* GPXfile) {
 		roxml_close(root);
 		return 0;
 	}
-	int wpcounter=0,i;
+	if(!routeReserve(total)) { //all the points at once, also for long routes
+		printLog("ERROR not enough memory for %d waypoints.\n",total);
+		roxml_release(RELEASE_ALL);
+		roxml_close(root);
+		return -6;
+	}
+	int wpcounter=0;
 	node_t* node;
 	double latX,lonX,altX;
-	for(i=0;i<total;i++) {
-		wp=roxml_get_chld(route,NULL,i);
-		text=roxml_get_name(wp,NULL,0);
-		if(strcmp(text,"rtept")==0) {
+	char value[ROUTE_TEXT_SIZE],name[ROUTE_TEXT_SIZE]; //given to libroxml, otherwise it allocates a buffer for each text until the release
+	for(wp=roxml_get_chld(route,NULL,0);wp!=NULL;wp=roxml_get_next_sibling(wp)) { //by siblings: by index would be quadratic
+		if(strcmp(roxml_get_name(wp,value,ROUTE_TEXT_SIZE),"rtept")==0) {
 			wpcounter++;
 			node=roxml_get_attr(wp,"lat",0);
-			if(node!=NULL) {
-				text=roxml_get_content(node,NULL,0,NULL);
-				latX=atof(text);
-			} else break; //WP without latitude, skip it
+			if(node!=NULL) latX=atof(roxml_get_content(node,value,ROUTE_TEXT_SIZE,NULL));
+			else break; //WP without latitude, skip it
 			node=roxml_get_attr(wp,"lon",0);
-			if(node!=NULL) {
-				text=roxml_get_content(node,NULL,0,NULL);
-				lonX=atof(text);
-			} else break; //WP without longitude, skip it
+			if(node!=NULL) lonX=atof(roxml_get_content(node,value,ROUTE_TEXT_SIZE,NULL));
+			else break; //WP without longitude, skip it
 			node=roxml_get_chld(wp,"ele",0);
-			if(node!=NULL) {
-				text=roxml_get_content(node,NULL,0,NULL);
-				if(text!=NULL) altX=atof(text);
-				else altX=0;
-			} else altX=0; //WP altitude missing we put it to 0
+			if(node!=NULL) altX=atof(roxml_get_content(node,value,ROUTE_TEXT_SIZE,NULL)); //0 if empty
+			else altX=0; //WP altitude missing we put it to 0
 			node=roxml_get_chld(wp,"name",0);
-			if(node!=NULL) {
-				text=roxml_get_content(node,NULL,0,NULL);
-				if(text==NULL) asprintf(&text,"Unamed WP %d",wpcounter);
-			} else asprintf(&text,"Unamed WP %d",wpcounter);
-			NavAddWayPoint(Deg2Rad(latX),Deg2Rad(-lonX),altX,text); //East longitudes are positive according to the GPX standard
+			if(node==NULL || roxml_get_content(node,name,ROUTE_TEXT_SIZE,NULL)[0]=='\0') snprintf(name,ROUTE_TEXT_SIZE,"Unamed WP %d",wpcounter);
+			NavAddWayPoint(Deg2Rad(latX),Deg2Rad(-lonX),altX,name); //East longitudes are positive according to the GPX standard
 		}
 	}
 	roxml_release(RELEASE_ALL);
@@ -232,43 +321,22 @@ int NavLoadFlightPlan(char* GPXfile) {
 
 void NavAddWayPoint(double latWP, double lonWP, double altWPmt, char *WPname) {
 	if(Navigator.status!=NAV_STATUS_NO_ROUTE_SET) return;
-	wayPoint newWP;
-	newWP=(wayPoint)malloc(sizeof(struct wp));
-	newWP->name=strdup(WPname);
-	newWP->latitude=latWP;
-	newWP->longitude=lonWP;
-	newWP->altitude=altWPmt;
-	newWP->next=NULL;
-	if(Navigator.numWayPoints==0) { //its's the first
-		Navigator.dept=newWP;
-		newWP->prev=NULL;
-	} else {
-		Navigator.currWP->next=newWP;
-		newWP->prev=Navigator.currWP; //link to the previous
-	}
-	Navigator.currWP=newWP;
-	newWP->seqNo=Navigator.numWayPoints++;
+	struct route *route=&Navigator.route;
+	if(Navigator.numWayPoints==route->size && !routeReserve(route->size>0?route->size*2:ROUTE_MIN_SIZE)) return;
+	int nameOffset=routeAddName(WPname);
+	if(nameOffset<0) return;
+	int i=Navigator.numWayPoints++;
+	route->latitude[i]=latWP;
+	route->longitude[i]=lonWP;
+	route->altitude[i]=altWPmt;
+	route->nameOffset[i]=nameOffset;
+	route->arrUtc[i]=0;
 }
 
 int NavReverseRoute(void) {
 	if(Navigator.status==NAV_STATUS_NAV_BUSY || Navigator.status==NAV_STATUS_NO_ROUTE_SET || Navigator.numWayPoints<2) return 0;
 	Navigator.status=NAV_STATUS_NAV_BUSY;
-	Navigator.dest=Navigator.dept;
-	Navigator.currWP=Navigator.dept;
-	wayPoint next;
-	int i=Navigator.numWayPoints-1;
-	while(Navigator.currWP->next!=NULL) {
-		Navigator.currWP->seqNo=i--;
-		next=Navigator.currWP->next;
-		Navigator.currWP->next=Navigator.currWP->prev;
-		Navigator.currWP->prev=next;
-		Navigator.currWP=next;
-	}
-	Navigator.currWP->seqNo=0;
-	Navigator.currWP->next=Navigator.currWP->prev;
-	Navigator.currWP->prev=NULL;
-	Navigator.dept=Navigator.currWP;
-	Navigator.currWP=Navigator.dest;
+	routeReverse();
 	Navigator.routeLog=fopen(Navigator.routeLogPath,"a+"); //Reopen the route log file to write about the reversed route
 	if(Navigator.routeLog==NULL) {
 		printLog("ERROR not possible to write the route log file.\n");
@@ -284,19 +352,12 @@ int NavReverseRoute(void) {
 	return 1;
 }
 
-void NavClearRoute(void) {
+void NavClearRoute(void) { //the memory of the route is kept for the next one
+	pthread_mutex_lock(&Navigator.mutex);
 	Navigator.status=NAV_STATUS_NAV_BUSY;
-	if(Navigator.numWayPoints!=0) {
-		do {
-			Navigator.currWP=Navigator.dept;
-			free(Navigator.currWP->name);
-			Navigator.currWP->name=NULL;
-			Navigator.dept=Navigator.currWP->next;
-			free(Navigator.currWP);
-			Navigator.currWP=NULL;
-		} while(Navigator.dept!=NULL);
-		Navigator.numWayPoints=0;
-	}
+	Navigator.numWayPoints=0;
+	Navigator.route.namesUsed=0;
+	Navigator.curr=0;
 	Navigator.trueCourse=0;
 	Navigator.trackErr=0;
 	Navigator.remainDist=-1;
@@ -306,102 +367,113 @@ void NavClearRoute(void) {
 	free(Navigator.routeLogPath);
 	Navigator.routeLogPath=NULL;
 	Navigator.status=NAV_STATUS_NO_ROUTE_SET;
+	pthread_mutex_unlock(&Navigator.mutex);
 }
 
 void NavClose(void) {
 	NavClearRoute();
+	routeFree();
 	Navigator.status=NAV_STATUS_NOT_INIT;
 }
 
 void NavFindNextWP(double lat, double lon) {
 	if(Navigator.status!=NAV_STATUS_TO_START_NAV && Navigator.status!=NAV_STATUS_WAIT_FIX) return;
+	struct route *route=&Navigator.route;
+	int dest=Navigator.numWayPoints-1;
 	if(Navigator.numWayPoints==1) {
-		Navigator.currWP=Navigator.dest;
+		Navigator.curr=dest;
 		Navigator.status=NAV_STATUS_NAV_TO_SINGLE_WP;
 		return;
 	}
-	wayPoint i, nearest=Navigator.dept;
-	double shortestDist=calcAngularDist(lat,lon,Navigator.dept->latitude,Navigator.dept->longitude);
-	for(i=Navigator.dept->next;i!=NULL;i=i->next) { //searching the nearest
-		double distance=calcAngularDist(lat,lon,i->latitude,i->longitude);
+	int nearest=0;
+	double shortestDist=calcAngularDist(lat,lon,route->latitude[0],route->longitude[0]);
+	for(int i=1;i<=dest;i++) { //searching the nearest
+		double distance=calcAngularDist(lat,lon,route->latitude[i],route->longitude[i]);
 		if(distance<=shortestDist) {
 			shortestDist=distance;
 			nearest=i;
 		}
 	}
-	printLog("\nNearest waypoint is: %s No: %d at %f Km\n",nearest->name,nearest->seqNo,Rad2Km(shortestDist));
-	if(nearest==Navigator.dest) {
-		if(Navigator.dept->latitude==Navigator.dest->latitude && Navigator.dept->longitude==Navigator.dest->longitude) { //Navigator.dept and Navigator.dest are the same place
-			if(calcAngularDist(lat,lon,Navigator.dept->latitude,Navigator.dept->longitude)<m2Rad(config.deptDistTolerance)) Navigator.currWP=Navigator.dept->next;
-			else Navigator.currWP=Navigator.dest;
-		} else Navigator.currWP=Navigator.dest;
-	} else { //The nearest WP isn't the Navigator.destination
-		if(calcAngularDist(lat,lon,nearest->next->latitude,nearest->next->longitude)<=nearest->next->dist) Navigator.currWP=nearest->next;
-		else Navigator.currWP=nearest;
+	printLog("\nNearest waypoint is: %s No: %d at %f Km\n",wpName(nearest),nearest,Rad2Km(shortestDist));
+	if(nearest==dest) {
+		if(route->latitude[0]==route->latitude[dest] && route->longitude[0]==route->longitude[dest]) { //departure and destination are the same place
+			if(calcAngularDist(lat,lon,route->latitude[0],route->longitude[0])<m2Rad(config.deptDistTolerance)) Navigator.curr=1;
+			else Navigator.curr=dest;
+		} else Navigator.curr=dest;
+	} else { //The nearest WP isn't the destination
+		if(calcAngularDist(lat,lon,route->latitude[nearest+1],route->longitude[nearest+1])<=route->dist[nearest+1]) Navigator.curr=nearest+1;
+		else Navigator.curr=nearest;
 	}
-	if(Navigator.currWP==Navigator.dept) {
-		if(calcAngularDist(lat,lon,Navigator.dept->latitude,Navigator.dept->longitude)<m2Rad(config.deptDistTolerance)) { //we are near the dpt
-			Navigator.currWP=Navigator.dept->next;
+	if(Navigator.curr==0) {
+		if(calcAngularDist(lat,lon,route->latitude[0],route->longitude[0])<m2Rad(config.deptDistTolerance)) { //we are near the dpt
+			Navigator.curr=1;
 			Navigator.status=NAV_STATUS_NAV_TO_WPT;
 		} else Navigator.status=NAV_STATUS_NAV_TO_DPT; //we have still to go to the departure
 	} else { //we are not traveling to the departure
-		if(Navigator.currWP->seqNo>1) { //  //Navigator.currWP->prev!=Navigator.dept  if we aren't traveling direcly from the departure
-			Navigator.prevWPsTotDist=0;
-			for(i=Navigator.dept->next;i!=Navigator.currWP;i=i->next) Navigator.prevWPsTotDist+=i->dist;
-			Navigator.prevWPsTotDist=Rad2Km(Navigator.prevWPsTotDist);
-			Navigator.currWP->prev->arrTimestamp=Navigator.dept->arrTimestamp+(Navigator.prevWPsTotDist/config.cruiseSpeed)*3600; //ETA to the previous WP, adding the time to reach the previous WP
-		}
+		if(Navigator.curr>1) //if we aren't traveling direcly from the departure: ETA to the previous WP, adding the time to reach it along the legs
+			route->arrUtc[Navigator.curr-1]=route->arrUtc[0]+(long long)(Rad2Km(route->cumDist[Navigator.curr-1])/config.cruiseSpeed*3600e6);
 		Navigator.status=NAV_STATUS_NAV_TO_WPT;
 	}
-	if(Navigator.currWP==Navigator.dest) Navigator.status=NAV_STATUS_NAV_TO_DST;
-	printLog("Next waypoint is: %s\n\n\n",Navigator.currWP->name);
+	if(Navigator.curr==dest) Navigator.status=NAV_STATUS_NAV_TO_DST;
+	printLog("Next waypoint is: %s\n\n\n",wpName(Navigator.curr));
 }
 
 void NavStartNavigation() {
-	if(Navigator.status!=NAV_STATUS_TO_START_NAV) return;
-	pthread_mutex_lock(&gps.mutex);
-	float timestamp=gps.timestamp; //timestamp is the real time when we start the travel try to get it from GPS
-	if(timestamp==-1) timestamp=getCurrentTime(); //if not valid get it from internal clock
-	if(timestamp<0) {
-		pthread_mutex_unlock(&gps.mutex);
+	struct GPSdata gpsData;
+	GPSgetData(&gpsData);
+	long long utc=gpsData.utc; //the real time when we start the travel, try to get it from GPS
+	if(utc==0) utc=TimeBaseNow(); //if not valid get it from the RTC
+	pthread_mutex_lock(&Navigator.mutex);
+	if(Navigator.status!=NAV_STATUS_TO_START_NAV) {
+		pthread_mutex_unlock(&Navigator.mutex);
 		return;
 	}
-	if(gps.fixMode>MODE_NO_FIX && gps.lat!=100) { //if have fix give immediately the position to the nav. The lat!=100 is just to avoid the case of having fix but still not a position stored
-		NavFindNextWP(gps.lat,gps.lon);
-		if(Navigator.status==NAV_STATUS_NAV_TO_WPT || Navigator.status==NAV_STATUS_NAV_TO_DST || Navigator.status==NAV_STATUS_NAV_TO_SINGLE_WP) Navigator.dept->arrTimestamp=timestamp; //record the starting time for whole route
-		NavUpdatePosition(gps.lat,gps.lon,gps.realAltMt,gps.speedKmh,timestamp);
+	if(gpsData.fixMode>MODE_NO_FIX && gpsData.pos.lat!=GEO_NO_POS) { //if have fix give immediately the position to the nav. The GEO_NO_POS is just to avoid the case of having fix but still not a position stored
+		double lat=geoLat2rad(gpsData.pos.lat), lon=geoLon2rad(gpsData.pos.lon);
+		NavFindNextWP(lat,lon);
+		if(Navigator.status==NAV_STATUS_NAV_TO_WPT || Navigator.status==NAV_STATUS_NAV_TO_DST || Navigator.status==NAV_STATUS_NAV_TO_SINGLE_WP) Navigator.route.arrUtc[0]=utc; //record the starting time for whole route
+		updateNavigation(lat,lon,gpsData.realAltMt,gpsData.speedKmh,utc);
 	} else {
-		if(Navigator.numWayPoints>1) Navigator.currWP=Navigator.dept->next;
-		else Navigator.currWP=Navigator.dest;
+		if(Navigator.numWayPoints>1) Navigator.curr=1;
+		else Navigator.curr=Navigator.numWayPoints-1;
 		Navigator.status=NAV_STATUS_WAIT_FIX;
 	}
-	pthread_mutex_unlock(&gps.mutex);
+	pthread_mutex_unlock(&Navigator.mutex);
 }
 
-void updateDtgEteEtaAs(double atd, float timestamp, double remainDist) {
-	if(timestamp>Navigator.currWP->prev->arrTimestamp) { //to avoid infinite, null or negative speed and time
+void updateDtgEteEtaAs(double atd, long long utc, double remainDist) {
+	if(utc>Navigator.route.arrUtc[Navigator.curr-1]) { //to avoid infinite, null or negative speed and time
 		Navigator.WPreaminDist=Rad2Km(remainDist); //Km
 		if(atd>=0) {
-			Navigator.WPaverageSpeed=ms2Kmh(Rad2m(atd)/(timestamp-Navigator.currWP->prev->arrTimestamp));
+			Navigator.WPaverageSpeed=ms2Kmh(Rad2m(atd)/((utc-Navigator.route.arrUtc[Navigator.curr-1])*1e-6));
 			Navigator.prevWpAvgSpeed=Navigator.WPaverageSpeed;
 		} else Navigator.WPaverageSpeed=Navigator.prevWpAvgSpeed; //with negative ATDs we estimate using previous average speed
 		Navigator.WPremaingTime=Navigator.WPreaminDist/Navigator.WPaverageSpeed; //ETE (remaining time) in hours
 		if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavRemainingDistWP(Navigator.WPreaminDist,Navigator.WPaverageSpeed,Navigator.WPremaingTime);
 	}
-	if(timestamp>Navigator.dept->arrTimestamp) {
-		double totCoveredDistKm=Navigator.prevWPsTotDist+Rad2Km(atd);
+	if(utc>Navigator.route.arrUtc[0]) {
+		double totCoveredDistKm=Rad2Km(Navigator.route.cumDist[Navigator.curr]-Navigator.route.dist[Navigator.curr]+atd); //from the departure to the previous WP, then along the leg
 		if(atd>=0) {
-			Navigator.TotAverageSpeed=ms2Kmh((totCoveredDistKm*1000)/(timestamp-Navigator.dept->arrTimestamp)); //Km/h
+			Navigator.TotAverageSpeed=ms2Kmh((totCoveredDistKm*1000)/((utc-Navigator.route.arrUtc[0])*1e-6)); //Km/h
 			Navigator.prevTotAvgSpeed=Navigator.TotAverageSpeed;
 		} else Navigator.TotAverageSpeed=Navigator.prevTotAvgSpeed;
-		Navigator.TotRemainDist=Navigator.totalDistKm-totCoveredDistKm; //Km
+		Navigator.TotRemainDist=Rad2Km(Navigator.route.cumDist[Navigator.numWayPoints-1])-totCoveredDistKm; //Km
 		Navigator.TotArrivalTime=Navigator.TotRemainDist/Navigator.TotAverageSpeed; //hours
-		Navigator.TotArrivalTime+=timestamp/3600; //hours, in order to obtain the ETA
+		Navigator.TotArrivalTime+=TimeBaseDayMs(utc)/3600000.0; //hours, in order to obtain the ETA
 		if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavRemainingDistDST(Navigator.TotRemainDist,Navigator.TotAverageSpeed,Navigator.TotArrivalTime);
 	}
 }
 
-void NavUpdatePosition(double lat, double lon, double altMt, double speedKmh, float timestamp) {
+void NavUpdatePosition(const struct GeoPosition *pos, double altMt, double speedKmh, long long utc) { //called by the GPS parser for each new position
+	TRACE_BEGIN(TRACE_NAV_UPDATE);
+	double lat=geoLat2rad(pos->lat), lon=geoLon2rad(pos->lon); //the only conversion of the fix, for the trigonometry
+	pthread_mutex_lock(&Navigator.mutex);
+	updateNavigation(lat,lon,altMt,speedKmh,utc);
+	pthread_mutex_unlock(&Navigator.mutex);
+	TRACE_END(TRACE_NAV_UPDATE);
+}
+
+void updateNavigation(double lat, double lon, double altMt, double speedKmh, long long utc) { //the mutex of the navigator must be held
 	//TODO: somwhere here update ephemerides
 	switch(Navigator.status) {
 		case NAV_STATUS_NOT_INIT:
@@ -412,99 +484,98 @@ void NavUpdatePosition(double lat, double lon, double altMt, double speedKmh, fl
 			if(Navigator.previousAltitude==-1000) Navigator.previousAltitude=altMt;
 			else if(altMt-Navigator.previousAltitude>config.takeOffdiffAlt && speedKmh>config.stallSpeed) { //in this case start the navigation
 				NavFindNextWP(lat,lon);
-				if(Navigator.status==NAV_STATUS_NAV_TO_WPT || Navigator.status==NAV_STATUS_NAV_TO_DST || Navigator.status==NAV_STATUS_NAV_TO_SINGLE_WP) Navigator.dept->arrTimestamp=timestamp; //record the starting time for whole route
-				NavUpdatePosition(lat,lon,altMt,speedKmh,timestamp); //recursive call
-				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavStatus(Navigator.status,Navigator.currWP->name);
+				if(Navigator.status==NAV_STATUS_NAV_TO_WPT || Navigator.status==NAV_STATUS_NAV_TO_DST || Navigator.status==NAV_STATUS_NAV_TO_SINGLE_WP) Navigator.route.arrUtc[0]=utc; //record the starting time for whole route
+				updateNavigation(lat,lon,altMt,speedKmh,utc); //recursive call
+				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavStatus(Navigator.status,wpName(Navigator.curr));
 				break;
 			}
-			if(Navigator.numWayPoints>1) Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.dept->next->latitude,Navigator.dept->next->longitude,&Navigator.remainDist); //calc just course and distance
-			else Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.dest->latitude,Navigator.dest->longitude,&Navigator.remainDist); //numWayPoint==1
+			if(Navigator.numWayPoints>1) Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.route.latitude[1],Navigator.route.longitude[1],&Navigator.remainDist); //calc just course and distance
+			else Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.route.latitude[Navigator.numWayPoints-1],Navigator.route.longitude[Navigator.numWayPoints-1],&Navigator.remainDist); //numWayPoint==1
 			if(getMainStatus()==MAIN_DISPLAY_HSI) {
 				PrintNavDTG(Navigator.remainDist);
 				HSIupdateCDI(Rad2Deg(Navigator.bearing),0,false,0);
 			}
 			break;
 		case NAV_STATUS_NAV_TO_DPT: //we are still going to the departure point
-			Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.dept->latitude,Navigator.dept->longitude,&Navigator.remainDist); //calc just course and distance
+			Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.route.latitude[0],Navigator.route.longitude[0],&Navigator.remainDist); //calc just course and distance
 			if(getMainStatus()==MAIN_DISPLAY_HSI) {
 				PrintNavDTG(Navigator.remainDist);
 				HSIupdateCDI(Rad2Deg(Navigator.bearing),0,false,0);
 			}
 			if(Navigator.remainDist<m2Rad(config.deptDistTolerance)) {
-				Navigator.currWP=Navigator.dept->next;
-				Navigator.dept->arrTimestamp=timestamp; //here we record the starting time for whole route
-				if(Navigator.currWP!=Navigator.dest) Navigator.status=NAV_STATUS_NAV_TO_WPT;
+				Navigator.curr=1;
+				Navigator.route.arrUtc[0]=utc; //here we record the starting time for whole route
+				if(Navigator.curr!=Navigator.numWayPoints-1) Navigator.status=NAV_STATUS_NAV_TO_WPT;
 				else Navigator.status=NAV_STATUS_NAV_TO_DST; //Next WP is already the final Navigator.destination
-				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavStatus(Navigator.status,Navigator.currWP->name);
-				NavUpdatePosition(lat,lon,altMt,speedKmh,timestamp); //recursive call
+				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavStatus(Navigator.status,wpName(Navigator.curr));
+				updateNavigation(lat,lon,altMt,speedKmh,utc); //recursive call
 			}
 			break;
 		case NAV_STATUS_NAV_TO_WPT: {
-			Navigator.trackErr=Rad2m(calcGCCrossTrackError(Navigator.currWP->prev->latitude,Navigator.currWP->prev->longitude,Navigator.currWP->longitude,lat,lon,Navigator.currWP->initialCourse,&Navigator.atd));
-			if(Navigator.atd>=0) Navigator.remainDist=Navigator.currWP->dist-Navigator.atd;
-			else Navigator.remainDist=Navigator.currWP->dist+fabs(Navigator.atd); //negative ATD: we are still before the prev WP
-			//TODO: Need to check here, the bearing can be taken from here...
-			Navigator.bearing=calcGreatCircleCourse(lat,lon,Navigator.currWP->latitude,Navigator.currWP->longitude); //Find the direct direction to curr WP (needed to check if we passed the bisector)
-			if(Navigator.atd>=0 && (Navigator.atd>=Navigator.currWP->dist || bisectorOverpassed(Navigator.currWP->finalCourse,Navigator.bearing,Navigator.currWP->bisector1,Navigator.currWP->bisector2))) { //consider this WP as reached
-				Navigator.currWP->arrTimestamp=timestamp;
-				Navigator.prevWPsTotDist+=Rad2Km(Navigator.currWP->dist);
-				Navigator.currWP=Navigator.currWP->next;
-				if(Navigator.currWP==Navigator.dest) Navigator.status=NAV_STATUS_NAV_TO_DST; //Next WP is the final Navigator.destination
-				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavStatus(Navigator.status,Navigator.currWP->name);
-				NavUpdatePosition(lat,lon,altMt,speedKmh,timestamp); //Recursive call on the new WayPoint
+			struct route *route=&Navigator.route;
+			int wp=Navigator.curr;
+			struct nVector position;
+			latLon2nVector(lat,lon,&position);
+			Navigator.trackErr=Rad2m(calcLegCrossTrackError(&route->leg[wp],&position,&Navigator.atd));
+			if(Navigator.atd>=0) Navigator.remainDist=route->dist[wp]-Navigator.atd;
+			else Navigator.remainDist=route->dist[wp]+fabs(Navigator.atd); //negative ATD: we are still before the prev WP
+			Navigator.bearing=calcNvectorCourse(&position,&route->position[wp]); //Find the direct direction to curr WP
+			if(Navigator.atd>=0 && (Navigator.atd>=route->dist[wp] || bisectorPassed(&route->passNormal[wp],&position))) { //consider this WP as reached
+				route->arrUtc[wp]=utc;
+				Navigator.curr++;
+				if(Navigator.curr==Navigator.numWayPoints-1) Navigator.status=NAV_STATUS_NAV_TO_DST; //Next WP is the final Navigator.destination
+				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavStatus(Navigator.status,wpName(Navigator.curr));
+				updateNavigation(lat,lon,altMt,speedKmh,utc); //Recursive call on the new WayPoint
 				return;
 			} //else the WP or bisector is still not reached...
-			if(fabs(Navigator.trackErr)>config.trackErrorTolearnce) { //if we have bigger error
-				double latI,lonI; //the perpendicular point on the route
-				calcIntermediatePoint(Navigator.currWP->prev->latitude,Navigator.currWP->prev->longitude,Navigator.currWP->latitude,Navigator.currWP->longitude,Navigator.atd,Navigator.currWP->dist,&latI,&lonI);
-				Navigator.trueCourse=calcGreatCircleCourse(latI,lonI,Navigator.currWP->latitude,Navigator.currWP->longitude);
-			} else Navigator.trueCourse=Navigator.bearing; //with small error the bearing is fine enough
+			if(fabs(Navigator.trackErr)>config.trackErrorTolearnce) Navigator.trueCourse=calcLegCourseAbeam(&route->leg[wp],&position); //if we have bigger error: the course of the route at the perpendicular point
+			else Navigator.trueCourse=Navigator.bearing; //with small error the bearing is fine enough
 			if(getMainStatus()==MAIN_DISPLAY_HSI) {
 				HSIupdateCDI(Rad2Deg(Navigator.trueCourse),Navigator.trackErr,true,Rad2Deg(Navigator.bearing));
 				PrintNavTrackATD(Navigator.atd);
-				if(Navigator.atd>=0) HSIupdateVSI(m2Ft((Navigator.currWP->altitude-Navigator.currWP->prev->altitude)/Navigator.currWP->dist*Navigator.atd+Navigator.currWP->prev->altitude));
+				if(Navigator.atd>=0) HSIupdateVSI(m2Ft((route->altitude[wp]-route->altitude[wp-1])/route->dist[wp]*Navigator.atd+route->altitude[wp-1]));
 			}
-			updateDtgEteEtaAs(Navigator.atd,timestamp,Navigator.remainDist);
+			updateDtgEteEtaAs(Navigator.atd,utc,Navigator.remainDist);
 		} break;
 		case NAV_STATUS_NAV_TO_DST: {
+			struct route *route=&Navigator.route;
+			int wp=Navigator.curr;
+			struct nVector position;
+			latLon2nVector(lat,lon,&position);
 			double atd, trackErr;
-			trackErr=Rad2m(calcGCCrossTrackError(Navigator.currWP->prev->latitude,Navigator.currWP->prev->longitude,Navigator.currWP->longitude,lat,lon,Navigator.currWP->initialCourse,&atd));
-			if(atd>=0) Navigator.remainDist=Navigator.currWP->dist-atd;
-			else Navigator.remainDist=Navigator.currWP->dist+fabs(atd); //negative ATD: we are still before the prev WP
-			if(atd>=Navigator.currWP->dist) { //consider Navigator.destination as reached (90 degrees bisector)
-				Navigator.currWP->arrTimestamp=timestamp;
+			trackErr=Rad2m(calcLegCrossTrackError(&route->leg[wp],&position,&atd));
+			if(atd>=0) Navigator.remainDist=route->dist[wp]-atd;
+			else Navigator.remainDist=route->dist[wp]+fabs(atd); //negative ATD: we are still before the prev WP
+			if(atd>=route->dist[wp]) { //consider Navigator.destination as reached (90 degrees bisector)
+				route->arrUtc[wp]=utc;
 				Navigator.status=NAV_STATUS_END_NAV;
 				if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavStatus(Navigator.status,"Nowhere");
-				NavUpdatePosition(lat,lon,altMt,speedKmh,timestamp); //Recursive call on the new WayPoint
+				updateNavigation(lat,lon,altMt,speedKmh,utc); //Recursive call on the new WayPoint
 				return;
 			} //else the Navigator.destination is still not reached...
-			Navigator.bearing=calcGreatCircleCourse(lat,lon,Navigator.currWP->latitude,Navigator.currWP->longitude); //just find the direct direction to the Navigator.destination
+			Navigator.bearing=calcNvectorCourse(&position,&route->position[wp]); //just find the direct direction to the Navigator.destination
 			if(fabs(trackErr)<config.trackErrorTolearnce) Navigator.trueCourse=Navigator.bearing; //with really small error
-			else { //otherwise we have bigger error and so we calculate it better...
-				double latI,lonI; //the perpendicular point on the route
-				calcIntermediatePoint(Navigator.currWP->prev->latitude,Navigator.currWP->prev->longitude,Navigator.currWP->latitude,Navigator.currWP->longitude,atd,Navigator.currWP->dist,&latI,&lonI);
-				Navigator.trueCourse=calcGreatCircleCourse(latI,lonI,Navigator.currWP->latitude,Navigator.currWP->longitude);
-			}
+			else Navigator.trueCourse=calcLegCourseAbeam(&route->leg[wp],&position); //otherwise the course of the route at the perpendicular point
 			if(getMainStatus()==MAIN_DISPLAY_HSI) {
 				PrintNavTrackATD(atd);
 				HSIupdateCDI(Rad2Deg(Navigator.trueCourse),trackErr,true,Rad2Deg(Navigator.bearing));
-				if(atd>=0) HSIupdateVSI(m2Ft((Navigator.currWP->altitude-Navigator.currWP->prev->altitude)/Navigator.currWP->dist*atd+Navigator.currWP->prev->altitude));
+				if(atd>=0) HSIupdateVSI(m2Ft((route->altitude[wp]-route->altitude[wp-1])/route->dist[wp]*atd+route->altitude[wp-1]));
 			}
-			updateDtgEteEtaAs(atd,timestamp,Navigator.remainDist);
+			updateDtgEteEtaAs(atd,utc,Navigator.remainDist);
 		} break;
 		case NAV_STATUS_NAV_TO_SINGLE_WP: {
-			Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.dest->latitude,Navigator.dest->longitude,&Navigator.remainDist); //calc just course and distance
+			Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.route.latitude[Navigator.numWayPoints-1],Navigator.route.longitude[Navigator.numWayPoints-1],&Navigator.remainDist); //calc just course and distance
 			if(getMainStatus()==MAIN_DISPLAY_HSI) HSIupdateCDI(Rad2Deg(Navigator.bearing),0,false,0);
 			Navigator.WPreaminDist=Rad2Km(Navigator.remainDist); //Km
 			Navigator.WPremaingTime=Navigator.WPreaminDist/speedKmh; //ETE (remaining time) in hours
 			if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavRemainingDistWP(Navigator.WPreaminDist,-1,Navigator.WPremaingTime);
 			else Navigator.WPaverageSpeed=-1;
-			Navigator.TotArrivalTime=Navigator.WPremaingTime+timestamp/3600; //hours, in order to obtain the ETA
+			Navigator.TotArrivalTime=Navigator.WPremaingTime+TimeBaseDayMs(utc)/3600000.0; //hours, in order to obtain the ETA
 			if(getMainStatus()==MAIN_DISPLAY_HSI) PrintNavRemainingDistDST(Navigator.remainDist,-1,Navigator.TotArrivalTime);
 			else Navigator.TotAverageSpeed=-1;
 		} break;
 		case NAV_STATUS_END_NAV: //We have reached or passed the Navigator.destination
-			Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.dest->latitude,Navigator.dest->longitude,&Navigator.remainDist); //calc just course and distance
+			Navigator.bearing=calcGreatCircleRoute(lat,lon,Navigator.route.latitude[Navigator.numWayPoints-1],Navigator.route.longitude[Navigator.numWayPoints-1],&Navigator.remainDist); //calc just course and distance
 			if(getMainStatus()==MAIN_DISPLAY_HSI) {
 				PrintNavDTG(Navigator.remainDist);
 				HSIupdateCDI(Rad2Deg(Navigator.bearing),0,false,0);
@@ -512,7 +583,7 @@ void NavUpdatePosition(double lat, double lon, double altMt, double speedKmh, fl
 			break;
 		case NAV_STATUS_WAIT_FIX:
 			NavFindNextWP(lat,lon);
-			NavUpdatePosition(lat,lon,altMt,speedKmh,timestamp);
+			updateNavigation(lat,lon,altMt,speedKmh,utc);
 			break;
 		default: //unknown state, we should be never here
 			break;
@@ -521,27 +592,27 @@ void NavUpdatePosition(double lat, double lon, double altMt, double speedKmh, fl
 
 void NavRedrawNavInfo(void) { //this is to redraw HSI screen when returning from main menu
 	if(getMainStatus()!=MAIN_DISPLAY_HSI) return;
-	int latMin,lonMin;
-	double latSec,lonSec;
-	pthread_mutex_lock(&gps.mutex);
-	HSIfirstTimeDraw(gps.trueTrack,Rad2Deg(Navigator.trueCourse),Navigator.trackErr,
+	struct GPSdata gpsData;
+	GPSgetData(&gpsData);
+	pthread_mutex_lock(&Navigator.mutex);
+	HSIfirstTimeDraw(gpsData.trueTrack,Rad2Deg(Navigator.trueCourse),Navigator.trackErr,
 			Navigator.status<=NAV_STATUS_NAV_BUSY, //This is when we have only a heading to show and no route planned
 			Navigator.status>=NAV_STATUS_NAV_TO_WPT && Navigator.status<=NAV_STATUS_NAV_TO_DST,
 			Rad2Deg(Navigator.bearing));
-	if(gps.altFt!=-100 && gps.altMt!=-100) {
-		HSIdrawVSIscale(gps.altFt);
-		PrintAltitude(gps.altMt,gps.altFt);
+	if(gpsData.altFt!=-100 && gpsData.altMt!=-100) {
+		HSIdrawVSIscale(gpsData.altFt);
+		PrintAltitude(gpsData.altMt,gpsData.altFt);
+		PrintVerticalSpeed(gpsData.climbFtMin);
 	}
-	if(gps.latMinDecimal!=-70) {
-		convertDecimal2DegMin(gps.latMinDecimal,&latMin,&latSec);
-		convertDecimal2DegMin(gps.lonMinDecimal,&lonMin,&lonSec);
-		PrintPosition(gps.latDeg,latMin,latSec,gps.isLatN,gps.lonDeg,lonMin,lonSec,gps.isLonE);
-		PrintSpeed(gps.speedKmh,gps.speedKnots);
+	if(gpsData.pos.lat!=GEO_NO_POS) {
+		PrintPosition(&gpsData.pos);
+		PrintSpeed(gpsData.speedKmh,gpsData.speedKnots);
+		PrintTurnRate(gpsData.turnRateDegMin);
 	}
-	PrintTime(gps.hour,gps.minute,gps.second,true);
-	PrintNumOfSats(gps.activeSats,gps.satsInView);
-	PrintFixMode(gps.fixMode);
-	pthread_mutex_unlock(&gps.mutex);
+	PrintTime(gpsData.hour,gpsData.minute,gpsData.second,true);
+	PrintNumOfSats(gpsData.activeSats,gpsData.satsInView);
+	if(GPSisLost()) PrintGPSlost();
+	else PrintFixMode(gpsData.fixMode);
 	switch(Navigator.status) {
 		case NAV_STATUS_NOT_INIT:
 		case NAV_STATUS_NO_ROUTE_SET:
@@ -553,20 +624,20 @@ void NavRedrawNavInfo(void) { //this is to redraw HSI screen when returning from
 		case NAV_STATUS_TO_START_NAV:
 		case NAV_STATUS_WAIT_FIX:
 		case NAV_STATUS_NAV_TO_DPT:
-			PrintNavStatus(Navigator.status,Navigator.currWP->name);
+			PrintNavStatus(Navigator.status,wpName(Navigator.curr));
 			PrintNavRemainingDistWP(Navigator.WPreaminDist,Navigator.WPaverageSpeed,Navigator.WPremaingTime);
 			PrintNavRemainingDistDST(Navigator.TotRemainDist,Navigator.TotAverageSpeed,Navigator.TotArrivalTime);
 			if(Navigator.remainDist!=-1) PrintNavDTG(Navigator.remainDist);
 			break;
 		case NAV_STATUS_NAV_TO_WPT:
 		case NAV_STATUS_NAV_TO_DST:
-			PrintNavStatus(Navigator.status,Navigator.currWP->name);
+			PrintNavStatus(Navigator.status,wpName(Navigator.curr));
 			PrintNavRemainingDistWP(Navigator.WPreaminDist,Navigator.WPaverageSpeed,Navigator.WPremaingTime);
 			PrintNavRemainingDistDST(Navigator.TotRemainDist,Navigator.TotAverageSpeed,Navigator.TotArrivalTime);
 			if(Navigator.atd!=-1) PrintNavTrackATD(Navigator.atd);
 			break;
 		case NAV_STATUS_NAV_TO_SINGLE_WP:
-			PrintNavStatus(Navigator.status,Navigator.currWP->name);
+			PrintNavStatus(Navigator.status,wpName(Navigator.curr));
 			PrintNavRemainingDistWP(Navigator.WPreaminDist,Navigator.WPaverageSpeed,Navigator.WPremaingTime);
 			PrintNavRemainingDistDST(Navigator.TotRemainDist,Navigator.TotAverageSpeed,Navigator.TotArrivalTime);
 			break;
@@ -577,15 +648,15 @@ void NavRedrawNavInfo(void) { //this is to redraw HSI screen when returning from
 		default: //unknown state, we should be never here
 			break;
 	}
+	pthread_mutex_unlock(&Navigator.mutex);
 }
 
 void NavRedrawEphemeridalInfo(void) { //this is to redraw HSI screen when returning from main menu
 	//TODO: draw sunset screen ....
 	if(getMainStatus()!=MAIN_DISPLAY_SUNRISE_SUNSET) return;
 
-	//pthread_mutex_lock(&gps.mutex);
-	// get the data
-	//pthread_mutex_unlock(&gps.mutex);
+	//struct GPSdata gpsData;
+	//GPSgetData(&gpsData); // get the data
 
 	// prepare the screen depending on the navigator status
 	switch(Navigator.status) {
@@ -611,29 +682,36 @@ void NavRedrawEphemeridalInfo(void) { //this is to redraw HSI screen when return
 }
 
 void NavSkipCurrentWayPoint(void) {
+	struct GPSdata gpsData;
+	GPSgetData(&gpsData);
+	pthread_mutex_lock(&Navigator.mutex);
 	if(Navigator.status==NAV_STATUS_NAV_TO_WPT || Navigator.status==NAV_STATUS_NAV_TO_DST) {
 		Navigator.status=NAV_STATUS_NAV_BUSY;
-		if(Navigator.currWP==Navigator.dest) {
+		if(Navigator.curr==Navigator.numWayPoints-1) {
 			Navigator.status=NAV_STATUS_END_NAV;
+			pthread_mutex_unlock(&Navigator.mutex);
 			return;
 		}
-		pthread_mutex_lock(&gps.mutex);
-		double lat=gps.lat;
-		double lon=gps.lon;
-		float timestamp=gps.timestamp;
-		pthread_mutex_unlock(&gps.mutex);
-		Navigator.currWP->arrTimestamp=timestamp; //we put the arrival timestamp when we skip it
+		double lat=geoLat2rad(gpsData.pos.lat);
+		double lon=geoLon2rad(gpsData.pos.lon);
+		Navigator.route.arrUtc[Navigator.curr]=gpsData.utc!=0?gpsData.utc:TimeBaseNow(); //we put the arrival time when we skip it
+		struct route *route=&Navigator.route;
+		struct nVector position;
+		latLon2nVector(lat,lon,&position);
 		double atd;
-		calcGCCrossTrackError(Navigator.currWP->prev->latitude,Navigator.currWP->prev->longitude,Navigator.currWP->longitude,lat,lon,Navigator.currWP->initialCourse,&atd);
-		Navigator.prevWPsTotDist+=Rad2Km(atd); //we add only the ATD
-		Navigator.totalDistKm-=Rad2Km(Navigator.currWP->dist)-Rad2Km(atd); //from the total substract the skipped reamaining dst
-		Navigator.totalDistKm-=Navigator.currWP->next->dist; //from the total substract the dst from skipped wp to the next
-		Navigator.currWP=Navigator.currWP->next; //jump to the next
-		Navigator.currWP->initialCourse=calcGreatCircleRoute(lat,lon,Navigator.currWP->latitude,Navigator.currWP->longitude,&Navigator.currWP->dist); //recalc course
-		Navigator.totalDistKm+=Rad2Km(Navigator.currWP->dist); //we add the new dst form current pos to the next WP
-		if(Navigator.currWP!=Navigator.dest) Navigator.status=NAV_STATUS_NAV_TO_WPT;
+		calcLegCrossTrackError(&route->leg[Navigator.curr],&position,&atd);
+		double covered=route->cumDist[Navigator.curr]-route->dist[Navigator.curr]+atd; //we count only the ATD of the skipped leg
+		Navigator.curr++; //jump to the next
+		calcGCleg(lat,lon,route->latitude[Navigator.curr],route->longitude[Navigator.curr],&route->leg[Navigator.curr]); //the new leg starts from the current position
+		route->dist[Navigator.curr]=route->leg[Navigator.curr].dist;
+		route->initialCourse[Navigator.curr]=calcNvectorCourse(&position,&route->position[Navigator.curr]); //recalc course
+		if(Navigator.curr<Navigator.numWayPoints-1) calcBisectorNormal(&route->position[Navigator.curr],&route->leg[Navigator.curr],&route->leg[Navigator.curr+1],&route->passNormal[Navigator.curr]);
+		double shift=covered+route->dist[Navigator.curr]-route->cumDist[Navigator.curr]; //the new leg starts from the current position
+		for(int i=Navigator.curr;i<Navigator.numWayPoints;i++) route->cumDist[i]+=shift; //the distances from the departure of this and the next WPs
+		if(Navigator.curr!=Navigator.numWayPoints-1) Navigator.status=NAV_STATUS_NAV_TO_WPT;
 		else Navigator.status=NAV_STATUS_NAV_TO_DST;
 	}
+	pthread_mutex_unlock(&Navigator.mutex);
 }
 
 enum navigatorStatus NavGetStatus(void) {
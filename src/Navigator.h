@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 28/2/2016
+// Last change : 18/10/2026
 // Description : Header of the navigation manager: Navigator.c
 //============================================================================
 
@@ -33,7 +33,7 @@ void NavAddWayPoint(double latWP, double lonWP, double altWP, char *WPname);
 void NavRedrawNavInfo(void);
 void NavRedrawEphemeridalInfo(void);
 void NavClearRoute(void);
-void NavUpdatePosition(double lat, double lon, double alt, double speed, float timestamp);
+void NavUpdatePosition(const struct GeoPosition *pos, double alt, double speed, long long utc); //utc in us from 1/1/1970
 short checkDaytime(bool calcOnlyDest);
 void NavStartNavigation(void);
 int NavReverseRoute(void);
@@ -0,0 +1,103 @@
+//============================================================================
+// Name        : Regression.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Least squares slope of the last samples of a value, updated in constant time
+//============================================================================
+
+//The samples are kept in a ring together with the running sums of t, y, t*t and t*y: each new sample is
+//added to the sums and the ones going out of the window are subtracted, so the slope costs the same with
+//any number of samples. Times and values are unwrapped respect the previous sample (midnight, 360 deg)
+//and taken from an origin that is moved forward to the oldest sample from time to time, recalculating the
+//sums, so that they stay small and the rounding errors of the subtractions do not pile up.
+
+#include "Regression.h"
+
+#define REGRESSION_REBASE 600 //s from the origin after which it is moved to the oldest sample
+
+void regressionRebase(struct Regression *reg);
+
+void RegressionInit(struct Regression *reg, long spanMs, long timeWrap, double valueWrap) {
+	reg->span=spanMs;
+	reg->timeWrap=timeWrap;
+	reg->valueWrap=valueWrap;
+	RegressionReset(reg);
+}
+
+void RegressionReset(struct Regression *reg) {
+	reg->head=0;
+	reg->tail=0;
+	reg->sumT=0;
+	reg->sumY=0;
+	reg->sumTT=0;
+	reg->sumTY=0;
+}
+
+void RegressionAdd(struct Regression *reg, long timestamp, double value) {
+	double t=0, y=0;
+	if(reg->head!=reg->tail) { //relative to the last sample
+		unsigned int last=(reg->head-1)&(REGRESSION_SIZE-1);
+		long deltaT=timestamp-reg->lastTimestamp;
+		double deltaY=value-reg->lastValue;
+		if(deltaT<0 && reg->timeWrap>0) deltaT+=reg->timeWrap;
+		if(deltaT==0) return; //same epoch
+		if(deltaT<0 || deltaT>reg->span) RegressionReset(reg); //too old to be part of the slope: start again from this one
+		else {
+			if(reg->valueWrap>0) { //the shortest way
+				if(deltaY>reg->valueWrap/2) deltaY-=reg->valueWrap;
+				else if(deltaY<=-reg->valueWrap/2) deltaY+=reg->valueWrap;
+			}
+			t=reg->t[last]+deltaT*0.001;
+			y=reg->y[last]+deltaY;
+		}
+	}
+	while(reg->head!=reg->tail && (reg->head-reg->tail==REGRESSION_SIZE || (t-reg->t[reg->tail&(REGRESSION_SIZE-1)])*1000>reg->span)) {
+		unsigned int old=(reg->tail++)&(REGRESSION_SIZE-1); //out of the window
+		reg->sumT-=reg->t[old];
+		reg->sumY-=reg->y[old];
+		reg->sumTT-=reg->t[old]*reg->t[old];
+		reg->sumTY-=reg->t[old]*reg->y[old];
+	}
+	unsigned int next=(reg->head++)&(REGRESSION_SIZE-1);
+	reg->t[next]=t;
+	reg->y[next]=y;
+	reg->sumT+=t;
+	reg->sumY+=y;
+	reg->sumTT+=t*t;
+	reg->sumTY+=t*y;
+	reg->lastTimestamp=timestamp;
+	reg->lastValue=value;
+	if(t>REGRESSION_REBASE) regressionRebase(reg);
+}
+
+void regressionRebase(struct Regression *reg) { //the slope does not change moving the origin
+	unsigned int oldest=reg->tail&(REGRESSION_SIZE-1);
+	double t0=reg->t[oldest], y0=reg->y[oldest];
+	reg->sumT=0;
+	reg->sumY=0;
+	reg->sumTT=0;
+	reg->sumTY=0;
+	for(unsigned int i=reg->tail;i!=reg->head;i++) {
+		unsigned int j=i&(REGRESSION_SIZE-1);
+		reg->t[j]-=t0;
+		reg->y[j]-=y0;
+		reg->sumT+=reg->t[j];
+		reg->sumY+=reg->y[j];
+		reg->sumTT+=reg->t[j]*reg->t[j];
+		reg->sumTY+=reg->t[j]*reg->y[j];
+	}
+}
+
+bool RegressionSlope(struct Regression *reg, double *slope) {
+	unsigned int n=reg->head-reg->tail;
+	if(n<3) return false;
+	double den=n*reg->sumTT-reg->sumT*reg->sumT;
+	if(den<1e-6) return false; //all the samples at the same time
+	*slope=(n*reg->sumTY-reg->sumT*reg->sumY)/den;
+	return true;
+}
@@ -0,0 +1,36 @@
+//============================================================================
+// Name        : Regression.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Least squares slope of the last samples of a value, updated in constant time
+//============================================================================
+
+#ifndef REGRESSION_H_
+#define REGRESSION_H_
+
+#include "Common.h"
+
+#define REGRESSION_SIZE 64 //max samples in the window, power of 2
+
+struct Regression {
+	long span;                                   //ms, the samples older than this respect the last one are dropped
+	long timeWrap;                               //ms at which the timestamps start again from 0 (e.g. a day), 0 if never
+	double valueWrap;                            //at which the values start again from 0 (e.g. 360 deg), 0 if never
+	double t[REGRESSION_SIZE],y[REGRESSION_SIZE]; //s and unwrapped value respect the origin
+	unsigned int head,tail;                      //free running indexes, wrapped with REGRESSION_SIZE-1
+	long lastTimestamp;                          //ms, as given, of the last sample
+	double lastValue;                            //as given, of the last sample
+	double sumT,sumY,sumTT,sumTY;                //of the samples in the window
+};
+
+void RegressionInit(struct Regression *reg, long spanMs, long timeWrap, double valueWrap);
+void RegressionReset(struct Regression *reg);
+void RegressionAdd(struct Regression *reg, long timestamp, double value);
+bool RegressionSlope(struct Regression *reg, double *slope); //value per second, false if not enough samples
+
+#endif /* REGRESSION_H_ */
@@ -0,0 +1,106 @@
+//============================================================================
+// Name        : RingBuffer.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Lock-free single producer single consumer byte ring
+//============================================================================
+
+//The producer moves only head and the consumer moves only tail, both indexes are free running
+//and wrapped with the mask, so used bytes are always head-tail also when the indexes overflow.
+//The data must be written before publishing the new head (and read before publishing the new tail)
+//that is why there is a memory barrier before updating the indexes.
+
+#include <stdlib.h>
+#include <string.h>
+#include "RingBuffer.h"
+
+
+bool RingBufferInit(struct RingBuffer *ring, unsigned int size) {
+	unsigned int realSize=RING_BUFFER_MIN_SIZE;
+	while(realSize<size && realSize<0x80000000) realSize<<=1; //round up to the next power of 2
+	ring->data=(unsigned char*)malloc(realSize);
+	if(ring->data==NULL) return false;
+	ring->size=realSize;
+	ring->mask=realSize-1;
+	ring->head=0;
+	ring->tail=0;
+	ring->overflows=0;
+	ring->droppedBytes=0;
+	ring->highWater=0;
+	return true;
+}
+
+void RingBufferRelease(struct RingBuffer *ring) {
+	free(ring->data);
+	ring->data=NULL;
+	ring->size=0;
+	ring->mask=0;
+	ring->head=0;
+	ring->tail=0;
+}
+
+unsigned int RingBufferUsed(struct RingBuffer *ring) {
+	return ring->head-ring->tail;
+}
+
+unsigned int RingBufferGetWriteSpace(struct RingBuffer *ring, unsigned char **ptr) { //to be called only by the producer
+	unsigned int head=ring->head;
+	unsigned int space=ring->size-(head-ring->tail);
+	unsigned int toEnd=ring->size-(head&ring->mask); //contiguous bytes until the end of the ring
+	*ptr=ring->data+(head&ring->mask);
+	return space<toEnd?space:toEnd;
+}
+
+void RingBufferCommitWrite(struct RingBuffer *ring, unsigned int len) { //to be called only by the producer
+	MEMORY_BARRIER(); //the bytes must be in the ring before the consumer can see them
+	ring->head+=len;
+	unsigned int used=ring->head-ring->tail;
+	if(used>ring->highWater) ring->highWater=used;
+}
+
+void RingBufferRecordOverflow(struct RingBuffer *ring, unsigned int lostBytes) { //to be called only by the producer
+	ring->overflows++;
+	ring->droppedBytes+=lostBytes;
+}
+
+unsigned int RingBufferGetReadSpace(struct RingBuffer *ring, unsigned char **ptr) { //to be called only by the consumer
+	unsigned int tail=ring->tail;
+	unsigned int used=ring->head-tail;
+	unsigned int toEnd=ring->size-(tail&ring->mask); //contiguous bytes until the end of the ring
+	MEMORY_BARRIER(); //do not read the bytes before having seen the head
+	*ptr=ring->data+(tail&ring->mask);
+	return used<toEnd?used:toEnd;
+}
+
+void RingBufferCommitRead(struct RingBuffer *ring, unsigned int len) { //to be called only by the consumer
+	MEMORY_BARRIER(); //finish to read the bytes before giving back the space to the producer
+	ring->tail+=len;
+}
+
+bool RingBufferWrite(struct RingBuffer *ring, const void *src, unsigned int len) { //all or nothing copy, to be called only by the producer
+	if(ring->size-(ring->head-ring->tail)<len) return false;
+	unsigned int offset=ring->head&ring->mask;
+	unsigned int first=ring->size-offset; //contiguous bytes until the end of the ring
+	if(first>len) first=len;
+	memcpy(ring->data+offset,src,first);
+	memcpy(ring->data,(const unsigned char*)src+first,len-first); //the rest from the beginning
+	RingBufferCommitWrite(ring,len);
+	return true;
+}
+
+bool RingBufferRead(struct RingBuffer *ring, void *dst, unsigned int len) { //all or nothing copy, to be called only by the consumer
+	if(ring->head-ring->tail<len) return false;
+	MEMORY_BARRIER(); //do not read the bytes before having seen the head
+	unsigned int offset=ring->tail&ring->mask;
+	unsigned int first=ring->size-offset;
+	if(first>len) first=len;
+	memcpy(dst,ring->data+offset,first);
+	memcpy((unsigned char*)dst+first,ring->data,len-first);
+	RingBufferCommitRead(ring,len);
+	return true;
+}
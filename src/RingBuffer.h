@@ -0,0 +1,42 @@
+//============================================================================
+// Name        : RingBuffer.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Header of RingBuffer.c lock-free single producer single consumer byte ring
+//============================================================================
+
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include "Common.h"
+
+#define RING_BUFFER_MIN_SIZE 1024
+
+struct RingBuffer {
+	unsigned char *data;            //the bytes of the ring
+	unsigned int size;              //size of the ring, always a power of 2
+	unsigned int mask;              //size-1 used to wrap the indexes
+	volatile unsigned int head;     //free running write index: written only by the producer
+	volatile unsigned int tail;     //free running read index: written only by the consumer
+	volatile unsigned long overflows;    //number of times the producer found the ring full
+	volatile unsigned long droppedBytes; //bytes thrown away because the ring was full
+	unsigned int highWater;         //maximum number of bytes waiting in the ring (updated by the producer)
+};
+
+bool RingBufferInit(struct RingBuffer *ring, unsigned int size);
+void RingBufferRelease(struct RingBuffer *ring);
+unsigned int RingBufferUsed(struct RingBuffer *ring);
+unsigned int RingBufferGetWriteSpace(struct RingBuffer *ring, unsigned char **ptr);
+void RingBufferCommitWrite(struct RingBuffer *ring, unsigned int len);
+void RingBufferRecordOverflow(struct RingBuffer *ring, unsigned int lostBytes);
+unsigned int RingBufferGetReadSpace(struct RingBuffer *ring, unsigned char **ptr);
+void RingBufferCommitRead(struct RingBuffer *ring, unsigned int len);
+bool RingBufferWrite(struct RingBuffer *ring, const void *src, unsigned int len);
+bool RingBufferRead(struct RingBuffer *ring, void *dst, unsigned int len);
+
+#endif /* RINGBUFFER_H_ */
@@ -0,0 +1,157 @@
+//============================================================================
+// Name        : SerialPort.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Raw low latency setup of a serial port and detection of its baud rate
+//============================================================================
+
+//The port is put in raw mode and kept non blocking, as the event loop wants it: a read() never waits and
+//returns what is already there. VTIME is 0 so VMIN tells only when select() or epoll report the port as
+//readable: with VMIN=1 at the first byte, with a bigger VMIN once VMIN bytes are there, so there are less wake
+//ups at high rates. The tail of each burst shorter than VMIN does not wake up the reader: it has to read the
+//port every SERIAL_DRAIN_PERIOD ms to take it.
+//The autobaud does not wait either: the caller starts it, calls SerialPortAutobaudRead() each time the port is
+//readable and SerialPortAutobaudNext() every SERIAL_AUTOBAUD_LISTEN ms to go to the next rate.
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#include "SerialPort.h"
+#include "Logger.h"
+
+struct baudRate {
+	long rate;
+	speed_t constant;
+};
+
+static const struct baudRate baudRates[] = { //in the order tried by the autobaud: the most used by GPS receivers first
+	{115200,B115200},
+	{9600,B9600},
+	{4800,B4800},
+	{38400,B38400},
+	{57600,B57600},
+	{19200,B19200},
+	{230400,B230400},
+	{2400,B2400},
+	{1800,B1800},
+	{1200,B1200},
+	{600,B600},
+	{300,B300},
+	{200,B200},
+	{150,B150},
+	{134,B134},
+	{110,B110},
+	{75,B75},
+	{50,B50}
+};
+
+#define NUM_BAUD_RATES (sizeof(baudRates)/sizeof(baudRates[0]))
+
+void serialSetLowLatency(int fd);
+bool serialAutobaudSetup(struct SerialAutobaud *autobaud);
+
+
+speed_t SerialPortBaudConstant(long baudRate) { //B0 if the rate is not supported
+	for(unsigned int i=0;i<NUM_BAUD_RATES;i++) if(baudRates[i].rate==baudRate) return baudRates[i].constant;
+	return B0;
+}
+
+void serialSetLowLatency(int fd) { //ask the driver to push each received byte at once instead of every timer tick
+	struct serial_struct serial;
+	if(ioctl(fd,TIOCGSERIAL,&serial)==0) {
+		serial.flags|=ASYNC_LOW_LATENCY;
+		if(ioctl(fd,TIOCSSERIAL,&serial)==0) return;
+	}
+	LogWrite(LOG_DEBUG,LOG_GPS,"the serial driver does not support the low latency mode.\n");
+}
+
+bool SerialPortSetup(int fd, long baudRate, short dataBits, short stopBits, short parity, int minRead) {
+	speed_t speed=SerialPortBaudConstant(baudRate);
+	struct termios tio;
+	if(speed==B0 || tcgetattr(fd,&tio)!=0) {
+		LogWrite(LOG_ERROR,LOG_GPS,"unable to set up the serial port at %ld baud.\n",baudRate);
+		return false;
+	}
+	cfmakeraw(&tio); //no line editing, no echo, no signals and no translation of the received bytes
+	tio.c_cflag&=~(CSIZE|CSTOPB|PARENB|PARODD|CRTSCTS); //no flow control: the GPS does not use it
+	switch(dataBits) {
+		case 5: tio.c_cflag|=CS5; break;
+		case 6: tio.c_cflag|=CS6; break;
+		case 7: tio.c_cflag|=CS7; break;
+		case 8:
+		default: tio.c_cflag|=CS8; break;
+	}
+	if(stopBits==2) tio.c_cflag|=CSTOPB;
+	switch(parity) {
+		case 1: tio.c_cflag|=PARENB|PARODD; break; //odd
+		case 2: tio.c_cflag|=PARENB; break; //even
+		case 0:
+		default: break; //none
+	}
+	tio.c_cflag|=CLOCAL|CREAD;
+	tio.c_iflag=parity==1||parity==2?INPCK:IGNPAR;
+	if(minRead<0) minRead=0;
+	else if(minRead>SERIAL_MAX_MIN_READ) minRead=SERIAL_MAX_MIN_READ;
+	tio.c_cc[VMIN]=minRead;
+	tio.c_cc[VTIME]=0; //with a silence timer the port would be readable at the first byte
+	cfsetispeed(&tio,speed);
+	cfsetospeed(&tio,speed);
+	if(tcsetattr(fd,TCSANOW,&tio)!=0) {
+		LogWrite(LOG_ERROR,LOG_GPS,"unable to set up the serial port at %ld baud.\n",baudRate);
+		return false;
+	}
+	int flags=fcntl(fd,F_GETFL);
+	if(flags!=-1) fcntl(fd,F_SETFL,flags|O_NONBLOCK); //the reads must never block the event loop
+	serialSetLowLatency(fd);
+	tcflush(fd,TCIFLUSH); //throw away what was received before
+	return true;
+}
+
+bool serialAutobaudSetup(struct SerialAutobaud *autobaud) { //set up the port at the current rate or at the next ones that can be set
+	for(;autobaud->rateIndex<NUM_BAUD_RATES;autobaud->rateIndex++) {
+		if(!SerialPortSetup(autobaud->fd,baudRates[autobaud->rateIndex].rate,autobaud->dataBits,autobaud->stopBits,autobaud->parity,1)) continue;
+		LogWrite(LOG_DEBUG,LOG_GPS,"autobaud: trying %ld baud.\n",baudRates[autobaud->rateIndex].rate);
+		autobaud->len=0;
+		return true;
+	}
+	return false;
+}
+
+bool SerialPortAutobaudStart(struct SerialAutobaud *autobaud, int fd, short dataBits, short stopBits, short parity, bool (*isValid)(const unsigned char *buf, int len, void *arg), void *arg) {
+	autobaud->fd=fd;
+	autobaud->dataBits=dataBits;
+	autobaud->stopBits=stopBits;
+	autobaud->parity=parity;
+	autobaud->isValid=isValid;
+	autobaud->arg=arg;
+	autobaud->rateIndex=0;
+	return serialAutobaudSetup(autobaud);
+}
+
+long SerialPortAutobaudRead(struct SerialAutobaud *autobaud) { //when the port is readable: the rate if the data is valid, 0 if not yet, -1 if the port has gone
+	unsigned char discard[SERIAL_AUTOBAUD_BUFFER]; //after SERIAL_AUTOBAUD_BUFFER bytes the port is only emptied
+	int redBytes;
+	if(autobaud->len<SERIAL_AUTOBAUD_BUFFER) redBytes=read(autobaud->fd,autobaud->buf+autobaud->len,SERIAL_AUTOBAUD_BUFFER-autobaud->len);
+	else redBytes=read(autobaud->fd,discard,SERIAL_AUTOBAUD_BUFFER);
+	if(redBytes==0 || (redBytes<0 && errno!=EAGAIN && errno!=EINTR)) return -1;
+	if(redBytes<0 || autobaud->len>=SERIAL_AUTOBAUD_BUFFER) return 0;
+	autobaud->len+=redBytes;
+	return autobaud->isValid(autobaud->buf,autobaud->len,autobaud->arg)?baudRates[autobaud->rateIndex].rate:0;
+}
+
+bool SerialPortAutobaudNext(struct SerialAutobaud *autobaud) { //every SERIAL_AUTOBAUD_LISTEN ms: false when all the rates have been tried
+	autobaud->rateIndex++;
+	return serialAutobaudSetup(autobaud);
+}
+
+long SerialPortAutobaudRate(const struct SerialAutobaud *autobaud) { //the rate being tried
+	return autobaud->rateIndex<NUM_BAUD_RATES?baudRates[autobaud->rateIndex].rate:0;
+}
@@ -0,0 +1,41 @@
+//============================================================================
+// Name        : SerialPort.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Raw low latency setup of a serial port and detection of its baud rate
+//============================================================================
+
+#ifndef SERIALPORT_H_
+#define SERIALPORT_H_
+
+#include <termios.h>
+#include "Common.h"
+
+#define SERIAL_AUTOBAUD_LISTEN 1500 //ms to listen at each baud rate: more than one cycle of a 1 Hz receiver
+#define SERIAL_AUTOBAUD_BUFFER 1024 //bytes looked at for each baud rate
+#define SERIAL_MAX_MIN_READ     255 //VMIN is a single byte
+#define SERIAL_DRAIN_PERIOD     100 //ms between the reads of the tail of the bursts when VMIN is more than 1
+
+struct SerialAutobaud { //search of the baud rate driven by the caller: one rate every SERIAL_AUTOBAUD_LISTEN ms
+	int fd;
+	short dataBits, stopBits, parity;
+	unsigned int rateIndex;                    //the rate being tried in the order of the autobaud
+	unsigned char buf[SERIAL_AUTOBAUD_BUFFER]; //bytes received at this rate
+	int len;
+	bool (*isValid)(const unsigned char *buf, int len, void *arg); //true if buf has valid data at this rate
+	void *arg;
+};
+
+speed_t SerialPortBaudConstant(long baudRate);
+bool SerialPortSetup(int fd, long baudRate, short dataBits, short stopBits, short parity, int minRead);
+bool SerialPortAutobaudStart(struct SerialAutobaud *autobaud, int fd, short dataBits, short stopBits, short parity, bool (*isValid)(const unsigned char *buf, int len, void *arg), void *arg);
+long SerialPortAutobaudRead(struct SerialAutobaud *autobaud);
+bool SerialPortAutobaudNext(struct SerialAutobaud *autobaud);
+long SerialPortAutobaudRate(const struct SerialAutobaud *autobaud);
+
+#endif /* SERIALPORT_H_ */
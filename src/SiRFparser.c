@@ -6,26 +6,35 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 27/11/2013
+// Last change : 18/10/2026
 // Description : Parses SiRF messages from a GPS device
 //============================================================================
 
-//TODO: This has to be finished and reviewed
+//The frames are A0 A2, 15 bits length, payload, 15 bits checksum, B0 B3; all the fields are big endian.
+//The payload is decoded in place where it has been received, the messages of a receiver cycle are assembled
+//in one GPS solution published when the Geodetic Navigation Data (MID 41) arrives, the last one of the cycle.
 
-#include <stdlib.h>
 #include <string.h>
-#include <fcntl.h>
 #include <stdint.h>
-//#include <time.h>
-//#include <sys/time.h>
 #include "SiRFparser.h"
 #include "Common.h"
 #include "GPSreceiver.h"
+#include "Configuration.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "TimeBase.h"
 
-#define MAX_PAYLOAD_LENGHT 1023
+#define SIRF_MEASURED_NAV_MSGID  0x02 //Measured Navigation Data: fix mode, HDOP and satellites used
+#define SIRF_MEASURED_NAV_LEN    41
+#define SIRF_TRACKER_MSGID       0x04 //Measured Tracker Data: satellites in view
+#define SIRF_TRACKER_HEADER_LEN  8    //MID, week, TOW and number of channels
+#define SIRF_TRACKER_CHANNEL_LEN 15
+#define SIRF_GEODETIC_MSGID      0x29 //Geodetic Navigation Data: the navigation solution
+#define SIRF_GEODETIC_MSG_LEN    91
 
-#define SIRF_GEODETIC_MSGID 0x29
-#define SIRF_GEODETIC_MSG_LEN 91
+#define SIRF_U16(p) ((unsigned int)(((p)[0]<<8)|(p)[1]))
+#define SIRF_U32(p) (((uint32_t)(p)[0]<<24)|((uint32_t)(p)[1]<<16)|((uint32_t)(p)[2]<<8)|(uint32_t)(p)[3])
+#define SIRF_S32(p) ((int32_t)SIRF_U32(p))
 
 
 enum SiRFparserStatus {
@@ -40,183 +49,238 @@ enum SiRFparserStatus {
 	SIRF_END_SEQ_2      //get second byte of end sequence
 };
 
-static struct SiRFparserStruct {
+struct SiRFparserStruct {
+	int source;                  //index of the GPS source parsed with this context
 	enum SiRFparserStatus frameStatus;
-	int payloadLength,rcvdBytesOfPayload,checksum;
-	unsigned char payload[MAX_PAYLOAD_LENGHT];
-	unsigned char firstBytePayloadLength,firstByteChecksum;
+	int payloadLength,rcvdBytesOfPayload;
+	unsigned int checksum,calcChecksum; //received one and 15 bits sum of the payload updated as it arrives
+	unsigned char payload[SIRF_MAX_PAYLOAD_LENGTH]; //the only copy of the payload, decoded in place
+	unsigned int streamOffset;   //offset in the GPS stream of the first byte of the buffer being processed
+	unsigned int frameOffset;    //offset in the GPS stream of the start of the current frame
+	unsigned int epochOffset;    //offset in the GPS stream of the MID 41 of the current epoch, or of its first frame without it
+	bool epochStarted;           //true if epochOffset has been taken for the current epoch
+	struct GPSsolution epoch;    //solution being assembled from the messages of the same receiver cycle
+	bool epochHasNavData;        //a MID 2 is already in the epoch
+	unsigned long measuredNavMsgs, trackerMsgs, geodeticMsgs;
+	unsigned long otherMsgs, wrongChecksums, brokenFrames, publishedEpochs;
 };
 
-struct geodetic_nav_data {
-	uint8_t  msgID;
-	uint16_t navValid;
-	uint16_t navType;
-	uint16_t weekNo;
-	uint32_t TOW;
-	uint16_t year;
-	uint8_t month;
-	uint8_t day;
-	uint8_t hour;
-	uint8_t minute;
-	uint16_t second;
-	uint32_t satIDlist;
-	int32_t latitude;
-	int32_t longitude;
-	uint32_t altEllips;
-	uint32_t altitude;
-	uint8_t mapDatum;
-	uint16_t speed;
-	uint16_t course;
-	int16_t magneticVar;
-	int16_t climbRate;
-	int16_t headingRate;
-	uint32_t estHposPosErr;
-	uint32_t estVposPosErr;
-	uint32_t estTimeErr;
-	uint16_t estHvelocityErr;
-	int32_t clockBias;
-	uint32_t clockBiasErr;
-	int32_t clockDrift;
-	uint32_t clockDriftErr;
-	uint32_t distance;
-	uint16_t distErr;
-	uint16_t headingErr;
-	uint8_t SVcount;
-	uint8_t HDOP;
-	uint8_t addModeInfo;
-};
+void sirfProcessPayload(void);
+void sirfDecodeMeasuredNav(void);
+void sirfDecodeTracker(void);
+void sirfDecodeGeodetic(void);
+enum GPSmode sirfFixMode(unsigned int navType);
+void sirfCloseEpoch(void);
 
-inline uint16_t endian16_swap(uint16_t val);
-inline uint32_t endian32_swap(uint32_t val);
-void processPayload(char *payloadCopy, int len, long timestamp);
-
-static struct SiRFparserStruct SiRFparser = {
-	.frameStatus=SIRF_START_SEQ_1,
-	.payloadLength=0,
-	.rcvdBytesOfPayload=0,
-	.checksum=0,
-	.firstBytePayloadLength=0,
-	.firstByteChecksum=0
-};
+static struct SiRFparserStruct SiRFparsers[GPS_MAX_SOURCES]; //one context for each GPS source
+static struct SiRFparserStruct *SiRFparser=SiRFparsers; //context of the source being parsed, there is only the parser thread
 
+void SiRFparserInit(int source) {
+	SiRFparser=&SiRFparsers[source];
+	memset(SiRFparser,0,sizeof(*SiRFparser));
+	SiRFparser->source=source;
+	SiRFparser->epoch.fixMode=MODE_UNKNOWN;
+	SiRFparser->frameStatus=SIRF_START_SEQ_1;
+}
 
-void SiRFparserProcessBuffer(unsigned char *buf, long timestamp, int redBytes) {
+void SiRFparserProcessBuffer(int source, unsigned char *buf, int redBytes) {
+	SiRFparser=&SiRFparsers[source];
 	for(int i=0;i<redBytes;i++) {
-		printLog("%02X ",buf[i]); //////////////DEBUG
-
-	switch(SiRFparser.frameStatus) { //for each byte received in the buffer
-		case SIRF_START_SEQ_1: //waiting for start sequence
-			if(buf[i]==0xA0) SiRFparser.frameStatus=SIRF_START_SEQ_2; //found first byte of start sequence
-			break;
-		case SIRF_START_SEQ_2: //waiting for second byte of sequence
-			if(buf[i]==0xA2) SiRFparser.frameStatus=SIRF_PAYLOAD_LEN_1; //found second byte of start sequence
-			else SiRFparser.frameStatus=SIRF_START_SEQ_1;
-			break;
-		case SIRF_PAYLOAD_LEN_1: //getting the first byte of payload length
-			if(buf[i]<=0x7F) { //check if it is OK //should be <=0x03 if the payload is maximum 1023??
-				SiRFparser.firstBytePayloadLength=buf[i];
-				SiRFparser.frameStatus=SIRF_PAYLOAD_LEN_2;
-			} else SiRFparser.frameStatus=SIRF_START_SEQ_1;
-			break;
-		case SIRF_PAYLOAD_LEN_2: //getting the second byte of payload length
-			SiRFparser.payloadLength=SiRFparser.firstBytePayloadLength*256+buf[i];
-			SiRFparser.frameStatus=SIRF_PAYLOAD;
-			SiRFparser.rcvdBytesOfPayload=0;
-			break;
-		case SIRF_PAYLOAD: //getting bytes of the payload //TODO: implement pre-selection on msgID (first byte of payload)
-			SiRFparser.payload[SiRFparser.rcvdBytesOfPayload++]=buf[i];
-			if(SiRFparser.rcvdBytesOfPayload==SiRFparser.payloadLength) SiRFparser.frameStatus=SIRF_CHECKSUM_1;
-			break;
-		case SIRF_CHECKSUM_1: //payload finished, getting first byte of checksum
-			if(buf[i]<=0x7F) { //check if it is OK
-				SiRFparser.firstByteChecksum=buf[i];
-				SiRFparser.frameStatus=SIRF_CHECKSUM_2;
-			} else SiRFparser.frameStatus=SIRF_START_SEQ_1;
-			break;
-		case SIRF_CHECKSUM_2: //getting the second byte of checksum
-			SiRFparser.checksum=SiRFparser.firstByteChecksum*256+buf[i];
-			SiRFparser.frameStatus=SIRF_END_SEQ_1;
-			break;
-		case SIRF_END_SEQ_1: //get first byte of end sequence
-			if(buf[i]==0xB0) SiRFparser.frameStatus=SIRF_END_SEQ_2;
-			else {
-				SiRFparser.frameStatus=SIRF_START_SEQ_1;
-				SiRFparser.rcvdBytesOfPayload=0;
-			}
-			break;
-		case SIRF_END_SEQ_2: //get second byte of end sequence
-			if(buf[i]==0xB3) {
-				int j, calcChecksum=0;
-				for(j=0;j<SiRFparser.payloadLength;j++) calcChecksum=(calcChecksum+SiRFparser.payload[j])&0x7FFF;
-				if(calcChecksum==SiRFparser.checksum) { //CRC check
-					char *payloadCopy=malloc(SiRFparser.payloadLength);
-					if(payloadCopy!=NULL) {
-						memcpy(payloadCopy,SiRFparser.payload,SiRFparser.payloadLength);
-						processPayload(payloadCopy,SiRFparser.payloadLength,timestamp);
+		unsigned char c=buf[i];
+		switch(SiRFparser->frameStatus) { //for each byte received in the buffer
+			case SIRF_START_SEQ_1: //waiting for start sequence
+				if(c==0xA0) { //found first byte of start sequence
+					SiRFparser->frameOffset=SiRFparser->streamOffset+i;
+					SiRFparser->frameStatus=SIRF_START_SEQ_2;
+				}
+				break;
+			case SIRF_START_SEQ_2: //waiting for second byte of sequence
+				if(c==0xA2) SiRFparser->frameStatus=SIRF_PAYLOAD_LEN_1; //found second byte of start sequence
+				else SiRFparser->frameStatus=c==0xA0?SIRF_START_SEQ_2:SIRF_START_SEQ_1;
+				break;
+			case SIRF_PAYLOAD_LEN_1: //getting the first byte of payload length
+				if(c<=(SIRF_MAX_PAYLOAD_LENGTH>>8)) {
+					SiRFparser->payloadLength=c<<8;
+					SiRFparser->frameStatus=SIRF_PAYLOAD_LEN_2;
+				} else { //too long: it is not a frame
+					SiRFparser->brokenFrames++;
+					SiRFparser->frameStatus=SIRF_START_SEQ_1;
+				}
+				break;
+			case SIRF_PAYLOAD_LEN_2: //getting the second byte of payload length
+				SiRFparser->payloadLength|=c;
+				SiRFparser->rcvdBytesOfPayload=0;
+				SiRFparser->calcChecksum=0;
+				if(SiRFparser->payloadLength==0 || SiRFparser->payloadLength>SIRF_MAX_PAYLOAD_LENGTH) {
+					SiRFparser->brokenFrames++;
+					SiRFparser->frameStatus=SIRF_START_SEQ_1;
+				} else SiRFparser->frameStatus=SIRF_PAYLOAD;
+				break;
+			case SIRF_PAYLOAD: { //getting bytes of the payload, copied at once as many as available
+				int len=SiRFparser->payloadLength-SiRFparser->rcvdBytesOfPayload;
+				if(len>redBytes-i) len=redBytes-i;
+				unsigned char *dest=SiRFparser->payload+SiRFparser->rcvdBytesOfPayload;
+				memcpy(dest,buf+i,len);
+				for(int j=0;j<len;j++) SiRFparser->calcChecksum+=dest[j];
+				SiRFparser->calcChecksum&=0x7FFF;
+				SiRFparser->rcvdBytesOfPayload+=len;
+				i+=len-1;
+				if(SiRFparser->rcvdBytesOfPayload==SiRFparser->payloadLength) SiRFparser->frameStatus=SIRF_CHECKSUM_1;
+			}	break;
+			case SIRF_CHECKSUM_1: //payload finished, getting first byte of checksum
+				if(c<=0x7F) { //check if it is OK
+					SiRFparser->checksum=c<<8;
+					SiRFparser->frameStatus=SIRF_CHECKSUM_2;
+				} else {
+					SiRFparser->brokenFrames++;
+					SiRFparser->frameStatus=SIRF_START_SEQ_1;
+				}
+				break;
+			case SIRF_CHECKSUM_2: //getting the second byte of checksum
+				SiRFparser->checksum|=c;
+				SiRFparser->frameStatus=SIRF_END_SEQ_1;
+				break;
+			case SIRF_END_SEQ_1: //get first byte of end sequence
+				if(c==0xB0) SiRFparser->frameStatus=SIRF_END_SEQ_2;
+				else {
+					SiRFparser->brokenFrames++;
+					SiRFparser->frameStatus=SIRF_START_SEQ_1;
+				}
+				break;
+			case SIRF_END_SEQ_2: //get second byte of end sequence
+				if(c!=0xB3) SiRFparser->brokenFrames++;
+				else if(SiRFparser->calcChecksum!=SiRFparser->checksum) SiRFparser->wrongChecksums++;
+				else {
+					if(SiRFparser->source==0) TRACE_MARK(TRACE_SENTENCE_OK,SiRFparser->frameOffset,SiRFparser->payloadLength);
+					if(!SiRFparser->epochStarted) {
+						SiRFparser->epochOffset=SiRFparser->frameOffset;
+						SiRFparser->epochStarted=true;
+						SiRFparser->epoch.received=TimeBaseMonotonic();
 					}
-				} else printLog("Wrong checksum :(\n");
-			}
-			SiRFparser.rcvdBytesOfPayload=0;
-			SiRFparser.frameStatus=SIRF_START_SEQ_1;
-			break;
-		default:
-			break;
-	} } printLog("\n\n"); //end of for(each byte) and switch(status) of received byte
+					sirfProcessPayload();
+				}
+				SiRFparser->frameStatus=SIRF_START_SEQ_1;
+				break;
+		}
+	} //end of for(each byte) of just received sequence
+	SiRFparser->streamOffset+=redBytes;
+}
+
+void SiRFparserLogStats(int source) {
+	SiRFparser=&SiRFparsers[source];
+	LogWrite(LOG_INFO,LOG_GPS,"source %d: SiRF MID 2 %lu, MID 4 %lu, MID 41 %lu messages, %lu others, %lu wrong checksums, %lu broken frames.\n",source,
+			SiRFparser->measuredNavMsgs,SiRFparser->trackerMsgs,SiRFparser->geodeticMsgs,SiRFparser->otherMsgs,SiRFparser->wrongChecksums,SiRFparser->brokenFrames);
+	LogWrite(LOG_INFO,LOG_GPS,"source %d: %lu epochs parsed.\n",source,SiRFparser->publishedEpochs);
+}
+
+void sirfProcessPayload(void) {
+	switch(SiRFparser->payload[0]) { //message ID
+		case SIRF_MEASURED_NAV_MSGID:
+			if(SiRFparser->payloadLength!=SIRF_MEASURED_NAV_LEN) break;
+			SiRFparser->measuredNavMsgs++;
+			if(SiRFparser->epochHasNavData) sirfCloseEpoch(); //the cycle before has not been closed by a MID 41
+			sirfDecodeMeasuredNav();
+			return;
+		case SIRF_TRACKER_MSGID:
+			if(SiRFparser->payloadLength<SIRF_TRACKER_HEADER_LEN) break;
+			SiRFparser->trackerMsgs++;
+			sirfDecodeTracker();
+			return;
+		case SIRF_GEODETIC_MSGID:
+			if(SiRFparser->payloadLength!=SIRF_GEODETIC_MSG_LEN) break;
+			SiRFparser->geodeticMsgs++;
+			SiRFparser->epochOffset=SiRFparser->frameOffset; //the epoch is timed by the arrival of its UTC
+			SiRFparser->epoch.received=TimeBaseMonotonic();
+			sirfDecodeGeodetic();
+			sirfCloseEpoch(); //last message of the receiver cycle
+			return;
+	}
+	SiRFparser->otherMsgs++; //just count it: logging each one would be too expensive
 }
 
-void processPayload(char *payloadCopy, int len, long timestamp) {
-	unsigned char msgID=payloadCopy[0];
-	printLog("Received frame ID: %d of length: %d\n",msgID,len);
-	if(msgID==SIRF_GEODETIC_MSGID && len==SIRF_GEODETIC_MSG_LEN) { //we want to interpret only geodetic
-//TODO: put the data in the right place: in the gps struct of GPSreceiver
-//		time_t curr_time,gps_time;
-//		struct timeval new_time;
-//		//char * saved_tz=NULL;
-//		struct geodetic_nav_data * msg=(struct geodetic_nav_data *)payloadCopy;
-//		lat_deg=((int32_t)endian32_swap(msg->latitude))/10000000;
-//		lat_mins=((endian32_swap(msg->latitude)*60)/10000000)%60;
-//		long_deg=((int32_t)endian32_swap(msg->longitude))/10000000;
-//		long_mins=((endian32_swap(msg->longitude)*60)/10000000)%60;
-//		alt_cm=endian32_swap(msg->altitude);
-//		sat_id_list=endian32_swap(msg->satIDlist);
-//		sat_nb=msg->SVcount;
-//		speed_kmh=(endian16_swap(msg->speed)*36)/1000;
-//		time.tm_sec=endian16_swap(msg->second)/1000;
-//		time.tm_min=msg->minute;
-//		time.tm_hour=msg->hour;
-//		time.tm_mday=msg->day;
-//		time.tm_mon=msg->month-1;
-//		time.tm_year=endian16_swap(msg->year)-1900;
-//		time.tm_isdst=-1;
-//		printLog("lat: %d %d; lon: %d %d; time: %d/%d/%d %d:%d:%d\n",lat_deg,lat_mins,long_deg,long_mins,time.tm_mday,time.tm_mon,time.tm_year,time.tm_hour,time.tm_min,time.tm_sec);
-//		time(&curr_time);
-//		//saved_tz=strdup(getenv("TZ"));
-//		//unsetenv("TZ");
-//		gps_time=mktime(&time);
-//		if(abs(gps_time-curr_time)>10) {
-//			printLog("Syncing clock needed ! system : %d - GPS : %d\n",(int)curr_time,(int)gps_time);
-//			new_time.tv_sec=gps_time;
-//			new_time.tv_usec=0;
-//			settimeofday(&new_time,NULL);
-//		} else printLog("No need to sync.\n");
-//		//if(saved_tz!=NULL) {
-//		//	setenv("TZ",saved_tz,1);
-//		//	free(saved_tz);
-//		//}
-		printLog("Geodetic OK !\n");
+enum GPSmode sirfFixMode(unsigned int navType) { //bits 0-2 of the navigation type of MID 2 and 41
+	switch(navType&7) {
+		case 0: //no navigation solution
+			return MODE_NO_FIX;
+		case 4: //more than 3 satellites with Kalman filter
+		case 6: //3D least squares
+			return MODE_3D_FIX;
+		default: //1-3 satellites, 2D least squares or dead reckoning
+			return MODE_2D_FIX;
 	}
-	free(payloadCopy);
 }
 
-inline uint16_t endian16_swap(uint16_t val) { //16 bits endianess helper
-	uint16_t temp;
-	temp = val & 0xFF;
-	temp = (val >> 8) | (temp << 8);
-	return temp;
+void sirfDecodeMeasuredNav(void) { //MID 2: position in ECEF (not used), fix mode, HDOP and satellites in use
+	const unsigned char *p=SiRFparser->payload;
+	struct GPSsolution *epoch=&SiRFparser->epoch;
+	epoch->fixMode=sirfFixMode(p[19]);
+	epoch->hdop=p[20]*20; //units of 0.2
+	epoch->satsInUse=p[28];
+	epoch->content|=SOLUTION_HDOP|SOLUTION_SATS_IN_USE;
+	SiRFparser->epochHasNavData=true;
 }
 
-inline uint32_t endian32_swap(uint32_t val) { //32 bits endianess hleper
-	uint32_t temp;
-	temp = ( val >> 24) | ((val & 0x00FF0000) >> 8) |  ((val & 0x0000FF00) << 8) | ((val & 0x000000FF) << 24);
-	return temp;
+void sirfDecodeTracker(void) { //MID 4: elevation, azimuth and C/No of the satellites in view
+	const unsigned char *p=SiRFparser->payload;
+	int channels=p[7];
+	if(SIRF_TRACKER_HEADER_LEN+channels*SIRF_TRACKER_CHANNEL_LEN>SiRFparser->payloadLength) return;
+	struct GPSsolution *epoch=&SiRFparser->epoch;
+	for(int i=0; i<MAX_NUM_SAT; i++) for(int j=SAT_ELEVATION; j<=SAT_SNR; j++) epoch->satellites[i][j]=-1; //reset all sats
+	epoch->satsInView=0;
+	for(int i=0;i<channels;i++) {
+		const unsigned char *ch=p+SIRF_TRACKER_HEADER_LEN+i*SIRF_TRACKER_CHANNEL_LEN;
+		int satId=ch[0];
+		if(satId==0) continue; //channel not tracking
+		epoch->satsInView++;
+		if(satId>MAX_NUM_SAT) continue; //not in the matrix of the GPS PRNs
+		int cno=0;
+		for(int j=5;j<15;j++) cno+=ch[j]; //10 measurements of C/No in dB-Hz
+		epoch->satellites[satId-1][SAT_ELEVATION]=ch[2]/2; //units of 0.5 deg
+		epoch->satellites[satId-1][SAT_AZIMUTH]=ch[1]*3/2; //units of 1.5 deg
+		epoch->satellites[satId-1][SAT_SNR]=cno/10;
+	}
+	epoch->content|=SOLUTION_SATELLITES|SOLUTION_SATS_IN_VIEW;
+}
+
+void sirfDecodeGeodetic(void) { //MID 41: the navigation solution with UTC time and date
+	const unsigned char *p=SiRFparser->payload;
+	struct GPSsolution *epoch=&SiRFparser->epoch;
+	int year=SIRF_U16(p+11);
+	if(year>0) { //the receiver knows the UTC time
+		epoch->year=year;
+		epoch->month=p[13];
+		epoch->day=p[14];
+		epoch->hour=p[15];
+		epoch->minute=p[16];
+		epoch->milliSec=SIRF_U16(p+17);
+		epoch->timestamp=(epoch->hour*3600L+epoch->minute*60)*1000+epoch->milliSec;
+		if(epoch->timestamp<0 || epoch->timestamp>=MS_DAY) return; //broken time: the whole message is not trusted
+		epoch->content|=SOLUTION_TIME|SOLUTION_DATE;
+	}
+	epoch->fixMode=sirfFixMode(SIRF_U16(p+3));
+	if(epoch->fixMode==MODE_NO_FIX) return;
+	epoch->pos.lat=SIRF_S32(p+23); //1e-7 degrees as GeoPosition
+	epoch->pos.lon=SIRF_S32(p+27);
+	epoch->alt=SIRF_S32(p+31)*10L; //from cm to mm respect WGS84
+	epoch->altUnit='M';
+	epoch->groundSpeedKnots=SIRF_U16(p+40)*19438L/1000; //from cm/s to thousandths of knot
+	epoch->trueTrack=SIRF_U16(p+42); //hundredths of degree
+	epoch->latErr=SIRF_U32(p+50)*10; //estimated horizontal error in cm used for both the components
+	epoch->lonErr=epoch->latErr;
+	epoch->altErr=SIRF_U32(p+54)*10;
+	epoch->satsInUse=p[88];
+	epoch->hdop=p[89]*20; //units of 0.2
+	epoch->content|=SOLUTION_POSITION|SOLUTION_ALTITUDE|SOLUTION_VELOCITY|SOLUTION_HDOP|SOLUTION_SATS_IN_USE|SOLUTION_ERRORS;
+}
+
+void sirfCloseEpoch(void) { //publish the current epoch and start a new empty one
+	if(SiRFparser->epoch.content!=0 || SiRFparser->epoch.fixMode!=MODE_UNKNOWN) {
+		if(SiRFparser->source==0) TRACE_MARK(TRACE_EPOCH_CLOSED,SiRFparser->publishedEpochs,SiRFparser->epochOffset);
+		GPSpublishSolution(SiRFparser->source,&SiRFparser->epoch);
+		SiRFparser->publishedEpochs++;
+	}
+	memset(&SiRFparser->epoch,0,sizeof(SiRFparser->epoch));
+	SiRFparser->epoch.fixMode=MODE_UNKNOWN;
+	SiRFparser->epochHasNavData=false;
+	SiRFparser->epochStarted=false;
 }
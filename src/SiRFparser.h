@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 25/11/2013
+// Last change : 18/10/2026
 // Description : Parses SiRF messages from a GPS device
 //============================================================================
 
@@ -14,9 +14,11 @@
 #ifndef SIRFPARSER_H_
 #define SIRFPARSER_H_
 
-#define SIRF_BUFFER_SIZE        1034
+#define SIRF_MAX_PAYLOAD_LENGTH 1023 //longer payloads are not sent by the SiRF receivers
 
-void SiRFparserProcessBuffer(unsigned char *buf, long timestamp, int redBytes);
+void SiRFparserInit(int source);
+void SiRFparserProcessBuffer(int source, unsigned char *buf, int redBytes);
+void SiRFparserLogStats(int source);
 
 
 #endif
@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 29/11/2013
+// Last change : 18/10/2026
 // Description : Touch screen reader
 //============================================================================
 
@@ -14,117 +14,55 @@
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
-#include <pthread.h>
-#include <signal.h>
 #include <sys/ioctl.h>
 #include <barcelona/Barc_ts.h>
 //#include <barcelona/Barc_Battery.h>
 #include "TSreader.h"
+#include "EventLoop.h"
 #include "Common.h"
 
 struct TSreaderStruct {
-	volatile short reading;
 	int tsfd;
-	pthread_t thread;
-	pthread_mutex_t lastTouchMutex;
-	pthread_cond_t lastTouchSignal;
-	TS_EVENT lastTouch;
+	void (*onTouch)(const TS_EVENT *touch); //called by the event loop for each completed touch
 };
 
-void TSreaderRelease(void);
-void initializeTSreader(void);
-void* runTSreader(void *arg);
+void readTouchScreen(int fd, void *arg);
 
 static struct TSreaderStruct TSreader = {
-	.reading=-1, //-1 means still not initialized
-	.tsfd=-1
+	.tsfd=-1,
+	.onTouch=NULL
 };
 
-void TSreaderRelease(void) {
-	pthread_mutex_destroy(&TSreader.lastTouchMutex);
-	pthread_cond_destroy(&TSreader.lastTouchSignal);
-	if(TSreader.tsfd>=0) close(TSreader.tsfd);
-	TSreader.tsfd=-1;
-	TSreader.reading=-1;
+void readTouchScreen(int fd, void *arg) { //called by the event loop when there is something new
+	TS_EVENT event;
+	while(read(fd,&event,sizeof(TS_EVENT))==sizeof(TS_EVENT)) {
+		if(event.pressure==0) TSreader.onTouch(&event); //to detect when the finger is going away from the screen so the touch is completed
+	}
 }
 
-void initializeTSreader(void) {
-	if(pthread_mutex_init(&TSreader.lastTouchMutex,NULL) || pthread_cond_init(&TSreader.lastTouchSignal,NULL)) {
-		printLog("TSreader: ERROR while initializing mutex and condition variable\n");
-		TSreaderRelease();
-	}
+short TSreaderStart(void (*onTouch)(const TS_EVENT *touch)) {
+	if(TSreader.tsfd>=0) return 1;
 	TSreader.tsfd=open("/dev/ts",O_RDONLY|O_NOCTTY|O_NONBLOCK);
 	if(TSreader.tsfd<0) {
 		printLog("TSreader: ERROR can't open the device: /dev/ts\n");
-		TSreaderRelease();
+		return 0;
 	}
 	ioctl(TSreader.tsfd,TS_SET_RAW_OFF,NULL);
-	TSreader.reading=0; //in this case we can start the thread
-}
-
-void* runTSreader(void *arg) { //This is the thread listening for input on the touch screen
-	struct sigaction sa;
-	sa.sa_handler = NULL;
-	sa.sa_sigaction = NULL/*gotsig*/;
-	sa.sa_flags = SA_SIGINFO;
-	sigemptyset(&sa.sa_mask);
-	fd_set fdset;
-	int maxfd=TSreader.tsfd+1;
-	int read_len;
-	while(TSreader.reading) { //loop while waiting for input
-		FD_ZERO(&fdset);
-		FD_SET(TSreader.tsfd, &fdset);
-		if(sigaction((int)arg, &sa, NULL)<0) { //register signal to kill the thread otherwise it will wait until next input
-			printLog("TSreader: ERROR while registering signal to stop listen thread.");
-			TSreader.reading=0;
-			pthread_exit(NULL);
-			return NULL;
-		}
-		select(maxfd,&fdset,NULL,NULL,NULL); //wait until we have something new
-		TS_EVENT event;
-		read_len=read(TSreader.tsfd,&event,sizeof(TS_EVENT));
-		if(read_len==sizeof(TS_EVENT)) {
-			if(event.pressure==0) { //to detect when the finger is going away from the screen so the touch is completed
-				pthread_mutex_lock(&TSreader.lastTouchMutex);
-				TSreader.lastTouch=event; //it's a simple struct no need to use memcpy
-				pthread_cond_signal(&TSreader.lastTouchSignal); //signal that there is a new touch
-				pthread_mutex_unlock(&TSreader.lastTouchMutex);
-			}
-		}
-	}
-	pthread_exit(NULL);
-	return NULL;
-}
-
-short TSreaderStart() {
-	if(TSreader.reading==-1) initializeTSreader();
-	if(TSreader.reading==0) {
-		TSreader.reading=1;
-		if(pthread_create(&TSreader.thread,NULL,runTSreader,(void*)SIGUSR1)) {
-			TSreader.reading=0;
-			printLog("TSreader: ERROR unable to create the reading thread.\n");
-			TSreaderRelease();
-		}
+	TSreader.onTouch=onTouch;
+	if(!EventLoopAddFd(TSreader.tsfd,readTouchScreen,NULL)) {
+		printLog("TSreader: ERROR unable to listen to the touch screen.\n");
+		TSreaderClose();
+		return 0;
 	}
-	return TSreader.reading;
+	return 1;
 }
 
-void TSreaderClose() {
-	if(TSreader.reading==1) {
-		TSreader.reading=0;
-		pthread_kill(TSreader.thread,SIGUSR1); //send the signal to kill the thread
-		pthread_join(TSreader.thread,NULL); //wait for thread death
+void TSreaderClose(void) {
+	if(TSreader.tsfd>=0) {
+		EventLoopRemoveFd(TSreader.tsfd);
+		close(TSreader.tsfd);
 	}
-	TSreaderRelease();
-}
-
-short TSreaderGetTouch(TS_EVENT *lastTouch) {
-	if(TSreader.reading!=1) return -1;
-	pthread_mutex_lock(&TSreader.lastTouchMutex);
-	pthread_cond_wait(&TSreader.lastTouchSignal,&TSreader.lastTouchMutex); //wait user touches the screen
-	*lastTouch=TSreader.lastTouch; //get a copy of the coordinates of the last touch
-	pthread_mutex_unlock(&TSreader.lastTouchMutex);
-	return 1;
+	TSreader.tsfd=-1;
 }
 
 /*
@@ -6,20 +6,18 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 29/11/2013
+// Last change : 18/10/2026
 // Description : Header of TSreader.c the touch screen reader
 //============================================================================
 
 #ifndef TSREADER_H_
 #define TSREADER_H_
 
-#include <pthread.h>
 #include <barcelona/Barc_ts.h>
 
 
-short TSreaderStart(void);
+short TSreaderStart(void (*onTouch)(const TS_EVENT *touch)); //the touch screen is read by the event loop
 void TSreaderClose(void);
-short TSreaderGetTouch(TS_EVENT *lastTouch);
 
 //short checkBattery(short *batVolt, short *refVolt, short *chargeCurr);
 
@@ -0,0 +1,208 @@
+//============================================================================
+// Name        : TimeBase.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : UTC time in microseconds from the monotonic clock, disciplined by the GPS
+//============================================================================
+
+//UTC is the monotonic clock plus an offset: at start the offset is taken from the RTC, or from the system clock,
+//then from the date and time of the GPS solutions. A GPS solution arrives some time after its UTC tag, so
+//each one gives an offset smaller than the true one by the latency: the biggest offset is the best one.
+//The offset goes up at once to any bigger estimate and follows the smaller ones slowly, as fast as a clock
+//can drift, unless they are too far: in that case the time jumped and the offset is set again.
+//The offset is published with the same double buffer of the GPS data, so any thread can read the time.
+//The monotonic clock is CLOCK_MONOTONIC or a virtual one that moves only when TimeBaseAdvance() is called, to
+//play a recorded flight as fast as possible and always in the same way (see GPSreplay.c): then the event loop
+//and the GPS parser never wait for the time, they wait for the driver of the clock.
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <barcelona/Barc_rtc.h>
+#include "TimeBase.h"
+#include "Logger.h"
+
+#define TIME_STEP_LIMIT 1000000LL //us of difference from the GPS after which the time is set again
+#define TIME_MAX_DRIFT  200       //ppm, how fast the offset follows the estimates smaller than it
+
+struct timeBaseValue { //64 bit value written by one thread and read by any
+	long long value[2];            //readers use the one of version
+	volatile unsigned int version; //incremented after each change of the value
+};
+
+struct TimeBaseStruct {
+	const struct TimeBaseClock *clock;
+	struct timeBaseValue offset;   //us from the monotonic clock to UTC
+	volatile enum timeSource source;
+	long long lastDiscipline;      //monotonic time of the last GPS time taken
+	struct timeBaseValue virtualNow; //us of the virtual clock, moved by TimeBaseAdvance()
+};
+
+long long systemMonotonic(void);
+long long virtualMonotonic(void);
+bool virtualUTC(long long *utc);
+bool timeBaseReadRTC(long long *utc);
+void timeBasePublish(struct timeBaseValue *published, long long value);
+long long timeBaseRead(const struct timeBaseValue *published);
+long daysFromCivil(int year, int month, int day);
+
+const struct TimeBaseClock TimeBaseClockSystem = {
+	.name="system",
+	.monotonic=systemMonotonic,
+	.utc=timeBaseReadRTC
+};
+
+const struct TimeBaseClock TimeBaseClockVirtual = {
+	.name="virtual",
+	.monotonic=virtualMonotonic,
+	.utc=virtualUTC
+};
+
+static struct TimeBaseStruct TimeBase = {
+	.clock=&TimeBaseClockSystem, //also before TimeBaseInit()
+	.offset={{0,0},0},
+	.source=TIME_SOURCE_SYSTEM,
+	.virtualNow={{0,0},0}
+};
+
+void TimeBaseInit(const struct TimeBaseClock *clock) {
+	long long utc;
+	TimeBase.clock=clock;
+	long long monotonic=TimeBaseMonotonic();
+	if(clock==&TimeBaseClockVirtual) {
+		clock->utc(&utc);
+		TimeBase.source=TIME_SOURCE_SYSTEM;
+		LogWrite(LOG_INFO,LOG_MAIN,"virtual clock: the time will be taken from the GPS replayed.\n");
+	} else if(clock->utc(&utc)) {
+		TimeBase.source=TIME_SOURCE_RTC;
+		LogWrite(LOG_INFO,LOG_MAIN,"time taken from the RTC.\n");
+	} else {
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME,&now);
+		utc=(long long)now.tv_sec*1000000+now.tv_nsec/1000;
+		TimeBase.source=TIME_SOURCE_SYSTEM;
+		LogWrite(LOG_INFO,LOG_MAIN,"time taken from the system clock.\n");
+	}
+	timeBasePublish(&TimeBase.offset,utc-monotonic);
+}
+
+bool TimeBaseIsVirtual(void) {
+	return TimeBase.clock==&TimeBaseClockVirtual;
+}
+
+void TimeBaseAdvance(long long us) { //the other threads read the clock at any time
+	if(us>0) timeBasePublish(&TimeBase.virtualNow,TimeBase.virtualNow.value[TimeBase.virtualNow.version&1]+us);
+}
+
+bool timeBaseReadRTC(long long *utc) { //the driver gives 6 binary bytes: YY MM DD hh mm ss
+	unsigned char rtc[6];
+	int fd=open("/dev/"RTC_DEVNAME,O_RDONLY);
+	if(fd<0) return false;
+	int redBytes=read(fd,rtc,sizeof(rtc));
+	close(fd);
+	if(redBytes!=sizeof(rtc) || rtc[1]<1 || rtc[1]>12 || rtc[2]<1 || rtc[2]>31 || rtc[3]>23 || rtc[4]>59 || rtc[5]>59) return false;
+	*utc=TimeBaseFromDate(2000+rtc[0],rtc[1],rtc[2],((rtc[3]*60L+rtc[4])*60+rtc[5])*1000);
+	return true;
+}
+
+long long systemMonotonic(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (long long)now.tv_sec*1000000+now.tv_nsec/1000;
+}
+
+long long virtualMonotonic(void) {
+	return timeBaseRead(&TimeBase.virtualNow);
+}
+
+bool virtualUTC(long long *utc) { //always the same start, so that the replays do not depend on when they are done
+	*utc=0;
+	return true;
+}
+
+long long TimeBaseMonotonic(void) {
+	return TimeBase.clock->monotonic();
+}
+
+void timeBasePublish(struct timeBaseValue *published, long long value) { //only one writer at a time for each value
+	unsigned int next=published->version+1;
+	published->value[next&1]=value;
+	MEMORY_BARRIER(); //the value must be complete before the readers can see it
+	published->version=next;
+}
+
+long long timeBaseRead(const struct timeBaseValue *published) { //consistent copy, it is 64 bit also on a 32 bit CPU
+	long long value;
+	unsigned int version;
+	do {
+		version=published->version;
+		MEMORY_BARRIER();
+		value=published->value[version&1];
+		MEMORY_BARRIER();
+	} while(version!=published->version);
+	return value;
+}
+
+long long TimeBaseUTC(long long monotonic) {
+	return monotonic+timeBaseRead(&TimeBase.offset);
+}
+
+long long TimeBaseNow(void) {
+	return TimeBaseMonotonic()+timeBaseRead(&TimeBase.offset);
+}
+
+long daysFromCivil(int year, int month, int day) { //days from 1/1/1970 of a date of the Gregorian calendar
+	year-=month<=2;
+	long era=(year>=0?year:year-399)/400;
+	long yearOfEra=year-era*400;
+	long dayOfYear=(153*(month+(month>2?-3:9))+2)/5+day-1; //from the 1st of March
+	long dayOfEra=yearOfEra*365+yearOfEra/4-yearOfEra/100+dayOfYear;
+	return era*146097+dayOfEra-719468;
+}
+
+long long TimeBaseFromDate(int year, int month, int day, long dayMs) {
+	if(year<100) year+=2000; //two digits of NMEA
+	return daysFromCivil(year,month,day)*US_DAY+dayMs*1000LL;
+}
+
+long long TimeBaseFromDayMs(long dayMs) { //without the date: the day that gives the time nearest to now, also across midnight
+	long long now=TimeBaseNow();
+	long long utc=now-now%US_DAY+dayMs*1000LL;
+	if(utc-now>US_DAY/2) utc-=US_DAY;
+	else if(now-utc>US_DAY/2) utc+=US_DAY;
+	return utc;
+}
+
+long TimeBaseDayMs(long long utc) {
+	return (long)((utc%US_DAY)/1000);
+}
+
+void TimeBaseSplit(long long utc, struct tm *date) {
+	time_t seconds=(time_t)(utc/1000000);
+	gmtime_r(&seconds,date);
+}
+
+void TimeBaseDiscipline(int year, int month, int day, long dayMs, long long received) {
+	long long estimate=TimeBaseFromDate(year,month,day,dayMs)-received; //smaller than the true offset by the latency
+	long long offset=TimeBase.offset.value[TimeBase.offset.version&1]; //this thread is the only writer
+	long long error=estimate-offset;
+	if(TimeBase.source!=TIME_SOURCE_GPS || error>TIME_STEP_LIMIT || error<-TIME_STEP_LIMIT) {
+		LogWrite(LOG_INFO,LOG_GPS,"time set from the GPS, %lld ms from the previous one.\n",error/1000);
+		offset=estimate;
+		TimeBase.source=TIME_SOURCE_GPS;
+	} else if(error>0) offset=estimate; //less latency than ever: nearer to the true offset
+	else { //more latency or drift of the clock: follow it slowly
+		long long maxSlew=(received-TimeBase.lastDiscipline)*TIME_MAX_DRIFT/1000000;
+		offset+=-error<maxSlew?error:-maxSlew;
+	}
+	TimeBase.lastDiscipline=received;
+	if(offset!=TimeBase.offset.value[TimeBase.offset.version&1]) timeBasePublish(&TimeBase.offset,offset);
+}
+
+enum timeSource TimeBaseSource(void) {
+	return TimeBase.source;
+}
@@ -0,0 +1,49 @@
+//============================================================================
+// Name        : TimeBase.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : UTC time in microseconds from the monotonic clock, disciplined by the GPS
+//============================================================================
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <time.h>
+#include "Common.h"
+
+#define US_DAY 86400000000LL //microseconds in a day
+
+enum timeSource {
+	TIME_SOURCE_SYSTEM, //system clock
+	TIME_SOURCE_RTC,    //real time clock of the TomTom
+	TIME_SOURCE_GPS     //UTC given by the GPS
+};
+
+struct TimeBaseClock { //where the time comes from: the clocks of the TomTom or a virtual one
+	const char *name;
+	long long (*monotonic)(void); //us from an arbitrary start, it never goes back
+	bool (*utc)(long long *utc);  //us from 1/1/1970 UTC at start, false if unknown
+};
+
+extern const struct TimeBaseClock TimeBaseClockSystem;  //CLOCK_MONOTONIC, the RTC or else the system clock at start
+extern const struct TimeBaseClock TimeBaseClockVirtual; //moved only by TimeBaseAdvance(), from 1/1/1970 until the GPS gives the time
+
+void TimeBaseInit(const struct TimeBaseClock *clock);
+bool TimeBaseIsVirtual(void);
+void TimeBaseAdvance(long long us);                 //the virtual clock moves forward, only the thread driving it
+long long TimeBaseMonotonic(void);                  //us of the monotonic clock of the time base
+long long TimeBaseUTC(long long monotonic);         //us from 1/1/1970 UTC at the given monotonic time, it never wraps
+long long TimeBaseNow(void);                        //us from 1/1/1970 UTC
+long long TimeBaseFromDate(int year, int month, int day, long dayMs);
+long long TimeBaseFromDayMs(long dayMs);            //UTC of a time of the day, in the day nearest to now
+long TimeBaseDayMs(long long utc);                  //ms from the beginning of the UTC day
+void TimeBaseSplit(long long utc, struct tm *date); //date and time of day
+void TimeBaseDiscipline(int year, int month, int day, long dayMs, long long received); //UTC given by the GPS and monotonic time of its arrival, only the GPS parser thread
+enum timeSource TimeBaseSource(void);
+
+#endif /* TIMEBASE_H_ */
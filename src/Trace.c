@@ -0,0 +1,190 @@
+//============================================================================
+// Name        : Trace.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Recorder of timed events to measure the latency from the GPS to the display
+//============================================================================
+
+//Each thread writes fixed size records with their CLOCK_MONOTONIC time in its own lock-free ring, a low
+//priority writer thread drains the rings in the trace file. When the trace is not enabled recording an
+//event costs just a test. The file can be converted in the Chrome trace format with utility/traceExport.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "Trace.h"
+#include "RingBuffer.h"
+#include "Logger.h"
+
+#define TRACE_MAX_THREADS   16
+#define TRACE_RING_SIZE     16384  //records of each thread waiting to be written
+#define TRACE_WRITER_PERIOD 100000 //us between two drains of the rings
+#define TRACE_WRITER_NICE   10     //priority of the writer thread, lower than the others
+
+
+struct TraceRing {
+	struct RingBuffer ring;         //records of one thread
+	unsigned char id;               //ID of the ring written in the records
+	volatile bool closed;           //the thread is dead: the ring can be released once empty
+	volatile unsigned long dropped; //records lost because the ring was full
+};
+
+struct TraceStruct {
+	FILE *file;
+	volatile bool running;          //true while the writer thread is running
+	pthread_t writer;
+	pthread_key_t key;              //to get the ring of each thread
+	pthread_mutex_t ringsMutex;     //protects the list of rings, it is not taken to record
+	struct TraceRing *rings[TRACE_MAX_THREADS];
+	int numOfRings;
+	unsigned char nextId;
+	unsigned long records;          //records written in the file
+	unsigned long dropped;          //records lost by the threads already dead
+};
+
+struct TraceRing* traceGetRing(void);
+void traceReleaseRing(void *ptr);
+void traceDrainRings(void);
+void* traceRunWriter(void *ptr);
+
+static struct TraceStruct Trace = {
+	.file=NULL,
+	.running=false,
+	.numOfRings=0,
+	.nextId=0,
+	.records=0,
+	.dropped=0
+};
+
+static struct TraceRing noRing; //marks the threads that could not get a ring
+
+bool TraceOpen(void) {
+	Trace.file=fopen(BASE_PATH "trace.bin","wb");
+	if(Trace.file==NULL) {
+		LogWrite(LOG_ERROR,LOG_MAIN,"unable to create the trace file\n");
+		return false;
+	}
+	unsigned int header[2]={TRACE_FILE_VERSION,TRACE_ENDIAN_MARK};
+	fwrite(TRACE_FILE_MAGIC,1,4,Trace.file);
+	fwrite(header,sizeof(header),1,Trace.file);
+	pthread_key_create(&Trace.key,traceReleaseRing);
+	pthread_mutex_init(&Trace.ringsMutex,NULL);
+	Trace.running=true;
+	if(pthread_create(&Trace.writer,NULL,traceRunWriter,NULL)) {
+		Trace.running=false;
+		pthread_key_delete(Trace.key);
+		pthread_mutex_destroy(&Trace.ringsMutex);
+		fclose(Trace.file);
+		Trace.file=NULL;
+		return false;
+	}
+	LogWrite(LOG_INFO,LOG_MAIN,"tracing the latency of the GPS fixes\n");
+	return true;
+}
+
+struct TraceRing* traceGetRing(void) {
+	struct TraceRing *traceRing=(struct TraceRing*)pthread_getspecific(Trace.key);
+	if(traceRing!=NULL) return traceRing;
+	traceRing=(struct TraceRing*)malloc(sizeof(struct TraceRing)); //first event of this thread
+	if(traceRing!=NULL) {
+		if(RingBufferInit(&traceRing->ring,TRACE_RING_SIZE)) {
+			traceRing->closed=false;
+			traceRing->dropped=0;
+			pthread_mutex_lock(&Trace.ringsMutex);
+			if(Trace.numOfRings<TRACE_MAX_THREADS) {
+				traceRing->id=Trace.nextId++;
+				Trace.rings[Trace.numOfRings++]=traceRing;
+			} else {
+				RingBufferRelease(&traceRing->ring);
+				free(traceRing);
+				traceRing=NULL;
+			}
+			pthread_mutex_unlock(&Trace.ringsMutex);
+		} else {
+			free(traceRing);
+			traceRing=NULL;
+		}
+	}
+	if(traceRing==NULL) traceRing=&noRing; //do not try again at each event
+	pthread_setspecific(Trace.key,traceRing);
+	return traceRing;
+}
+
+void traceReleaseRing(void *ptr) { //called at the death of a thread
+	struct TraceRing *traceRing=(struct TraceRing*)ptr;
+	if(traceRing!=&noRing) traceRing->closed=true; //the writer will release it
+}
+
+void TraceEvent(enum traceEvent event, enum tracePhase phase, unsigned int id, unsigned int arg) {
+	if(!Trace.running) return;
+	struct TraceRing *traceRing=traceGetRing();
+	if(traceRing==&noRing) return;
+	struct traceRecord record;
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	record.sec=now.tv_sec;
+	record.nsec=now.tv_nsec;
+	record.id=id;
+	record.arg=arg;
+	record.event=event;
+	record.phase=phase;
+	record.thread=traceRing->id;
+	record.reserved=0;
+	if(!RingBufferWrite(&traceRing->ring,&record,sizeof(record))) traceRing->dropped++;
+}
+
+void traceDrainRings(void) {
+	struct traceRecord record;
+	pthread_mutex_lock(&Trace.ringsMutex);
+	for(int i=0;i<Trace.numOfRings;i++) {
+		struct TraceRing *traceRing=Trace.rings[i];
+		bool closed=traceRing->closed; //read it before draining: after that no more records can arrive
+		while(RingBufferRead(&traceRing->ring,&record,sizeof(record))) {
+			fwrite(&record,sizeof(record),1,Trace.file);
+			Trace.records++;
+		}
+		if(closed) { //the thread is dead and its ring is empty
+			Trace.dropped+=traceRing->dropped;
+			RingBufferRelease(&traceRing->ring);
+			free(traceRing);
+			Trace.rings[i--]=Trace.rings[--Trace.numOfRings];
+		}
+	}
+	pthread_mutex_unlock(&Trace.ringsMutex);
+	fflush(Trace.file);
+}
+
+void* traceRunWriter(void *ptr) {
+	setpriority(PRIO_PROCESS,0,TRACE_WRITER_NICE); //on Linux it works on the calling thread
+	while(Trace.running) {
+		usleep(TRACE_WRITER_PERIOD);
+		traceDrainRings();
+	}
+	traceDrainRings(); //the last events
+	return NULL;
+}
+
+void TraceClose(void) {
+	if(Trace.file==NULL) return;
+	Trace.running=false;
+	pthread_join(Trace.writer,NULL);
+	pthread_key_delete(Trace.key); //no more destructors for the rings
+	for(int i=0;i<Trace.numOfRings;i++) {
+		Trace.dropped+=Trace.rings[i]->dropped;
+		RingBufferRelease(&Trace.rings[i]->ring);
+		free(Trace.rings[i]);
+	}
+	Trace.numOfRings=0;
+	pthread_mutex_destroy(&Trace.ringsMutex);
+	fclose(Trace.file);
+	Trace.file=NULL;
+	LogWrite(LOG_INFO,LOG_MAIN,"traced %lu events, %lu lost.\n",Trace.records,Trace.dropped);
+}
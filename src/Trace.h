@@ -0,0 +1,55 @@
+//============================================================================
+// Name        : Trace.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Header of Trace.c recorder of timed events
+//============================================================================
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "Common.h"
+
+#define TRACE_FILE_MAGIC   "ANTR"     //first 4 bytes of the trace file
+#define TRACE_FILE_VERSION 1
+#define TRACE_ENDIAN_MARK  0x01020304 //to find out the byte order of integers
+
+enum traceEvent {
+	TRACE_BYTES_ARRIVED, //bytes read from the GPS: id is the stream offset after them, arg their number
+	TRACE_SENTENCE_OK,   //checksum of a sentence or binary frame verified: id is its stream offset, arg its length
+	TRACE_EPOCH_CLOSED,  //GPS solution ready to be published: id is its number, arg the offset of its first sentence with UTC
+	TRACE_NAV_UPDATE,    //span of NavUpdatePosition()
+	TRACE_HSI_DRAW,      //span of the drawing of the HSI
+	TRACE_FB_FLUSH,      //span of FBrenderFlush()
+	TRACE_NUM_EVENTS
+};
+
+enum tracePhase {
+	TRACE_INSTANT,
+	TRACE_BEGIN,
+	TRACE_END
+};
+
+struct traceRecord { //20 bytes, all the fields are naturally aligned
+	unsigned int sec, nsec; //CLOCK_MONOTONIC time of the event
+	unsigned int id, arg;   //meaning depends on the event
+	unsigned char event;    //enum traceEvent
+	unsigned char phase;    //enum tracePhase
+	unsigned char thread;   //ID of the ring of the thread
+	unsigned char reserved;
+};
+
+bool TraceOpen(void);
+void TraceEvent(enum traceEvent event, enum tracePhase phase, unsigned int id, unsigned int arg);
+void TraceClose(void);
+
+#define TRACE_MARK(event,id,arg) TraceEvent(event,TRACE_INSTANT,id,arg)
+#define TRACE_BEGIN(event)       TraceEvent(event,TRACE_BEGIN,0,0)
+#define TRACE_END(event)         TraceEvent(event,TRACE_END,0,0)
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,369 @@
+//============================================================================
+// Name        : UBXparser.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Parses u-blox UBX messages from a GPS device
+//============================================================================
+
+//The frames are B5 62, class, ID, 16 bits length, payload, 8 bits Fletcher checksum; all the fields are
+//little endian. Once its serial port is set up the receiver is told to send only NAV-PVT and NAV-EOE at each
+//epoch, NAV-DOP and NAV-SAT once per second. The payload is decoded in place and NAV-EOE closes the epoch and
+//publishes it, so NAV-SAT, sent after NAV-PVT, stays with its epoch; until the first NAV-EOE each NAV-PVT
+//closes the epoch.
+
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "UBXparser.h"
+#include "GPSreceiver.h"
+#include "Configuration.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "TimeBase.h"
+
+#define UBX_CLASS_NAV   0x01
+#define UBX_NAV_DOP     0x04 //dilutions of precision
+#define UBX_NAV_DOP_LEN 18
+#define UBX_NAV_PVT     0x07 //the navigation solution
+#define UBX_NAV_PVT_LEN 84   //92 from protocol 15 with the magnetic declination at the end
+#define UBX_NAV_SAT     0x35 //satellites in view
+#define UBX_NAV_SAT_HEADER_LEN 8
+#define UBX_NAV_SAT_SV_LEN     12
+#define UBX_NAV_EOE     0x61 //end of epoch
+#define UBX_CLASS_ACK   0x05
+#define UBX_ACK_NAK     0x00
+#define UBX_ACK_ACK     0x01
+#define UBX_CLASS_CFG   0x06
+#define UBX_CFG_MSG     0x01 //output rate of a message on the current port
+#define UBX_CFG_RATE    0x08 //measurement rate
+#define UBX_CLASS_NMEA  0xF0
+
+#define UBX_U16(p) ((unsigned int)((p)[0]|((p)[1]<<8)))
+#define UBX_U32(p) ((uint32_t)(p)[0]|((uint32_t)(p)[1]<<8)|((uint32_t)(p)[2]<<16)|((uint32_t)(p)[3]<<24))
+#define UBX_S16(p) ((int16_t)UBX_U16(p))
+#define UBX_S32(p) ((int32_t)UBX_U32(p))
+
+
+enum UBXparserStatus {
+	UBX_SYNC_1,    //waiting for the first sync char
+	UBX_SYNC_2,    //waiting for the second sync char
+	UBX_CLASS,
+	UBX_ID,
+	UBX_LENGTH_1,
+	UBX_LENGTH_2,
+	UBX_PAYLOAD,
+	UBX_CHECKSUM_A,
+	UBX_CHECKSUM_B
+};
+
+struct UBXparserStruct {
+	int source;                  //index of the GPS source parsed with this context
+	enum UBXparserStatus frameStatus;
+	unsigned char msgClass, msgId;
+	int payloadLength,rcvdBytesOfPayload;
+	unsigned char ckA,ckB;       //Fletcher checksum of class, ID, length and payload updated as they arrive
+	unsigned char payload[UBX_MAX_PAYLOAD_LENGTH]; //the only copy of the payload, decoded in place
+	unsigned int streamOffset;   //offset in the GPS stream of the first byte of the buffer being processed
+	unsigned int frameOffset;    //offset in the GPS stream of the start of the current frame
+	unsigned int epochOffset;    //offset in the GPS stream of the NAV-PVT of the current epoch, or of its first frame without it
+	bool epochStarted;           //true if epochOffset has been taken for the current epoch
+	struct GPSsolution epoch;    //solution being assembled from the messages of the same epoch
+	bool endOfEpochSeen;         //the receiver sends NAV-EOE: it closes the epochs instead of NAV-PVT
+	unsigned long pvtMsgs, dopMsgs, satMsgs, acks, naks;
+	unsigned long otherMsgs, wrongChecksums, brokenFrames, publishedEpochs;
+};
+
+void ubxProcessPayload(void);
+void ubxDecodePVT(void);
+void ubxDecodeDOP(void);
+void ubxDecodeSAT(void);
+void ubxCloseEpoch(void);
+bool ubxSend(int fd, unsigned char msgClass, unsigned char msgId, const unsigned char *payload, int length);
+
+static struct UBXparserStruct UBXparsers[GPS_MAX_SOURCES]; //one context for each GPS source
+static struct UBXparserStruct *UBXparser=UBXparsers; //context of the source being parsed, there is only the parser thread
+
+static const unsigned char NMEAmessages[]={0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0A,0x0D,0x0F}; //GGA GLL GSA GSV RMC VTG GRS GST ZDA GBS DTM GNS VLW
+
+void UBXparserInit(int source) {
+	UBXparser=&UBXparsers[source];
+	memset(UBXparser,0,sizeof(*UBXparser));
+	UBXparser->source=source;
+	UBXparser->epoch.fixMode=MODE_UNKNOWN;
+	UBXparser->frameStatus=UBX_SYNC_1;
+}
+
+bool ubxSend(int fd, unsigned char msgClass, unsigned char msgId, const unsigned char *payload, int length) {
+	unsigned char frame[8+16]; //the configuration messages sent here are short
+	unsigned char ckA=0, ckB=0;
+	frame[0]=0xB5;
+	frame[1]=0x62;
+	frame[2]=msgClass;
+	frame[3]=msgId;
+	frame[4]=length&0xFF;
+	frame[5]=length>>8;
+	memcpy(frame+6,payload,length);
+	for(int i=2;i<6+length;i++) {
+		ckA+=frame[i];
+		ckB+=ckA;
+	}
+	frame[6+length]=ckA;
+	frame[7+length]=ckB;
+	return write(fd,frame,8+length)==8+length;
+}
+
+bool UBXparserConfigureReceiver(int fd, int rateHz) { //NAV-PVT and NAV-EOE each epoch, NAV-DOP and NAV-SAT once per second, no NMEA
+	bool ok=true;
+	unsigned char msgRate[3]={UBX_CLASS_NMEA,0,0}; //class, ID, rate in epochs on the current port
+	for(unsigned int i=0;i<sizeof(NMEAmessages);i++) {
+		msgRate[1]=NMEAmessages[i];
+		ok&=ubxSend(fd,UBX_CLASS_CFG,UBX_CFG_MSG,msgRate,sizeof(msgRate));
+	}
+	int perSecond=rateHz>0?rateHz:1; //epochs in a second
+	if(perSecond>255) perSecond=255;
+	msgRate[0]=UBX_CLASS_NAV;
+	msgRate[1]=UBX_NAV_PVT;
+	msgRate[2]=1;
+	ok&=ubxSend(fd,UBX_CLASS_CFG,UBX_CFG_MSG,msgRate,sizeof(msgRate));
+	msgRate[1]=UBX_NAV_EOE; //closes each epoch after all its messages
+	ok&=ubxSend(fd,UBX_CLASS_CFG,UBX_CFG_MSG,msgRate,sizeof(msgRate));
+	msgRate[1]=UBX_NAV_DOP;
+	msgRate[2]=perSecond;
+	ok&=ubxSend(fd,UBX_CLASS_CFG,UBX_CFG_MSG,msgRate,sizeof(msgRate));
+	msgRate[1]=UBX_NAV_SAT;
+	ok&=ubxSend(fd,UBX_CLASS_CFG,UBX_CFG_MSG,msgRate,sizeof(msgRate));
+	if(rateHz>0) { //measurement period in ms, one navigation solution per measurement, aligned to GPS time
+		int period=1000/rateHz;
+		unsigned char rate[6]={period&0xFF,period>>8,1,0,1,0};
+		ok&=ubxSend(fd,UBX_CLASS_CFG,UBX_CFG_RATE,rate,sizeof(rate));
+	}
+	if(ok) LogWrite(LOG_INFO,LOG_GPS,"u-blox receiver configured for UBX at %d Hz.\n",rateHz);
+	else LogWrite(LOG_WARNING,LOG_GPS,"unable to send the configuration to the u-blox receiver.\n");
+	return ok;
+}
+
+void UBXparserProcessBuffer(int source, unsigned char *buf, int redBytes) {
+	UBXparser=&UBXparsers[source];
+	for(int i=0;i<redBytes;i++) {
+		unsigned char c=buf[i];
+		if(UBXparser->frameStatus>=UBX_CLASS && UBXparser->frameStatus<=UBX_LENGTH_2) { //the header is in the checksum
+			UBXparser->ckA+=c;
+			UBXparser->ckB+=UBXparser->ckA;
+		}
+		switch(UBXparser->frameStatus) { //for each byte received in the buffer
+			case UBX_SYNC_1:
+				if(c==0xB5) {
+					UBXparser->frameOffset=UBXparser->streamOffset+i;
+					UBXparser->frameStatus=UBX_SYNC_2;
+				}
+				break;
+			case UBX_SYNC_2:
+				if(c==0x62) {
+					UBXparser->ckA=0;
+					UBXparser->ckB=0;
+					UBXparser->frameStatus=UBX_CLASS;
+				} else UBXparser->frameStatus=c==0xB5?UBX_SYNC_2:UBX_SYNC_1;
+				break;
+			case UBX_CLASS:
+				UBXparser->msgClass=c;
+				UBXparser->frameStatus=UBX_ID;
+				break;
+			case UBX_ID:
+				UBXparser->msgId=c;
+				UBXparser->frameStatus=UBX_LENGTH_1;
+				break;
+			case UBX_LENGTH_1:
+				UBXparser->payloadLength=c;
+				UBXparser->frameStatus=UBX_LENGTH_2;
+				break;
+			case UBX_LENGTH_2:
+				UBXparser->payloadLength|=c<<8;
+				UBXparser->rcvdBytesOfPayload=0;
+				if(UBXparser->payloadLength>UBX_MAX_PAYLOAD_LENGTH) { //too long: skip it
+					UBXparser->brokenFrames++;
+					UBXparser->frameStatus=UBX_SYNC_1;
+				} else UBXparser->frameStatus=UBXparser->payloadLength>0?UBX_PAYLOAD:UBX_CHECKSUM_A;
+				break;
+			case UBX_PAYLOAD: { //getting bytes of the payload, copied at once as many as available
+				int len=UBXparser->payloadLength-UBXparser->rcvdBytesOfPayload;
+				if(len>redBytes-i) len=redBytes-i;
+				unsigned char *dest=UBXparser->payload+UBXparser->rcvdBytesOfPayload;
+				memcpy(dest,buf+i,len);
+				unsigned char ckA=UBXparser->ckA, ckB=UBXparser->ckB;
+				for(int j=0;j<len;j++) {
+					ckA+=dest[j];
+					ckB+=ckA;
+				}
+				UBXparser->ckA=ckA;
+				UBXparser->ckB=ckB;
+				UBXparser->rcvdBytesOfPayload+=len;
+				i+=len-1;
+				if(UBXparser->rcvdBytesOfPayload==UBXparser->payloadLength) UBXparser->frameStatus=UBX_CHECKSUM_A;
+			}	break;
+			case UBX_CHECKSUM_A:
+				if(c==UBXparser->ckA) UBXparser->frameStatus=UBX_CHECKSUM_B;
+				else {
+					UBXparser->wrongChecksums++;
+					UBXparser->frameStatus=UBX_SYNC_1;
+				}
+				break;
+			case UBX_CHECKSUM_B:
+				if(c==UBXparser->ckB) {
+					if(UBXparser->source==0) TRACE_MARK(TRACE_SENTENCE_OK,UBXparser->frameOffset,UBXparser->payloadLength);
+					if(!UBXparser->epochStarted) {
+						UBXparser->epochOffset=UBXparser->frameOffset;
+						UBXparser->epochStarted=true;
+						UBXparser->epoch.received=TimeBaseMonotonic();
+					}
+					ubxProcessPayload();
+				} else UBXparser->wrongChecksums++;
+				UBXparser->frameStatus=UBX_SYNC_1;
+				break;
+		}
+	} //end of for(each byte) of just received sequence
+	UBXparser->streamOffset+=redBytes;
+}
+
+void UBXparserLogStats(int source) {
+	UBXparser=&UBXparsers[source];
+	LogWrite(LOG_INFO,LOG_GPS,"source %d: UBX NAV-PVT %lu, NAV-DOP %lu, NAV-SAT %lu messages, %lu ACK, %lu NAK, %lu others, %lu wrong checksums, %lu broken frames.\n",source,
+			UBXparser->pvtMsgs,UBXparser->dopMsgs,UBXparser->satMsgs,UBXparser->acks,UBXparser->naks,UBXparser->otherMsgs,UBXparser->wrongChecksums,UBXparser->brokenFrames);
+	LogWrite(LOG_INFO,LOG_GPS,"source %d: %lu epochs parsed.\n",source,UBXparser->publishedEpochs);
+}
+
+void ubxProcessPayload(void) {
+	int len=UBXparser->payloadLength;
+	if(UBXparser->msgClass==UBX_CLASS_NAV) switch(UBXparser->msgId) {
+		case UBX_NAV_PVT:
+			if(len<UBX_NAV_PVT_LEN) break;
+			UBXparser->pvtMsgs++;
+			UBXparser->epochOffset=UBXparser->frameOffset; //the epoch starts with its UTC, not with what is left of the one before
+			UBXparser->epoch.received=TimeBaseMonotonic();
+			ubxDecodePVT();
+			if(!UBXparser->endOfEpochSeen) ubxCloseEpoch(); //NAV-EOE not seen yet: NAV-SAT will go with the next epoch
+			return;
+		case UBX_NAV_DOP:
+			if(len<UBX_NAV_DOP_LEN) break;
+			UBXparser->dopMsgs++;
+			ubxDecodeDOP();
+			return;
+		case UBX_NAV_SAT:
+			if(len<UBX_NAV_SAT_HEADER_LEN) break;
+			UBXparser->satMsgs++;
+			ubxDecodeSAT();
+			return;
+		case UBX_NAV_EOE: //from now on it closes the epochs, after NAV-SAT too
+			UBXparser->endOfEpochSeen=true;
+			ubxCloseEpoch();
+			return;
+	} else if(UBXparser->msgClass==UBX_CLASS_ACK && len==2) {
+		if(UBXparser->msgId==UBX_ACK_ACK) UBXparser->acks++;
+		else {
+			UBXparser->naks++;
+			LogWrite(LOG_WARNING,LOG_GPS,"u-blox receiver refused the message of class %02X ID %02X\n",UBXparser->payload[0],UBXparser->payload[1]);
+		}
+		return;
+	}
+	UBXparser->otherMsgs++; //just count it: logging each one would be too expensive
+}
+
+void ubxDecodePVT(void) { //NAV-PVT: time, date, position, altitude, velocity, accuracy and satellites in use
+	const unsigned char *p=UBXparser->payload;
+	struct GPSsolution *epoch=&UBXparser->epoch;
+	unsigned char valid=p[11];
+	if((valid&3)==3) { //valid date and time
+		long nano=UBX_S32(p+16); //fraction of second, it can be negative
+		long timestamp=((p[8]*60L+p[9])*60+p[10])*1000+(nano>=0?(nano+500000)/1000000:-((500000-nano)/1000000));
+		if(timestamp<0) timestamp=0; //the rounding must not change the day
+		else if(timestamp>=MS_DAY) timestamp=MS_DAY-1;
+		epoch->timestamp=timestamp;
+		epoch->hour=timestamp/3600000;
+		epoch->minute=(timestamp/60000)%60;
+		epoch->milliSec=timestamp%60000;
+		epoch->year=UBX_U16(p+4);
+		epoch->month=p[6];
+		epoch->day=p[7];
+		epoch->content|=SOLUTION_TIME|SOLUTION_DATE;
+	}
+	epoch->satsInUse=p[23];
+	epoch->content|=SOLUTION_SATS_IN_USE;
+	if(!(p[21]&1)) { //gnssFixOK not set: the position is not valid
+		epoch->fixMode=MODE_NO_FIX;
+		return;
+	}
+	switch(p[20]) { //fix type
+		case 2: //2D
+		case 1: //dead reckoning only
+			epoch->fixMode=MODE_2D_FIX;
+			break;
+		case 3: //3D
+		case 4: //GNSS and dead reckoning
+			epoch->fixMode=MODE_3D_FIX;
+			break;
+		default: //no fix or time only
+			epoch->fixMode=MODE_NO_FIX;
+			return;
+	}
+	epoch->pos.lon=UBX_S32(p+24); //1e-7 degrees as GeoPosition
+	epoch->pos.lat=UBX_S32(p+28);
+	epoch->alt=UBX_S32(p+32); //mm respect WGS84
+	epoch->altUnit='M';
+	epoch->groundSpeedKnots=(long)(UBX_S32(p+60)*1943844LL/1000000); //from mm/s to thousandths of knot
+	epoch->trueTrack=UBX_S32(p+64)/1000; //from 1e-5 to hundredths of degree
+	if(epoch->trueTrack<0) epoch->trueTrack+=36000;
+	epoch->latErr=UBX_U32(p+40); //horizontal accuracy estimate in mm used for both the components
+	epoch->lonErr=epoch->latErr;
+	epoch->altErr=UBX_U32(p+44);
+	epoch->content|=SOLUTION_POSITION|SOLUTION_ALTITUDE|SOLUTION_VELOCITY|SOLUTION_ERRORS;
+	if(UBXparser->payloadLength>=92 && (valid&8)) { //valid magnetic declination
+		int magDec=UBX_S16(p+88); //hundredths of degree, positive to east
+		epoch->isMagVarToEast=magDec>=0;
+		epoch->magneticVariation=magDec>=0?magDec:-magDec;
+		epoch->content|=SOLUTION_MAGVAR;
+	}
+}
+
+void ubxDecodeDOP(void) { //NAV-DOP: all the dilutions already in hundredths
+	const unsigned char *p=UBXparser->payload;
+	struct GPSsolution *epoch=&UBXparser->epoch;
+	epoch->pdop=UBX_U16(p+6);
+	epoch->vdop=UBX_U16(p+10);
+	epoch->hdop=UBX_U16(p+12);
+	epoch->content|=SOLUTION_DOP;
+}
+
+void ubxDecodeSAT(void) { //NAV-SAT: elevation, azimuth and C/No of the satellites in view
+	const unsigned char *p=UBXparser->payload;
+	int numSvs=p[5];
+	if(UBX_NAV_SAT_HEADER_LEN+numSvs*UBX_NAV_SAT_SV_LEN>UBXparser->payloadLength) return;
+	struct GPSsolution *epoch=&UBXparser->epoch;
+	for(int i=0; i<MAX_NUM_SAT; i++) for(int j=SAT_ELEVATION; j<=SAT_SNR; j++) epoch->satellites[i][j]=-1; //reset all sats
+	epoch->satsInView=0;
+	for(int i=0;i<numSvs;i++) {
+		const unsigned char *sv=p+UBX_NAV_SAT_HEADER_LEN+i*UBX_NAV_SAT_SV_LEN;
+		int satId=sv[1];
+		if(sv[0]!=0) continue; //the matrix is only for GPS PRNs
+		epoch->satsInView++;
+		if(satId<=0 || satId>MAX_NUM_SAT) continue;
+		epoch->satellites[satId-1][SAT_ELEVATION]=(signed char)sv[3];
+		epoch->satellites[satId-1][SAT_AZIMUTH]=UBX_S16(sv+4);
+		epoch->satellites[satId-1][SAT_SNR]=sv[2];
+	}
+	epoch->content|=SOLUTION_SATELLITES|SOLUTION_SATS_IN_VIEW;
+}
+
+void ubxCloseEpoch(void) { //publish the current epoch and start a new empty one
+	if(UBXparser->epoch.content!=0) {
+		if(UBXparser->source==0) TRACE_MARK(TRACE_EPOCH_CLOSED,UBXparser->publishedEpochs,UBXparser->epochOffset);
+		GPSpublishSolution(UBXparser->source,&UBXparser->epoch);
+		UBXparser->publishedEpochs++;
+	}
+	memset(&UBXparser->epoch,0,sizeof(UBXparser->epoch));
+	UBXparser->epoch.fixMode=MODE_UNKNOWN;
+	UBXparser->epochStarted=false;
+}
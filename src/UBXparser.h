@@ -0,0 +1,25 @@
+//============================================================================
+// Name        : UBXparser.h
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Parses u-blox UBX messages from a GPS device
+//============================================================================
+
+#ifndef UBXPARSER_H_
+#define UBXPARSER_H_
+
+#include "Common.h"
+
+#define UBX_MAX_PAYLOAD_LENGTH 1024 //enough for NAV-SAT with 84 satellites
+
+void UBXparserInit(int source);
+bool UBXparserConfigureReceiver(int fd, int rateHz);
+void UBXparserProcessBuffer(int source, unsigned char *buf, int redBytes);
+void UBXparserLogStats(int source);
+
+#endif /* UBXPARSER_H_ */
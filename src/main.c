@@ -6,7 +6,7 @@
 // Copyright   : (C) 2010-2016 Alberto Realis-Luc
 // License     : GNU GPL v2
 // Repository  : https://github.com/AirNavigator/AirNavigator.git
-// Last change : 28/2/2016
+// Last change : 18/10/2026
 // Description : main function of the AirNavigator program for TomTom devices
 //============================================================================
 
@@ -27,11 +27,18 @@
 #include "AirCalc.h"
 #include "BlackBox.h"
 #include "HSI.h"
+#include "Trace.h"
+#include "EventLoop.h"
+#include "Accelerometer.h"
+#include "TimeBase.h"
+#include "FastTrig.h"
 
 #ifndef VERSION
 #define VERSION "0.3.2"
 #endif
 
+#define MAIN_REFRESH_PERIOD 1000 //ms between two redraws of the screens not updated by the GPS
+
 
 typedef struct fileName {
 	int seqNo;             //sequence number
@@ -44,21 +51,33 @@ struct mainStruct {
 	enum mainStatus status;           //Main status, it is the screen shown: main menu, HSI or select GPX file
 	char *bottomBarMsg;               //Text confirmation message shown at the bottom of main menu
 	unsigned short bottomBarMsgColor; //Color of text confirmation message
+	fileEntry fileList, currFile;     //the list of the found GPX flight plans and the pointer to the current one
+	int numGPXfiles;
+	int numWPloaded;                  //the number of waypoints loaded from the selected flight plan
 };
 
 void releaseAll(void);
 int showMessage(unsigned short color, bool logMessage, const char *args, ...);
+void drawScreen(void);
+void processTouch(const TS_EVENT *lastTouch);
+void refreshScreen(void *arg);
 
 static struct mainStruct mainData = {
 	.status=MAIN_NOT_INIT,
-	.bottomBarMsg=NULL
+	.bottomBarMsg=NULL,
+	.fileList=NULL,
+	.currFile=NULL,
+	.numGPXfiles=0,
+	.numWPloaded=0
 };
 
 int main(int argc, char** argv) {
 	if(openLog()) //if the log file has been created...
 		if(FBrenderOpen()) //if the frame buffer render is started
-			if(TSreaderStart()) mainData.status=MAIN_DISPLAY_MENU; //if the touch screen listening thread is started
-			else printLog("ERROR: Unable to start the Touch Screen manager!\n");
+			if(EventLoopInit()) //if the event loop is ready
+				if(TSreaderStart(processTouch)) mainData.status=MAIN_DISPLAY_MENU; //if the touch screen is listened
+				else printLog("ERROR: Unable to start the Touch Screen manager!\n");
+			else printLog("ERROR: Unable to start the event loop!\n");
 		else printLog("ERROR: Unable to start the Frame Buffer renderer!\n");
 	else printf("ERROR: Unable to create the logFile file!\n");
 	if(mainData.status!=MAIN_DISPLAY_MENU) {
@@ -102,8 +121,9 @@ int main(int argc, char** argv) {
 	}
 	printLog("Screen resolution: %dx%d pixel\n",screen.width,screen.height); //logFile screen resolution
 	loadConfig(); //Load configuration
-	fileEntry fileList=NULL, currFile=NULL; //the list of the found GPX flight plans and the pointer to the current one
-	int numGPXfiles=0;
+	FastTrigInit(); //before any drawing or navigation
+	TimeBaseInit(config.GPSreplayFile!=NULL?&TimeBaseClockVirtual:&TimeBaseClockSystem); //from the RTC until the GPS gives the time
+	if(config.traceEnabled) TraceOpen();
 	struct dirent *entry=NULL;
 	char *routesPath; //... prepare the list of available flight plans found in the routes folder
 	asprintf(&routesPath,"%sRoutes",BASE_PATH);
@@ -119,175 +139,193 @@ int main(int argc, char** argv) {
 						(entry->d_name[len-1]=='X' || entry->d_name[len-1]=='x')) {
 					fileEntry newFile=(fileEntry)malloc(sizeof(struct fileName));
 					newFile->name=strdup(entry->d_name);
-					newFile->seqNo=numGPXfiles;
+					newFile->seqNo=mainData.numGPXfiles;
 					newFile->next=NULL;
-					if(numGPXfiles==0) { //it's the first
-							fileList=newFile;
+					if(mainData.numGPXfiles==0) { //it's the first
+							mainData.fileList=newFile;
 							newFile->prev=NULL;
 					} else {
-							currFile->next=newFile;
-							newFile->prev=currFile; //link to the previous
+							mainData.currFile->next=newFile;
+							newFile->prev=mainData.currFile; //link to the previous
 					}
-					currFile=newFile;
-					numGPXfiles++;
+					mainData.currFile=newFile;
+					mainData.numGPXfiles++;
 				}
 		}
 		closedir(dir);
-		if(numGPXfiles==0) showMessage(config.colorSchema.warning,true,"WARNING: No GPX flight plan files found.");
+		if(mainData.numGPXfiles==0) showMessage(config.colorSchema.warning,true,"WARNING: No GPX flight plan files found.");
 		else {
-			showMessage(config.colorSchema.ok,true,"Found %d GPX flight plan files.",numGPXfiles);
-			currFile=fileList;
+			showMessage(config.colorSchema.ok,true,"Found %d GPX flight plan files.",mainData.numGPXfiles);
+			mainData.currFile=mainData.fileList;
 		}
 	} else showMessage(config.colorSchema.caution,true,"ERROR: could not open the Routes directory.");
 	if(!GPSreceiverStart()) showMessage(config.colorSchema.caution,true,"ERROR: GPSreceiver failed to start."); //Start GPSrecveiver
 	//TODO: if GPS failed to start many buttons should be disabled...
-	bool doExit=false;
-	TS_EVENT lastTouch; //data of the last event from the touch screen
-	char *toLoad=NULL; //the path to the chosen GPX file to be loaded
-	int numWPloaded=0; //the number of waypoints loaded from the selected flight plan
-	while(!doExit) { //Main loop
-		FBrenderClear(0,screen.height,config.colorSchema.background);
-		switch(mainData.status) { //Depending on status display the proper screen
-			case MAIN_DISPLAY_MENU:
-				FBrenderBlitText(10,10,config.colorSchema.dirMarker,config.colorSchema.background,false,"AirNavigator v.%s",VERSION);
-				FBrenderBlitText(200,10,config.colorSchema.magneticDir,config.colorSchema.background,true,"http://www.alus.it/airnavigator");
-				DrawButton(20,50,numGPXfiles>0,"Load flight plan");
-				DrawButton(20,90,NavGetStatus()==NAV_STATUS_TO_START_NAV,"Start navigation");
-				DrawButton(20,130,numWPloaded>1,"Reverse flight plan");
-				DrawButton(20,170,numWPloaded>0,"Unload flight plan");
-				DrawButton(220,50,true,"Show HSI");
-				DrawButton(220,90,true,BlackBoxIsStarted()?"Stop Track Recorder":"Start Track Recorder");
-				DrawButton(220,130,BlackBoxIsStarted(),BlackBoxIsPaused()?"Resume Track Recorder":"Pause Track Recorder");
-				DrawButton(220,210,true,"EXIT");
-				if(mainData.bottomBarMsg!=NULL) FBrenderBlitText(10,260,mainData.bottomBarMsgColor,config.colorSchema.background,false,"%s                                                         ",mainData.bottomBarMsg); //render confirmation msg
-				break;
-			case MAIN_DISPLAY_SELECT_ROUTE: //Display the select GPX flight plan screen
-				FBrenderBlitText(20,20,config.colorSchema.dirMarker,config.colorSchema.background,0,"Select and load the desired GPX flight plan");
-				FBrenderBlitText(20,35,config.colorSchema.text,config.colorSchema.background,0,"%d GPX flight plans found.",numGPXfiles);
-				FBrenderBlitText(20,60,config.colorSchema.text,config.colorSchema.background,0,"Selected GPX flight plan:");
-				FBrenderBlitText(20,70,config.colorSchema.warning,config.colorSchema.background,0,"%s                                         ",currFile->name); //print the name of the current file
-				DrawButton(20,90,currFile->prev!=NULL,"<< Previous");
-				DrawButton(220,90,currFile->next!=NULL,"    Next >>");
-				DrawButton(220,210,currFile!=NULL,"    LOAD");
-				DrawButton(20,210,true,"Back to menu");
-			break;
-			case MAIN_DISPLAY_HSI: //Display HSI
-				NavRedrawNavInfo();
-				break;
-			case MAIN_DISPLAY_SUNRISE_SUNSET: // Display ephemerides
-				NavRedrawEphemeridalInfo();
-				break;
-			default:
-				break;
-		} //end of display switch
-		FBrenderFlush();
-		TSreaderGetTouch(&lastTouch); //wait that the user touches the screen and get the coordinates of the touch
-		switch(mainData.status) { //depending on which screen we are process the input touch
-			case MAIN_DISPLAY_MENU: //here process main menu input
-				if(lastTouch.x>=20 && lastTouch.x<=200) { //touched the first column of buttons
-					if(lastTouch.y>=50 && lastTouch.y<=80 && numGPXfiles>0) mainData.status=MAIN_DISPLAY_SELECT_ROUTE; //touched load route button
-					if(lastTouch.y>=90 && lastTouch.y<=120 && NavGetStatus()==NAV_STATUS_TO_START_NAV) { //touched start navigation button
-						NavStartNavigation();
-						mainData.status=MAIN_DISPLAY_HSI;
-					}
-					if(lastTouch.y>=130 && lastTouch.y<=160 && numWPloaded>1) { //touched reverse route button
-						if(NavReverseRoute()) showMessage(config.colorSchema.ok,false,"Route reversed."); //reverse the route
-						else showMessage(config.colorSchema.caution,true,"ERROR: Failed to reverse route.");
-					}
-					if(lastTouch.y>=170 && lastTouch.y<=200 && numWPloaded>0) { //touched unload route button
-						NavClearRoute();
-						numWPloaded=0;
-						currFile=fileList;
-						showMessage(config.colorSchema.ok,false,"Route unloaded.");
-					}
-				} else if(lastTouch.x>=220 && lastTouch.x<=400) { //touched second column of buttons
-					if(lastTouch.y>=50 && lastTouch.y<=80) mainData.status=MAIN_DISPLAY_HSI; //touched show HSI button
-					if(lastTouch.y>=90 && lastTouch.y<=120) { //touched start stop track recorder button
-						if(BlackBoxIsStarted()) {
-							BlackBoxClose();
-							showMessage(config.colorSchema.ok,true,"Track recorder stopped.");
-						} else {
-							BlackBoxStart();
-							showMessage(config.colorSchema.ok,true,"Track recorder started.");
-						}
-					}
-					if(lastTouch.y>=130 && lastTouch.y<=160 && BlackBoxIsStarted()) { //touched pause resume track recorder button
-						if(BlackBoxIsPaused()) {
-							BlackBoxResume();
-							showMessage(config.colorSchema.ok,false,"Track recorder resumed.");
-						} else {
-							BlackBoxPause();
-							showMessage(config.colorSchema.ok,false,"Track recorder paused.");
-						}
-					}
-					if(lastTouch.y>=210 && lastTouch.y<=240) { //touched exit button
-						doExit=true;
-						showMessage(config.colorSchema.warning,false,"Exit: releasing all... Goodbye!"); //Show goodbye message
-						FBrenderBlitText(10,260,mainData.bottomBarMsgColor,config.colorSchema.background,false,"%s                                                         ",mainData.bottomBarMsg);
-						FBrenderFlush();
-					}
-				}
-				break;
-			case MAIN_DISPLAY_SELECT_ROUTE: //here process user input in select route screen
-				if(lastTouch.y>=90 && lastTouch.y<=120) { //user touched at the height of prev and next buttons
-					if(lastTouch.x>=20 && lastTouch.x<=200 && currFile->prev!=NULL) currFile=currFile->prev;  //user touched prev button
-					else if(lastTouch.x>=220 && lastTouch.x<=400 && currFile->next!=NULL) currFile=currFile->next; //user touched next button
-				} else if(lastTouch.y>=210 && lastTouch.y<=240) { //user touched at the height of back, load buttons
-					if(lastTouch.x>=20 && lastTouch.x<=200) {  //user touched back button
-						mainData.status=MAIN_DISPLAY_MENU; //go back to main menu
-						free(mainData.bottomBarMsg); //remove previous message
-						mainData.bottomBarMsg=NULL;
-					} else if(lastTouch.x>=220 && lastTouch.x<=400) { //user touched LOAD button
-						asprintf(&toLoad,"%s%s%s",BASE_PATH,"Routes/",currFile->name);
-						numWPloaded=NavLoadFlightPlan(toLoad); //Attempt to load the flight plan
-						if(numWPloaded<1) { //if load route failed
-							if(toLoad!=NULL) showMessage(config.colorSchema.caution,true,"ERROR: while opening: %s",toLoad);
-							else showMessage(config.colorSchema.caution,true,"ERROR: NULL pointer to the route file to be loaded.");
-						} else showMessage(config.colorSchema.ok,true,"Loaded route: %s - %d WayPoints",currFile->name,numWPloaded);
-						free(toLoad);
-						toLoad=NULL;
-						mainData.status=MAIN_DISPLAY_MENU;
-					}
-				}
-				break;
-			case MAIN_DISPLAY_HSI: //here process the user input the HSI screen
-			case MAIN_DISPLAY_SUNRISE_SUNSET: // and in the ephemeides screen
-				mainData.status=MAIN_DISPLAY_MENU; //a touch anywhere here brings back to main menu
-				if(numWPloaded>0) showMessage(config.colorSchema.ok,false,"Loaded route: %s - %d WayPoints",currFile->name,numWPloaded);
-				else { //Nothing to display
-					free(mainData.bottomBarMsg);
-					mainData.bottomBarMsg=NULL;
-				}
-				break;
-			default:
-				doExit=true;
-				break;
-		} //end of user input processing switch
-	} //end of main loop
+	if(config.accelEnabled) { //a devName out of /dev is a recording of the accelerometer
+		const struct AccelDevice *device=config.accelDevName==NULL||strncmp(config.accelDevName,"/dev/",5)==0?&AccelDeviceTomTom:&AccelDeviceRecorded;
+		if(!AccelerometerStart(device)) showMessage(config.colorSchema.warning,true,"WARNING: accelerometer failed to start.");
+	}
+	drawScreen();
+	EventLoopAddTimer(MAIN_REFRESH_PERIOD,refreshScreen,NULL);
+	EventLoopRun(); //Main loop: the touches and the GPS are processed by the handlers until exit is touched
+	AccelerometerClose();
 	GPSreceiverClose(); //Clean and Close all ...
-	free(config.GPSdevName);
+	free(config.accelDevName);
+	free(config.accelCaptureFile);
+	free(config.GPSreplayFile);
+	for(int i=0;i<config.numOfGPSsources;i++) free(config.GPSsources[i].devName);
 	NavClose();
 	BlackBoxClose();
 	free(config.tomtomModel);
 	free(config.serialNumber);
 	free(mainData.bottomBarMsg);
-	if(numGPXfiles>0) do { //free the list of GPX files
-		currFile=fileList;
-		free(currFile->name);
-		fileList=currFile->next;
-		free(currFile);
-	} while(fileList!=NULL);
+	if(mainData.numGPXfiles>0) do { //free the list of GPX files
+		mainData.currFile=mainData.fileList;
+		free(mainData.currFile->name);
+		mainData.fileList=mainData.currFile->next;
+		free(mainData.currFile);
+	} while(mainData.fileList!=NULL);
 	releaseAll();
 	exit(EXIT_SUCCESS);
 }
 
 void releaseAll(void) {
-	closeLog();
 	TSreaderClose();
+	EventLoopClose();
 	FBrenderClose();
+	TraceClose();
+	closeLog(); //the last one, so the others can still log
 	pthread_exit(NULL);
 }
 
+void drawScreen(void) { //draws the whole current screen and shows it
+	FBrenderClear(0,screen.height,config.colorSchema.background);
+	switch(mainData.status) { //Depending on status display the proper screen
+		case MAIN_DISPLAY_MENU:
+			FBrenderBlitText(10,10,config.colorSchema.dirMarker,config.colorSchema.background,false,"AirNavigator v.%s",VERSION);
+			FBrenderBlitText(200,10,config.colorSchema.magneticDir,config.colorSchema.background,true,"http://www.alus.it/airnavigator");
+			DrawButton(20,50,mainData.numGPXfiles>0,"Load flight plan");
+			DrawButton(20,90,NavGetStatus()==NAV_STATUS_TO_START_NAV,"Start navigation");
+			DrawButton(20,130,mainData.numWPloaded>1,"Reverse flight plan");
+			DrawButton(20,170,mainData.numWPloaded>0,"Unload flight plan");
+			DrawButton(220,50,true,"Show HSI");
+			DrawButton(220,90,true,BlackBoxIsStarted()?"Stop Track Recorder":"Start Track Recorder");
+			DrawButton(220,130,BlackBoxIsStarted(),BlackBoxIsPaused()?"Resume Track Recorder":"Pause Track Recorder");
+			DrawButton(220,210,true,"EXIT");
+			if(mainData.bottomBarMsg!=NULL) FBrenderBlitText(10,260,mainData.bottomBarMsgColor,config.colorSchema.background,false,"%s                                                         ",mainData.bottomBarMsg); //render confirmation msg
+			break;
+		case MAIN_DISPLAY_SELECT_ROUTE: //Display the select GPX flight plan screen
+			FBrenderBlitText(20,20,config.colorSchema.dirMarker,config.colorSchema.background,0,"Select and load the desired GPX flight plan");
+			FBrenderBlitText(20,35,config.colorSchema.text,config.colorSchema.background,0,"%d GPX flight plans found.",mainData.numGPXfiles);
+			FBrenderBlitText(20,60,config.colorSchema.text,config.colorSchema.background,0,"Selected GPX flight plan:");
+			FBrenderBlitText(20,70,config.colorSchema.warning,config.colorSchema.background,0,"%s                                         ",mainData.currFile->name); //print the name of the current file
+			DrawButton(20,90,mainData.currFile->prev!=NULL,"<< Previous");
+			DrawButton(220,90,mainData.currFile->next!=NULL,"    Next >>");
+			DrawButton(220,210,mainData.currFile!=NULL,"    LOAD");
+			DrawButton(20,210,true,"Back to menu");
+		break;
+		case MAIN_DISPLAY_HSI: //Display HSI
+			NavRedrawNavInfo();
+			break;
+		case MAIN_DISPLAY_SUNRISE_SUNSET: // Display ephemerides
+			NavRedrawEphemeridalInfo();
+			break;
+		default:
+			break;
+	} //end of display switch
+	FBrenderFlush();
+}
+
+void processTouch(const TS_EVENT *lastTouch) { //called by the event loop each time the user touches the screen
+	switch(mainData.status) { //depending on which screen we are process the input touch
+		case MAIN_DISPLAY_MENU: //here process main menu input
+			if(lastTouch->x>=20 && lastTouch->x<=200) { //touched the first column of buttons
+				if(lastTouch->y>=50 && lastTouch->y<=80 && mainData.numGPXfiles>0) mainData.status=MAIN_DISPLAY_SELECT_ROUTE; //touched load route button
+				if(lastTouch->y>=90 && lastTouch->y<=120 && NavGetStatus()==NAV_STATUS_TO_START_NAV) { //touched start navigation button
+					NavStartNavigation();
+					mainData.status=MAIN_DISPLAY_HSI;
+				}
+				if(lastTouch->y>=130 && lastTouch->y<=160 && mainData.numWPloaded>1) { //touched reverse route button
+					if(NavReverseRoute()) showMessage(config.colorSchema.ok,false,"Route reversed."); //reverse the route
+					else showMessage(config.colorSchema.caution,true,"ERROR: Failed to reverse route.");
+				}
+				if(lastTouch->y>=170 && lastTouch->y<=200 && mainData.numWPloaded>0) { //touched unload route button
+					NavClearRoute();
+					mainData.numWPloaded=0;
+					mainData.currFile=mainData.fileList;
+					showMessage(config.colorSchema.ok,false,"Route unloaded.");
+				}
+			} else if(lastTouch->x>=220 && lastTouch->x<=400) { //touched second column of buttons
+				if(lastTouch->y>=50 && lastTouch->y<=80) mainData.status=MAIN_DISPLAY_HSI; //touched show HSI button
+				if(lastTouch->y>=90 && lastTouch->y<=120) { //touched start stop track recorder button
+					if(BlackBoxIsStarted()) {
+						BlackBoxClose();
+						showMessage(config.colorSchema.ok,true,"Track recorder stopped.");
+					} else {
+						BlackBoxStart();
+						showMessage(config.colorSchema.ok,true,"Track recorder started.");
+					}
+				}
+				if(lastTouch->y>=130 && lastTouch->y<=160 && BlackBoxIsStarted()) { //touched pause resume track recorder button
+					if(BlackBoxIsPaused()) {
+						BlackBoxResume();
+						showMessage(config.colorSchema.ok,false,"Track recorder resumed.");
+					} else {
+						BlackBoxPause();
+						showMessage(config.colorSchema.ok,false,"Track recorder paused.");
+					}
+				}
+				if(lastTouch->y>=210 && lastTouch->y<=240) { //touched exit button
+					EventLoopStop();
+					showMessage(config.colorSchema.warning,false,"Exit: releasing all... Goodbye!"); //Show goodbye message
+					FBrenderBlitText(10,260,mainData.bottomBarMsgColor,config.colorSchema.background,false,"%s                                                         ",mainData.bottomBarMsg);
+					FBrenderFlush();
+					return;
+				}
+			}
+			break;
+		case MAIN_DISPLAY_SELECT_ROUTE: //here process user input in select route screen
+			if(lastTouch->y>=90 && lastTouch->y<=120) { //user touched at the height of prev and next buttons
+				if(lastTouch->x>=20 && lastTouch->x<=200 && mainData.currFile->prev!=NULL) mainData.currFile=mainData.currFile->prev;  //user touched prev button
+				else if(lastTouch->x>=220 && lastTouch->x<=400 && mainData.currFile->next!=NULL) mainData.currFile=mainData.currFile->next; //user touched next button
+			} else if(lastTouch->y>=210 && lastTouch->y<=240) { //user touched at the height of back, load buttons
+				if(lastTouch->x>=20 && lastTouch->x<=200) {  //user touched back button
+					mainData.status=MAIN_DISPLAY_MENU; //go back to main menu
+					free(mainData.bottomBarMsg); //remove previous message
+					mainData.bottomBarMsg=NULL;
+				} else if(lastTouch->x>=220 && lastTouch->x<=400) { //user touched LOAD button
+					char *toLoad=NULL; //the path to the chosen GPX file to be loaded
+					asprintf(&toLoad,"%s%s%s",BASE_PATH,"Routes/",mainData.currFile->name);
+					mainData.numWPloaded=NavLoadFlightPlan(toLoad); //Attempt to load the flight plan
+					if(mainData.numWPloaded<1) { //if load route failed
+						if(toLoad!=NULL) showMessage(config.colorSchema.caution,true,"ERROR: while opening: %s",toLoad);
+						else showMessage(config.colorSchema.caution,true,"ERROR: NULL pointer to the route file to be loaded.");
+					} else showMessage(config.colorSchema.ok,true,"Loaded route: %s - %d WayPoints",mainData.currFile->name,mainData.numWPloaded);
+					free(toLoad);
+					mainData.status=MAIN_DISPLAY_MENU;
+				}
+			}
+			break;
+		case MAIN_DISPLAY_HSI: //here process the user input the HSI screen
+		case MAIN_DISPLAY_SUNRISE_SUNSET: // and in the ephemeides screen
+			mainData.status=MAIN_DISPLAY_MENU; //a touch anywhere here brings back to main menu
+			if(mainData.numWPloaded>0) showMessage(config.colorSchema.ok,false,"Loaded route: %s - %d WayPoints",mainData.currFile->name,mainData.numWPloaded);
+			else { //Nothing to display
+				free(mainData.bottomBarMsg);
+				mainData.bottomBarMsg=NULL;
+			}
+			break;
+		default:
+			EventLoopStop();
+			return;
+	} //end of user input processing switch
+	drawScreen();
+}
+
+void refreshScreen(void *arg) { //called periodically by the event loop to show what changes without a touch
+	if(mainData.status!=MAIN_DISPLAY_HSI) drawScreen(); //the HSI is drawn by the GPS parser at each fix
+}
+
 enum mainStatus getMainStatus(void) {
 	return mainData.status;
 }
@@ -0,0 +1,141 @@
+//============================================================================
+// Name        : airCalcAccuracy.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Accuracy of the numeric backend of AirCalc respect a reference in long double
+//============================================================================
+
+//Usage: airCalcAccuracy_double, airCalcAccuracy_float or airCalcAccuracy_fixed, as made by build.sh with the
+//AirCalc.c of each backend.
+//Legs are laid all over the Earth: starting every 10 degrees of latitude from 80 S to 80 N and every 30 degrees
+//of longitude, with courses every 30 degrees and lengths from 100 m to 1000 Km. Each leg is followed by points
+//before, along and after it, on the track and off it by up to 5 Km. The results of the functions of AirCalc used
+//for each fix are compared with the ones calculated here in long double, and the largest and RMS errors printed.
+//The courses are checked only towards points at least 1 Km away.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../../src/AirCalc.h"
+#include "../../src/FastTrig.h"
+
+#define EARTH_RADIUS_M    6371000
+#define MIN_COURSE_DIST_M 1000 //closer the course is as uncertain as the position
+
+struct vec {
+	long double x, y, z;
+};
+
+struct stat {
+	const char *name, *unit;
+	double scale;         //from rad to the unit
+	double max, sumSq;
+	long count;
+};
+
+static struct vec toVec(long double lat, long double lon) { //longitude West positive, as in AirCalc
+	struct vec v={cosl(lat)*cosl(lon),-cosl(lat)*sinl(lon),sinl(lat)};
+	return v;
+}
+
+static void fromVec(struct vec v, double *lat, double *lon) {
+	*lat=atan2l(v.z,sqrtl(v.x*v.x+v.y*v.y));
+	*lon=-atan2l(v.y,v.x);
+}
+
+static struct vec comb(long double a, struct vec u, long double b, struct vec v) {
+	struct vec r={a*u.x+b*v.x,a*u.y+b*v.y,a*u.z+b*v.z};
+	return r;
+}
+
+static struct vec crossVec(struct vec a, struct vec b) {
+	struct vec r={a.y*b.z-a.z*b.y,a.z*b.x-a.x*b.z,a.x*b.y-a.y*b.x};
+	return r;
+}
+
+static long double dotVec(struct vec a, struct vec b) {
+	return a.x*b.x+a.y*b.y+a.z*b.z;
+}
+
+static long double courseAt(struct vec p, struct vec dir) { //true course at p of the direction dir
+	long double east=p.x*dir.y-p.y*dir.x;
+	long double north=(p.x*p.x+p.y*p.y)*dir.z-p.z*(p.x*dir.x+p.y*dir.y);
+	long double c=atan2l(east,north);
+	return c<0?c+2*M_PI:c;
+}
+
+static void addError(struct stat *s, double err) {
+	if(isnan(err)) err=INFINITY;
+	err=fabs(err);
+	if(err>s->max) s->max=err;
+	s->sumSq+=err*err;
+	s->count++;
+}
+
+static double angleError(double value, long double ref) {
+	double d=fmod(fabs(value-(double)ref),2*M_PI);
+	return d>M_PI?2*M_PI-d:d;
+}
+
+int main(void) {
+	struct stat dist={"distance","m",EARTH_RADIUS_M}, course={"course","deg",180/M_PI};
+	struct stat legDist={"leg distance","m",EARTH_RADIUS_M}, xtd={"XTD","m",EARTH_RADIUS_M}, atd={"ATD","m",EARTH_RADIUS_M};
+	struct stat bearing={"bearing to WP","deg",180/M_PI}, abeam={"course abeam","deg",180/M_PI};
+	struct stat *stats[]={&dist,&course,&legDist,&xtd,&atd,&bearing,&abeam};
+	static const double lengthsM[]={100,1000,10000,100000,1000000};
+	static const double fractions[]={-0.1,0,0.25,0.5,0.9,1,1.1};
+	static const double offsetsM[]={-5000,-500,-50,0,50,500,5000};
+	FastTrigInit(); //used by AIRCALC_FIXED
+	for(int latDeg=-80;latDeg<=80;latDeg+=10) for(int lonDeg=-180;lonDeg<180;lonDeg+=30) for(int crsDeg=0;crsDeg<360;crsDeg+=30)
+		for(unsigned int l=0;l<sizeof(lengthsM)/sizeof(lengthsM[0]);l++) {
+			long double lat1=latDeg*M_PI/180, lon1=lonDeg*M_PI/180, crs=crsDeg*M_PI/180, d=lengthsM[l]/EARTH_RADIUS_M;
+			struct vec from=toVec(lat1,lon1);
+			struct vec north={-sinl(lat1)*cosl(lon1),sinl(lat1)*sinl(lon1),cosl(lat1)}; //local North and East at the start
+			struct vec east={-sinl(lon1),-cosl(lon1),0};
+			struct vec along=comb(cosl(crs),north,sinl(crs),east); //90 deg from the start along the leg
+			struct vec normal=crossVec(from,along); //on the left of the leg
+			struct vec to=comb(cosl(d),from,sinl(d),along);
+			double la1,lo1,la2,lo2;
+			fromVec(from,&la1,&lo1);
+			fromVec(to,&la2,&lo2);
+			from=toVec(la1,lo1); //the exact points given to AirCalc
+			to=toVec(la2,lo2);
+			long double refDist=atan2l(sqrtl(dotVec(crossVec(from,to),crossVec(from,to))),dotVec(from,to));
+			addError(&dist,calcAngularDist(la1,lo1,la2,lo2)-refDist);
+			double dd;
+			double crsCalc=calcGreatCircleRoute(la1,lo1,la2,lo2,&dd);
+			if(lengthsM[l]>=MIN_COURSE_DIST_M) addError(&course,angleError(crsCalc,courseAt(from,to)));
+			struct nVector wp1,wp2;
+			struct GCleg leg;
+			latLon2nVector(la1,lo1,&wp1);
+			latLon2nVector(la2,lo2,&wp2);
+			calcGCleg(la1,lo1,la2,lo2,&leg);
+			addError(&legDist,leg.dist-refDist);
+			for(unsigned int f=0;f<sizeof(fractions)/sizeof(fractions[0]);f++) for(unsigned int o=0;o<sizeof(offsetsM)/sizeof(offsetsM[0]);o++) {
+				long double a=fractions[f]*d, x=offsetsM[o]/EARTH_RADIUS_M;
+				struct vec abeamPoint=comb(cosl(a),from,sinl(a),along);
+				struct vec p=comb(cosl(x),abeamPoint,-sinl(x),normal); //XTD positive on the right
+				double lat,lon,fixAtd;
+				fromVec(p,&lat,&lon);
+				p=toVec(lat,lon);
+				struct nVector fix;
+				latLon2nVector(lat,lon,&fix);
+				addError(&xtd,calcLegCrossTrackError(&leg,&fix,&fixAtd)-x);
+				addError(&atd,fixAtd-a);
+				if(atan2l(sqrtl(dotVec(crossVec(p,to),crossVec(p,to))),dotVec(p,to))*EARTH_RADIUS_M>=MIN_COURSE_DIST_M)
+					addError(&bearing,angleError(calcNvectorCourse(&fix,&wp2),courseAt(p,to)));
+				addError(&abeam,angleError(calcLegCourseAbeam(&leg,&fix),courseAt(p,crossVec(normal,p))));
+			}
+		}
+	printf("Errors of the backend %s respect long double, courses to points at least %d m away:\n",
+		AIRCALC_BACKEND==AIRCALC_FIXED?"AIRCALC_FIXED":AIRCALC_BACKEND==AIRCALC_FLOAT?"AIRCALC_FLOAT":"AIRCALC_DOUBLE",MIN_COURSE_DIST_M);
+	for(unsigned int i=0;i<sizeof(stats)/sizeof(stats[0]);i++)
+		printf("%-14s max %12.6f %-3s RMS %12.6f %-3s over %ld cases\n",stats[i]->name,stats[i]->max*stats[i]->scale,stats[i]->unit,
+			sqrt(stats[i]->sumSq/stats[i]->count)*stats[i]->scale,stats[i]->unit,stats[i]->count);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+for backend in double float fixed; do
+	gcc -O2 -Wall -std=gnu99 -DAIRCALC_BACKEND=AIRCALC_${backend^^} airCalcAccuracy.c ../../src/AirCalc.c ../../src/FastTrig.c -o airCalcAccuracy_$backend -lm
+done
@@ -0,0 +1,160 @@
+//============================================================================
+// Name        : gpsReplay.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Plays back a GPS stream captured by AirNavigator
+//============================================================================
+
+//Usage: gpsReplay [-s speed] [-l] capture.cap output
+//The output can be a FIFO (created if it does not exist) to be used as devName of the GPS receiver, for
+//example /var/run/gpsfeed, or - for the standard output. The chunks are written as they were read by the
+//receiver: at their original pace (speed 1), N times faster (speed N) or as fast as possible (speed 0).
+//The layout of the file is described in src/GPScapture.h, this tool does not include it to be built alone.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+
+#define HEADER_SIZE 12   //magic, version and endianness mark
+#define RECORD_SIZE 12   //sec, nsec and length of each chunk
+#define MAX_CHUNK   65536
+
+static int swapBytes=0;
+
+static unsigned int getU32(const unsigned char *p) {
+	if(swapBytes) return ((unsigned int)p[0]<<24)|(p[1]<<16)|(p[2]<<8)|p[3];
+	return p[0]|(p[1]<<8)|(p[2]<<16)|((unsigned int)p[3]<<24);
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static void waitUntil(double when) {
+	double delay=when-now();
+	if(delay<=0) return;
+	struct timespec ts;
+	ts.tv_sec=(time_t)delay;
+	ts.tv_nsec=(long)((delay-ts.tv_sec)*1e9);
+	while(nanosleep(&ts,&ts)==-1 && errno==EINTR);
+}
+
+static int openOutput(const char *path) {
+	if(strcmp(path,"-")==0) return STDOUT_FILENO;
+	struct stat st;
+	if(stat(path,&st)!=0) {
+		if(mkfifo(path,0644)!=0) {
+			perror(path);
+			return -1;
+		}
+		fprintf(stderr,"Created FIFO %s, waiting for the reader...\n",path);
+	} else if(S_ISFIFO(st.st_mode)) fprintf(stderr,"Waiting for the reader of %s...\n",path);
+	int fd=open(path,O_WRONLY|O_CREAT|O_TRUNC,0644); //on a FIFO it blocks until the reader opens it
+	if(fd<0) perror(path);
+	return fd;
+}
+
+static int writeAll(int fd, const unsigned char *buf, unsigned int len) {
+	while(len>0) {
+		ssize_t done=write(fd,buf,len);
+		if(done<0) {
+			if(errno==EINTR) continue;
+			return 0;
+		}
+		buf+=done;
+		len-=done;
+	}
+	return 1;
+}
+
+static int replay(FILE *file, int out, double speed, unsigned long *chunks, unsigned long *bytes) { //one pass of the file, 0 if the output is closed
+	static unsigned char data[MAX_CHUNK];
+	unsigned char record[RECORD_SIZE];
+	double firstTime=-1, start=now();
+	fseek(file,HEADER_SIZE,SEEK_SET);
+	while(fread(record,1,RECORD_SIZE,file)==RECORD_SIZE) {
+		unsigned int length=getU32(record+8);
+		double time=getU32(record)+getU32(record+4)*1e-9;
+		if(length>MAX_CHUNK || fread(data,1,length,file)!=length) {
+			fprintf(stderr,"Truncated or corrupted capture file\n");
+			break;
+		}
+		if(firstTime<0) firstTime=time;
+		if(speed>0) waitUntil(start+(time-firstTime)/speed);
+		if(!writeAll(out,data,length)) return 0;
+		(*chunks)++;
+		*bytes+=length;
+	}
+	return 1;
+}
+
+int main(int argc, char** argv) {
+	double speed=1;
+	int loop=0, opt;
+	while((opt=getopt(argc,argv,"s:l"))!=-1) {
+		switch(opt) {
+			case 's':
+				speed=atof(optarg);
+				break;
+			case 'l':
+				loop=1;
+				break;
+			default:
+				argc=0; //print the usage
+				break;
+		}
+	}
+	if(argc-optind!=2 || speed<0) {
+		fprintf(stderr,"Usage: %s [-s speed] [-l] capture.cap output\n",argv[0]);
+		fprintf(stderr,"  -s speed  1 real time (default), N for N times faster, 0 as fast as possible\n");
+		fprintf(stderr,"  -l        loop forever\n");
+		fprintf(stderr,"  output    FIFO or file to write (a FIFO is created if missing), - for stdout\n");
+		return EXIT_FAILURE;
+	}
+	FILE *file=fopen(argv[optind],"rb");
+	if(file==NULL) {
+		perror(argv[optind]);
+		return EXIT_FAILURE;
+	}
+	unsigned char header[HEADER_SIZE];
+	if(fread(header,1,HEADER_SIZE,file)!=HEADER_SIZE || memcmp(header,"ANGC",4)!=0) {
+		fprintf(stderr,"%s is not an AirNavigator GPS capture file\n",argv[optind]);
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+	if(getU32(header+8)!=0x01020304) swapBytes=1;
+	if(getU32(header+8)!=0x01020304 || getU32(header+4)!=1) {
+		fprintf(stderr,"Unknown capture file version\n");
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+	signal(SIGPIPE,SIG_IGN); //the end of the reader is seen as a write error
+	int out=openOutput(argv[optind+1]);
+	if(out<0) {
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+	unsigned long chunks=0, bytes=0;
+	double start=now();
+	while(replay(file,out,speed,&chunks,&bytes) && loop);
+	double elapsed=now()-start;
+	fprintf(stderr,"Replayed %lu chunks, %lu bytes in %.3f s (%.0f bytes/s)\n",chunks,bytes,elapsed,elapsed>0?bytes/elapsed:0);
+	if(out!=STDOUT_FILENO) close(out);
+	fclose(file);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+gcc -O2 -Wall -std=gnu99 logDecoder.c -o logDecoder
@@ -0,0 +1,227 @@
+//============================================================================
+// Name        : logDecoder.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Host tool to convert the AirNavigator binary log files to text
+//============================================================================
+
+//Usage: logDecoder log.bin [log.1.bin ...]
+//The layout of the file is described in src/Logger.h, this tool does not include it to be built alone.
+//Integers are converted if the file was written with the other byte order, doubles also when they have
+//the two words swapped as with the FPA format of the old ARM ABI.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_SIZE  20  //size of the header of each record
+#define MAX_FORMATS 257  //256 formats plus the one redefined before each use when the table of the logger is full
+#define MAX_TEXT   1024
+
+enum recordKind {RECORD_MESSAGE, RECORD_FORMAT, RECORD_DROPPED};
+
+static const char *levelNames[]={"ERROR","WARNING","INFO","DEBUG"};
+static const char *subsystemNames[]={"main","GPS","NMEA","nav","display","touch","blackBox","config","accel"};
+
+static int swapBytes=0, swapWords=0;
+static char *formats[MAX_FORMATS];
+
+static unsigned int getU16(const unsigned char *p) {
+	return swapBytes?(p[0]<<8)|p[1]:p[0]|(p[1]<<8);
+}
+
+static unsigned int getU32(const unsigned char *p) {
+	if(swapBytes) return ((unsigned int)p[0]<<24)|(p[1]<<16)|(p[2]<<8)|p[3];
+	return p[0]|(p[1]<<8)|(p[2]<<16)|((unsigned int)p[3]<<24);
+}
+
+static unsigned long long getU64(const unsigned char *p) { //integers of 8 bytes are never word swapped
+	unsigned long long low=getU32(swapBytes?p+4:p), high=getU32(swapBytes?p:p+4);
+	return (high<<32)|low;
+}
+
+static double getDouble(const unsigned char *p) {
+	unsigned char bytes[8];
+	double value;
+	for(int i=0;i<8;i++) bytes[i]=p[swapBytes?7-i:i]; //to the byte order of this machine, assumed little endian
+	if(swapWords) for(int i=0;i<4;i++) {
+		unsigned char tmp=bytes[i];
+		bytes[i]=bytes[i+4];
+		bytes[i+4]=tmp;
+	}
+	memcpy(&value,bytes,8);
+	return value;
+}
+
+static int readHeader(FILE *file) {
+	unsigned char buf[20];
+	if(fread(buf,1,20,file)!=20 || memcmp(buf,"ANLG",4)!=0) return 0;
+	if(getU32(buf+8)!=0x01020304) {
+		swapBytes=1;
+		if(getU32(buf+8)!=0x01020304) return 0;
+	}
+	if(getU32(buf+4)!=1) {
+		fprintf(stderr,"Unknown version %u\n",getU32(buf+4));
+		return 0;
+	}
+	if(getDouble(buf+12)!=1.5) {
+		swapWords=1;
+		if(getDouble(buf+12)!=1.5) return 0;
+	}
+	return 1;
+}
+
+static int formatMessage(const char *format, const unsigned char *args, unsigned int length, char *out, int size) {
+	unsigned int pos=0;
+	int len=0;
+	for(const char *c=format;*c!='\0' && len<size-1;c++) {
+		if(*c!='%') {
+			out[len++]=*c;
+			continue;
+		}
+		if(c[1]=='%') {
+			out[len++]='%';
+			c++;
+			continue;
+		}
+		char spec[32];
+		int specLen=0;
+		spec[specLen++]=*c++;
+		while(strchr("-+ #0",*c)!=NULL && *c!='\0' && specLen<8) spec[specLen++]=*c++;
+		for(int part=0;part<2;part++) { //width and precision
+			if(part==1) {
+				if(*c!='.') break;
+				spec[specLen++]=*c++;
+			}
+			if(*c=='*') {
+				if(pos+5>length || args[pos]!='i') return len;
+				specLen+=sprintf(spec+specLen,"%d",(int)getU32(args+pos+1));
+				pos+=5;
+				c++;
+			} else while(*c>='0' && *c<='9' && specLen<24) spec[specLen++]=*c++;
+		}
+		while(strchr("hlLqjzt",*c)!=NULL && *c!='\0') c++; //the size is in the tag of the argument
+		if(*c=='\0' || pos>=length) return len;
+		char tag=args[pos++];
+		switch(*c) {
+			case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c': {
+				long long value;
+				if(tag=='i') {
+					value=getU32(args+pos);
+					if(*c=='d' || *c=='i') value=(int)value;
+					pos+=4;
+				} else if(tag=='q') {
+					value=getU64(args+pos);
+					pos+=8;
+				} else return len;
+				if(*c=='c') {
+					spec[specLen++]='c';
+					spec[specLen]='\0';
+					len+=snprintf(out+len,size-len,spec,(int)value);
+				} else {
+					spec[specLen++]='l';
+					spec[specLen++]='l';
+					spec[specLen++]=*c;
+					spec[specLen]='\0';
+					len+=snprintf(out+len,size-len,spec,value);
+				}
+			}	break;
+			case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+				if(tag!='d') return len;
+				spec[specLen++]=*c;
+				spec[specLen]='\0';
+				len+=snprintf(out+len,size-len,spec,getDouble(args+pos));
+				pos+=8;
+				break;
+			case 's': {
+				if(tag!='s') return len;
+				unsigned int textLen=getU16(args+pos);
+				pos+=2;
+				if(pos+textLen>length || textLen>=MAX_TEXT) return len;
+				char text[MAX_TEXT];
+				memcpy(text,args+pos,textLen);
+				text[textLen]='\0';
+				pos+=textLen;
+				spec[specLen++]='s';
+				spec[specLen]='\0';
+				len+=snprintf(out+len,size-len,spec,text);
+			}	break;
+			case 'p':
+				len+=snprintf(out+len,size-len,"%#llx",tag=='q'?getU64(args+pos):(unsigned long long)getU32(args+pos));
+				pos+=tag=='q'?8:4;
+				break;
+			default:
+				return len;
+		}
+		if(len>=size) len=size-1;
+	}
+	return len;
+}
+
+static int decodeFile(const char *path) {
+	FILE *file=fopen(path,"rb");
+	if(file==NULL) {
+		perror(path);
+		return 0;
+	}
+	swapBytes=0;
+	swapWords=0;
+	if(!readHeader(file)) {
+		fprintf(stderr,"%s is not an AirNavigator binary log file\n",path);
+		fclose(file);
+		return 0;
+	}
+	memset(formats,0,sizeof(formats));
+	unsigned char header[HEADER_SIZE];
+	unsigned char body[65536];
+	char text[MAX_TEXT*4];
+	while(fread(header,1,HEADER_SIZE,file)==HEADER_SIZE) {
+		unsigned int length=getU16(header+4), formatId=getU32(header+8);
+		unsigned int sec=getU32(header+12), usec=getU32(header+16);
+		if(fread(body,1,length,file)!=length) {
+			fprintf(stderr,"%s: truncated record\n",path);
+			break;
+		}
+		switch(header[0]) {
+			case RECORD_FORMAT:
+				if(formatId>=MAX_FORMATS) break;
+				free(formats[formatId]);
+				formats[formatId]=(char*)malloc(length+1);
+				memcpy(formats[formatId],body,length);
+				formats[formatId][length]='\0';
+				break;
+			case RECORD_MESSAGE: {
+				int len=0;
+				if(formatId<MAX_FORMATS && formats[formatId]!=NULL) len=formatMessage(formats[formatId],body,length,text,sizeof(text));
+				else len=sprintf(text,"<unknown format %u>",formatId);
+				if(len>0 && text[len-1]=='\n') len--;
+				text[len]='\0';
+				printf("%u.%06u %-7s %-8s T%u: %s\n",sec,usec,header[1]<4?levelNames[header[1]]:"?",header[2]<9?subsystemNames[header[2]]:"?",header[3],text);
+			}	break;
+			case RECORD_DROPPED:
+				printf("%u.%06u %-7s %-8s T%u: %u messages lost\n",sec,usec,"DROPPED","",header[3],length>=4?getU32(body):0);
+				break;
+			default:
+				fprintf(stderr,"%s: unknown record kind %u\n",path,header[0]);
+				break;
+		}
+	}
+	for(int i=0;i<MAX_FORMATS;i++) free(formats[i]);
+	fclose(file);
+	return 1;
+}
+
+int main(int argc, char** argv) {
+	if(argc<2) {
+		fprintf(stderr,"Usage: %s log.bin [log.1.bin ...]\n",argv[0]);
+		return EXIT_FAILURE;
+	}
+	int ok=1;
+	for(int i=1;i<argc;i++) ok&=decodeFile(argv[i]);
+	return ok?EXIT_SUCCESS:EXIT_FAILURE;
+}
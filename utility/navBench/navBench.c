@@ -0,0 +1,147 @@
+//============================================================================
+// Name        : navBench.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Host benchmark of the evaluation of a GPS fix against the current leg of the route
+//============================================================================
+
+//Usage: navBench [-n fixes] [-e errorMt]
+//A leg of about 60 Km with a next leg turning by 40 degrees is followed by the given number of fixes, spread
+//along it and off the track by up to the given error. Each fix is evaluated as the Navigator does in
+//NAV_TO_WPT: cross track error, along track distance, bearing to the WP, check of the bisector and course of
+//the route abeam. The number of evaluations per second is printed for the spherical trigonometry used before
+//(latitude and longitude of the WPs) and for the n-vectors precomputed for each leg used now, with the
+//largest differences between the results of the two for the fixes abeam the leg.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include "../../src/AirCalc.h"
+
+struct fix {
+	double lat, lon;
+};
+
+struct result {
+	double xtd, atd, bearing, course;
+	bool passed;
+};
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static void evalTrig(const struct fix *fixes, long n, double lat0, double lon0, double lat1, double lon1, double lat2, double lon2, struct result *res) {
+	double dist, bisector1, bisector2;
+	double initialCourse=calcGreatCircleRoute(lat0,lon0,lat1,lon1,&dist); //precomputed as the route was loaded
+	double finalCourse=calcGreatCircleFinalCourse(lat0,lon0,lat1,lon1);
+	calcBisector(finalCourse,calcGreatCircleCourse(lat1,lon1,lat2,lon2),&bisector1,&bisector2);
+	for(long i=0;i<n;i++) {
+		double atd;
+		double xtd=calcGCCrossTrackError(lat0,lon0,lon1,fixes[i].lat,fixes[i].lon,initialCourse,&atd);
+		double bearing=calcGreatCircleCourse(fixes[i].lat,fixes[i].lon,lat1,lon1);
+		res[i].passed=atd>=0 && (atd>=dist || bisectorOverpassed(finalCourse,bearing,bisector1,bisector2));
+		double latI,lonI;
+		calcIntermediatePoint(lat0,lon0,lat1,lon1,atd,dist,&latI,&lonI);
+		res[i].course=calcGreatCircleCourse(latI,lonI,lat1,lon1);
+		res[i].xtd=xtd;
+		res[i].atd=atd;
+		res[i].bearing=bearing;
+	}
+}
+
+static void evalVector(const struct fix *fixes, long n, double lat0, double lon0, double lat1, double lon1, double lat2, double lon2, struct result *res) {
+	struct nVector wp1, passNormal;
+	struct GCleg leg, next; //precomputed as the route was loaded
+	latLon2nVector(lat1,lon1,&wp1);
+	calcGCleg(lat0,lon0,lat1,lon1,&leg);
+	calcGCleg(lat1,lon1,lat2,lon2,&next);
+	calcBisectorNormal(&wp1,&leg,&next,&passNormal);
+	for(long i=0;i<n;i++) {
+		struct nVector p;
+		double atd;
+		latLon2nVector(fixes[i].lat,fixes[i].lon,&p);
+		res[i].xtd=calcLegCrossTrackError(&leg,&p,&atd);
+		res[i].bearing=calcNvectorCourse(&p,&wp1);
+		res[i].passed=atd>=0 && (atd>=leg.dist || bisectorPassed(&passNormal,&p));
+		res[i].course=calcLegCourseAbeam(&leg,&p);
+		res[i].atd=atd;
+	}
+}
+
+static double angleDiff(double a, double b) {
+	double d=fabs(a-b);
+	return d>M_PI?2*M_PI-d:d;
+}
+
+int main(int argc, char *argv[]) {
+	long n=1000000;
+	double errorMt=2000;
+	int opt;
+	while((opt=getopt(argc,argv,"n:e:"))!=-1) {
+		switch(opt) {
+			case 'n': n=atol(optarg); break;
+			case 'e': errorMt=atof(optarg); break;
+			default:
+				fprintf(stderr,"Usage: %s [-n fixes] [-e errorMt]\n",argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+	if(n<1) n=1;
+	double lat0=Deg2Rad(45.0), lon0=Deg2Rad(-7.0); //West positive as in AirNavigator
+	double lat1=Deg2Rad(45.4), lon1=Deg2Rad(-7.5);
+	double lat2=Deg2Rad(45.5), lon2=Deg2Rad(-8.3);
+	struct fix *fixes=malloc(n*sizeof(struct fix));
+	struct result *resTrig=malloc(n*sizeof(struct result));
+	struct result *resVector=malloc(n*sizeof(struct result));
+	if(fixes==NULL || resTrig==NULL || resVector==NULL) {
+		fprintf(stderr,"Not enough memory for %ld fixes\n",n);
+		return EXIT_FAILURE;
+	}
+	double dist;
+	calcGreatCircleRoute(lat0,lon0,lat1,lon1,&dist);
+	srand(1);
+	for(long i=0;i<n;i++) { //from a bit before the previous WP to a bit after the next one
+		double atd=dist*(-0.05+1.1*rand()/RAND_MAX);
+		double off=m2Rad(errorMt*(2.0*rand()/RAND_MAX-1));
+		double lat,lon;
+		calcIntermediatePoint(lat0,lon0,lat1,lon1,atd,dist,&lat,&lon);
+		fixes[i].lat=lat+off;
+		fixes[i].lon=lon+off/cos(lat);
+	}
+	double t0=now();
+	evalTrig(fixes,n,lat0,lon0,lat1,lon1,lat2,lon2,resTrig);
+	double t1=now();
+	evalVector(fixes,n,lat0,lon0,lat1,lon1,lat2,lon2,resVector);
+	double t2=now();
+	double maxXtd=0, maxAtd=0, maxBearing=0, maxCourse=0;
+	long passedDiff=0, signDiff=0;
+	for(long i=0;i<n;i++) {
+		if(resVector[i].atd<0 || resVector[i].atd>dist) continue; //there the ATD had no sign before
+		maxXtd=fmax(maxXtd,fabs(resTrig[i].xtd-resVector[i].xtd));
+		maxAtd=fmax(maxAtd,fabs(fabs(resTrig[i].atd)-resVector[i].atd));
+		if(resTrig[i].atd<0) signDiff++; //the sign was taken from the bearing from the previous WP, wrong when close to it
+		maxBearing=fmax(maxBearing,angleDiff(resTrig[i].bearing,resVector[i].bearing));
+		maxCourse=fmax(maxCourse,angleDiff(resTrig[i].course,resVector[i].course));
+		if(resTrig[i].passed!=resVector[i].passed) passedDiff++;
+	}
+	printf("fixes: %ld, leg: %.1f Km, off track up to %.0f m\n",n,Rad2Km(dist),errorMt);
+	printf("trigonometry: %10.0f evaluations/s\n",n/(t1-t0));
+	printf("n-vectors:    %10.0f evaluations/s\n",n/(t2-t1));
+	printf("largest differences abeam the leg: XTD %.3f m, ATD %.3f m, bearing %.6f deg, course %.6f deg, WP reached %ld times\n",
+		Rad2m(maxXtd),Rad2m(maxAtd),Rad2Deg(maxBearing),Rad2Deg(maxCourse),passedDiff);
+	printf("negative ATD before, abeam the leg: %ld times\n",signDiff);
+	free(fixes);
+	free(resTrig);
+	free(resVector);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+gcc -O2 -Wall -std=gnu99 -DLINUX_TARGET -I ../../include nmeaBench.c ../../src/NMEAparser.c -o nmeaBench -lm
@@ -0,0 +1,404 @@
+//============================================================================
+// Name        : nmeaBench.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Validation and speed of the NMEA field decoders respect the sscanf ones used before
+//============================================================================
+
+//Usage: nmeaBench [-r repeats] corpus
+//The corpus is a recording of a GPS receiver: the raw NMEA stream as logged from its serial port, or a capture
+//file made by AirNavigator (see src/GPScapture.h) whose chunks are joined. The sentences with a right checksum
+//are taken, and the fields of the types known by the parser (GGA, RMC, GSA, GSV, VTG, GLL, ZDA and GST of any
+//talker) are decoded with the sscanf decoders of the parser before and with the fixed point ones of
+//NMEAparser.c. Every value must be the same within the resolution of the fixed point and the precision of the
+//float of sscanf, and both must accept or refuse the same fields: each mismatch is printed and the exit status
+//is 1. Then the decoding of the whole corpus is timed repeats times with both and the sentences/s printed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <float.h>
+#include <time.h>
+#include "../../src/GPScapture.h"
+#include "../../src/NMEAparser.h"
+#include "../../src/Logger.h"
+#include "../../src/TimeBase.h"
+#include "../../src/Trace.h"
+
+#define MAX_FIELDS   30
+#define MAX_MISMATCH 20  //printed, then just counted
+
+//The decoders of NMEAparser.c, not in its header
+int hexDigitValue(char digit);
+bool parseTime(const char* field, int* timeHour, int* timeMin, int* timeMilliSec);
+bool parseDate(const char* field, int* dd, int* mm, int* yy);
+bool parseLatitude(const char* firstField, const char* secondField, int* latitude);
+bool parseLongitude(const char* firstField, const char* secondField, int* longitude);
+bool parseInteger(const char* field, int* value);
+bool parseFixed(const char* field, int decimals, long* value);
+
+struct GPSsolution; //not including GPSreceiver.h, which defines gps as NMEAparser.c does
+
+struct sentence {
+	char text[MAX_SENTENCE_LENGTH]; //fields terminated in place
+	int numOfFields;
+	const char *kinds;          //kind of each field, see decodeKinds
+	unsigned char fieldStart[MAX_FIELDS];
+};
+
+struct sentenceKinds {
+	const char *type;
+	const char *kinds; //for each field: t time, d date, a and o latitude and longitude (with the next field),
+	                   //i integer, 1 2 3 fixed with so many decimals, - not decoded; * repeats the previous kind
+};
+
+static const struct sentenceKinds decodeKinds[] = { //the fields decoded by the parser for each type
+	{"GGA","-ta-o--i23-3-1i"},
+	{"RMC","-t-a-o-23d2"},
+	{"GSA","--iiiiiiiiiiii222"},
+	{"GSV","-iiii*"},
+	{"VTG","-2-2-3"},
+	{"GLL","-a-o-t"},
+	{"ZDA","-tiii"},
+	{"GST","-t----333"}
+};
+
+static long mismatches=0;
+
+//Stubs of what NMEAparser.c needs from the rest of AirNavigator
+void GPSpublishSolution(int source, const struct GPSsolution *solution) {}
+int LogWrite(enum logLevel level, enum logSubsystem subsystem, const char *format, ...) { return 0; }
+long long TimeBaseMonotonic(void) { return 0; }
+long long TimeBaseUTC(long long monotonic) { return 0; }
+long long TimeBaseFromDayMs(long dayMs) { return 0; }
+void TraceEvent(enum traceEvent event, enum tracePhase phase, unsigned int id, unsigned int arg) {}
+
+//The sscanf decoders of the parser before
+static bool oldParseTime(const char* field, int* timeHour, int* timeMin, float* timeSec) {
+	if(field[0]=='\0') return false;
+	return (sscanf(field,"%2d%2d%f",timeHour,timeMin,timeSec)==3); //Hour, Minute, second hhmmss.sss
+}
+
+static bool oldParseDate(const char* field, int* dd, int* mm, int* yy) {
+	if(field[0]=='\0') return false;
+	if(sscanf(field,"%2d%2d%d",dd,mm,yy)!=3) return false; //Date ddmmyy
+	return (*dd>0 && *mm>0);
+}
+
+static bool oldParseLatitude(const char* firstField, const char* secondField, int* latDeg, float* latMin, bool* latNorth) {
+	if(firstField[0]=='\0' || secondField[0]=='\0') return false;
+	if(sscanf(firstField,"%2d%f",latDeg,latMin)!=2) return false; //Latitude ddmm.mm
+	switch(secondField[0]) { //North or South
+		case 'N':
+			*latNorth=true;
+			return true;
+		case 'S':
+			*latNorth=false;
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool oldParseLongitude(const char* firstField, const char* secondField, int* lonDeg, float* lonMin, bool* lonEast) {
+	if(firstField[0]=='\0' || secondField[0]=='\0') return false;
+	if(sscanf(firstField,"%3d%f",lonDeg,lonMin)!=2) return false; //Longitude dddmm.mm
+	switch(secondField[0]) { //East or West
+		case 'E':
+			*lonEast=true;
+			return true;
+		case 'W':
+			*lonEast=false;
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool oldParseInteger(const char* field, int* value) {
+	if(field[0]=='\0') return false;
+	return (sscanf(field,"%d",value)==1);
+}
+
+static bool oldParseFloat(const char* field, float* value) {
+	if(field[0]=='\0') return false;
+	return (sscanf(field,"%f",value)==1);
+}
+
+static unsigned int oldChecksum(const char *hex) { //as getCRCintValue()
+	unsigned int checksum;
+	sscanf(hex,"%x",&checksum);
+	return checksum;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static unsigned char *readCorpus(const char *path, long *length) { //the bytes of the stream, joined if a capture
+	FILE *file=fopen(path,"rb");
+	if(file==NULL) {
+		perror(path);
+		return NULL;
+	}
+	fseek(file,0,SEEK_END);
+	long size=ftell(file);
+	fseek(file,0,SEEK_SET);
+	unsigned char *data=malloc(size+1);
+	if(data==NULL || fread(data,1,size,file)!=(size_t)size) {
+		fprintf(stderr,"Cannot read %s\n",path);
+		fclose(file);
+		free(data);
+		return NULL;
+	}
+	fclose(file);
+	*length=size;
+	if(size<12 || memcmp(data,GPS_CAPTURE_MAGIC,4)!=0) return data; //raw stream
+	unsigned int endian;
+	memcpy(&endian,data+8,4);
+	if(endian!=GPS_CAPTURE_ENDIAN_MARK) {
+		fprintf(stderr,"%s is a capture file of the other byte order\n",path);
+		free(data);
+		return NULL;
+	}
+	long in=12, out=0;
+	while(in+12<=size) { //each chunk follows its header: sec, nsec and length
+		unsigned int chunk;
+		memcpy(&chunk,data+in+8,4);
+		in+=12;
+		if(chunk>size-in) break; //truncated
+		memmove(data+out,data+in,chunk);
+		out+=chunk;
+		in+=chunk;
+	}
+	*length=out;
+	return data;
+}
+
+static const char *kindsOf(const char *address) { //address is the first field, as GPGGA
+	if(strlen(address)!=5) return NULL;
+	for(unsigned int i=0;i<sizeof(decodeKinds)/sizeof(decodeKinds[0]);i++)
+		if(memcmp(address+2,decodeKinds[i].type,3)==0) return decodeKinds[i].kinds;
+	return NULL;
+}
+
+static int splitSentences(const unsigned char *data, long length, struct sentence **sentences) { //only the right ones of the known types
+	int num=0, max=1024;
+	*sentences=malloc(max*sizeof(struct sentence));
+	for(long i=0;i<length;i++) {
+		if(data[i]!='$') continue;
+		long end=i+1;
+		while(end<length && end-i<=MAX_SENTENCE_LENGTH-4 && data[end]!='*' && data[end]!='$') end++; //as the parser, up to MAX_SENTENCE_LENGTH-1 bytes with the checksum
+		if(end+2>=length || data[end]!='*') continue;
+		char hex[3]={data[end+1],data[end+2],'\0'};
+		unsigned char checksum=0;
+		for(long j=i+1;j<end;j++) checksum^=data[j];
+		int high=hexDigitValue(hex[0]), low=hexDigitValue(hex[1]);
+		if(high<0 || low<0 || ((high<<4)|low)!=checksum) continue;
+		if(oldChecksum(hex)!=checksum) {
+			if(mismatches++<MAX_MISMATCH) fprintf(stderr,"checksum %s: sscanf %X\n",hex,oldChecksum(hex));
+			continue;
+		}
+		if(num==max) *sentences=realloc(*sentences,(max*=2)*sizeof(struct sentence));
+		struct sentence *s=&(*sentences)[num];
+		memcpy(s->text,data+i+1,end-i-1);
+		s->text[end-i-1]='\0';
+		s->numOfFields=1;
+		s->fieldStart[0]=0;
+		for(char *c=s->text;*c!='\0' && s->numOfFields<MAX_FIELDS;c++) if(*c==',') {
+			*c='\0';
+			s->fieldStart[s->numOfFields++]=c+1-s->text;
+		}
+		s->kinds=kindsOf(s->text);
+		if(s->kinds!=NULL) num++;
+		i=end;
+	}
+	return num;
+}
+
+static char kindOf(const struct sentence *s, int field) {
+	const char *k=s->kinds;
+	int len=strlen(k);
+	if(k[len-1]=='*') return field<len-1?k[field]:k[len-2];
+	return field<len?k[field]:'-';
+}
+
+#define FIELD(n) (s->text+s->fieldStart[n])
+
+static void mismatch(const struct sentence *s, int field, const char *what) {
+	if(mismatches++<MAX_MISMATCH) fprintf(stderr,"%s field %d \"%s\": %s\n",s->text,field,FIELD(field),what);
+}
+
+static void validate(const struct sentence *s) { //both decoders on each field of the sentence
+	char what[120];
+	for(int f=1;f<s->numOfFields;f++) {
+		char kind=kindOf(s,f);
+		switch(kind) {
+			case 't': {
+				int h1,m1,h2,m2,ms;
+				float sec;
+				bool ok1=oldParseTime(FIELD(f),&h1,&m1,&sec), ok2=parseTime(FIELD(f),&h2,&m2,&ms);
+				double diff=ok1&&ok2?sec*1000.0-ms:0; //the new one truncates to the ms
+				if(ok1!=ok2 || (ok1 && (h1!=h2 || m1!=m2 || diff<-0.01 || diff>=1.01))) {
+					sprintf(what,"sscanf %d %02d:%02d:%f, now %d %02d:%02d %d ms",ok1,h1,m1,sec,ok2,h2,m2,ms);
+					mismatch(s,f,what);
+				}
+			} break;
+			case 'd': {
+				int d1,mo1,y1,d2,mo2,y2;
+				bool ok1=oldParseDate(FIELD(f),&d1,&mo1,&y1), ok2=parseDate(FIELD(f),&d2,&mo2,&y2);
+				if(ok1!=ok2 || (ok1 && (d1!=d2 || mo1!=mo2 || y1!=y2))) mismatch(s,f,"date");
+			} break;
+			case 'a':
+			case 'o': {
+				int deg, coord;
+				float min;
+				bool positive;
+				bool ok1=kind=='a'?oldParseLatitude(FIELD(f),FIELD(f+1),&deg,&min,&positive):oldParseLongitude(FIELD(f),FIELD(f+1),&deg,&min,&positive);
+				bool ok2=kind=='a'?parseLatitude(FIELD(f),FIELD(f+1),&coord):parseLongitude(FIELD(f),FIELD(f+1),&coord);
+				if(ok1!=ok2) mismatch(s,f,"coordinate accepted by one only");
+				else if(ok1) {
+					double ref=(deg+min/60.0)*GEO_UNITS_DEG;
+					double tol=0.5+GEO_UNITS_DEG/60.0*(0.5e-6+fabs(min)*FLT_EPSILON); //rounding of 1e-7 deg and of 1e-6 min, float of sscanf
+					if((coord>=0)!=positive || fabs(fabs((double)coord)-ref)>tol) {
+						sprintf(what,"sscanf %d %f', now %d",deg,min,coord);
+						mismatch(s,f,what);
+					}
+				}
+				f++;
+			} break;
+			case 'i': {
+				int v1,v2;
+				bool ok1=oldParseInteger(FIELD(f),&v1), ok2=parseInteger(FIELD(f),&v2);
+				if(ok1!=ok2 || (ok1 && v1!=v2)) {
+					sprintf(what,"sscanf %d %d, now %d %d",ok1,ok1?v1:0,ok2,ok2?v2:0);
+					mismatch(s,f,what);
+				}
+			} break;
+			case '1':
+			case '2':
+			case '3': {
+				int decimals=kind-'0';
+				double scale=pow(10,decimals);
+				float v1;
+				long v2;
+				bool ok1=oldParseFloat(FIELD(f),&v1), ok2=parseFixed(FIELD(f),decimals,&v2);
+				if(ok1!=ok2 || (ok1 && fabs(v1*scale-v2)>0.5+fabs(v1)*scale*FLT_EPSILON)) {
+					sprintf(what,"sscanf %d %f, now %d %ld",ok1,ok1?v1:0,ok2,ok2?v2:0);
+					mismatch(s,f,what);
+				}
+			} break;
+		}
+	}
+}
+
+static long decodeOld(const struct sentence *s) { //all the fields as the parser did before
+	long sum=0;
+	for(int f=1;f<s->numOfFields;f++) switch(kindOf(s,f)) {
+		case 't': {
+			int h,m;
+			float sec;
+			if(oldParseTime(FIELD(f),&h,&m,&sec)) sum+=h+m+(long)sec;
+		} break;
+		case 'd': {
+			int d,m,y;
+			if(oldParseDate(FIELD(f),&d,&m,&y)) sum+=d+m+y;
+		} break;
+		case 'a':
+		case 'o': {
+			int deg;
+			float min;
+			bool positive;
+			if(kindOf(s,f)=='a'?oldParseLatitude(FIELD(f),FIELD(f+1),&deg,&min,&positive):oldParseLongitude(FIELD(f),FIELD(f+1),&deg,&min,&positive)) sum+=deg+(long)min;
+			f++;
+		} break;
+		case 'i': {
+			int v;
+			if(oldParseInteger(FIELD(f),&v)) sum+=v;
+		} break;
+		case '1':
+		case '2':
+		case '3': {
+			float v;
+			if(oldParseFloat(FIELD(f),&v)) sum+=(long)v;
+		} break;
+	}
+	return sum;
+}
+
+static long decodeNew(const struct sentence *s) { //all the fields as the parser does now
+	long sum=0;
+	for(int f=1;f<s->numOfFields;f++) switch(kindOf(s,f)) {
+		case 't': {
+			int h,m,ms;
+			if(parseTime(FIELD(f),&h,&m,&ms)) sum+=h+m+ms;
+		} break;
+		case 'd': {
+			int d,m,y;
+			if(parseDate(FIELD(f),&d,&m,&y)) sum+=d+m+y;
+		} break;
+		case 'a':
+		case 'o': {
+			int coord;
+			if(kindOf(s,f)=='a'?parseLatitude(FIELD(f),FIELD(f+1),&coord):parseLongitude(FIELD(f),FIELD(f+1),&coord)) sum+=coord;
+			f++;
+		} break;
+		case 'i': {
+			int v;
+			if(parseInteger(FIELD(f),&v)) sum+=v;
+		} break;
+		case '1':
+		case '2':
+		case '3': {
+			long v;
+			if(parseFixed(FIELD(f),kindOf(s,f)-'0',&v)) sum+=v;
+		} break;
+	}
+	return sum;
+}
+
+int main(int argc, char *argv[]) {
+	int repeats=100, opt;
+	while((opt=getopt(argc,argv,"r:"))!=-1) {
+		switch(opt) {
+			case 'r': repeats=atoi(optarg); break;
+			default: argc=0; break; //print the usage
+		}
+	}
+	if(argc-optind!=1) {
+		fprintf(stderr,"Usage: %s [-r repeats] corpus\n",argv[0]);
+		return EXIT_FAILURE;
+	}
+	if(repeats<1) repeats=1;
+	long length;
+	unsigned char *data=readCorpus(argv[optind],&length);
+	if(data==NULL) return EXIT_FAILURE;
+	struct sentence *sentences;
+	int num=splitSentences(data,length,&sentences);
+	free(data);
+	if(num==0) {
+		fprintf(stderr,"No known NMEA sentences in %s\n",argv[optind]);
+		return EXIT_FAILURE;
+	}
+	for(int i=0;i<num;i++) validate(&sentences[i]);
+	printf("%d sentences, %ld mismatches\n",num,mismatches);
+	volatile long sink=0; //so that nothing is optimized away
+	double t0=now();
+	for(int r=0;r<repeats;r++) for(int i=0;i<num;i++) sink+=decodeOld(&sentences[i]);
+	double t1=now();
+	for(int r=0;r<repeats;r++) for(int i=0;i<num;i++) sink+=decodeNew(&sentences[i]);
+	double t2=now();
+	printf("sscanf:      %10.0f sentences/s\n",(double)num*repeats/(t1-t0));
+	printf("fixed point: %10.0f sentences/s\n",(double)num*repeats/(t2-t1));
+	free(sentences);
+	return mismatches==0?EXIT_SUCCESS:EXIT_FAILURE;
+}
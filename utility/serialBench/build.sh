@@ -0,0 +1,3 @@
+#!/bin/bash
+
+gcc -O2 -Wall -std=gnu99 -DLINUX_TARGET serialBench.c ../../src/SerialPort.c ../../src/RingBuffer.c -o serialBench -lpthread -lrt
@@ -0,0 +1,236 @@
+//============================================================================
+// Name        : serialBench.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Host benchmark of the latency from the serial port to the GPS parser
+//============================================================================
+
+//Usage: serialBench [-b baud] [-r Hz] [-s bytes] [-e epochs] [minRead...]
+//A pseudo terminal stands in for the serial port of the GPS: a writer thread sends on the master side a burst
+//of NMEA sentences at each epoch, in chunks of 16 bytes paced as a UART at the given baud rate would deliver
+//them. The slave side is set up with SerialPortSetup() of AirNavigator and read as the GPS receiver does: a
+//reader thread moves the bytes in a ring when the port is readable, or every SERIAL_DRAIN_PERIOD ms for the
+//tail of the bursts, and wakes up a parser thread. For each value of minRead (VMIN) the
+//latency from the write of each chunk to its arrival to the parser and the number of wake ups are printed.
+//The pseudo terminal does not support the low latency mode of the real serial drivers.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include "../../src/SerialPort.h"
+#include "../../src/RingBuffer.h"
+#include "../../src/Logger.h"
+
+#define CHUNK_SIZE 16
+#define MAX_CHUNKS 200000
+
+static const char *sentences= //a typical burst of a 1 Hz receiver
+	"$GPGGA,123519.00,4807.03800,N,01131.00000,E,1,08,0.9,545.4,M,46.9,M,,*69\r\n"
+	"$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+	"$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n"
+	"$GPGSV,2,2,08,15,40,083,46,16,17,308,41,17,07,344,39,18,22,228,45*7F\r\n"
+	"$GPRMC,123519.00,A,4807.03800,N,01131.00000,E,022.4,084.4,230394,003.1,W*44\r\n"
+	"$GPVTG,084.4,T,087.5,M,022.4,N,041.5,K*48\r\n";
+
+struct bench {
+	int master, slave;
+	long baud, rateHz, burstSize, epochs;
+	long chunks;                 //chunks written
+	double *writeTimes;          //time of the write of each chunk
+	double *latencies;           //from the write to the parser of the last byte of each chunk
+	volatile bool reading;
+	struct RingBuffer ring;
+	pthread_mutex_t mutex;
+	pthread_cond_t signal;
+	long wakeUps;                //reads done by the reader
+	int minRead;                 //VMIN of the port
+};
+
+int LogWrite(enum logLevel level, enum logSubsystem subsystem, const char *format, ...) { //instead of the one of Logger.c
+	static char last[256]="";
+	char text[256];
+	va_list args;
+	va_start(args,format);
+	int len=vsnprintf(text,sizeof(text),format,args);
+	va_end(args);
+	if(strcmp(text,last)!=0) fprintf(stderr,"SerialPort: %s",text); //print the same message once
+	strcpy(last,text);
+	return len;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static void sleepUntil(double t) {
+	double left=t-now();
+	if(left<=0) return;
+	struct timespec ts={(time_t)left,(long)((left-(time_t)left)*1e9)};
+	nanosleep(&ts,NULL);
+}
+
+static int compareDoubles(const void *a, const void *b) {
+	double diff=*(const double*)a-*(const double*)b;
+	return diff<0?-1:diff>0;
+}
+
+static void* writer(void *ptr) {
+	struct bench *b=(struct bench*)ptr;
+	long sentencesLen=strlen(sentences);
+	double chunkTime=CHUNK_SIZE*10.0/b->baud; //start, 8 data and stop bits for each byte
+	double start=now()+0.1;
+	long offset=0;
+	for(long e=0;e<b->epochs && b->chunks<MAX_CHUNKS;e++) {
+		double t=start+(double)e/b->rateHz;
+		for(long sent=0;sent<b->burstSize && b->chunks<MAX_CHUNKS;sent+=CHUNK_SIZE) {
+			char chunk[CHUNK_SIZE];
+			for(int i=0;i<CHUNK_SIZE;i++) chunk[i]=sentences[(offset+i)%sentencesLen];
+			offset+=CHUNK_SIZE;
+			t+=chunkTime;
+			sleepUntil(t); //the last byte of the chunk has been received by the UART
+			b->writeTimes[b->chunks]=now();
+			if(write(b->master,chunk,CHUNK_SIZE)!=CHUNK_SIZE) perror("write");
+			b->chunks++;
+		}
+	}
+	sleepUntil(now()+0.3); //let the last bytes arrive also waiting for the drain of the tail
+	b->reading=false;
+	pthread_mutex_lock(&b->mutex);
+	pthread_cond_signal(&b->signal);
+	pthread_mutex_unlock(&b->mutex);
+	return NULL;
+}
+
+static void* reader(void *ptr) { //as readGPSdevice() and drainGPSdevices() in GPSreceiver.c
+	struct bench *b=(struct bench*)ptr;
+	unsigned char *buf;
+	double drainTime=now()+SERIAL_DRAIN_PERIOD/1000.0;
+	while(b->reading) {
+		fd_set readfs;
+		double left=drainTime-now();
+		if(left<0) left=0;
+		struct timeval timeout={(long)left,(long)((left-(long)left)*1e6)};
+		FD_ZERO(&readfs);
+		FD_SET(b->slave,&readfs);
+		bool drain=select(b->slave+1,&readfs,NULL,NULL,&timeout)!=1; //the drain timer: the port is non blocking
+		if(drain) {
+			drainTime+=SERIAL_DRAIN_PERIOD/1000.0;
+			if(drainTime<=now()) drainTime=now()+SERIAL_DRAIN_PERIOD/1000.0; //as the timers of the event loop
+			if(b->minRead<=1) continue; //as the receiver, that drains only the ports with minRead>1
+		}
+		int redBytes, reads=0;
+		do { //a wake up reads once, the drain until the port is empty
+			unsigned int space=RingBufferGetWriteSpace(&b->ring,&buf);
+			if(space==0) break;
+			redBytes=read(b->slave,buf,space);
+			if(redBytes<=0) break;
+			if(reads++==0) b->wakeUps++;
+			RingBufferCommitWrite(&b->ring,redBytes);
+			pthread_mutex_lock(&b->mutex);
+			pthread_cond_signal(&b->signal);
+			pthread_mutex_unlock(&b->mutex);
+		} while(drain);
+	}
+	return NULL;
+}
+
+static void parse(struct bench *b) { //as runParser() in GPSreceiver.c: only the arrival of the bytes is taken
+	unsigned char *buf;
+	unsigned int len;
+	unsigned long received=0;
+	while(b->reading) {
+		pthread_mutex_lock(&b->mutex);
+		while(b->reading && RingBufferUsed(&b->ring)==0) pthread_cond_wait(&b->signal,&b->mutex);
+		pthread_mutex_unlock(&b->mutex);
+		double t=now();
+		while((len=RingBufferGetReadSpace(&b->ring,&buf))>0) {
+			unsigned long end=received+len;
+			for(unsigned long chunk=received/CHUNK_SIZE;chunk<end/CHUNK_SIZE;chunk++) b->latencies[chunk]=t-b->writeTimes[chunk]; //its last byte has arrived
+			received=end;
+			RingBufferCommitRead(&b->ring,len);
+		}
+	}
+}
+
+static void runBench(struct bench *b, int minRead) {
+	if(!SerialPortSetup(b->slave,b->baud,8,1,0,minRead)) exit(EXIT_FAILURE);
+	b->minRead=minRead;
+	b->chunks=0;
+	b->wakeUps=0;
+	b->reading=true;
+	pthread_t writerThread, readerThread;
+	pthread_create(&readerThread,NULL,reader,b);
+	pthread_create(&writerThread,NULL,writer,b);
+	parse(b);
+	pthread_join(writerThread,NULL);
+	pthread_join(readerThread,NULL);
+	while(RingBufferUsed(&b->ring)>0) {
+		unsigned char *buf;
+		RingBufferCommitRead(&b->ring,RingBufferGetReadSpace(&b->ring,&buf));
+	}
+	qsort(b->latencies,b->chunks,sizeof(double),compareDoubles);
+	printf("minRead %3d  %6ld chunks  %6ld wake ups  %5.1f bytes/wake up  p50 %7.3f ms  p99 %7.3f ms  max %7.3f ms\n",minRead,
+		b->chunks,b->wakeUps,b->wakeUps>0?(double)b->chunks*CHUNK_SIZE/b->wakeUps:0,
+		b->latencies[b->chunks/2]*1e3,b->latencies[(b->chunks*99)/100]*1e3,b->latencies[b->chunks-1]*1e3);
+}
+
+int main(int argc, char** argv) {
+	struct bench b={.baud=115200,.rateHz=10,.burstSize=512,.epochs=100};
+	int opt;
+	while((opt=getopt(argc,argv,"b:r:s:e:"))!=-1) switch(opt) {
+		case 'b': b.baud=atol(optarg); break;
+		case 'r': b.rateHz=atol(optarg); break;
+		case 's': b.burstSize=atol(optarg); break;
+		case 'e': b.epochs=atol(optarg); break;
+		default:
+			fprintf(stderr,"Usage: %s [-b baud] [-r Hz] [-s bytes] [-e epochs] [minRead...]\n",argv[0]);
+			fprintf(stderr,"  defaults: 115200 baud, 10 Hz, 512 bytes for each epoch, 100 epochs, minRead 1 and 64\n");
+			return EXIT_FAILURE;
+	}
+	if(SerialPortBaudConstant(b.baud)==B0 || b.rateHz<=0 || b.burstSize<=0 || b.epochs<=0) {
+		fprintf(stderr,"Invalid parameters\n");
+		return EXIT_FAILURE;
+	}
+	b.master=posix_openpt(O_RDWR|O_NOCTTY);
+	if(b.master<0 || grantpt(b.master)!=0 || unlockpt(b.master)!=0) {
+		perror("posix_openpt");
+		return EXIT_FAILURE;
+	}
+	b.slave=open(ptsname(b.master),O_RDWR|O_NOCTTY|O_NONBLOCK); //opened as the GPS receiver does
+	if(b.slave<0) {
+		perror(ptsname(b.master));
+		return EXIT_FAILURE;
+	}
+	b.writeTimes=(double*)malloc(MAX_CHUNKS*sizeof(double));
+	b.latencies=(double*)malloc(MAX_CHUNKS*sizeof(double));
+	if(b.writeTimes==NULL || b.latencies==NULL || !RingBufferInit(&b.ring,65536)) {
+		fprintf(stderr,"Out of memory\n");
+		return EXIT_FAILURE;
+	}
+	pthread_mutex_init(&b.mutex,NULL);
+	pthread_cond_init(&b.signal,NULL);
+	printf("%ld baud, %ld Hz, %ld bytes for each epoch\n",b.baud,b.rateHz,b.burstSize);
+	if(optind==argc) {
+		runBench(&b,1);
+		runBench(&b,64);
+	} else for(int i=optind;i<argc;i++) runBench(&b,atoi(argv[i]));
+	RingBufferRelease(&b.ring);
+	close(b.slave);
+	close(b.master);
+	return EXIT_SUCCESS;
+}
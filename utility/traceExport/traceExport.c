@@ -0,0 +1,172 @@
+//============================================================================
+// Name        : traceExport.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Host tool to convert the AirNavigator trace file in the Chrome trace format
+//============================================================================
+
+//Usage: traceExport trace.bin [trace.json]
+//The JSON file can be opened with chrome://tracing or https://ui.perfetto.dev, the statistics of the latency
+//from the GPS to the display are printed on the standard error.
+//The latency of each epoch is measured from the arrival of the bytes of its first sentence to the end of the
+//first flush of the frame buffer done by the parser thread after the epoch has been closed.
+//The layout of the file is described in src/Trace.h, this tool does not include it to be built alone.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_SIZE 12 //magic, version and endianness mark
+#define RECORD_SIZE 20
+
+enum traceEvent {TRACE_BYTES_ARRIVED, TRACE_SENTENCE_OK, TRACE_EPOCH_CLOSED, TRACE_NAV_UPDATE, TRACE_HSI_DRAW, TRACE_FB_FLUSH, TRACE_NUM_EVENTS};
+enum tracePhase {TRACE_INSTANT, TRACE_BEGIN, TRACE_END};
+
+static const char *eventNames[TRACE_NUM_EVENTS]={"bytes arrived","sentence","epoch closed","navigation","HSI draw","frame buffer flush"};
+static const char phaseNames[]={'i','B','E'};
+
+struct record {
+	double time; //seconds
+	unsigned int id, arg;
+	unsigned char event, phase, thread;
+};
+
+static int swapBytes=0;
+
+static unsigned int getU32(const unsigned char *p) {
+	if(swapBytes) return ((unsigned int)p[0]<<24)|(p[1]<<16)|(p[2]<<8)|p[3];
+	return p[0]|(p[1]<<8)|(p[2]<<16)|((unsigned int)p[3]<<24);
+}
+
+static int compareRecords(const void *a, const void *b) {
+	double diff=((const struct record*)a)->time-((const struct record*)b)->time;
+	return diff<0?-1:diff>0;
+}
+
+static int compareDoubles(const void *a, const void *b) {
+	double diff=*(const double*)a-*(const double*)b;
+	return diff<0?-1:diff>0;
+}
+
+static struct record* readRecords(const char *path, long *num) {
+	FILE *file=fopen(path,"rb");
+	if(file==NULL) {
+		perror(path);
+		return NULL;
+	}
+	unsigned char buf[RECORD_SIZE];
+	if(fread(buf,1,HEADER_SIZE,file)!=HEADER_SIZE || memcmp(buf,"ANTR",4)!=0) {
+		fprintf(stderr,"%s is not an AirNavigator trace file\n",path);
+		fclose(file);
+		return NULL;
+	}
+	if(getU32(buf+8)!=0x01020304) swapBytes=1;
+	if(getU32(buf+8)!=0x01020304 || getU32(buf+4)!=1) {
+		fprintf(stderr,"Unknown trace file version\n");
+		fclose(file);
+		return NULL;
+	}
+	fseek(file,0,SEEK_END);
+	long max=(ftell(file)-HEADER_SIZE)/RECORD_SIZE;
+	fseek(file,HEADER_SIZE,SEEK_SET);
+	struct record *records=(struct record*)malloc((max>0?max:1)*sizeof(struct record));
+	*num=0;
+	while(*num<max && fread(buf,1,RECORD_SIZE,file)==RECORD_SIZE) {
+		struct record *r=&records[*num];
+		r->time=getU32(buf)+getU32(buf+4)*1e-9;
+		r->id=getU32(buf+8);
+		r->arg=getU32(buf+12);
+		r->event=buf[16];
+		r->phase=buf[17];
+		r->thread=buf[18];
+		if(r->event<TRACE_NUM_EVENTS && r->phase<=TRACE_END) (*num)++; //skip the unknown ones
+	}
+	fclose(file);
+	qsort(records,*num,sizeof(struct record),compareRecords); //the rings of the threads are written one after the other
+	return records;
+}
+
+static void writeJSON(FILE *out, const struct record *records, long num) {
+	double start=num>0?records[0].time:0;
+	fprintf(out,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for(long i=0;i<num;i++) {
+		const struct record *r=&records[i];
+		fprintf(out,"{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",eventNames[r->event],phaseNames[r->phase],(r->time-start)*1e6,r->thread);
+		if(r->phase==TRACE_INSTANT) fprintf(out,",\"s\":\"t\",\"args\":{\"id\":%u,\"arg\":%u}",r->id,r->arg);
+		fprintf(out,"}%s\n",i<num-1?",":"");
+	}
+	fprintf(out,"]}\n");
+}
+
+static double arrivalTime(const struct record *records, long before, unsigned int offset) { //time of the chunk of bytes containing the given offset, -1 if not found
+	for(long i=before-1;i>=0;i--) if(records[i].event==TRACE_BYTES_ARRIVED) {
+		unsigned int end=records[i].id, start=end-records[i].arg; //free running offsets
+		if(offset-start<records[i].arg) return records[i].time;
+		if((int)(end-offset)<=0) break; //this chunk and the older ones are before the offset
+	}
+	return -1;
+}
+
+static double displayTime(const struct record *records, long num, long after) { //end of the first flush of the same thread, -1 if not found
+	unsigned char thread=records[after].thread;
+	for(long i=after+1;i<num;i++) if(records[i].thread==thread) {
+		if(records[i].event==TRACE_EPOCH_CLOSED) break; //the epoch has not been displayed
+		if(records[i].event==TRACE_FB_FLUSH && records[i].phase==TRACE_END) return records[i].time;
+	}
+	return -1;
+}
+
+static void printStats(const char *name, double *values, long num) {
+	if(num==0) return;
+	qsort(values,num,sizeof(double),compareDoubles);
+	fprintf(stderr,"%-18s p50 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n",name,values[num/2]*1e3,values[(num*99)/100]*1e3,values[num-1]*1e3);
+}
+
+static void computeLatencies(const struct record *records, long num) {
+	long epochs=0, measured=0;
+	double *fixToDisplay=(double*)malloc((num>0?num:1)*sizeof(double));
+	double *closeToDisplay=(double*)malloc((num>0?num:1)*sizeof(double));
+	for(long i=0;i<num;i++) if(records[i].event==TRACE_EPOCH_CLOSED) {
+		epochs++;
+		double displayed=displayTime(records,num,i);
+		double arrived=arrivalTime(records,i,records[i].arg);
+		if(displayed<0 || arrived<0) continue;
+		fixToDisplay[measured]=displayed-arrived;
+		closeToDisplay[measured]=displayed-records[i].time;
+		measured++;
+	}
+	fprintf(stderr,"%ld events, %ld epochs, %ld displayed\n",num,epochs,measured);
+	printStats("fix to display",fixToDisplay,measured);
+	printStats("close to display",closeToDisplay,measured);
+	free(fixToDisplay);
+	free(closeToDisplay);
+}
+
+int main(int argc, char** argv) {
+	if(argc<2 || argc>3) {
+		fprintf(stderr,"Usage: %s trace.bin [trace.json]\n",argv[0]);
+		fprintf(stderr,"  without the JSON file only the statistics of the latency are printed\n");
+		return EXIT_FAILURE;
+	}
+	long num=0;
+	struct record *records=readRecords(argv[1],&num);
+	if(records==NULL) return EXIT_FAILURE;
+	if(argc==3) {
+		FILE *out=fopen(argv[2],"w");
+		if(out==NULL) {
+			perror(argv[2]);
+			free(records);
+			return EXIT_FAILURE;
+		}
+		writeJSON(out,records,num);
+		fclose(out);
+	}
+	computeLatencies(records,num);
+	free(records);
+	return EXIT_SUCCESS;
+}
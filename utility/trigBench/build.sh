@@ -0,0 +1,3 @@
+#!/bin/bash
+
+gcc -O2 -Wall -std=gnu99 -DTRIG_TABLE_BITS=${1:-12} trigBench.c ../../src/FastTrig.c -o trigBench -lm
@@ -0,0 +1,115 @@
+//============================================================================
+// Name        : trigBench.c
+// Since       : 18/10/2026
+// Author      : Alberto Realis-Luc <alberto.realisluc@gmail.com>
+// Web         : http://www.alus.it/airnavigator/
+// Copyright   : (C) 2010-2016 Alberto Realis-Luc
+// License     : GNU GPL v2
+// Repository  : https://github.com/AirNavigator/AirNavigator.git
+// Last change : 18/10/2026
+// Description : Errors and speed of the table trigonometry of FastTrig.c respect libm
+//============================================================================
+
+//Usage: trigBench [-n samples]
+//Build it with build.sh giving the bits of the tables (12 if not given), as TRIGBITS in the Makefile.
+//FastTrigSin, FastTrigCos, FastTrigAtan2 and FastTrigAsin are compared with sin, cos, atan2 and asin of libm
+//in double on random angles and points, and the largest errors printed. Then the time of each one is measured
+//together with the ones of libm in double and in single precision. On a PC with an FPU libm is fast: the gain
+//is on the TomTom, where libm runs on the emulated floating point (build it for ARM with -mcpu=arm920t).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include "../../src/FastTrig.h"
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static unsigned int randomAngle(void) {
+	return ((unsigned int)rand()<<16)^(unsigned int)rand();
+}
+
+static int randomQ30(void) { //between -1 and 1
+	return (int)((long long)randomAngle()-TRIG_HALF_TURN)/2;
+}
+
+static double angleError(unsigned int angle, double rad) { //respect a reference in rad, in rad
+	double d=fmod(fabs(FastTrigAngle2Rad(angle)-rad),2*M_PI);
+	return d>M_PI?2*M_PI-d:d;
+}
+
+int main(int argc, char *argv[]) {
+	long n=10000000;
+	int opt;
+	while((opt=getopt(argc,argv,"n:"))!=-1) {
+		switch(opt) {
+			case 'n': n=atol(optarg); break;
+			default:
+				fprintf(stderr,"Usage: %s [-n samples]\n",argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+	if(n<1) n=1;
+	FastTrigInit();
+	unsigned int *angles=malloc(n*sizeof(unsigned int));
+	int *ys=malloc(n*sizeof(int)), *xs=malloc(n*sizeof(int));
+	double *rads=malloc(n*sizeof(double)), *ysD=malloc(n*sizeof(double)), *xsD=malloc(n*sizeof(double));
+	float *radsF=malloc(n*sizeof(float)), *ysF=malloc(n*sizeof(float)), *xsF=malloc(n*sizeof(float));
+	if(angles==NULL || ys==NULL || xs==NULL || rads==NULL || ysD==NULL || xsD==NULL || radsF==NULL || ysF==NULL || xsF==NULL) {
+		fprintf(stderr,"Not enough memory for %ld samples\n",n);
+		return EXIT_FAILURE;
+	}
+	srand(1);
+	for(long i=0;i<n;i++) {
+		angles[i]=randomAngle();
+		rads[i]=FastTrigAngle2Rad(angles[i]);
+		radsF[i]=rads[i];
+		ys[i]=randomQ30();
+		xs[i]=randomQ30();
+		ysD[i]=ys[i];
+		xsD[i]=xs[i];
+		ysF[i]=ys[i];
+		xsF[i]=xs[i];
+	}
+	double maxSin=0, maxCos=0, maxAtan2=0, maxAsin=0;
+	for(long i=0;i<n;i++) {
+		maxSin=fmax(maxSin,fabs((double)FastTrigSin(angles[i])/TRIG_ONE-sin(rads[i])));
+		maxCos=fmax(maxCos,fabs((double)FastTrigCos(angles[i])/TRIG_ONE-cos(rads[i])));
+		maxAtan2=fmax(maxAtan2,angleError(FastTrigAtan2(ys[i],xs[i]),atan2(ysD[i],xsD[i])));
+		maxAsin=fmax(maxAsin,angleError(FastTrigAsin(ys[i]),asin(ysD[i]/TRIG_ONE)));
+	}
+	printf("%ld samples, largest errors: sin %.2e, cos %.2e, atan2 %.2e rad, asin %.2e rad\n",n,maxSin,maxCos,maxAtan2,maxAsin);
+	volatile long long sumI=0; //so that nothing is optimized away
+	volatile double sumD=0;
+	volatile float sumF=0;
+	double t0=now();
+	for(long i=0;i<n;i++) sumI+=FastTrigSin(angles[i])+FastTrigCos(angles[i]);
+	double t1=now();
+	for(long i=0;i<n;i++) sumD+=sin(rads[i])+cos(rads[i]);
+	double t2=now();
+	for(long i=0;i<n;i++) sumF+=sinf(radsF[i])+cosf(radsF[i]);
+	double t3=now();
+	for(long i=0;i<n;i++) sumI+=FastTrigAtan2(ys[i],xs[i]);
+	double t4=now();
+	for(long i=0;i<n;i++) sumD+=atan2(ysD[i],xsD[i]);
+	double t5=now();
+	for(long i=0;i<n;i++) sumF+=atan2f(ysF[i],xsF[i]);
+	double t6=now();
+	printf("sin+cos: FastTrig %6.1f ns, libm double %6.1f ns, libm float %6.1f ns\n",(t1-t0)/n*1e9,(t2-t1)/n*1e9,(t3-t2)/n*1e9);
+	printf("atan2:   FastTrig %6.1f ns, libm double %6.1f ns, libm float %6.1f ns\n",(t4-t3)/n*1e9,(t5-t4)/n*1e9,(t6-t5)/n*1e9);
+	free(angles);
+	free(ys);
+	free(xs);
+	free(rads);
+	free(ysD);
+	free(xsD);
+	free(radsF);
+	free(ysF);
+	free(xsF);
+	return EXIT_SUCCESS;
+}